@@ -31,17 +31,17 @@
 		 |  0  0 10 |
  */
 int main(int argc, char* argv[]) {
-	dvec3 V1(1, 2, 3);
-	dvec3 V2(-1, -2, -3);
+	rvec3 V1(1, 2, 3);
+	rvec3 V2(-1, -2, -3);
 
-	dmat2 M2x2A(2, 4, 1, 2);
+	rmat2 M2x2A(2, 4, 1, 2);
 
-	dmat3 M3x3A(1, 0, 3, 2, 1, 1, 3, 2, 0);
-	dmat3 M3x3B(1, 2, 3, 2, 4, 0, 0, 0, 1);
-	dmat3 M3x3C(10, 0, 0, 0, 10, 0, 0, 0, 10);
+	rmat3 M3x3A(1, 0, 3, 2, 1, 1, 3, 2, 0);
+	rmat3 M3x3B(1, 2, 3, 2, 4, 0, 0, 0, 1);
+	rmat3 M3x3C(10, 0, 0, 0, 10, 0, 0, 0, 10);
 
-	vector<dmat3> vecMats = { M3x3A, M3x3B, M3x3C };
-	vector<dvec3> vecVecs = { V1, V2 };
+	vector<rmat3> vecMats = { M3x3A, M3x3B, M3x3C };
+	vector<rvec3> vecVecs = { V1, V2 };
 
 	cout << "Get row: " << endl;
 	cout << getRow(M3x3A, 0) << endl;			// [1 2 3]
@@ -11,8 +11,8 @@
 #include "rasterization.h"
 
 vector<PositionalLightPtr> lights = {
-	new PositionalLight(dvec3(10, 10, 10), pureWhiteLight),
-	new SpotLight(dvec3(2, 5, -2), dvec3(0,-1,0), glm::radians(45.0), pureWhiteLight)
+	new PositionalLight(rvec3(10, 10, 10), pureWhiteLight),
+	new SpotLight(rvec3(2, 5, -2), rvec3(0,-1,0), glm::radians(45.0), pureWhiteLight)
 };
 
 PositionalLightPtr posLight = lights[0];
@@ -21,10 +21,10 @@ SpotLightPtr spotLight = (SpotLightPtr)lights[1];
 FrameBuffer frameBuffer(WINDOW_WIDTH, WINDOW_HEIGHT);
 RayTracer rayTrace(lightGray);
 
-dvec3 cameraPos(0, 5, 10);
-dvec3 cameraFocus(0, 5, 0);
-dvec3 cameraUp = Y_AXIS;
-double cameraFOV = PI_2;
+rvec3 cameraPos(0, 5, 10);
+rvec3 cameraFocus(0, 5, 0);
+rvec3 cameraUp = Y_AXIS;
+real cameraFOV = PI_2;
 
 PerspectiveCamera pCamera(cameraPos, cameraFocus, cameraUp, cameraFOV, WINDOW_WIDTH, WINDOW_HEIGHT);
 IScene scene(&pCamera);
@@ -34,12 +34,12 @@ void render() {
 	int width = frameBuffer.getWindowWidth();
 	int height = frameBuffer.getWindowHeight();
 
-	double N = 10.0;
+	real N = 10.0;
 	pCamera = PerspectiveCamera(cameraPos, cameraFocus, cameraUp, cameraFOV, width, height);
 	rayTrace.raytraceScene(frameBuffer, 0, scene);
 
 	int frameEndTime = glutGet(GLUT_ELAPSED_TIME); // Get end time
-	double totalTimeSec = (frameEndTime - frameStartTime) / 1000.0;
+	real totalTimeSec = (frameEndTime - frameStartTime) / 1000.0;
 	cout << "Render time: " << totalTimeSec << " sec." << endl;
 }
 
@@ -49,12 +49,12 @@ void resize(int width, int height) {
 }
 
 void buildScene() {
-	IShape *plane = new IPlane(dvec3(0.0, -2.0, 0.0), dvec3(0.0, 1.0, 0.0));
-	ISphere *sphere1 = new ISphere(dvec3(0.0, 0.0, 0.0), 2.0);
-	ISphere *sphere2 = new ISphere(dvec3(-2.0, 0.0, -8.0), 2.0);
-	IEllipsoid *ellipsoid = new IEllipsoid(dvec3(4.0, 0.0, 3.0), dvec3(2.0, 1.0, 2.0));
-	IDisk* disk = new IDisk(dvec3(15.0, 0.0, 0.0), dvec3(0.0, 0.0, 1.0), 5.0);
-	IDisk* disk2 = new IDisk(dvec3(-5.0, 0.0, 0.0), dvec3(1.0, 0.0, 1.0), 2.0);
+	IShape *plane = new IPlane(rvec3(0.0, -2.0, 0.0), rvec3(0.0, 1.0, 0.0));
+	ISphere *sphere1 = new ISphere(rvec3(0.0, 0.0, 0.0), 2.0);
+	ISphere *sphere2 = new ISphere(rvec3(-2.0, 0.0, -8.0), 2.0);
+	IEllipsoid *ellipsoid = new IEllipsoid(rvec3(4.0, 0.0, 3.0), rvec3(2.0, 1.0, 2.0));
+	IDisk* disk = new IDisk(rvec3(15.0, 0.0, 0.0), rvec3(0.0, 0.0, 1.0), 5.0);
+	IDisk* disk2 = new IDisk(rvec3(-5.0, 0.0, 0.0), rvec3(1.0, 0.0, 1.0), 2.0);
 
 	scene.addOpaqueObject(new VisibleIShape(plane, tin));
 	scene.addOpaqueObject(new VisibleIShape(sphere1, silver));
@@ -64,6 +64,7 @@ void buildScene() {
 	scene.addOpaqueObject(new VisibleIShape(disk2, gold));
 
 	scene.addLight(lights[0]);
+	scene.finalize();
 }
 
 int main(int argc, char *argv[]) {
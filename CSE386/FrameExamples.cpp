@@ -12,51 +12,51 @@
 #include "utilities.h"
 #include "defs.h"
 #include "io.h"
-void testPosition(const Frame& eyeFrame, const dvec3& pos) {
-	dvec3 frameCoords = eyeFrame.toFrameCoords(pos);
-	dvec3 backToWorldCoords = eyeFrame.toWorldCoords(frameCoords);
+void testPosition(const Frame& eyeFrame, const rvec3& pos) {
+	rvec3 frameCoords = eyeFrame.toFrameCoords(pos);
+	rvec3 backToWorldCoords = eyeFrame.toWorldCoords(frameCoords);
 	cout << "POSITION" << endl;
 	cout << "World: " << pos <<
 		" To frame: " << frameCoords <<
 		" Back to world : " << backToWorldCoords << endl;
 
-	dvec3 worldCoords = eyeFrame.toWorldCoords(pos);
-	dvec3 backToFrameCoords = eyeFrame.toFrameCoords(worldCoords);
+	rvec3 worldCoords = eyeFrame.toWorldCoords(pos);
+	rvec3 backToFrameCoords = eyeFrame.toFrameCoords(worldCoords);
 	cout << "Frame: " << pos <<
 		" To world: " << worldCoords <<
 		" Back to frame: " << backToFrameCoords << endl << endl;
 }
-void testVector(const Frame & eyeFrame, const dvec3 & dir) {
+void testVector(const Frame & eyeFrame, const rvec3 & dir) {
 	cout << "VECTOR" << endl;
-	dvec3 frameVector = eyeFrame.toFrameVector(dir);
-	dvec3 backToWorldVector = eyeFrame.toWorldVector(frameVector);
+	rvec3 frameVector = eyeFrame.toFrameVector(dir);
+	rvec3 backToWorldVector = eyeFrame.toWorldVector(frameVector);
 	cout << "World: " << dir <<
 		" To frame: " << frameVector <<
 		" Back to world: " << backToWorldVector << endl;
 
-	dvec3 worldVector = eyeFrame.toWorldVector(dir);
-	dvec3 backToFrameVector = eyeFrame.toFrameVector(worldVector);
+	rvec3 worldVector = eyeFrame.toWorldVector(dir);
+	rvec3 backToFrameVector = eyeFrame.toFrameVector(worldVector);
 	cout << "Frame: " << dir <<
 		" To world: " << worldVector <<
 		" Back to frame: " << backToFrameVector << endl << endl;
 }
 int main(int argc, char *argv[]) {
-	dvec3 cameraPos(1, 1, 1);
-	dvec3 lookAt(0, 0, 0);
-	dvec3 viewDir = lookAt - cameraPos;
-	dvec3 w = -glm::normalize(viewDir);
-	dvec3 up = Y_AXIS;
-	dvec3 u = glm::normalize(glm::cross(up, w));
-	dvec3 v = glm::normalize(glm::cross(w, u));
+	rvec3 cameraPos(1, 1, 1);
+	rvec3 lookAt(0, 0, 0);
+	rvec3 viewDir = lookAt - cameraPos;
+	rvec3 w = -glm::normalize(viewDir);
+	rvec3 up = Y_AXIS;
+	rvec3 u = glm::normalize(glm::cross(up, w));
+	rvec3 v = glm::normalize(glm::cross(w, u));
 
 	Frame cameraFrame(cameraPos, u, v, w);
 
 	cout << cameraFrame << endl;
 
-	testPosition(cameraFrame, dvec3(0, 0, 0));
-	testPosition(cameraFrame, dvec3(1, 1, 1));
-	testVector(cameraFrame, dvec3(0, 0, 1));
-	testVector(cameraFrame, dvec3(1, 0, 0));
+	testPosition(cameraFrame, rvec3(0, 0, 0));
+	testPosition(cameraFrame, rvec3(1, 1, 1));
+	testVector(cameraFrame, rvec3(0, 0, 1));
+	testVector(cameraFrame, rvec3(1, 0, 0));
 
 	return 0;
 }
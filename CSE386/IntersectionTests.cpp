@@ -2,9 +2,9 @@
 #include "io.h"
 
 void checkEm(const char *name, const IShape& shape) {
-	Ray ray1(dvec3(0, 0, 0), glm::normalize(dvec3(0, 0.5, -1)));	// Viewing rays are normalized
-	Ray ray2(dvec3(0, 0, 0), glm::normalize(dvec3(0, 0, -1)));
-	Ray ray3(dvec3(0, 0, 0), dvec3(0, -0.5, -1));
+	Ray ray1(rvec3(0, 0, 0), glm::normalize(rvec3(0, 0.5, -1)));	// Viewing rays are normalized
+	Ray ray2(rvec3(0, 0, 0), glm::normalize(rvec3(0, 0, -1)));
+	Ray ray3(rvec3(0, 0, 0), rvec3(0, -0.5, -1));
 
 	HitRecord hit1;
 	HitRecord hit2;
@@ -23,13 +23,13 @@ void checkEm(const char *name, const IShape& shape) {
 }
 
 int main(int argc, char* argv[]) {
-	double s3 = -1.0/glm::sqrt(3.0);
-	checkEm("Plane", IPlane(dvec3(0, -1, 0), dvec3(0, 1, 0)));	// normal vectors will be unit length
-	checkEm("Sphere", ISphere(dvec3(0.0, 0, -1.0), 0.75));
-	checkEm("Disk1", IDisk(dvec3(0, 0, -1), dvec3(0, 0, 1), 1.0));
-	checkEm("Disk2", IDisk(dvec3(0, 0, -10), dvec3(0, 0, 1), 1.0));
+	real s3 = -1.0/glm::sqrt(3.0);
+	checkEm("Plane", IPlane(rvec3(0, -1, 0), rvec3(0, 1, 0)));	// normal vectors will be unit length
+	checkEm("Sphere", ISphere(rvec3(0.0, 0, -1.0), 0.75));
+	checkEm("Disk1", IDisk(rvec3(0, 0, -1), rvec3(0, 0, 1), 1.0));
+	checkEm("Disk2", IDisk(rvec3(0, 0, -10), rvec3(0, 0, 1), 1.0));
 
-	ISphere(dvec3(0, 0, 0), 2.0);
+	ISphere(rvec3(0, 0, 0), 2.0);
 	return 0;
 }
 /*
@@ -0,0 +1,652 @@
+/****************************************************
+ * 2016-2021 Eric Bachmann and Mike Zmuda
+ * All Rights Reserved.
+ * NOTICE:
+ * Dissemination of this information or reproduction
+ * of this material is prohibited unless prior written
+ * permission is granted.
+ ****************************************************/
+
+/*
+ * Microbenchmarks for the hot paths of the ray tracer and the rasterizer,
+ * plus full-frame renders of a few canonical scenes. Results are written as
+ * JSON so that runs can be compared to catch performance regressions.
+ *
+ * Like offlinerender.cpp, this driver is headless. Build it with CONSOLE_ONLY
+ * defined, together with the library sources:
+ *
+ *	g++ -std=c++17 -O2 -DCONSOLE_ONLY -pthread camera.cpp colorandmaterials.cpp
+ *		defs.cpp eshape.cpp fragmentops.cpp framebuffer.cpp image.cpp io.cpp
+ *		iscene.cpp ishape.cpp bvh.cpp light.cpp rasterization.cpp raytracer.cpp
+ *		texture.cpp utilities.cpp vertexops.cpp vertextdata.cpp benchmarks.cpp -o benchmarks
+ *
+ * Add -DSINGLE_PRECISION to benchmark the float build of the math core. The
+ * precision is recorded in the results.
+ *
+ * Every heap allocation is counted, and each result records the allocations
+ * made per operation. The rasterizer, shadow feelers and the single threaded
+ * pipeline are meant to run without allocating once they are warmed up, so if
+ * any of their benchmarks allocates, the run reports it and exits with status 1.
+ * It does the same if a texture cache does not return to its memory budget.
+ *
+ * Usage: benchmarks [-o results.json] [-filter text] [-threads T]
+ *	-o			write the JSON to a file instead of standard output
+ *	-filter		only run the benchmarks whose name contains text
+ *	-threads	render threads for the full-frame benchmarks (default 1)
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <random>
+#include <sstream>
+#include "defs.h"
+#include "io.h"
+#include "ishape.h"
+#include "eshape.h"
+#include "framebuffer.h"
+#include "raytracer.h"
+#include "iscene.h"
+#include "light.h"
+#include "camera.h"
+#include "image.h"
+#include "texture.h"
+#include "rasterization.h"
+#include "vertexops.h"
+
+/**
+ * @struct	BenchmarkResult
+ * @brief	The timing of one benchmark.
+ */
+
+struct BenchmarkResult {
+	string name;			//!< What was measured.
+	long long iterations;	//!< How many times the operation ran.
+	real secondsPerOp;	//!< Average time for one operation.
+	string unit;			//!< What one "item" is, e.g., "rays" or "pixels".
+	real itemsPerOp;		//!< Items processed by one operation.
+	real allocsPerOp;		//!< Average heap allocations made by one operation.
+};
+
+const real MIN_SECONDS = 0.25;		//!< Each benchmark runs at least this long.
+
+vector<BenchmarkResult> results;
+vector<string> failures;			//!< Checks made while benchmarking that did not hold.
+string filter;
+int numThreads = 1;
+volatile real sink = 0;				//!< Keeps the compiler from discarding results.
+std::atomic<long long> numAllocations(0);	//!< Heap allocations made so far, by every thread.
+
+void *operator new(size_t size) {
+	numAllocations++;
+	void *p = malloc(size > 0 ? size : 1);
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void *operator new[](size_t size) {
+	return operator new(size);
+}
+
+// Every new above gets its memory from malloc, so free is the right match. GCC
+// cannot see that once this is inlined into a caller and warns that it is not.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void *p) noexcept {
+	free(p);
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+void operator delete[](void *p) noexcept {
+	operator delete(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+	operator delete(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+	operator delete(p);
+}
+
+/**
+ * @fn	template <typename OP> void runBenchmark(const string &name, const string &unit, real itemsPerOp, OP op)
+ * @brief	Runs op repeatedly, doubling the batch size until a batch takes at least
+ * 			MIN_SECONDS, and records the time and heap allocations per call.
+ * @param	name	  	Name of the benchmark.
+ * @param	unit	  	What op processes, for the throughput figure.
+ * @param	itemsPerOp	How many units each call to op processes.
+ * @param	op		  	The operation to time.
+ */
+
+template <typename OP>
+void runBenchmark(const string &name, const string &unit, real itemsPerOp, OP op) {
+	if (name.find(filter) == string::npos) {
+		return;
+	}
+	op();		// warm up
+	long long iterations = 1;
+	real seconds = 0;
+	long long allocations = 0;
+	while (true) {
+		long long allocationsBefore = numAllocations;
+		auto start = std::chrono::steady_clock::now();
+		for (long long i = 0; i < iterations; i++) {
+			op();
+		}
+		seconds = std::chrono::duration<real>(std::chrono::steady_clock::now() - start).count();
+		allocations = numAllocations - allocationsBefore;
+		if (seconds >= MIN_SECONDS) {
+			break;
+		}
+		iterations *= 2;
+	}
+	results.push_back({ name, iterations, seconds / iterations, unit, itemsPerOp,
+						(real)allocations / iterations });
+	std::cerr << name << ": " << seconds / iterations * 1e9 << " ns/op" << endl;
+}
+
+/**
+ * @fn	vector<Ray> makeRays(const rvec3 &target, real spread, int count)
+ * @brief	Creates rays from random points on a sphere of radius 10 around target,
+ * 			aimed at random points within spread of the target.
+ * @param	target	The point the rays are aimed at.
+ * @param	spread	How far from the target the rays may be aimed.
+ * @param	count 	Number of rays.
+ * @return	The rays.
+ */
+
+vector<Ray> makeRays(const rvec3 &target, real spread, int count) {
+	std::mt19937 rng(386);
+	std::uniform_real_distribution<real> unit(-1.0, 1.0);
+	vector<Ray> rays;
+	for (int i = 0; i < count; i++) {
+		rvec3 dir;
+		do {
+			dir = rvec3(unit(rng), unit(rng), unit(rng));
+		} while (glm::length(dir) < 0.1);
+		rvec3 origin = target + real(10.0) * glm::normalize(dir);
+		rvec3 aim = target + spread * rvec3(unit(rng), unit(rng), unit(rng));
+		rays.push_back(Ray(origin, aim - origin));
+	}
+	return rays;
+}
+
+/**
+ * @fn	void benchmarkShape(const string &name, const IShape &shape)
+ * @brief	Times findClosestIntersection for one shape over a fixed set of rays,
+ * 			about half of which hit.
+ * @param	name 	Name of the shape.
+ * @param	shape	The shape, centered at the origin with a size of about 2.
+ */
+
+void benchmarkShape(const string &name, const IShape &shape) {
+	const int NUM_RAYS = 1024;
+	vector<Ray> rays = makeRays(ORIGIN3D, 3.0, NUM_RAYS);
+	runBenchmark("intersect/" + name, "rays", NUM_RAYS, [&]() {
+		real total = 0;
+		for (const Ray &ray : rays) {
+			HitRecord hit;
+			shape.findClosestIntersection(ray, hit);
+			total += hit.t;
+		}
+		sink = sink + total;
+	});
+}
+
+/**
+ * @fn	void benchmarkIntersections()
+ * @brief	Times ray intersection for every kind of implicit shape.
+ */
+
+void benchmarkIntersections() {
+	benchmarkShape("ISphere", ISphere(ORIGIN3D, 2.0));
+	benchmarkShape("IEllipsoid", IEllipsoid(ORIGIN3D, rvec3(2.0, 1.0, 1.5)));
+	benchmarkShape("ICylinderY", ICylinderY(ORIGIN3D, 1.5, 3.0));
+	benchmarkShape("IClosedCylinderY", IClosedCylinderY(ORIGIN3D, 1.5, 3.0));
+	benchmarkShape("ICylinderZ", ICylinderZ(ORIGIN3D, 1.5, 3.0));
+	benchmarkShape("IConeY", IConeY(rvec3(0.0, -1.0, 0.0), 1.5, 2.0));
+	benchmarkShape("IPlane", IPlane(ORIGIN3D, Y_AXIS));
+	benchmarkShape("IDisk", IDisk(ORIGIN3D, rvec3(0.0, 1.0, 1.0), 2.0));
+}
+
+/**
+ * @fn	void benchmarkLighting()
+ * @brief	Times totalColor, with and without attenuation.
+ */
+
+void benchmarkLighting() {
+	const int NUM_POINTS = 1024;
+	std::mt19937 rng(386);
+	std::uniform_real_distribution<real> unit(-1.0, 1.0);
+	vector<rvec3> points, normals;
+	for (int i = 0; i < NUM_POINTS; i++) {
+		points.push_back(rvec3(unit(rng), unit(rng), unit(rng)) * real(5.0));
+		normals.push_back(glm::normalize(rvec3(unit(rng), 1.0 + unit(rng), unit(rng))));
+	}
+	const rvec3 lightPos(10, 10, 10);
+	const rvec3 eyePos(6, 6, 6);
+	const LightATParams atParams(1.0, 0.1, 0.01);
+
+	for (int attenuation = 0; attenuation < 2; attenuation++) {
+		runBenchmark(attenuation ? "lighting/totalColor_attenuated" : "lighting/totalColor",
+					"points", NUM_POINTS, [&]() {
+			color total;
+			for (int i = 0; i < NUM_POINTS; i++) {
+				rvec3 v = glm::normalize(eyePos - points[i]);
+				total += totalColor(gold, pureWhiteLight, v, normals[i], lightPos, points[i],
+									attenuation != 0, atParams);
+			}
+			sink = sink + total.r + total.g + total.b;
+		});
+	}
+}
+
+/**
+ * @fn	void benchmarkRasterization()
+ * @brief	Times drawFilledTriangle on a large and a small triangle, and
+ * 			VertexOps::clipPolygon on triangles that straddle the view volume.
+ */
+
+void benchmarkRasterization() {
+	const int W = 512, H = 512;
+	FrameBuffer frameBuffer(W, H);
+	frameBuffer.setClearColor(black);
+	frameBuffer.clearColorAndDepthBuffers();
+	vector<LightSourcePtr> lights = { new PositionalLight(rvec3(0, 10, 4), pureWhiteLight) };
+	Frame eyeFrame;
+	const rvec3 eyePos(0, 0, 10);
+
+	struct Triangle {
+		string name;
+		rvec2 a, b, c;
+	};
+	vector<Triangle> triangles = {
+		{ "large", rvec2(10, 10), rvec2(500, 40), rvec2(200, 480) },
+		{ "small", rvec2(100, 100), rvec2(108, 101), rvec2(103, 109) },
+	};
+
+	// Every fragment passes, so the whole triangle is shaded each time.
+	bool oldPerformDepthTest = FragmentOps::performDepthTest;
+	bool oldPerformLighting = FragmentOps::performLighting;
+	FragmentOps::performDepthTest = false;
+	for (bool lit : { false, true }) {
+		FragmentOps::performLighting = lit;
+		for (const Triangle &tri : triangles) {
+			VertexData v0(rvec4(tri.a.x, tri.a.y, 0.5, 1.0), Z_AXIS, gold, rvec3(tri.a, 0));
+			VertexData v1(rvec4(tri.b.x, tri.b.y, 0.5, 1.0), Z_AXIS, gold, rvec3(tri.b, 0));
+			VertexData v2(rvec4(tri.c.x, tri.c.y, 0.5, 1.0), Z_AXIS, gold, rvec3(tri.c, 0));
+			real area = std::abs((tri.b.x - tri.a.x) * (tri.c.y - tri.a.y) -
+									(tri.c.x - tri.a.x) * (tri.b.y - tri.a.y)) / 2;
+			runBenchmark("raster/drawFilledTriangle_" + tri.name + (lit ? "_lit" : ""), "pixels", area, [&]() {
+				drawFilledTriangle(frameBuffer, eyePos, lights, v0, v1, v2, eyeFrame);
+			});
+		}
+	}
+	FragmentOps::performDepthTest = oldPerformDepthTest;
+	FragmentOps::performLighting = oldPerformLighting;
+
+	const int NUM_TRIANGLES = 256;
+	std::mt19937 rng(386);
+	std::uniform_real_distribution<real> coord(-1.5, 1.5);
+	vector<VertexData> ndcCoords;
+	for (int i = 0; i < 3 * NUM_TRIANGLES; i++) {
+		ndcCoords.push_back(VertexData(rvec4(coord(rng), coord(rng), coord(rng), 1.0)));
+	}
+	vector<VertexData> clipped;
+	runBenchmark("raster/clipPolygon", "triangles", NUM_TRIANGLES, [&]() {
+		VertexOps::clipPolygon(ndcCoords, VertexOps::allButNearNDCPlanes, clipped);
+		sink = sink + clipped.size();
+	});
+}
+
+/**
+ * @fn	void benchmarkFrameBuffer()
+ * @brief	Times clearing and resolving framebuffers in each storage format. The
+ * 			clears are measured in bytes, so the rate also shows how much smaller
+ * 			the compact formats are.
+ */
+
+void benchmarkFrameBuffer() {
+	struct Format {
+		string name;
+		FrameBufferFormat format;
+	};
+	vector<Format> formats = {
+		{ "rgb8_real", { ColorFormat::RGB8, DepthFormat::REAL, PixelLayout::LINEAR } },
+		{ "rgba8_float", { ColorFormat::RGBA8, DepthFormat::FLOAT32, PixelLayout::LINEAR } },
+		{ "rgba8_float_tiled", { ColorFormat::RGBA8, DepthFormat::FLOAT32, PixelLayout::TILED } },
+		{ "rgba8_24_tiled", { ColorFormat::RGBA8, DepthFormat::UNORM24, PixelLayout::TILED } },
+		{ "float_float", { ColorFormat::RGBA_FLOAT, DepthFormat::FLOAT32, PixelLayout::LINEAR } },
+	};
+	const int W = 640, H = 480;
+	for (const Format &f : formats) {
+		FrameBuffer frameBuffer(W, H, f.format);
+		frameBuffer.setClearColor(lightGray);
+		runBenchmark("framebuffer/clear_" + f.name, "bytes", (real)frameBuffer.getMemorySize(), [&]() {
+			frameBuffer.clearColorAndDepthBuffers();
+		});
+	}
+}
+
+/**
+ * @fn	void benchmarkImages()
+ * @brief	Times loading the texture images in the working directory, the startup
+ * 			cost of textured scenes. Images that are not there are skipped.
+ */
+
+void benchmarkImages() {
+	for (const char *fileName : { "usflag.ppm", "blackbuck.ppm", "snail.ppm" }) {
+		if (!std::ifstream(fileName)) {
+			continue;
+		}
+		Image image(fileName);
+		runBenchmark(string("image/load_") + fileName, "pixels", (real)image.W * image.H, [&]() {
+			Image loaded(fileName);
+			sink = sink + loaded.W;
+		});
+	}
+}
+
+/**
+ * @fn	void benchmarkTextures()
+ * @brief	Times sampling usflag.ppm, if it is in the working directory, with
+ * 			Image::getPixelUV and with each Texture filter. The samples form a
+ * 			64 x 64 grid over the whole image, as when a texture is minified. The texture's
+ * 			memory is reported next to the image's. The last benchmark samples the
+ * 			same file through a TextureCache, to show what paging costs.
+ */
+
+void benchmarkTextures() {
+	const string fileName = "usflag.ppm";
+	if (!std::ifstream(fileName)) {
+		return;
+	}
+	const int GRID = 64;
+	const int NUM_SAMPLES = GRID * GRID;
+	Image image(fileName);
+	Texture texture(image);
+	vector<rvec2> uvs;
+	for (int y = 0; y < GRID; y++) {
+		for (int x = 0; x < GRID; x++) {
+			uvs.push_back(rvec2((x + 0.3) / GRID, (y + 0.6) / GRID));
+		}
+	}
+	const real footprint = 1.0 / GRID;
+	std::cerr << fileName << ": image " << (size_t)image.W * image.H * sizeof(color)
+			  << " bytes, texture " << texture.getMemorySize() << " bytes" << endl;
+
+	runBenchmark("texture/sample_image", "samples", NUM_SAMPLES, [&]() {
+		color sum;
+		for (const rvec2 &uv : uvs) {
+			sum += image.getPixelUV(uv.x, uv.y);
+		}
+		sink = sink + sum.r;
+	});
+	struct Filter {
+		string name;
+		TextureFilter filter;
+	};
+	for (const Filter &f : { Filter{ "nearest", TextureFilter::NEAREST },
+							 Filter{ "bilinear", TextureFilter::BILINEAR },
+							 Filter{ "trilinear", TextureFilter::TRILINEAR } }) {
+		texture.filter = f.filter;
+		runBenchmark("texture/sample_" + f.name, "samples", NUM_SAMPLES, [&]() {
+			color sum;
+			for (const rvec2 &uv : uvs) {
+				sum += texture.sample(uv.x, uv.y, footprint);
+			}
+			sink = sink + sum.r;
+		});
+	}
+
+	TextureCache cache;
+	TexturePtr cached = cache.get(fileName);
+	runBenchmark("texture/sample_trilinear_cached", "samples", NUM_SAMPLES, [&]() {
+		color sum;
+		for (const rvec2 &uv : uvs) {
+			sum += cached->sample(uv.x, uv.y, footprint);
+		}
+		sink = sink + sum.r;
+	});
+
+	// Full resolution samples with a budget of a few pages, so each frame pages
+	// the texture through memory
+	const size_t SMALL_BUDGET = 16 * TEXTURE_PAGE_BYTES;
+	TextureCache pagedCache(SMALL_BUDGET);
+	TexturePtr paged = pagedCache.get(fileName);
+	auto sampleFrame = [&]() {
+		TextureCache::beginFrame();
+		pagedCache.trim();
+		color sum;
+		for (const rvec2 &uv : uvs) {
+			sum += paged->sample(uv.x, uv.y);
+		}
+		sink = sink + sum.r;
+	};
+	runBenchmark("texture/sample_paged", "samples", NUM_SAMPLES, sampleFrame);
+
+	// After a frame that samples a single texel, the cache must be back within its budget
+	sampleFrame();
+	TextureCache::beginFrame();
+	pagedCache.trim();
+	sink = sink + paged->sample(0.5, 0.5).r;
+	if (pagedCache.getResidentSize() > SMALL_BUDGET) {
+		failures.push_back("texture cache holds " + std::to_string(pagedCache.getResidentSize()) +
+							" bytes after a light frame, over its budget of " + std::to_string(SMALL_BUDGET));
+	}
+}
+
+/**
+ * @fn	void buildFullScene(IScene &scene)
+ * @brief	The scene from fullraytrace.cpp, without textures.
+ * @param [in,out]	scene	The scene to fill.
+ */
+
+void buildFullScene(IScene &scene) {
+	scene.addOpaqueObject(new VisibleIShape(new IPlane(rvec3(0.0, -2.0, 0.0), Y_AXIS), tin));
+	scene.addTransparentObject(new VisibleIShape(new IPlane(rvec3(0.0, 0.0, -10.0), rvec3(0.0, 0.0, -1.0)),
+												Material(red, red, red, 0.0)), 0.25);
+	scene.addOpaqueObject(new VisibleIShape(new ISphere(rvec3(0.0, 4.0, 0.0), 2.0), gold));
+	scene.addOpaqueObject(new VisibleIShape(new IClosedCylinderY(rvec3(2.0, 0.0, 3.0), 2.0, 5.0), greenRubber));
+	scene.addOpaqueObject(new VisibleIShape(new ICylinderY(rvec3(-4.0, 0.0, 5.0), 2.0, 3.0), copper));
+	scene.addOpaqueObject(new VisibleIShape(new ICylinderZ(rvec3(5.0, 0.0, -2.0), 2.0, 3.0), polishedBronze));
+	scene.addOpaqueObject(new VisibleIShape(new IConeY(rvec3(1.0, 4.0, 4.0), 1.0, 2.0), yellowRubber));
+	scene.addLight(new PositionalLight(rvec3(10, 10, 10), pureWhiteLight));
+	scene.addLight(new SpotLight(rvec3(0, 10, 0), rvec3(0, -1, 0), glm::radians(65.0), pureWhiteLight));
+	scene.finalize();
+}
+
+/**
+ * @fn	void buildSpheresScene(IScene &scene)
+ * @brief	A 20 x 20 grid of spheres on a plane, lit by two lights. Stresses
+ * 			scenes with many objects.
+ * @param [in,out]	scene	The scene to fill.
+ */
+
+void buildSpheresScene(IScene &scene) {
+	vector<Material> materials = { gold, silver, copper, redPlastic, cyanPlastic, greenRubber };
+	scene.addOpaqueObject(new VisibleIShape(new IPlane(rvec3(0.0, -1.0, 0.0), Y_AXIS), tin));
+	for (int i = 0; i < 20; i++) {
+		for (int j = 0; j < 20; j++) {
+			rvec3 center(-9.5 + i, -0.6, -9.5 + j);
+			scene.addOpaqueObject(new VisibleIShape(new ISphere(center, 0.4), materials[(i + j) % materials.size()]));
+		}
+	}
+	scene.addLight(new PositionalLight(rvec3(10, 10, 10), pureWhiteLight));
+	scene.addLight(new PositionalLight(rvec3(-10, 8, 5), pureWhiteLight));
+	scene.finalize();
+}
+
+/**
+ * @fn	void benchmarkShadows()
+ * @brief	Times FrameLights::illuminate over a grid of points on the floor of the
+ * 			spheres scene, visited in rows as a ray tracer would, with and without
+ * 			the last occluder cache.
+ */
+
+void benchmarkShadows() {
+	const int N = 64;
+	PerspectiveCamera camera(rvec3(6, 6, 6), ORIGIN3D, Y_AXIS, glm::radians(100.0), N, N);
+	IScene scene(&camera);
+	buildSpheresScene(scene);
+	vector<rvec3> points;
+	for (int z = 0; z < N; z++) {
+		for (int x = 0; x < N; x++) {
+			points.push_back(rvec3(-10.0 + 20.0 * x / N, -1.0, -10.0 + 20.0 * z / N));
+		}
+	}
+
+	for (bool cached : { false, true }) {
+		FrameLights::cacheOccluders = cached;
+		const FrameLights lights(scene.lights, camera.getFrame());
+		runBenchmark(cached ? "shadow/illuminate_cached" : "shadow/illuminate", "points", N * N, [&]() {
+			color total;
+			for (const rvec3 &pt : points) {
+				total += lights.illuminate(pt, Y_AXIS, tin, &scene.opaqueBVH);
+			}
+			sink = sink + total.r + total.g + total.b;
+		});
+	}
+	FrameLights::cacheOccluders = true;
+}
+
+/**
+ * @fn	void benchmarkFrames()
+ * @brief	Times full-frame ray traced renders of the canonical scenes at several
+ * 			resolutions and sample counts, and full-frame pipeline renders.
+ */
+
+void benchmarkFrames() {
+	struct Resolution {
+		int width, height;
+	};
+	vector<Resolution> resolutions = { { 160, 120 }, { 320, 240 }, { 640, 480 } };
+	vector<int> sampleCounts = { 1, 2 };
+	RayTracer rayTracer(lightGray, numThreads);
+
+	for (int sceneNum = 0; sceneNum < 2; sceneNum++) {
+		string sceneName = sceneNum == 0 ? "full" : "spheres";
+		for (const Resolution &res : resolutions) {
+			PerspectiveCamera camera(rvec3(6, 6, 6), ORIGIN3D, Y_AXIS, glm::radians(100.0), res.width, res.height);
+			IScene scene(&camera);
+			if (sceneNum == 0) {
+				buildFullScene(scene);
+			} else {
+				buildSpheresScene(scene);
+			}
+			FrameBuffer frameBuffer(res.width, res.height);
+			for (int N : sampleCounts) {
+				std::stringstream name;
+				name << "frame/raytrace_" << sceneName << "_" << res.width << "x" << res.height << "_aa" << N;
+				runBenchmark(name.str(), "primary rays", (real)res.width * res.height * N * N, [&]() {
+					rayTracer.raytraceScene(frameBuffer, 1, scene, N, rvec2(0, 0), rvec2(res.width, res.height));
+				});
+			}
+		}
+	}
+
+	VertexOps::numThreads = numThreads;
+	vector<LightSourcePtr> lights = { new PositionalLight(rvec3(0, 10, 4), pureWhiteLight) };
+	EShapeData board = EShape::createECheckerBoard(copper, polishedCopper, 10, 10, 10);
+	EShapeData cone = EShape::createECone(pewter, 8);
+	EShapeData cylinder = EShape::createECylinder(redPlastic, 32);
+	const FrameBufferFormat compact = { ColorFormat::RGBA8, DepthFormat::FLOAT32, PixelLayout::TILED };
+	for (const Resolution &res : resolutions) {
+		for (bool isCompact : { false, true }) {
+			FrameBuffer frameBuffer(res.width, res.height, isCompact ? compact : FrameBufferFormat());
+			frameBuffer.setClearColor(lightGray);
+			PipelineMatrices pipeMats;
+			pipeMats.viewingMatrix = glm::lookAt(rvec3(0, 5, 5), rvec3(0, 0, 0), Y_AXIS);
+			pipeMats.projectionMatrix = glm::perspective(PI_3, (real)res.width / res.height, real(0.5), real(80.0));
+			pipeMats.viewportMatrix = VertexOps::getViewportTransformation(0, res.width, 0, res.height);
+
+			std::stringstream name;
+			name << "frame/pipeline_" << (isCompact ? "compact_" : "") << res.width << "x" << res.height;
+			runBenchmark(name.str(), "pixels", (real)res.width * res.height, [&]() {
+				frameBuffer.clearColorAndDepthBuffers();
+				VertexOps::render(frameBuffer, board, lights, rmat4(), pipeMats, true);
+				VertexOps::render(frameBuffer, cone, lights, T(-3, 0, 3), pipeMats, true);
+				VertexOps::render(frameBuffer, cylinder, lights, T(2, 0, 2), pipeMats, true);
+			});
+		}
+	}
+}
+
+/**
+ * @fn	void writeJSON(std::ostream &os)
+ * @brief	Writes the results as JSON.
+ * @param [in,out]	os	The stream to write to.
+ */
+
+void writeJSON(std::ostream &os) {
+	os << "{\n  \"precision\": \"" << (sizeof(real) == sizeof(float) ? "float" : "double") << "\",\n";
+	os << "  \"benchmarks\": [\n";
+	for (unsigned int i = 0; i < results.size(); i++) {
+		const BenchmarkResult &r = results[i];
+		os << "    { \"name\": \"" << r.name << "\""
+			<< ", \"iterations\": " << r.iterations
+			<< ", \"ns_per_op\": " << r.secondsPerOp * 1e9
+			<< ", \"unit\": \"" << r.unit << "\""
+			<< ", \"items_per_second\": " << r.itemsPerOp / r.secondsPerOp
+			<< ", \"allocs_per_op\": " << r.allocsPerOp << " }"
+			<< (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	os << "  ]\n}\n";
+}
+
+int main(int argc, char *argv[]) {
+	string outputFileName;
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "-o" && i + 1 < argc) {
+			outputFileName = argv[++i];
+		} else if (arg == "-filter" && i + 1 < argc) {
+			filter = argv[++i];
+		} else if (arg == "-threads" && i + 1 < argc) {
+			numThreads = atoi(argv[++i]);
+		} else {
+			std::cerr << "Usage: " << argv[0] << " [-o results.json] [-filter text] [-threads T]" << endl;
+			return 1;
+		}
+	}
+
+	benchmarkIntersections();
+	benchmarkLighting();
+	benchmarkRasterization();
+	benchmarkFrameBuffer();
+	benchmarkImages();
+	benchmarkTextures();
+	benchmarkShadows();
+	benchmarkFrames();
+
+	if (outputFileName.empty()) {
+		writeJSON(cout);
+	} else {
+		std::ofstream out(outputFileName);
+		writeJSON(out);
+	}
+
+	int status = 0;
+	for (const BenchmarkResult &r : results) {
+		bool mustNotAllocate = r.name.find("raster/") == 0 || r.name.find("shadow/") == 0 ||
+								(r.name.find("frame/pipeline") == 0 && numThreads == 1);
+		if (mustNotAllocate && r.allocsPerOp > 0) {
+			std::cerr << r.name << " allocated " << r.allocsPerOp << " times per operation" << endl;
+			status = 1;
+		}
+	}
+	for (const string &failure : failures) {
+		std::cerr << failure << endl;
+		status = 1;
+	}
+	return status;
+}
@@ -0,0 +1,333 @@
+/****************************************************
+ * 2016-2021 Eric Bachmann and Mike Zmuda
+ * All Rights Reserved.
+ * NOTICE:
+ * Dissemination of this information or reproduction
+ * of this material is prohibited unless prior written
+ * permission is granted.
+ ****************************************************/
+
+#include <algorithm>
+#include <climits>
+#include "bvh.h"
+
+const int MAX_SHAPES_PER_LEAF = 2;		//!< Nodes with this many shapes or fewer are not split.
+const int MAX_BVH_DEPTH = 64;			//!< Size of the traversal stack.
+
+/**
+ * @fn	BVH::BVH(const vector<VisibleIShapePtr> &objs)
+ * @brief	Constructs an unbuilt hierarchy over a list of shapes. Until build() is
+ * 			called, queries scan the list linearly.
+ * @param	objs	The list of shapes. The BVH keeps a reference to it.
+ */
+
+BVH::BVH(const vector<VisibleIShapePtr> &objs)
+	: objs(objs), builtSize(0) {
+}
+
+/**
+ * @fn	void BVH::build()
+ * @brief	(Re)builds the hierarchy from the current contents of the list.
+ */
+
+void BVH::build() {
+	nodes.clear();
+	items.clear();
+	unbounded.clear();
+
+	vector<AABB> boxes(objs.size());
+	for (unsigned int i = 0; i < objs.size(); i++) {
+		if (objs[i]->shape->getBoundingBox(boxes[i])) {
+			boxes[i].lo -= rvec3(EPSILON, EPSILON, EPSILON);
+			boxes[i].hi += rvec3(EPSILON, EPSILON, EPSILON);
+			items.push_back(i);
+		} else {
+			unbounded.push_back(i);
+		}
+	}
+
+	if (!items.empty()) {
+		nodes.reserve(2 * items.size());
+		buildNode(boxes, 0, (int)items.size());
+	}
+	builtSize = objs.size();
+}
+
+/**
+ * @fn	int BVH::buildNode(const vector<AABB> &boxes, int first, int count)
+ * @brief	Recursively builds the subtree over items[first, first + count). The
+ * 			shapes are split at the median centroid along the longest axis of the
+ * 			centroids' extent.
+ * @param	boxes	Bounding boxes of all shapes, indexed like objs.
+ * @param	first	Index into items of the first shape in this subtree.
+ * @param	count	Number of shapes in this subtree.
+ * @return	Index of the new node.
+ */
+
+int BVH::buildNode(const vector<AABB> &boxes, int first, int count) {
+	int nodeIndex = (int)nodes.size();
+	nodes.push_back(Node());
+
+	AABB box, centroids;
+	for (int i = first; i < first + count; i++) {
+		const AABB &itemBox = boxes[items[i]];
+		box.expand(itemBox);
+		centroids.expand(AABB(itemBox.centroid(), itemBox.centroid()));
+	}
+	nodes[nodeIndex].box = box;
+
+	rvec3 extent = centroids.hi - centroids.lo;
+	int axis = 0;
+	if (extent.y > extent[axis]) axis = 1;
+	if (extent.z > extent[axis]) axis = 2;
+
+	if (count <= MAX_SHAPES_PER_LEAF || extent[axis] <= 0.0) {
+		nodes[nodeIndex].first = first;
+		nodes[nodeIndex].count = count;
+		nodes[nodeIndex].right = -1;
+		return nodeIndex;
+	}
+
+	int half = count / 2;
+	std::nth_element(items.begin() + first, items.begin() + first + half, items.begin() + first + count,
+		[&boxes, axis](int a, int b) {
+			return boxes[a].centroid()[axis] < boxes[b].centroid()[axis];
+		});
+
+	buildNode(boxes, first, half);
+	int right = buildNode(boxes, first + half, count - half);
+	nodes[nodeIndex].first = first;
+	nodes[nodeIndex].count = 0;
+	nodes[nodeIndex].right = right;
+	return nodeIndex;
+}
+
+/**
+ * @fn	void BVH::testShape(const Ray &ray, int index, HitRecord &theHit, int &hitIndex) const
+ * @brief	Intersects one shape and keeps its hit if it is the closest so far. Equal
+ * 			distances go to the shape that comes first in the list, which is the
+ * 			choice a linear scan would make.
+ * @param 		  	ray			The ray.
+ * @param 		  	index   	Index of the shape in objs.
+ * @param [in,out]	theHit  	The closest hit so far.
+ * @param [in,out]	hitIndex	Index of the shape that produced theHit.
+ */
+
+void BVH::testShape(const Ray &ray, int index, HitRecord &theHit, int &hitIndex) const {
+	HitRecord thisHit;
+	objs[index]->findClosestIntersection(ray, thisHit);
+	if (thisHit.t < theHit.t || (thisHit.t == theHit.t && thisHit.t != FLT_MAX && index < hitIndex)) {
+		theHit = thisHit;
+		hitIndex = index;
+	}
+}
+
+/**
+ * @fn	void BVH::findIntersection(const Ray &ray, HitRecord &theHit) const
+ * @brief	Searches for the closest intersection with any shape in the list.
+ * @param 		  	ray   	The ray.
+ * @param [in,out]	theHit	The closest intersection that is in front of the ray's origin.
+ */
+
+void BVH::findIntersection(const Ray &ray, HitRecord &theHit) const {
+	if (builtSize != objs.size()) {
+		VisibleIShape::findIntersection(ray, objs, theHit);
+		return;
+	}
+
+	theHit.t = FLT_MAX;
+	int hitIndex = INT_MAX;
+	for (unsigned int i = 0; i < unbounded.size(); i++) {
+		testShape(ray, unbounded[i], theHit, hitIndex);
+	}
+	if (nodes.empty()) {
+		return;
+	}
+
+	rvec3 invDir(1.0 / ray.dir.x, 1.0 / ray.dir.y, 1.0 / ray.dir.z);
+	int stack[MAX_BVH_DEPTH];
+	int top = 0;
+	real tEntry;
+	if (nodes[0].box.intersects(ray, invDir, theHit.t, tEntry)) {
+		stack[top++] = 0;
+	}
+
+	while (top > 0) {
+		const Node &node = nodes[stack[--top]];
+		if (node.count > 0) {
+			for (int i = node.first; i < node.first + node.count; i++) {
+				testShape(ray, items[i], theHit, hitIndex);
+			}
+			continue;
+		}
+
+		int left = (int)(&node - &nodes[0]) + 1;
+		int right = node.right;
+		real tLeft, tRight;
+		bool hitLeft = nodes[left].box.intersects(ray, invDir, theHit.t, tLeft);
+		bool hitRight = nodes[right].box.intersects(ray, invDir, theHit.t, tRight);
+
+		// Push the farther child first so the nearer one is visited first and
+		// shrinks theHit.t before the farther one is tested.
+		if (hitLeft && hitRight) {
+			if (tLeft <= tRight) {
+				stack[top++] = right;
+				stack[top++] = left;
+			} else {
+				stack[top++] = left;
+				stack[top++] = right;
+			}
+		} else if (hitLeft) {
+			stack[top++] = left;
+		} else if (hitRight) {
+			stack[top++] = right;
+		}
+	}
+}
+
+/**
+ * @fn	void BVH::findIntersections(const RayPacket &packet, HitRecord hits[PACKET_SIZE]) const
+ * @brief	Finds the closest intersection for every ray in a packet. The packet walks
+ * 			the tree together: a node is visited if any of its rays reach the node's
+ * 			box, and each shape is intersected with its packet kernel. Only the shape
+ * 			that wins for a ray is then intersected again, alone, to fill in that
+ * 			ray's HitRecord. Packets whose rays head into different octants are
+ * 			traced one ray at a time. The results are identical to calling
+ * 			findIntersection on each ray.
+ * @param 		  	packet	The rays.
+ * @param [in,out]	hits  	The closest intersection for each ray.
+ */
+
+void BVH::findIntersections(const RayPacket &packet, HitRecord hits[PACKET_SIZE]) const {
+	if (builtSize != objs.size() || !packet.isCoherent()) {
+		for (int i = 0; i < PACKET_SIZE; i++) {
+			findIntersection(packet.rays[i], hits[i]);
+		}
+		return;
+	}
+
+	real bestT[PACKET_SIZE];
+	int bestIndex[PACKET_SIZE];
+	for (int i = 0; i < PACKET_SIZE; i++) {
+		bestT[i] = FLT_MAX;
+		bestIndex[i] = INT_MAX;
+	}
+
+	// Intersects the packet with one shape and keeps the hits, for the rays
+	// in mask, that beat the best so far. Ties go to the lower index.
+	auto testShape = [&](int index, const bool mask[PACKET_SIZE]) {
+		real t[PACKET_SIZE];
+		objs[index]->shape->findPacketIntersections(packet, t);
+		for (int i = 0; i < PACKET_SIZE; i++) {
+			if (mask[i] && (t[i] < bestT[i] || (t[i] == bestT[i] && t[i] != FLT_MAX && index < bestIndex[i]))) {
+				bestT[i] = t[i];
+				bestIndex[i] = index;
+			}
+		}
+	};
+
+	bool all[PACKET_SIZE];
+	for (int i = 0; i < PACKET_SIZE; i++) {
+		all[i] = true;
+	}
+	for (unsigned int i = 0; i < unbounded.size(); i++) {
+		testShape(unbounded[i], all);
+	}
+
+	if (!nodes.empty()) {
+		rvec3 invDir[PACKET_SIZE];
+		for (int i = 0; i < PACKET_SIZE; i++) {
+			invDir[i] = rvec3(1.0 / packet.dx[i], 1.0 / packet.dy[i], 1.0 / packet.dz[i]);
+		}
+
+		int stack[MAX_BVH_DEPTH];
+		int top = 0;
+		stack[top++] = 0;
+		while (top > 0) {
+			int nodeIndex = stack[--top];
+			const Node &node = nodes[nodeIndex];
+			bool mask[PACKET_SIZE];
+			bool any = false;
+			for (int i = 0; i < PACKET_SIZE; i++) {
+				real tEntry;
+				mask[i] = node.box.intersects(packet.rays[i], invDir[i], bestT[i], tEntry);
+				any = any || mask[i];
+			}
+			if (!any) {
+				continue;
+			}
+			if (node.count > 0) {
+				for (int i = node.first; i < node.first + node.count; i++) {
+					testShape(items[i], mask);
+				}
+			} else {
+				stack[top++] = node.right;
+				stack[top++] = nodeIndex + 1;
+			}
+		}
+	}
+
+	for (int i = 0; i < PACKET_SIZE; i++) {
+		if (bestIndex[i] != INT_MAX) {
+			objs[bestIndex[i]]->findClosestIntersection(packet.rays[i], hits[i]);
+		} else {
+			hits[i].t = FLT_MAX;
+		}
+	}
+}
+
+/**
+ * @fn	bool BVH::findAnyIntersection(const Ray &ray, real tMax, VisibleIShapePtr *blocker) const
+ * @brief	Determines if the ray hits any shape in the list before tMax. Returns as
+ * 			soon as one blocker is found.
+ * @param	ray			   	The ray.
+ * @param	tMax		   	Hits at or beyond this distance are ignored.
+ * @param [out]	blocker	If not nullptr, receives the shape that was hit.
+ * @return	True iff some shape is hit at some t in [0, tMax).
+ */
+
+bool BVH::findAnyIntersection(const Ray &ray, real tMax, VisibleIShapePtr *blocker) const {
+	if (builtSize != objs.size()) {
+		return VisibleIShape::findAnyIntersection(ray, objs, tMax, blocker);
+	}
+
+	for (unsigned int i = 0; i < unbounded.size(); i++) {
+		if (objs[unbounded[i]]->occludes(ray, tMax)) {
+			if (blocker != nullptr) {
+				*blocker = objs[unbounded[i]];
+			}
+			return true;
+		}
+	}
+	if (nodes.empty()) {
+		return false;
+	}
+
+	rvec3 invDir(1.0 / ray.dir.x, 1.0 / ray.dir.y, 1.0 / ray.dir.z);
+	int stack[MAX_BVH_DEPTH];
+	int top = 0;
+	stack[top++] = 0;
+
+	while (top > 0) {
+		int nodeIndex = stack[--top];
+		const Node &node = nodes[nodeIndex];
+		real tEntry;
+		if (!node.box.intersects(ray, invDir, tMax, tEntry)) {
+			continue;
+		}
+		if (node.count > 0) {
+			for (int i = node.first; i < node.first + node.count; i++) {
+				if (objs[items[i]]->occludes(ray, tMax)) {
+					if (blocker != nullptr) {
+						*blocker = objs[items[i]];
+					}
+					return true;
+				}
+			}
+		} else {
+			stack[top++] = node.right;
+			stack[top++] = nodeIndex + 1;
+		}
+	}
+	return false;
+}
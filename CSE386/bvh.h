@@ -0,0 +1,55 @@
+/****************************************************
+ * 2016-2021 Eric Bachmann and Mike Zmuda
+ * All Rights Reserved.
+ * NOTICE:
+ * Dissemination of this information or reproduction
+ * of this material is prohibited unless prior written
+ * permission is granted.
+ ****************************************************/
+
+#pragma once
+#include <vector>
+#include "defs.h"
+#include "hitrecord.h"
+#include "ishape.h"
+
+/**
+ * @struct	BVH
+ * @brief	Bounding volume hierarchy over a list of visible implicit shapes. The
+ * 			hierarchy is built over the shapes that report a bounding box; unbounded
+ * 			shapes (e.g., IPlanes) are kept in a separate list and tested against
+ * 			every ray. Queries return exactly the same HitRecord as
+ * 			VisibleIShape::findIntersection over the same list.
+ *
+ * 			The BVH refers to the list it was built from. It must be rebuilt, by
+ * 			calling build(), whenever a bounded shape in the list is moved. If shapes
+ * 			are added or removed after the last build, queries fall back to a linear
+ * 			scan of the list until build() is called again.
+ */
+
+struct BVH {
+	BVH(const vector<VisibleIShapePtr> &objs);
+	void build();
+	void findIntersection(const Ray &ray, HitRecord &theHit) const;
+	bool findAnyIntersection(const Ray &ray, real tMax, VisibleIShapePtr *blocker = nullptr) const;
+	void findIntersections(const RayPacket &packet, HitRecord hits[PACKET_SIZE]) const;
+protected:
+	/**
+	 * @struct	Node
+	 * @brief	A node in the flattened tree. The left child of an interior node
+	 * 			immediately follows it; the right child is at index right.
+	 */
+	struct Node {
+		AABB box;		//!< Box enclosing everything below this node.
+		int first;		//!< Index into items of the first shape in a leaf.
+		int count;		//!< Number of shapes in a leaf; 0 for interior nodes.
+		int right;		//!< Index of the right child of an interior node.
+	};
+	const vector<VisibleIShapePtr> &objs;	//!< The list this hierarchy is built over.
+	vector<Node> nodes;						//!< The tree, root first.
+	vector<int> items;						//!< Indices into objs, in leaf order.
+	vector<int> unbounded;					//!< Indices into objs of the shapes with no box.
+	size_t builtSize;						//!< Size of objs when build() was last called.
+	int buildNode(const vector<AABB> &boxes, int first, int count);
+	void testShape(const Ray &ray, int index, HitRecord &theHit, int &hitIndex) const;
+};
@@ -10,22 +10,22 @@
 #include "camera.h"
 
 /**
- * @fn	RaytracingCamera::RaytracingCamera(const dvec3 &viewingPos, 
- *											const dvec3 &lookAtPt, const dvec3 &up)
+ * @fn	RaytracingCamera::RaytracingCamera(const rvec3 &viewingPos, 
+ *											const rvec3 &lookAtPt, const rvec3 &up)
  * @brief	Constructs a raytracing camera.
  * @param	viewingPos	Location of camera.
  * @param	lookAtPt  	A focus point in front of the camera..
  * @param	up		  	Up vector.
  */
 
-RaytracingCamera::RaytracingCamera(const dvec3 &viewingPos, const dvec3 &lookAtPt, const dvec3 &up,
+RaytracingCamera::RaytracingCamera(const rvec3 &viewingPos, const rvec3 &lookAtPt, const rvec3 &up,
 									int width, int height) {
 	setupFrame(viewingPos, lookAtPt, up);
 }
 
 /**
- * @fn	void RaytracingCamera::setupViewingParameters(const dvec3 &viewingPos, 
- *														const dvec3 &lookAtPt, const dvec3 &up)
+ * @fn	void RaytracingCamera::setupViewingParameters(const rvec3 &viewingPos, 
+ *														const rvec3 &lookAtPt, const rvec3 &up)
  * @brief	Change configuration parameters of this camera. This is called to update
  *          the camera frame - camera origin, u, v, and w. The last line of this function will
  *			be a call to cameraFrame.setFrame();
@@ -34,17 +34,17 @@ RaytracingCamera::RaytracingCamera(const dvec3 &viewingPos, const dvec3 &lookAtP
  * @param	up		  	Up vector.
  */
 
-void RaytracingCamera::setupFrame(const dvec3 &viewingPos, const dvec3 &lookAtPt, const dvec3 &up) {
-	dvec3 viewingDirection = lookAtPt - viewingPos;
-	dvec3 w = glm::normalize(-viewingDirection);
-	dvec3 u = glm::normalize(glm::cross(up, w));
-	dvec3 v = glm::normalize(glm::cross(w, u));
+void RaytracingCamera::setupFrame(const rvec3 &viewingPos, const rvec3 &lookAtPt, const rvec3 &up) {
+	rvec3 viewingDirection = lookAtPt - viewingPos;
+	rvec3 w = glm::normalize(-viewingDirection);
+	rvec3 u = glm::normalize(glm::cross(up, w));
+	rvec3 v = glm::normalize(glm::cross(w, u));
 	cameraFrame.setFrame(viewingPos, u, v, w);
 }
 
 /**
- * @fn	PerspectiveCamera::PerspectiveCamera(const dvec3 &pos, const dvec3 &lookAtPt,
- *												const dvec3 &up, double FOVRads)
+ * @fn	PerspectiveCamera::PerspectiveCamera(const rvec3 &pos, const rvec3 &lookAtPt,
+ *												const rvec3 &up, real FOVRads)
  * @brief	Constructs a perspective camera.
  * @param	pos			The position of the camera.
  * @param	lookAtPt	A focus point in front of the camera.
@@ -52,8 +52,8 @@ void RaytracingCamera::setupFrame(const dvec3 &viewingPos, const dvec3 &lookAtPt
  * @param	FOVRads 	The field of view in radians.
  */
 
-PerspectiveCamera::PerspectiveCamera(const dvec3 &pos, const dvec3 &lookAtPt, const dvec3 &up, 
-									double FOVRads,
+PerspectiveCamera::PerspectiveCamera(const rvec3 &pos, const rvec3 &lookAtPt, const rvec3 &up, 
+									real FOVRads,
 											int width, int height)
 	: RaytracingCamera(pos, lookAtPt, up, width, height) {
 	fov = FOVRads;
@@ -61,8 +61,8 @@ PerspectiveCamera::PerspectiveCamera(const dvec3 &pos, const dvec3 &lookAtPt, co
 }
 
 /**
- * @fn	OrthographicCamera::OrthographicCamera(const dvec3 &pos, const dvec3 &lookAtPt, 
- *												const dvec3 &up, double ppwu)
+ * @fn	OrthographicCamera::OrthographicCamera(const rvec3 &pos, const rvec3 &lookAtPt, 
+ *												const rvec3 &up, real ppwu)
  * @brief	Constructs an orthographic camera.
  * @param	pos			Position of camera.
  * @param	lookAtPt	A focus point in front of the camera.
@@ -76,23 +76,23 @@ PerspectiveCamera::PerspectiveCamera(const dvec3 &pos, const dvec3 &lookAtPt, co
  *                      small when compared to the windows size, which is often in 100s of pixels.
  */
 
-OrthographicCamera::OrthographicCamera(const dvec3 &pos, const dvec3 &lookAtPt, const dvec3 &up, 
-											int width, int height, double scaleFactor)
+OrthographicCamera::OrthographicCamera(const rvec3 &pos, const rvec3 &lookAtPt, const rvec3 &up, 
+											int width, int height, real scaleFactor)
 	: RaytracingCamera(pos, lookAtPt, up, width, height) {
 	scale = scaleFactor;
 	setupViewingParameters(width, height);
 }
 
 /**
- * @fn	dvec2 RaytracingCamera::getProjectionPlaneCoordinates(double x, double y) const
+ * @fn	rvec2 RaytracingCamera::getProjectionPlaneCoordinates(real x, real y) const
  * @brief	Gets projection plane coordinates at (x, y).
  * @param	x	The x coordinate.
  * @param	y	The y coordinate.
  * @return	Projection plane coordinates.
  */
 
-dvec2 RaytracingCamera::getProjectionPlaneCoordinates(double x, double y) const {
-	dvec2 s;
+rvec2 RaytracingCamera::getProjectionPlaneCoordinates(real x, real y) const {
+	rvec2 s;
 	s.x = map(x, 0, nx, left, right);
 	s.y = map(y, 0, ny, bottom, top);
 	return s;
@@ -110,13 +110,13 @@ void PerspectiveCamera::setupViewingParameters(int W, int H) {
 	nx = W;
 	ny = H;
 
-	double fov_2 = fov / 2.0;
+	real fov_2 = fov / 2.0;
 	distToPlane = 1.0 / std::tan(fov_2);
 
 	top = 1.0;
 	bottom = -top;
 
-	right = top * ((double)nx / ny);
+	right = top * ((real)nx / ny);
 	left = -right;
 }
 
@@ -135,7 +135,7 @@ void OrthographicCamera::setupViewingParameters(int W, int H) {
 	top = H / 2.0;
 	bottom = -top;
 
-	right = top * (double)W / H;
+	right = top * (real)W / H;
 	left = -right;
 
 	left *= scale;
@@ -145,34 +145,58 @@ void OrthographicCamera::setupViewingParameters(int W, int H) {
 }
 
 /**
- * @fn	Ray OrthographicCamera::getRay(double x, double y) const
+ * @fn	Ray OrthographicCamera::getRay(real x, real y) const
  * @brief	Determines camera ray going through projection plane at (x, y), in direction -w.
  * @param	x	The x coordinate.
  * @param	y	The y coordinate.
  * @return	The ray through the projection plane at (x, y), in direction -w.
  */
 
-Ray OrthographicCamera::getRay(double x, double y) const {
-	dvec2 uv = getProjectionPlaneCoordinates(x, y);
+Ray OrthographicCamera::getRay(real x, real y) const {
+	rvec2 uv = getProjectionPlaneCoordinates(x, y);
 	return Ray(cameraFrame.origin + uv.x * cameraFrame.u + uv.y * cameraFrame.v, -cameraFrame.w);
 }
 
 /**
- * @fn	Ray PerspectiveCamera::getRay(double x, double y) const
+ * @fn	Ray PerspectiveCamera::getRay(real x, real y) const
  * @brief	Determines ray eminating from camera through the projection plane at (x, y).
  * @param	x	The x coordinate.
  * @param	y	The y coordinate.
  * @return	The ray eminating from camera through the projection plane at (x, y).
  */
 
-Ray PerspectiveCamera::getRay(double x, double y) const {
-	dvec2 uv = getProjectionPlaneCoordinates(x, y);
-	dvec3 rayDirection = glm::normalize(-distToPlane * cameraFrame.w +
+Ray PerspectiveCamera::getRay(real x, real y) const {
+	rvec2 uv = getProjectionPlaneCoordinates(x, y);
+	rvec3 rayDirection = glm::normalize(-distToPlane * cameraFrame.w +
 											uv.x * cameraFrame.u + 
 											uv.y * cameraFrame.v); // Page 76
 	return Ray(cameraFrame.origin, rayDirection);
 }
 
+/**
+ * @fn	real OrthographicCamera::getPixelFootprint(real dist) const
+ * @brief	Gets the width of the area a pixel covers, which does not depend on distance.
+ * @param	dist	The distance along the ray. Unused.
+ * @return	The width of a pixel on the projection plane.
+ */
+
+real OrthographicCamera::getPixelFootprint(real /*dist*/) const {
+	return (top - bottom) / ny;
+}
+
+/**
+ * @fn	real PerspectiveCamera::getPixelFootprint(real dist) const
+ * @brief	Gets the width of the area a pixel covers at a distance from the camera.
+ * 			Pixels near the edge of a wide view cover a little more; this is the
+ * 			width at the center.
+ * @param	dist	The distance along the ray.
+ * @return	The width, in world units, of the cone through a pixel at dist.
+ */
+
+real PerspectiveCamera::getPixelFootprint(real dist) const {
+	return dist * (top - bottom) / (ny * distToPlane);
+}
+
 /**
 * @fn	ostream &operator << (ostream &os, const RaytracingCamera &camera)
 * @brief	Output stream for cameras.
@@ -17,24 +17,25 @@
  */
 
 struct RaytracingCamera {
-	RaytracingCamera(const dvec3 &pos, const dvec3 &lookAtPt, const dvec3 &up,
+	RaytracingCamera(const rvec3 &pos, const rvec3 &lookAtPt, const rvec3 &up,
 						int width, int height);
-	virtual Ray getRay(double x, double y) const = 0;
+	virtual Ray getRay(real x, real y) const = 0;
+	virtual real getPixelFootprint(real dist) const = 0;
 	Frame getFrame() const { return cameraFrame;  }
 	int getNX() const { return nx; }
 	int getNY() const { return ny; }
-	double getLeft() const { return left; }
-	double getRight() const { return right; }
-	double getBottom() const { return bottom; }
-	double getTop() const { return top; }
+	real getLeft() const { return left; }
+	real getRight() const { return right; }
+	real getBottom() const { return bottom; }
+	real getTop() const { return top; }
 protected:
 	Frame cameraFrame;					//!< The camera's frame
 	int nx, ny;							//!< Window size
-	double left, right, bottom, top;	//!< The camera's vertical field of view
+	real left, right, bottom, top;	//!< The camera's vertical field of view
 
-	void setupFrame(const dvec3& pos, const dvec3& lookAtPt, const dvec3& up);
+	void setupFrame(const rvec3& pos, const rvec3& lookAtPt, const rvec3& up);
 	virtual void setupViewingParameters(int width, int height) = 0;
-	dvec2 getProjectionPlaneCoordinates(double x, double y) const;
+	rvec2 getProjectionPlaneCoordinates(real x, real y) const;
 public:
 
 	friend ostream &operator << (ostream &os, const RaytracingCamera &camera);
@@ -46,13 +47,14 @@ public:
  */
 
 struct PerspectiveCamera : public RaytracingCamera {
-	PerspectiveCamera(const dvec3& pos, const dvec3& lookAtPt, const dvec3& up, double FOVRads,
+	PerspectiveCamera(const rvec3& pos, const rvec3& lookAtPt, const rvec3& up, real FOVRads,
 							int width, int height);
-	virtual Ray getRay(double x, double y) const;
-	double getDistToPlane() const { return distToPlane; }
+	virtual Ray getRay(real x, real y) const;
+	virtual real getPixelFootprint(real dist) const;
+	real getDistToPlane() const { return distToPlane; }
 private:
-	double fov;						//!< The camera's field of view
-	double distToPlane;				//!< Distance to image plane
+	real fov;						//!< The camera's field of view
+	real distToPlane;				//!< Distance to image plane
 	virtual void setupViewingParameters(int width, int height);
 };
 
@@ -62,10 +64,11 @@ private:
  */
 
 struct OrthographicCamera : public RaytracingCamera {
-	OrthographicCamera(const dvec3& pos, const dvec3& lookAtPt, const dvec3& up,
-								int width, int height, double scaleFactor);
-	virtual Ray getRay(double x, double y) const;
+	OrthographicCamera(const rvec3& pos, const rvec3& lookAtPt, const rvec3& up,
+								int width, int height, real scaleFactor);
+	virtual Ray getRay(real x, real y) const;
+	virtual real getPixelFootprint(real dist) const;
 private:
-	double scale;		//!< Controls the size of the image plane.
+	real scale;		//!< Controls the size of the image plane.
 	virtual void setupViewingParameters(int width, int height);
 };
\ No newline at end of file
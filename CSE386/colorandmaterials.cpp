@@ -11,7 +11,7 @@
 #include "colorandmaterials.h"
 
 /**
- * @fn	Material::Material(const color &amb, const color &diff, const color &spec, double S)
+ * @fn	Material::Material(const color &amb, const color &diff, const color &spec, real S)
  * @brief	Construct a Materials based on the basic color and shinieness values.
  * @param	amb			Ambient
  * @param	diff		Diffuse
@@ -21,7 +21,7 @@
 
 Material::Material(const color &amb, 
 					const color &diff, 
-					const color &spec, double S) {
+					const color &spec, real S) {
 	ambient = amb;
 	diffuse = diff;
 	specular = spec;
@@ -30,12 +30,12 @@ Material::Material(const color &amb,
 }
 
 /**
- * @fn	Material::Material(const vector<double> &C)
+ * @fn	Material::Material(const vector<real> &C)
  * @brief	Construct a Materials based on the basic color and shinieness values.
  * @param	C			Vector holding 10 values: ambient, diffuse, specular, shinieness
  */
 
-Material::Material(const vector<double> &C) :
+Material::Material(const vector<real> &C) :
 	Material(color(C[0], C[1], C[2]),
 		color(C[3], C[4], C[5]),
 		color(C[6], C[7], C[8]),
@@ -58,13 +58,13 @@ Material::Material(const color &oneColor) {
 }
 
 /**
- * @fn	Material operator*(double w) const
+ * @fn	Material operator*(real w) const
  * @brief	Multiply a Material by a scalar value.
  * @param	w	Weight of multiplication.
  * @return	The Material resulting from multiplying the given Material by the given weight.
  */
 
-Material Material::operator *(double w) const {
+Material Material::operator *(real w) const {
 	Material result = *this;
 	result.alpha *= w;
 	result.ambient *= w;
@@ -106,13 +106,13 @@ Material Material::operator +(const Material &mat) const {
 }
 
 /**
- * @fn	Material operator*(double w, const Material &mat)
+ * @fn	Material operator*(real w, const Material &mat)
  * @brief	Multiply a Material and a scalar.
  * @param	w  	The scalar multiplicand
  * @param	mat	Material
  * @return	The original material multiplied by given weight.
  */
 
-Material operator *(double w, const Material &mat) {
+Material operator *(real w, const Material &mat) {
 	return mat * w;
 }
\ No newline at end of file
@@ -21,16 +21,16 @@
 
  /*
  Use this version of FragmentOps::processFragment:
- void FragmentOps::processFragment(FrameBuffer& frameBuffer, const dvec3& eyePositionInWorldCoords,
-									 const vector<LightSourcePtr> lights,
+ void FragmentOps::processFragment(FrameBuffer& frameBuffer, const rvec3& eyePositionInWorldCoords,
+									 const vector<LightSourcePtr> &lights,
 									 const Fragment& fragment,
 									 const Frame& eyeFrame) {
-	 const dvec3& eyePos = eyePositionInWorldCoords;
+	 const rvec3& eyePos = eyePositionInWorldCoords;
 
-	 double Z = fragment.windowPos.z;
+	 real Z = fragment.windowPos.z;
 	 int X = (int)fragment.windowPos.x;
 	 int Y = (int)fragment.windowPos.y;
-	 double oldZ = frameBuffer.getDepth(X, Y);
+	 real oldZ = frameBuffer.getDepth(X, Y);
 	 bool passDepthTest = !performDepthTest || Z < oldZ;
 
 	 if (passDepthTest) {
@@ -47,7 +47,7 @@
  */
 
 vector<LightSourcePtr> lights = {
-								new PositionalLight(dvec3(10, 10, 10), pureWhiteLight)
+								new PositionalLight(rvec3(10, 10, 10), pureWhiteLight)
 };
 const int W = 250;
 const int H = W;
@@ -55,18 +55,18 @@ int which = 0;
 FrameBuffer frameBuffer(W, H);
 
 PipelineMatrices pipeMats;
-dmat4& viewingMatrix = pipeMats.viewingMatrix;
-dmat4& projectionMatrix = pipeMats.projectionMatrix;
-dmat4& viewportMatrix = pipeMats.viewportMatrix;
-
-void square(double x, double y, double z, color C, double radius = 0.5) {
-	static dmat4 I;
-	dvec4 center(x, y, z, 1);
-	double D = radius;
-	VertexData a(center + dvec4(-D, -D, 0, 0), Z_AXIS, C);
-	VertexData b(center + dvec4(D, -D, 0, 0), Z_AXIS, C);
-	VertexData c(center + dvec4(D, D, 0, 0), Z_AXIS, C);
-	VertexData d(center + dvec4(-D, D, 0, 0), Z_AXIS, C);
+rmat4& viewingMatrix = pipeMats.viewingMatrix;
+rmat4& projectionMatrix = pipeMats.projectionMatrix;
+rmat4& viewportMatrix = pipeMats.viewportMatrix;
+
+void square(real x, real y, real z, color C, real radius = 0.5) {
+	static rmat4 I;
+	rvec4 center(x, y, z, 1);
+	real D = radius;
+	VertexData a(center + rvec4(-D, -D, 0, 0), Z_AXIS, C);
+	VertexData b(center + rvec4(D, -D, 0, 0), Z_AXIS, C);
+	VertexData c(center + rvec4(D, D, 0, 0), Z_AXIS, C);
+	VertexData d(center + rvec4(-D, D, 0, 0), Z_AXIS, C);
 	EShapeData verts = { a, b, c, a, c, d };
 	VertexOps::render(frameBuffer, verts, lights, I, pipeMats, true);
 }
@@ -207,16 +207,16 @@ void resize(int width, int height) {
 void render() {
 	int width = frameBuffer.getWindowWidth();
 	int height = frameBuffer.getWindowHeight();
-	double AR = (double)width / height;
-	viewingMatrix = glm::lookAt(ORIGIN3D, dvec3(0, 0, -1), Y_AXIS);
-
-	double vvWidth = 4.0;
-	double vvHeight = vvWidth / AR;
-	double left = -vvWidth / 2.0;
-	double right = -left;
-	double bottom = -vvHeight / 2.0;
-	double top = -bottom;
-	projectionMatrix = glm::ortho(left, right, bottom, top, 0.0, 10.0);
+	real AR = (real)width / height;
+	viewingMatrix = glm::lookAt(ORIGIN3D, rvec3(0, 0, -1), Y_AXIS);
+
+	real vvWidth = 4.0;
+	real vvHeight = vvWidth / AR;
+	real left = -vvWidth / 2.0;
+	real right = -left;
+	real bottom = -vvHeight / 2.0;
+	real top = -bottom;
+	projectionMatrix = glm::ortho(left, right, bottom, top, real(0.0), real(10.0));
 	viewportMatrix = VertexOps::getViewportTransformation(0, width, 0, height);
 
 	frameBuffer.clearColorAndDepthBuffers();
@@ -234,7 +234,7 @@ void render() {
 	frameBuffer.showColorBuffer();
 }
 void keyboard(unsigned char key, int x, int y) {
-	const double INC = 0.5;
+	const real INC = 0.5;
 	if (key == ESCAPE) {
 		glutLeaveMainLoop();
 	} else {
@@ -6,27 +6,27 @@
 
 int main(int argc, char* argv[]) {
 	// This example is the one used in the handout we covered in class.
-	dvec3 eyePos(3.0, 0.0, 1.0);
+	rvec3 eyePos(3.0, 0.0, 1.0);
 
-	dvec3 interceptPt(5.0, 2.0, -3.0);
-	dvec3 pointToRight(4.0, 4.0, 0.0);
-	dvec3 pointToLeft(0.0, 0.0, 0.0);
+	rvec3 interceptPt(5.0, 2.0, -3.0);
+	rvec3 pointToRight(4.0, 4.0, 0.0);
+	rvec3 pointToLeft(0.0, 0.0, 0.0);
 
 	color L1amb(0.3, 0.2, 0.1);
 	color L1diff(1.0, 1.0, 1.0);
 	color L1spec(0.5, 0.6, 0.7);
-	dvec3 L1pos(6.0, 1.0, 0.0);
+	rvec3 L1pos(6.0, 1.0, 0.0);
 
 	color mat1amb(0.4, 0.5, 0.6);
 	color mat1diff(0.9, 1.0, 0.9);
 	color mat1spec(0.9, 0.8, 0.7);
 
-	dvec3 V1 = pointToRight - interceptPt;
-	dvec3 V2 = pointToLeft - interceptPt;
-	dvec3 n = glm::normalize(glm::cross(V1, V2));
-	dvec3 v = glm::normalize(eyePos - interceptPt);
-	dvec3 l = glm::normalize(L1pos - interceptPt);
-	dvec3 r = glm::normalize(2.0 * glm::dot(l, n) * n - l);
+	rvec3 V1 = pointToRight - interceptPt;
+	rvec3 V2 = pointToLeft - interceptPt;
+	rvec3 n = glm::normalize(glm::cross(V1, V2));
+	rvec3 v = glm::normalize(eyePos - interceptPt);
+	rvec3 l = glm::normalize(L1pos - interceptPt);
+	rvec3 r = glm::normalize(real(2.0) * glm::dot(l, n) * n - l);
 
 	cout << "n: " << n << endl;
 	cout << "v: " << v << endl;
@@ -52,9 +52,9 @@ int main(int argc, char* argv[]) {
 	cout << endl;
 
 	cout << "Tests involving negative dot products" << endl;
-	dvec3 wonkyL = glm::normalize(dvec3(-1.0, -1.0, -1.0));
+	rvec3 wonkyL = glm::normalize(rvec3(-1.0, -1.0, -1.0));
 	cout << "Diffuse with negative l dot n: " << diffuseColor(mat1diff, L1diff, wonkyL, n) << endl;
-	dvec3 wonkyV = glm::normalize(dvec3(-1.0, -1.0, -1.0));
+	rvec3 wonkyV = glm::normalize(rvec3(-1.0, -1.0, -1.0));
 	cout << "Specular with negative r dot v: " << specularColor(mat1spec, L1spec, 1.0, r, wonkyV) << endl;
 
 	cout << endl;
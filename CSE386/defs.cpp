@@ -18,7 +18,7 @@
  */
 
 void Frame::setInverse() {
-	dmat4 T;
+	rmat4 T;
 	T[0][0] = u[0];
 	T[0][1] = u[1];
 	T[0][2] = u[2];
@@ -39,55 +39,55 @@ void Frame::setInverse() {
 }
 
 /**
- * @fn	dvec3 Frame::toFrameCoords(const dvec3 &pt) const
+ * @fn	rvec3 Frame::toFrameCoords(const rvec3 &pt) const
  * @brief	Converts a point to a frame coordinates
  * @param	pt	Point in world coordinates.
  * @return	The frame coordinates of a point given in woord coordinates.
  */
 
-dvec3 Frame::toFrameCoords(const dvec3 &pt) const {
-	return (inverse * dvec4(pt.x, pt.y, pt.z, 1.0)).xyz();
+rvec3 Frame::toFrameCoords(const rvec3 &pt) const {
+	return (inverse * rvec4(pt.x, pt.y, pt.z, 1.0)).xyz();
 }
 
 /**
-* @fn	dvec3 Frame::toWorldCoords(const dvec3 &pt) const
+* @fn	rvec3 Frame::toWorldCoords(const rvec3 &pt) const
 * @brief	Converts a frame coordinate into the equivalent point in world coordinates
 * @param	pt	Point in frame coordinates.
 * @return	The world coordinates of a point given in frame coordinates.
 */
 
-dvec3 Frame::toWorldCoords(const dvec3 &pt) const {
+rvec3 Frame::toWorldCoords(const rvec3 &pt) const {
 	return origin + pt.x * u + pt.y * v + pt.z * w;
 }
 
 /**
- * @fn	dvec3 Frame::toFrameVector(const dvec3 &V) const
+ * @fn	rvec3 Frame::toFrameVector(const rvec3 &V) const
  * @brief	Converts a V (in world system) into equivalent frame vector.
  * @param	V	World vector to process.
  * @return	Frame vector that expresses the same direction as the original.
  */
 
-dvec3 Frame::toFrameVector(const dvec3 &V) const {
-	dvec3 A = toFrameCoords(V);
-	dvec3 B = toFrameCoords(ORIGIN3D);
+rvec3 Frame::toFrameVector(const rvec3 &V) const {
+	rvec3 A = toFrameCoords(V);
+	rvec3 B = toFrameCoords(ORIGIN3D);
 	return A - B;
 }
 
 /**
- * @fn	dvec3 Frame::toWorldVector(const dvec3 &V) const
+ * @fn	rvec3 Frame::toWorldVector(const rvec3 &V) const
  * @brief	Converts a V (in frame system) into equivalent world vector.
  * @param	V	Frame vector to process.
  * @return	World vector that expresses the same direction as the original.
  */
 
-dvec3 Frame::toWorldVector(const dvec3 &V) const {
-	dvec3 vectorHead = origin + u * V.x + v * V.y + w * V.z;
-	dvec3 vectorTail = origin;
+rvec3 Frame::toWorldVector(const rvec3 &V) const {
+	rvec3 vectorHead = origin + u * V.x + v * V.y + w * V.z;
+	rvec3 vectorTail = origin;
 	return vectorHead - vectorTail;
 }
 
 /**
- * @fn	Frame Frame::createOrthoNormalBasis(const dvec3 &pos, const dvec3 &w, const dvec3 &up)
+ * @fn	Frame Frame::createOrthoNormalBasis(const rvec3 &pos, const rvec3 &w, const rvec3 &up)
  * @brief	Creates ortho normal basis given a position and two non-parallel vectors.
  * @param	pos	The position of the new frame's origin.
  * @param	w  	"z" vector in new frame.
@@ -95,7 +95,7 @@ dvec3 Frame::toWorldVector(const dvec3 &V) const {
  * @return	The new ortho normal basis.
  */
 
-Frame Frame::createOrthoNormalBasis(const dvec3 &pos, const dvec3 &w, const dvec3 &up) {
+Frame Frame::createOrthoNormalBasis(const rvec3 &pos, const rvec3 &w, const rvec3 &up) {
 	Frame frame;
 	frame.origin = pos;
 	frame.w = glm::normalize(w);
@@ -106,29 +106,29 @@ Frame Frame::createOrthoNormalBasis(const dvec3 &pos, const dvec3 &w, const dvec
 }
 
 /**
-* @fn	Frame Frame::createOrthoNormalBasis(const dmat4 &viewingMatrix)
+* @fn	Frame Frame::createOrthoNormalBasis(const rmat4 &viewingMatrix)
 * @brief	Creates ortho normal basis given two non-parallel vectors.
 * @param	viewingMatrix The viewing matrix created by glm::lookAt
 * @return	The equivalent Frame
 */
 
-Frame Frame::createOrthoNormalBasis(const dmat4 &viewingMatrix) {
-	dmat4 vmInverse = glm::inverse(viewingMatrix);
-	dvec3 u(vmInverse[0]);
-	dvec3 v(vmInverse[1]);
-	dvec3 w(vmInverse[2]);
-	dvec3 eye(vmInverse[3]);
+Frame Frame::createOrthoNormalBasis(const rmat4 &viewingMatrix) {
+	rmat4 vmInverse = glm::inverse(viewingMatrix);
+	rvec3 u(vmInverse[0]);
+	rvec3 v(vmInverse[1]);
+	rvec3 w(vmInverse[2]);
+	rvec3 eye(vmInverse[3]);
 	return Frame(eye, u, v, w);
 }
 
 /**
-* @fn	dmat4 Frame::toViewingMatrix()
+* @fn	rmat4 Frame::toViewingMatrix()
 * @brief	Returns the viewing matrix equivalent to the frame
 * @return	The equivalent viewing matrix
 */
 
-dmat4 Frame::toViewingMatrix() const {
-	return glm::inverse(dmat4(u.x, u.y, u.z, 0,
+rmat4 Frame::toViewingMatrix() const {
+	return glm::inverse(rmat4(u.x, u.y, u.z, 0,
 								v.x, v.y, v.z, 0,
 								w.x, w.y, w.z, 0,
 								origin.x, origin.y, origin.z, 1));
@@ -144,7 +144,7 @@ Frame::Frame() : origin(ORIGIN3D), u(ZEROVEC), v(ZEROVEC), w(ZEROVEC) {
 }
 
 /**
- * @fn	Frame::Frame(const dvec3 &O, const dvec3 &U, const dvec3 &V, const dvec3 &W)
+ * @fn	Frame::Frame(const rvec3 &O, const rvec3 &U, const rvec3 &V, const rvec3 &W)
  * @brief	Constructs a new frame given 3 orthonormal vectors (assumed to be orthonormal).
  * @param 	O	Origin of new frame.
  * @param	U	New "x" vector.
@@ -152,13 +152,13 @@ Frame::Frame() : origin(ORIGIN3D), u(ZEROVEC), v(ZEROVEC), w(ZEROVEC) {
  * @param 	W	New "z" vector.
  */
 
-Frame::Frame(const dvec3 &O, const dvec3 &U, const dvec3 &V, const dvec3 &W)
+Frame::Frame(const rvec3 &O, const rvec3 &U, const rvec3 &V, const rvec3 &W)
 	: origin(O), u(U), v(V), w(W) {
 	setInverse();
 }
 
 /**
- * @fn	void Frame::setFrame(const dvec3 &O, const dvec3 &U, const dvec3 &V, const dvec3 &W)
+ * @fn	void Frame::setFrame(const rvec3 &O, const rvec3 &U, const rvec3 &V, const rvec3 &W)
  * @brief	Sets the frame's axes and origin.
  * @param 	O	Origin of new frame.
  * @param	U	New "x" vector.
@@ -166,7 +166,7 @@ Frame::Frame(const dvec3 &O, const dvec3 &U, const dvec3 &V, const dvec3 &W)
  * @param 	W	New "z" vector.
  */
 
-void Frame::setFrame(const dvec3 &O, const dvec3 &U, const dvec3 &V, const dvec3 &W) {
+void Frame::setFrame(const rvec3 &O, const rvec3 &U, const rvec3 &V, const rvec3 &W) {
 	origin = O;
 	u = U;
 	v = V;
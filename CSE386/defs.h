@@ -18,8 +18,13 @@
 #include <limits>
 
 // Glut takes care of all the system-specific chores required for creating windows, 
-// initializing OpenGL contexts, and handling input events
+// initializing OpenGL contexts, and handling input events. Headless builds
+// (CONSOLE_ONLY) have no window and do not need OpenGL at all.
+#ifndef CONSOLE_ONLY
 #include <GL/freeglut.h>
+#else
+typedef unsigned char GLubyte;
+#endif
 
 #define GLM_FORCE_CTOR_INIT
 #define GLM_FORCE_SWIZZLE  // Enable GLM "swizzle" operators
@@ -44,8 +49,29 @@ using glm::dmat2;
 using glm::dmat3;
 using glm::dmat4;
 
+// The precision of the math core. Define SINGLE_PRECISION to build everything
+// (rays, shapes, hit records, vertices, colors, lighting) with float instead
+// of double.
+#ifdef SINGLE_PRECISION
+typedef float real;					//!< scalar type of the math core
+typedef glm::vec2 rvec2;
+typedef glm::vec3 rvec3;
+typedef glm::vec4 rvec4;
+typedef glm::mat2 rmat2;
+typedef glm::mat3 rmat3;
+typedef glm::mat4 rmat4;
+#else
+typedef double real;				//!< scalar type of the math core
+typedef glm::dvec2 rvec2;
+typedef glm::dvec3 rvec3;
+typedef glm::dvec4 rvec4;
+typedef glm::dmat2 rmat2;
+typedef glm::dmat3 rmat3;
+typedef glm::dmat4 rmat4;
+#endif
+
 const std::string username = "davilaek";
-const double EPSILON = 1.0E-3;		//!< default value used for "SMALL" tolerances.
+const real EPSILON = (real)1.0E-3;	//!< default value used for "SMALL" tolerances.
 
 const int TIME_INTERVAL = 100;		//!< default time interval used timers.
 const int WINDOW_WIDTH = 500;		//!< default window width.
@@ -53,20 +79,20 @@ const int WINDOW_HEIGHT = 250;		//!< default window height.
 const unsigned char ESCAPE = 27;	//!< escape key.
 const int DEFAULT_SLICES = 8;				//!< default value used when slicing up a curved object.
 
-const double PI = 3.14159265358979323846264338327950288419716939937510582097494;	//!< pi
-const double TWO_PI = 2 * PI;		//!< 2pi	(360 degrees)
-const double PI_2 = PI / 2.0;		//!< pi/2	(90 degrees)
-const double PI_3 = PI / 3.0;		//!< pi/3	(60 degrees)
-const double PI_4 = PI / 4.0;		//!< pi/4	(45 degrees)
-const double PI_6 = PI / 6.0;		//!< pi/6	(30 degrees)
+const real PI = 3.14159265358979323846264338327950288419716939937510582097494;	//!< pi
+const real TWO_PI = 2 * PI;		//!< 2pi	(360 degrees)
+const real PI_2 = PI / 2.0;		//!< pi/2	(90 degrees)
+const real PI_3 = PI / 3.0;		//!< pi/3	(60 degrees)
+const real PI_4 = PI / 4.0;		//!< pi/4	(45 degrees)
+const real PI_6 = PI / 6.0;		//!< pi/6	(30 degrees)
 
-const dvec3 ORIGIN3D(0.0, 0.0, 0.0);			//!< (0, 0, 0)
-const dvec2 ORIGIN2D(0.0, 0.0);					//!< (0, 0)
+const rvec3 ORIGIN3D(0.0, 0.0, 0.0);			//!< (0, 0, 0)
+const rvec2 ORIGIN2D(0.0, 0.0);					//!< (0, 0)
 
-const dvec3 ZEROVEC(0.0, 0.0, 0.0);			//!< <0, 0, 0>
-const dvec3 X_AXIS(1.0, 0.0, 0.0);			//!< <1, 0, 0>
-const dvec3 Y_AXIS(0.0, 1.0, 0.0);			//!< <0, 1, 0>
-const dvec3 Z_AXIS(0.0, 0.0, 1.0);			//!< <0, 0, 1>
+const rvec3 ZEROVEC(0.0, 0.0, 0.0);			//!< <0, 0, 0>
+const rvec3 X_AXIS(1.0, 0.0, 0.0);			//!< <1, 0, 0>
+const rvec3 Y_AXIS(0.0, 1.0, 0.0);			//!< <0, 1, 0>
+const rvec3 Z_AXIS(0.0, 0.0, 1.0);			//!< <0, 0, 1>
 
 /**
  * @class	BoundingBoxi
@@ -84,8 +110,8 @@ struct BoundingBoxi {
 		ly = bottom;
 		this->height = height;
 	}
-	double aspectRatio() const {
-		return (double)width / height;
+	real aspectRatio() const {
+		return (real)width / height;
 	}
 };
 
@@ -95,21 +121,21 @@ struct BoundingBoxi {
  */
 
 struct Frame {
-	dvec3 u;		//!< frame's "x" axis
-	dvec3 v;		//!< frame's "y" axis
-	dvec3 w;		//!< frame's "z" axis
-	dvec3 origin;	//!< location of frame's origin
-	dmat4 inverse;	//!< The inverse of the frame's transformation
+	rvec3 u;		//!< frame's "x" axis
+	rvec3 v;		//!< frame's "y" axis
+	rvec3 w;		//!< frame's "z" axis
+	rvec3 origin;	//!< location of frame's origin
+	rmat4 inverse;	//!< The inverse of the frame's transformation
 	Frame();
-	Frame(const dvec3 &O, const dvec3 &U, const dvec3 &V, const dvec3 &W);
-	dvec3 toFrameCoords(const dvec3 &pt) const;
-	dvec3 toWorldCoords(const dvec3 &pt) const;
-	dvec3 toFrameVector(const dvec3 &pt) const;
-	dvec3 toWorldVector(const dvec3 &pt) const;
-	void setFrame(const dvec3 &O, const dvec3 &U, const dvec3 &V, const dvec3 &W);
-	static Frame createOrthoNormalBasis(const dvec3 &pos, const dvec3 &w, const dvec3 &up);
-	static Frame createOrthoNormalBasis(const dmat4 &viewingMatrix);
-	dmat4 toViewingMatrix() const;
+	Frame(const rvec3 &O, const rvec3 &U, const rvec3 &V, const rvec3 &W);
+	rvec3 toFrameCoords(const rvec3 &pt) const;
+	rvec3 toWorldCoords(const rvec3 &pt) const;
+	rvec3 toFrameVector(const rvec3 &pt) const;
+	rvec3 toWorldVector(const rvec3 &pt) const;
+	void setFrame(const rvec3 &O, const rvec3 &U, const rvec3 &V, const rvec3 &W);
+	static Frame createOrthoNormalBasis(const rvec3 &pos, const rvec3 &w, const rvec3 &up);
+	static Frame createOrthoNormalBasis(const rmat4 &viewingMatrix);
+	rmat4 toViewingMatrix() const;
 	friend ostream &operator <<(ostream &os, const Frame &frame);
 protected:
 	void setInverse();
@@ -8,6 +8,60 @@
  ****************************************************/
 
 #include "eshape.h"
+#include "ishape.h"
+
+/**
+ * @fn	EShapeData::EShapeData(std::initializer_list<VertexData> triangleVerts)
+ * @brief	Constructs a mesh from successive vertex triplets, one per triangle. No
+ * 			vertices are shared.
+ * @param	triangleVerts	The triangle vertices.
+ */
+
+EShapeData::EShapeData(std::initializer_list<VertexData> triangleVerts) : vertices(triangleVerts) {
+	for (unsigned int i = 0; i < vertices.size(); i++) {
+		indices.push_back(i);
+	}
+}
+
+/**
+ * @fn	unsigned int EShapeData::addVertex(const VertexData &vertex)
+ * @brief	Adds a vertex.
+ * @param	vertex	The vertex.
+ * @return	The vertex's index.
+ */
+
+unsigned int EShapeData::addVertex(const VertexData &vertex) {
+	vertices.push_back(vertex);
+	return (unsigned int)vertices.size() - 1;
+}
+
+/**
+ * @fn	void EShapeData::addTriangle(unsigned int i, unsigned int j, unsigned int k)
+ * @brief	Adds a triangle, given the indices of its vertices in counterclockwise order.
+ * @param	i	The first vertex.
+ * @param	j	The second vertex.
+ * @param	k	The third vertex.
+ */
+
+void EShapeData::addTriangle(unsigned int i, unsigned int j, unsigned int k) {
+	indices.push_back(i);
+	indices.push_back(j);
+	indices.push_back(k);
+}
+
+/**
+ * @fn	vector<VertexData> EShapeData::triangleVertices() const
+ * @brief	Expands the mesh into successive vertex triplets, one per triangle.
+ * @return	The triangle vertices.
+ */
+
+vector<VertexData> EShapeData::triangleVertices() const {
+	vector<VertexData> result;
+	for (unsigned int index : indices) {
+		result.push_back(vertices[index]);
+	}
+	return result;
+}
 
 /**
  * @fn	EShapeData EShape::createEDisk(const Material &mat, int slices)
@@ -20,15 +74,20 @@
 EShapeData EShape::createEDisk(const Material &mat, int slices) {
 	EShapeData result;
 
-	double angleInc = TWO_PI / slices;
+	real angleInc = TWO_PI / slices;
+	rvec4 center(0.0, 0.0, 0.0, 1.0);
+	rvec3 n = normalFrom3Points(center.xyz(), rvec3(1.0, 0.0, 0.0),
+								rvec3(std::cos(angleInc), std::sin(angleInc), 0.0));
 
+	unsigned int A = result.addVertex(VertexData(center, n, mat));
 	for (int i = 0; i < slices; i++) {
-		double A1 = i * angleInc;
-		double A2 = A1 + angleInc;
-		dvec4 A(0.0, 0.0, 0.0, 1.0);
-		dvec4 B(std::cos(A1), std::sin(A1), 0.0, 1.0);
-		dvec4 C(std::cos(A2), std::sin(A2), 0.0, 1.0);
-		VertexData::addTriVertsAndComputeNormal(result, A, B, C, mat);
+		real A1 = i * angleInc;
+		result.addVertex(VertexData(rvec4(std::cos(A1), std::sin(A1), 0.0, 1.0), n, mat));
+	}
+	for (int i = 0; i < slices; i++) {
+		unsigned int B = A + 1 + i;
+		unsigned int C = A + 1 + (i + 1) % slices;
+		result.addTriangle(A, B, C);
 	}
 
 	return result;
@@ -47,19 +106,26 @@ EShapeData EShape::createECylinder(const Material &mat, int slices) {
 	// todo: check if normals are setup correctly
 	EShapeData result;
 
-	double angleInc = TWO_PI / slices;
+	real angleInc = TWO_PI / slices;
 
 	for (int i = 0; i < slices; i++) {
-		double A1 = i * angleInc;
-		double A2 = A1 + angleInc;
-		dvec4 A(std::cos(A1), 0.0, std::sin(A1), 1.0);
-		dvec4 B(std::cos(A2), 0.0, std::sin(A2), 1.0);
-		A += dvec4(0.0, -0.5, 0.0, 0.0);
-		B += dvec4(0.0, -0.5, 0.0, 0.0);
-		dvec4 C = B + dvec4(0.0, 1.0, 0.0, 0.0);
-		dvec4 D = A + dvec4(0.0, 1.0, 0.0, 0.0);
-		VertexData::addTriVertsAndComputeNormal(result, A, B, C, mat);
-		VertexData::addTriVertsAndComputeNormal(result, A, C, D, mat);
+		real A1 = i * angleInc;
+		real A2 = A1 + angleInc;
+		rvec4 A(std::cos(A1), 0.0, std::sin(A1), 1.0);
+		rvec4 B(std::cos(A2), 0.0, std::sin(A2), 1.0);
+		A += rvec4(0.0, -0.5, 0.0, 0.0);
+		B += rvec4(0.0, -0.5, 0.0, 0.0);
+		rvec4 C = B + rvec4(0.0, 1.0, 0.0, 0.0);
+		rvec4 D = A + rvec4(0.0, 1.0, 0.0, 0.0);
+
+		// Both triangles of a side lie in one plane, so they share its normal
+		rvec3 n = normalFrom3Points(A.xyz(), B.xyz(), C.xyz());
+		unsigned int a = result.addVertex(VertexData(A, n, mat));
+		unsigned int b = result.addVertex(VertexData(B, n, mat));
+		unsigned int c = result.addVertex(VertexData(C, n, mat));
+		unsigned int d = result.addVertex(VertexData(D, n, mat));
+		result.addTriangle(a, b, c);
+		result.addTriangle(a, c, d);
 	}
 
 	return result;
@@ -67,7 +133,8 @@ EShapeData EShape::createECylinder(const Material &mat, int slices) {
 
 /**
  * @fn	EShapeData EShape::createECone(const Material &mat, int slices)
- * @brief	Creates cone, which is aligned with y axis. Height and radius = 1
+ * @brief	Creates cone, which is aligned with y axis. Height and radius = 1. Each slice
+ * 			has its own normal, so slices do not share vertices.
  * @param	mat   	Material.
  * @param	slices	Slices.
  * @return	The new cone.
@@ -76,15 +143,19 @@ EShapeData EShape::createECylinder(const Material &mat, int slices) {
 EShapeData EShape::createECone(const Material &mat, int slices) {
 	EShapeData result;
 
-	double angleInc = TWO_PI / slices;
+	real angleInc = TWO_PI / slices;
 
 	for (int i = 0; i < slices; i++) {
-		double A1 = i * angleInc;
-		double A2 = A1 + angleInc;
-		dvec4 tip(0.0, 1.0, 0.0, 1.0);
-		dvec4 B(std::cos(A1), 0.0, std::sin(A1), 1.0);
-		dvec4 C(std::cos(A2), 0.0, std::sin(A2), 1.0);
-		VertexData::addTriVertsAndComputeNormal(result, tip, C, B, mat);
+		real A1 = i * angleInc;
+		real A2 = A1 + angleInc;
+		rvec4 tip(0.0, 1.0, 0.0, 1.0);
+		rvec4 B(std::cos(A1), 0.0, std::sin(A1), 1.0);
+		rvec4 C(std::cos(A2), 0.0, std::sin(A2), 1.0);
+		rvec3 n = normalFrom3Points(tip.xyz(), C.xyz(), B.xyz());
+		unsigned int t = result.addVertex(VertexData(tip, n, mat));
+		unsigned int c = result.addVertex(VertexData(C, n, mat));
+		unsigned int b = result.addVertex(VertexData(B, n, mat));
+		result.addTriangle(t, c, b);
 	}
 
 	return result;
@@ -92,7 +163,7 @@ EShapeData EShape::createECone(const Material &mat, int slices) {
 
 /**
  * @fn	EShapeData EShape::createETriangle(const Material &mat, 
- *											const dvec4& A, const dvec4& B, const dvec4& C)
+ *											const rvec4& A, const rvec4& B, const rvec4& C)
  * @brief	Creates one triangles from 3 vertices
  * @param	mat	Material.
  * @param	A  	First vertex.
@@ -102,15 +173,19 @@ EShapeData EShape::createECone(const Material &mat, int slices) {
  */
 
 EShapeData EShape::createETriangle(const Material& mat,
-									const dvec4& A, const dvec4& B, const dvec4& C) {
+									const rvec4& A, const rvec4& B, const rvec4& C) {
 	EShapeData result;
-	VertexData::addTriVertsAndComputeNormal(result, A, B, C, mat);
+	rvec3 n = normalFrom3Points(A.xyz(), B.xyz(), C.xyz());
+	unsigned int a = result.addVertex(VertexData(A, n, mat));
+	unsigned int b = result.addVertex(VertexData(B, n, mat));
+	unsigned int c = result.addVertex(VertexData(C, n, mat));
+	result.addTriangle(a, b, c);
 	return result;
 }
 
 /**
- * @fn	EShapeData EShape::createECheckerBoard(const Material &mat1, const Material &mat2, double WIDTH, double HEIGHT, int DIV)
- * @brief	Creates checker board pattern.
+ * @fn	EShapeData EShape::createECheckerBoard(const Material &mat1, const Material &mat2, real WIDTH, real HEIGHT, int DIV)
+ * @brief	Creates checker board pattern. Each square is two triangles sharing a diagonal.
  * @param	mat1  	Material #1.
  * @param	mat2  	Material #2.
  * @param	WIDTH 	Width of overall plane.
@@ -120,26 +195,25 @@ EShapeData EShape::createETriangle(const Material& mat,
  */
 
 EShapeData EShape::createECheckerBoard(const Material &mat1, const Material &mat2, 
-										double WIDTH, double HEIGHT, int DIV) {
+										real WIDTH, real HEIGHT, int DIV) {
 	EShapeData result;
 
-	const double INC = WIDTH / DIV;
+	const real INC = WIDTH / DIV;
 	for (int X = 0; X < DIV; X++) {
 		bool isMat1 = X % 2 == 0;
-		for (double Z = 0; Z < DIV; Z++) {
-			dvec4 V0(-WIDTH / 2.0 + X*INC, 0.0, -WIDTH / 2 + Z*INC, 1.0);
-			dvec4 V1 = V0 + dvec4(0.0, 0.0, INC, 0.0);
-			dvec4 V2 = V0 + dvec4(INC, 0.0, INC, 0.0);
-			dvec4 V3 = V0 + dvec4(INC, 0.0, 0.0, 0.0);
+		for (real Z = 0; Z < DIV; Z++) {
+			rvec4 V0(-WIDTH / 2.0 + X*INC, 0.0, -WIDTH / 2 + Z*INC, 1.0);
+			rvec4 V1 = V0 + rvec4(0.0, 0.0, INC, 0.0);
+			rvec4 V2 = V0 + rvec4(INC, 0.0, INC, 0.0);
+			rvec4 V3 = V0 + rvec4(INC, 0.0, 0.0, 0.0);
 			const Material &mat = isMat1 ? mat1 : mat2;
 
-			result.push_back(VertexData(V0, Y_AXIS, mat));
-			result.push_back(VertexData(V1, Y_AXIS, mat));
-			result.push_back(VertexData(V2, Y_AXIS, mat));
-
-			result.push_back(VertexData(V2, Y_AXIS, mat));
-			result.push_back(VertexData(V3, Y_AXIS, mat));
-			result.push_back(VertexData(V0, Y_AXIS, mat));
+			unsigned int i0 = result.addVertex(VertexData(V0, Y_AXIS, mat));
+			unsigned int i1 = result.addVertex(VertexData(V1, Y_AXIS, mat));
+			unsigned int i2 = result.addVertex(VertexData(V2, Y_AXIS, mat));
+			unsigned int i3 = result.addVertex(VertexData(V3, Y_AXIS, mat));
+			result.addTriangle(i0, i1, i2);
+			result.addTriangle(i2, i3, i0);
 			isMat1 = !isMat1;
 		}
 	}
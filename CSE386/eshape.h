@@ -9,26 +9,43 @@
 
 #pragma once
 
+#include <initializer_list>
 #include <utility>
 #include "vertexdata.h"
 #include "framebuffer.h"
 #include "light.h"
 
-typedef vector<VertexData> EShapeData;
+/**
+ * @struct	EShapeData
+ * @brief	An indexed triangle mesh. Vertices shared by several triangles are stored once,
+ * 			and each successive triplet of indices is a triangle. Every vertex carries its
+ * 			own material, so a vertex is only shared by triangles that agree on position,
+ * 			normal and material.
+ */
+
+struct EShapeData {
+	vector<VertexData> vertices;	//!< The distinct vertices.
+	vector<unsigned int> indices;	//!< Vertex indices, three per triangle.
+	EShapeData() {}
+	EShapeData(std::initializer_list<VertexData> triangleVerts);
+	unsigned int addVertex(const VertexData &vertex);
+	void addTriangle(unsigned int i, unsigned int j, unsigned int k);
+	vector<VertexData> triangleVertices() const;
+};
 
 /**
  * @struct	EShape
  * @brief	This class contains functions that create explicitly represented shapes.
  * 			This class is used within pipeline applications. The objects returned by
- * 			these routines are vectors of VertexData, where each successive triplet
- * 			is a triangle.
+ * 			these routines are indexed meshes, in which neighboring triangles share
+ * 			vertices wherever flat shading allows.
  */
 
 struct EShape {
 	static EShapeData createETriangle(const Material& mat,
-										const dvec4& A, const dvec4& B, const dvec4 &C);
+										const rvec4& A, const rvec4& B, const rvec4 &C);
 	static EShapeData createEDisk(const Material& mat, int slices = DEFAULT_SLICES);
 	static EShapeData createECylinder(const Material& mat, int slices = DEFAULT_SLICES);
 	static EShapeData createECone(const Material& mat, int slices = DEFAULT_SLICES);
-	static EShapeData createECheckerBoard(const Material& mat1, const Material& mat2, double WIDTH, double HEIGHT, int DIV);
+	static EShapeData createECheckerBoard(const Material& mat1, const Material& mat2, real WIDTH, real HEIGHT, int DIV);
 };
@@ -19,26 +19,26 @@ const int WINDOW_SZ = 500;
 FrameBuffer colorBuffer(WINDOW_SZ, WINDOW_SZ);
 const int N = 50;
 
-vector<dvec3> triangleVertices = { dvec3(-2 * N,2 * N,1), dvec3(-N,2 * N,1), dvec3(-1.5 * N,3 * N,1) };
-vector<dvec3> square1Vertices = { dvec3(-N,-N,1), dvec3(N,-N,1),
-											dvec3(N,N,1), dvec3(-N,N,1) };
-vector<dvec3> square2Vertices = { dvec3(3 * N,-2 * N,1), dvec3(3 * N,-3 * N,1),
-											dvec3(2 * N,-3 * N,1), dvec3(2 * N,-2 * N,1) };
+vector<rvec3> triangleVertices = { rvec3(-2 * N,2 * N,1), rvec3(-N,2 * N,1), rvec3(-1.5 * N,3 * N,1) };
+vector<rvec3> square1Vertices = { rvec3(-N,-N,1), rvec3(N,-N,1),
+											rvec3(N,N,1), rvec3(-N,N,1) };
+vector<rvec3> square2Vertices = { rvec3(3 * N,-2 * N,1), rvec3(3 * N,-3 * N,1),
+											rvec3(2 * N,-3 * N,1), rvec3(2 * N,-2 * N,1) };
 
 int displayedProblem = 0;
 
-vector<dvec3> transformVertices(const dmat3& transMatrix, const vector<dvec3>& vertices) {
-	vector<dvec3> transformedVertices;
+vector<rvec3> transformVertices(const rmat3& transMatrix, const vector<rvec3>& vertices) {
+	vector<rvec3> transformedVertices;
 
 	for (size_t i = 0; i < vertices.size(); i++) {
-		dvec3 vt(transMatrix * vertices[i]);
+		rvec3 vt(transMatrix * vertices[i]);
 		transformedVertices.push_back(vt);
 	}
 
 	return transformedVertices;
 }
 
-void drawWirePolygonWithShift(vector<dvec3> verts, const color& C) {
+void drawWirePolygonWithShift(vector<rvec3> verts, const color& C) {
 	int W2 = colorBuffer.getWindowWidth() / 2;
 	int H2 = colorBuffer.getWindowHeight() / 2;
 	for (unsigned int i = 0; i < verts.size(); i++) {
@@ -48,15 +48,15 @@ void drawWirePolygonWithShift(vector<dvec3> verts, const color& C) {
 	drawWirePolygon(colorBuffer, verts, C);
 }
 
-void drawObjectOnly(const vector<dvec3>& verts, bool drawAxis = true) {
+void drawObjectOnly(const vector<rvec3>& verts, bool drawAxis = true) {
 	if (drawAxis) {
 		drawAxisOnWindow(colorBuffer);
 	}
 	drawWirePolygonWithShift(verts, black);
 }
 
-void drawObjAndOneTransformation(const dmat3& TM, const vector<dvec3>& verts, bool drawAxis = true) {
-	vector<dvec3> vertsTransformed = transformVertices(TM, verts);
+void drawObjAndOneTransformation(const rmat3& TM, const vector<rvec3>& verts, bool drawAxis = true) {
+	vector<rvec3> vertsTransformed = transformVertices(TM, verts);
 	if (drawAxis) {
 		drawAxisOnWindow(colorBuffer);
 	}
@@ -64,7 +64,7 @@ void drawObjAndOneTransformation(const dmat3& TM, const vector<dvec3>& verts, bo
 	drawWirePolygonWithShift(vertsTransformed, red);
 }
 
-void drawObjectAndAllTransformations(const dmat3& TM) {
+void drawObjectAndAllTransformations(const rmat3& TM) {
 	drawObjAndOneTransformation(TM, triangleVertices, false);
 	drawObjAndOneTransformation(TM, square1Vertices, false);
 	drawObjAndOneTransformation(TM, square2Vertices, false);
@@ -73,66 +73,66 @@ void drawObjectAndAllTransformations(const dmat3& TM) {
 
 // Draw all the shapes, transformed by S(2, 0.5)
 void doScaleBy2xOneHalf() {
-	dmat3 TM = S(2.0, 0.5);
+	rmat3 TM = S(2.0, 0.5);
 	drawObjectAndAllTransformations(TM);
 }
 
 // Draw all the shapes, transformed by T(50, 50)
 void doTranslate50_50() {
-	dmat3 TM = T(50, 50);
+	rmat3 TM = T(50, 50);
 	drawObjectAndAllTransformations(TM);
 }
 
 // Draw all the shapes, transformed by R(45)
 void doRotate45() {
-	dmat3 TM = R(45);
+	rmat3 TM = R(45);
 	drawObjectAndAllTransformations(TM);
 }
 
 // Draw all the shapes, transformed by R(-10)
 void doRotateNeg10() {
-	dmat3 TM = R(-10);
+	rmat3 TM = R(-10);
 	drawObjectAndAllTransformations(TM);
 }
 
 // Draw all shapes, reflected across the Y axis
 void doReflectAcrossYaxis() {
-	dmat3 TM = S(-1, 1);
+	rmat3 TM = S(-1, 1);
 	drawObjectAndAllTransformations(TM);
 }
 
 // Draw all shapes, reflected across the origin
 void doReflectAcrossOrigin() {
-	dmat3 TM = S(-1, -1);
+	rmat3 TM = S(-1, -1);
 	drawObjectAndAllTransformations(TM);
 }
 
 // Draw only triangle, scaled 2X about its center (-1.5N, 2.5N)
 void doScale2XAboutCenterOfTriangle() {
-	dmat3 TM = T(1.5 * N, -2.5 * N) * S(2, 2);
+	rmat3 TM = T(1.5 * N, -2.5 * N) * S(2, 2);
 	drawObjAndOneTransformation(TM, triangleVertices);
 }
 
 // Draw all shapes, reflected across y=x+50
 void doReflectAcrossLineYeqXplus50() {
-	dmat3 TM = T(0, 50) * R(45) * S(1, -1) * R(-45) * T(0, -50);
+	rmat3 TM = T(0, 50) * R(45) * S(1, -1) * R(-45) * T(0, -50);
 	drawObjectAndAllTransformations(TM);
 }
 
 // Animate the rotation of the square1
 void doAnimationOfRotationByAngle() {
-	static double angle = 0.0;
+	static real angle = 0.0;
 	angle += 1.0;
-	dmat3 TM = R(angle);
+	rmat3 TM = R(angle);
 	drawObjAndOneTransformation(TM, square1Vertices);
 }
 
 // Render square1 so that it rotates about its own axis, and then orbits the origin.
 void doSquareRotatingAroundOwnAxisAndAroundSun() {
-	static double D = 0;
+	static real D = 0;
 	D += 2.5;
-	dmat3 TM = R(D) * T(2*N, 2*N) * R(D);
-	vector<dvec3> square1VerticesTransformed = transformVertices(TM, square1Vertices);
+	rmat3 TM = R(D) * T(2*N, 2*N) * R(D);
+	vector<rvec3> square1VerticesTransformed = transformVertices(TM, square1Vertices);
 	drawWirePolygonWithShift(square1VerticesTransformed, red);
 	drawAxisOnWindow(colorBuffer);
 }
@@ -15,21 +15,21 @@
 #include "light.h"
 #include "vertexops.h"
 
-PositionalLightPtr theLight = new PositionalLight(dvec3(2, 1, 3), pureWhiteLight);
+PositionalLightPtr theLight = new PositionalLight(rvec3(2, 1, 3), pureWhiteLight);
 vector<LightSourcePtr> lights = { theLight };
 
 PipelineMatrices pipeMats;
-dmat4 &viewingMatrix = pipeMats.viewingMatrix;
-dmat4 &projectionMatrix = pipeMats.projectionMatrix;
-dmat4 &viewportMatrix = pipeMats.viewportMatrix;
+rmat4 &viewingMatrix = pipeMats.viewingMatrix;
+rmat4 &projectionMatrix = pipeMats.projectionMatrix;
+rmat4 &viewportMatrix = pipeMats.viewportMatrix;
 
-const double WIDTH = 10.0;
+const real WIDTH = 10.0;
 const int DIV = 20;
 
-dvec3 position(0, 1, 5);
-double angle = 0;
+rvec3 position(0, 1, 5);
+real angle = 0;
 bool isMoving = true;
-const double SPEED = 0.1;
+const real SPEED = 0.1;
 
 FrameBuffer frameBuffer(WINDOW_WIDTH, WINDOW_HEIGHT);
 
@@ -40,10 +40,10 @@ EShapeData disk = EShape::createEDisk(greenPlastic, DEFAULT_SLICES);
 EShapeData cyl1 = EShape::createECylinder(silver, DEFAULT_SLICES);
 EShapeData cyl2 = EShape::createECylinder(silver, DEFAULT_SLICES);
 EShapeData tri = EShape::createETriangle(cyanPlastic, 
-										dvec4(0,0,0,1), dvec4(1,0,0,1), dvec4(1,1,0,1));
+										rvec4(0,0,0,1), rvec4(1,0,0,1), rvec4(1,1,0,1));
 
 void renderObjects() {
-	VertexOps::render(frameBuffer, plane, lights, dmat4(), pipeMats, true);
+	VertexOps::render(frameBuffer, plane, lights, rmat4(), pipeMats, true);
 	VertexOps::render(frameBuffer, cone1, lights, T(-1, 2, 0)*S(0.25)*Rx(angle), pipeMats, true);
 	VertexOps::render(frameBuffer, cone2, lights, Ry(angle)*T(2, 1, 0)*Rx(angle), pipeMats, true);
 	VertexOps::render(frameBuffer, disk, lights, T(0, 1, 0)*Ry(angle)*S(0.5), pipeMats, true);
@@ -57,8 +57,8 @@ static void render() {
 	int width = frameBuffer.getWindowWidth();
 	int height = frameBuffer.getWindowHeight();
 	viewingMatrix = glm::lookAt(position, ORIGIN3D, Y_AXIS);
-	double AR = (double)width / height;
-	projectionMatrix = glm::perspective(PI_3, AR, 0.5, 80.0);
+	real AR = (real)width / height;
+	projectionMatrix = glm::perspective(PI_3, AR, real(0.5), real(80.0));
 	viewportMatrix = VertexOps::getViewportTransformation(0, width, 0, height);
 	renderObjects();
 	frameBuffer.showAxes(viewingMatrix, projectionMatrix, viewportMatrix, 
@@ -68,15 +68,15 @@ static void render() {
 
 void resize(int width, int height) {
 	frameBuffer.setFrameBufferSize(width, height);
-	double AR = (double)width / height;
+	real AR = (real)width / height;
 
 	viewportMatrix = VertexOps::getViewportTransformation(0, width, 0, height);
-	projectionMatrix = glm::perspective(PI_3, AR, 0.5, 80.0);
+	projectionMatrix = glm::perspective(PI_3, AR, real(0.5), real(80.0));
 
 	glutPostRedisplay();
 }
 void keyboard(unsigned char key, int x, int y) {
-	const double INC = 0.5;
+	const real INC = 0.5;
 	switch (key) {
 	case 'X':
 	case 'x': theLight->pos.x += (isupper(key) ? INC : -INC);
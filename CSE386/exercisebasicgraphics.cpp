@@ -59,8 +59,8 @@ int main(int argc, char *argv[]) {
 
 	glutMainLoop();*/
 
-	double x = 33;
-	double y = 99;
+	real x = 33;
+	real y = 99;
 	cout << x << ' ' << y << endl;
 	swap(x, y);
 	cout << x << ' ' << y << endl;
@@ -139,22 +139,22 @@ int main(int argc, char *argv[]) {
 	cout << areaOfTriangle(0, 0, 3, 0, 0, 4) << endl;
 
 	cout << "" << endl;
-	double x1;
-	double y1;
+	real x1;
+	real y1;
 	pointOnUnitCircle(PI_2, x1, y1);
 	cout << x1 << ' ' << y1 << endl;
 
 	cout << "" << endl;
-	dvec2 center(3.0, 2.0);
-	dvec2 pt = pointOnCircle(center, 2.0, PI_2);
+	rvec2 center(3.0, 2.0);
+	rvec2 pt = pointOnCircle(center, 2.0, PI_2);
 	cout << pt << endl;
 
 	cout << "" << endl;
-	cout << directionInRadians(dvec2(0, 0), dvec2(2, 2)) << endl;           // -- > 0.7853981634
-	cout << directionInRadians(dvec2(2, 10), dvec2(3, 11)) << endl;                  // -- > 0.7853981634
-	cout << directionInRadians(dvec2(2, 2), dvec2(2, 0)) << endl;              //-- > 4.7123889804
-	cout << directionInRadians(dvec2(2, 2)) << endl;
-	cout << directionInRadians(dvec2(0, -2)) << endl;
+	cout << directionInRadians(rvec2(0, 0), rvec2(2, 2)) << endl;           // -- > 0.7853981634
+	cout << directionInRadians(rvec2(2, 10), rvec2(3, 11)) << endl;                  // -- > 0.7853981634
+	cout << directionInRadians(rvec2(2, 2), rvec2(2, 0)) << endl;              //-- > 4.7123889804
+	cout << directionInRadians(rvec2(2, 2)) << endl;
+	cout << directionInRadians(rvec2(0, -2)) << endl;
 	cout << directionInRadians(0, 0, 2, 2) << endl;
 	cout << directionInRadians(2, 10, 3, 11) << endl;
 	cout << directionInRadians(2, 2, 2, 0) << endl;
@@ -169,7 +169,7 @@ int main(int argc, char *argv[]) {
 	cout << quadratic(-3, 4, -1) << endl;
 
 	cout << "" << endl;
-	double roots[2];
+	real roots[2];
 	cout << quadratic(1, 4, 3, roots) << endl;
 	cout << roots[0] << " and " << roots[1] << endl;
 	cout << quadratic(1, 0, 0, roots) << endl;
@@ -180,7 +180,7 @@ int main(int argc, char *argv[]) {
 	cout << roots[0] << " and " << roots[1] << endl;
 
 	cout << "" << endl;
-	cout << glm::length(dvec3(3, 4, 0)) << endl;
+	cout << glm::length(rvec3(3, 4, 0)) << endl;
 
 	return 0;
 }
\ No newline at end of file
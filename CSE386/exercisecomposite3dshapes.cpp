@@ -19,14 +19,14 @@
 #include "camera.h"
 #include "rasterization.h"
 
-double z = 0.0;
-double inc = 0.2;
+real z = 0.0;
+real inc = 0.2;
 
-dvec3 cameraPos(0, 10, 10);
-dvec3 cameraFocus(0, 5, 0);
-dvec3 cameraUp = Y_AXIS;
-double cameraFOV = PI_2;
-PositionalLight posLight(dvec3(10, 10, 10), pureWhiteLight);
+rvec3 cameraPos(0, 10, 10);
+rvec3 cameraFocus(0, 5, 0);
+rvec3 cameraUp = Y_AXIS;
+real cameraFOV = PI_2;
+PositionalLight posLight(rvec3(10, 10, 10), pureWhiteLight);
 
 FrameBuffer frameBuffer(WINDOW_WIDTH, WINDOW_HEIGHT);
 RayTracer rayTrace(lightGray);
@@ -42,7 +42,7 @@ void render() {
 	rayTrace.raytraceScene(frameBuffer, 0, scene, 1);
 
 	int frameEndTime = glutGet(GLUT_ELAPSED_TIME); // Get end time
-	double totalTimeSec = (frameEndTime - frameStartTime) / 1000.0;
+	real totalTimeSec = (frameEndTime - frameStartTime) / 1000.0;
 	cout << "Render time: " << totalTimeSec << " sec." << endl;
 }
 
@@ -51,13 +51,13 @@ void resize(int width, int height) {
 	glutPostRedisplay();
 }
 
-IPlane* plane = new IPlane(dvec3(0, -2, 0), Y_AXIS);
-ICylinderY* cylinderY = new ICylinderY(dvec3(4.0, 5.0, 0.0), 5.0, 3.0);
-ICylinderZ* cylinderZ = new ICylinderZ(dvec3(-9.0, 0.0, 0.0), 2.0, 6.0);
-ISphere* sphere = new ISphere(dvec3(12.0, 0.0, 4.0), 3.0);
-IEllipsoid* ellipsoide = new IEllipsoid(dvec3(-20.0, 10.0, -10.0), dvec3(5.0, 10.0, 5.0));
-IClosedCylinderY* closedCylinder = new IClosedCylinderY(dvec3(-5.0, 0.0, 0.0), 2.0, 5.0);
-IConeY* cone = new IConeY(dvec3(0.0, 5.0, 4.0), 1.0, 5.0);
+IPlane* plane = new IPlane(rvec3(0, -2, 0), Y_AXIS);
+ICylinderY* cylinderY = new ICylinderY(rvec3(4.0, 5.0, 0.0), 5.0, 3.0);
+ICylinderZ* cylinderZ = new ICylinderZ(rvec3(-9.0, 0.0, 0.0), 2.0, 6.0);
+ISphere* sphere = new ISphere(rvec3(12.0, 0.0, 4.0), 3.0);
+IEllipsoid* ellipsoide = new IEllipsoid(rvec3(-20.0, 10.0, -10.0), rvec3(5.0, 10.0, 5.0));
+IClosedCylinderY* closedCylinder = new IClosedCylinderY(rvec3(-5.0, 0.0, 0.0), 2.0, 5.0);
+IConeY* cone = new IConeY(rvec3(0.0, 5.0, 4.0), 1.0, 5.0);
 
 void buildScene() {
 	scene.addOpaqueObject(new VisibleIShape(plane, tin));
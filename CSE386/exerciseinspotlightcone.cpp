@@ -13,11 +13,11 @@
 #include "light.h"
 
 int main(int argc, char* argv[]) {
-	cout << inCone(dvec3(0.0, 1.0, 0.0), -Y_AXIS, PI_2, dvec3(0.00, 0, 0)) << endl;  // 1
-	cout << inCone(dvec3(0.0, 1.0, 0.0), -Y_AXIS, PI_2, dvec3(0.99, 0, 0)) << endl;  // 1
-	cout << inCone(dvec3(0.0, 1.0, 0.0), -Y_AXIS, PI_2, dvec3(1.01, 0, 0)) << endl;  // 0
+	cout << inCone(rvec3(0.0, 1.0, 0.0), -Y_AXIS, PI_2, rvec3(0.00, 0, 0)) << endl;  // 1
+	cout << inCone(rvec3(0.0, 1.0, 0.0), -Y_AXIS, PI_2, rvec3(0.99, 0, 0)) << endl;  // 1
+	cout << inCone(rvec3(0.0, 1.0, 0.0), -Y_AXIS, PI_2, rvec3(1.01, 0, 0)) << endl;  // 0
 
-	cout << inCone(dvec3(3.0, 1.0, 0.0), dvec3(-1, -1, -1), PI_2, dvec3(2, 0, 0)) << endl;  // 1
-	cout << inCone(dvec3(3.0, 1.0, 0.0), dvec3(1, -1, -1), PI_2, dvec3(2, 0, 0)) << endl;  // 0
+	cout << inCone(rvec3(3.0, 1.0, 0.0), rvec3(-1, -1, -1), PI_2, rvec3(2, 0, 0)) << endl;  // 1
+	cout << inCone(rvec3(3.0, 1.0, 0.0), rvec3(1, -1, -1), PI_2, rvec3(2, 0, 0)) << endl;  // 0
 	return 0;
 }
\ No newline at end of file
@@ -15,19 +15,19 @@
 #include "light.h"
 #include "vertexops.h"
 
-PositionalLightPtr theLight = new PositionalLight(dvec3(0, 10, 4), pureWhiteLight);
+PositionalLightPtr theLight = new PositionalLight(rvec3(0, 10, 4), pureWhiteLight);
 vector<LightSourcePtr> lights = { theLight };
 FrameBuffer frameBuffer(WINDOW_WIDTH, WINDOW_HEIGHT);
 
 PipelineMatrices pipeMats;
-dmat4& viewingMatrix = pipeMats.viewingMatrix;
-dmat4& projectionMatrix = pipeMats.projectionMatrix;
-dmat4& viewportMatrix = pipeMats.viewportMatrix;
+rmat4& viewingMatrix = pipeMats.viewingMatrix;
+rmat4& projectionMatrix = pipeMats.projectionMatrix;
+rmat4& viewportMatrix = pipeMats.viewportMatrix;
 
 EShapeData board = EShape::createECheckerBoard(copper, polishedCopper, 10, 10, 10);
-dvec4 A(-1, -1, 0, 1);
-dvec4 B(+1, -1, 0, 1);
-dvec4 C( 0, +1, 0, 1);
+rvec4 A(-1, -1, 0, 1);
+rvec4 B(+1, -1, 0, 1);
+rvec4 C( 0, +1, 0, 1);
 EShapeData tri1 = EShape::createETriangle(gold, A, B, C);
 EShapeData tri2 = EShape::createETriangle(polishedCopper, A, B, C);
 EShapeData tri3 = EShape::createETriangle(cyanPlastic, A, B, C);
@@ -36,7 +36,7 @@ EShapeData cone = EShape::createECone(pewter, 8);
 void renderObjects() {
 	// The rendering should work regardless of the order in which
 	// the objects are rendered.
-	VertexOps::render(frameBuffer, board, lights, glm::dmat4(), pipeMats, true);
+	VertexOps::render(frameBuffer, board, lights, rmat4(), pipeMats, true);
 	VertexOps::render(frameBuffer, tri1, lights, T(0,2,0)*S(5,2,1), pipeMats, true);
 	VertexOps::render(frameBuffer, tri2, lights, T(-1, 0, 0) *Ry(-PI_3)* S(10, 3, 1), pipeMats, true);
 	VertexOps::render(frameBuffer, tri3, lights, T(0,1,0)*S(8,1,1)*Ry(PI_4)*Rz(PI_2), pipeMats, true);
@@ -47,7 +47,7 @@ static void render() {
 	frameBuffer.clearColorAndDepthBuffers();
 	int width = frameBuffer.getWindowWidth();
 	int height = frameBuffer.getWindowHeight();
-	viewingMatrix = glm::lookAt(glm::dvec3(0, 5, 5), glm::dvec3(0, 0, 0), Y_AXIS);
+	viewingMatrix = glm::lookAt(rvec3(0, 5, 5), rvec3(0, 0, 0), Y_AXIS);
 	renderObjects();
 	frameBuffer.showAxes(viewingMatrix, projectionMatrix, viewportMatrix,
 						BoundingBoxi(0, width, 0, height));
@@ -56,16 +56,16 @@ static void render() {
 
 void resize(int width, int height) {
 	frameBuffer.setFrameBufferSize(width, height);
-	double AR = (double)width / height;
+	real AR = (real)width / height;
 
 	viewportMatrix = VertexOps::getViewportTransformation(0, width, 0, height);
-	projectionMatrix = glm::perspective(PI_3, AR, 0.5, 80.0);
+	projectionMatrix = glm::perspective(PI_3, AR, real(0.5), real(80.0));
 
 	glutPostRedisplay();
 }
 
 void keyboard(unsigned char key, int x, int y) {
-	const double INC = 0.5;
+	const real INC = 0.5;
 	switch (key) {
 	case 'X':
 	case 'x': theLight->pos.x += (isupper(key) ? INC : -INC);
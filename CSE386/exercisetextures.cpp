@@ -25,39 +25,40 @@
 #include <ctime> 
 
 FrameBuffer frameBuffer(WINDOW_WIDTH, WINDOW_HEIGHT);
-Image im("usflag.ppm");
+TexturePtr im = TextureCache::global().get("usflag.ppm");
 
-double angle = 0.0;
+real angle = 0.0;
 bool isAnimated = true;
 
-double cameraFOV = PI_2;
+real cameraFOV = PI_2;
 
-PerspectiveCamera camera(dvec3(10,10,10), ORIGIN3D, Y_AXIS, cameraFOV, WINDOW_WIDTH, WINDOW_HEIGHT);
+PerspectiveCamera camera(rvec3(10,10,10), ORIGIN3D, Y_AXIS, cameraFOV, WINDOW_WIDTH, WINDOW_HEIGHT);
 IScene theScene(&camera);
 
 RayTracer rayTrace(white);
 
-PositionalLightPtr posLight = new PositionalLight(dvec3(-10.0, 5.0, 15.0), pureWhiteLight);
+PositionalLightPtr posLight = new PositionalLight(rvec3(-10.0, 5.0, 15.0), pureWhiteLight);
 
 void buildScene() {
-	IShapePtr disk1 = new IDisk(dvec3(-8, 0, 3), dvec3(0, 0, 1), 3);
-	IShapePtr disk2 = new IDisk(dvec3(-10, 0, -3), dvec3(0, 0, 1), 4);
+	IShapePtr disk1 = new IDisk(rvec3(-8, 0, 3), rvec3(0, 0, 1), 3);
+	IShapePtr disk2 = new IDisk(rvec3(-10, 0, -3), rvec3(0, 0, 1), 4);
 
-	IShapePtr cylinder1 = new ICylinderY(dvec3(0, 0, 0), 3.0, 4.0);
+	IShapePtr cylinder1 = new ICylinderY(rvec3(0, 0, 0), 3.0, 4.0);
 
 	theScene.addOpaqueObject(new VisibleIShape(disk2, silver));
-	theScene.addOpaqueObject(new VisibleIShape(disk1, gold, &im));
-	theScene.addOpaqueObject(new VisibleIShape(cylinder1, redPlastic, &im));
+	theScene.addOpaqueObject(new VisibleIShape(disk1, gold, im));
+	theScene.addOpaqueObject(new VisibleIShape(cylinder1, redPlastic, im));
 
 	theScene.addLight(posLight);
+	theScene.finalize();
 }
 
 void render() {
 	int frameStartTime = glutGet(GLUT_ELAPSED_TIME);
 
-	double R = 9;
-	double rads = glm::radians(angle);
-	dvec3 cameraPos = dvec3(R*std::cos(-rads), R, R*std::sin(-rads));
+	real R = 9;
+	real rads = glm::radians(angle);
+	rvec3 cameraPos = rvec3(R*std::cos(-rads), R, R*std::sin(-rads));
 	int width = frameBuffer.getWindowWidth();
 	int height = frameBuffer.getWindowHeight();
 
@@ -65,9 +66,9 @@ void render() {
 
 	frameBuffer.setClearColor(gray);
 	frameBuffer.clearColorAndDepthBuffers();
-	rayTrace.raytraceScene(frameBuffer, 0, theScene, 1, dvec2(0, 0), dvec2(width, height));
+	rayTrace.raytraceScene(frameBuffer, 0, theScene, 1, rvec2(0, 0), rvec2(width, height));
 	int frameEndTime = glutGet(GLUT_ELAPSED_TIME);
-	double totalTimeSec = (frameEndTime - frameStartTime) / 1000.0;
+	real totalTimeSec = (frameEndTime - frameStartTime) / 1000.0;
 
 	cout << "Render time: " << totalTimeSec << " sec." << endl;
 }
@@ -13,26 +13,44 @@ FogParams FragmentOps::fogParams;
 bool FragmentOps::performDepthTest = true;
 bool FragmentOps::readonlyDepthBuffer = false;
 bool FragmentOps::readonlyColorBuffer = false;
+bool FragmentOps::performLighting = false;
+bool FragmentOps::batchFragments = true;
+bool FragmentOps::earlyDepthTest = true;
+bool FragmentOps::hierarchicalDepthTest = true;
+DepthCullStats FragmentOps::depthCullStats;
 
 /**
- * @fn	double FogParams::fogFactor(const dvec3 &fragPos, const dvec3 &eyePos) const
+ * @fn	void DepthCullStats::reset()
+ * @brief	Sets every count to zero.
+ */
+
+void DepthCullStats::reset() {
+	trianglesCulled = 0;
+	blocksCulled = 0;
+	fragmentsRejected = 0;
+	fragmentsInterpolated = 0;
+	fragmentsShaded = 0;
+}
+
+/**
+ * @fn	real FogParams::fogFactor(const rvec3 &fragPos, const rvec3 &eyePos) const
  * @brief	Computes fog factor - f.
  * @param	fragPos	The fragment position.
  * @param	eyePos 	The eye position.
  * @return	The fog factor - f.
  */
 
-double FogParams::fogFactor(const dvec3 &fragPos, const dvec3 &eyePos) const {
+real FogParams::fogFactor(const rvec3 &fragPos, const rvec3 &eyePos) const {
 	/* CSE 386 - todo  */
-	double fogFactor = 1.0;
+	real fogFactor = 1.0;
 	return fogFactor;
 }
 
 /**
  * @fn	color FragmentOps::applyLighting(const Fragment &fragment, 
- *										const dvec3 &eyePositionInWorldCoords,
+ *										const rvec3 &eyePositionInWorldCoords,
  *										const vector<LightSourcePtr> &lights,
- *										const dmat4 &viewingMatrix)
+ *										const rmat4 &viewingMatrix)
  * @brief	Applies the lighting to a fragment
  * @param	fragment					The fragment.
  * @param	eyePositionInWorldCoords	The eye position in world coordinates.
@@ -42,16 +60,19 @@ double FogParams::fogFactor(const dvec3 &fragPos, const dvec3 &eyePos) const {
  * @return	The color of the fragment after applying lighting equations.
  */
 
-color FragmentOps::applyLighting(const Fragment &fragment, const dvec3 &eyePositionInWorldCoords,
+color FragmentOps::applyLighting(const Fragment &fragment, const rvec3 &eyePositionInWorldCoords,
 										const vector<LightSourcePtr> &lights,
 										const Frame &eyeFrame) {
-	/* CSE 386 - todo  */
-	return lights[0]->illuminate(fragment.worldPos, fragment.worldNormal, fragment.material, eyeFrame, false);
-	//inShadow(lights[0], fragment.worldPos, fragment.worldNormal, ) in shadow not possible in object order rendering
+	// Shadows are not possible in object order rendering
+	color result = black;
+	for (const LightSourcePtr &light : lights) {
+		result += light->illuminate(fragment.worldPos, fragment.worldNormal, fragment.material, eyeFrame, false);
+	}
+	return result;
 }
 
 /**
- * @fn	color FragmentOps::applyFog(const color &destColor, const dvec3 &eyePos, const dvec3 &fragPos)
+ * @fn	color FragmentOps::applyFog(const color &destColor, const rvec3 &eyePos, const rvec3 &fragPos)
  * @brief	Applies fog to a fragment.
  * @param	destColor	Destination color.
  * @param	eyePos   	Eye position.
@@ -60,13 +81,13 @@ color FragmentOps::applyLighting(const Fragment &fragment, const dvec3 &eyePosit
  */
 
 color FragmentOps::applyFog(const color &destColor,
-							const dvec3 &eyePos, const dvec3 &fragPos) {
+							const rvec3 &eyePos, const rvec3 &fragPos) {
 	/* CSE 386 - todo  */
 	return destColor;
 }
 
 /**
- * @fn	color FragmentOps::applyBlending(double alpha, const color &srcColor, const color &destColor)
+ * @fn	color FragmentOps::applyBlending(real alpha, const color &srcColor, const color &destColor)
  * @brief	Applies blending to a fragment.
  * @param	alpha	 	Alpha value.
  * @param	srcColor 	Source color.
@@ -74,17 +95,17 @@ color FragmentOps::applyFog(const color &destColor,
  * @return	The blended color.
  */
 
-color FragmentOps::applyBlending(double alpha, const color &srcColor, const color &destColor) {
+color FragmentOps::applyBlending(real alpha, const color &srcColor, const color &destColor) {
 	/* CSE 386 - todo  */
 	return srcColor;
 }
 
 /**
  * @fn	void FragmentOps::processFragment(FrameBuffer &frameBuffer, 
- *											const dvec3 &eyePositionInWorldCoords,
- *											const vector<LightSourcePtr> lights, 
+ *											const rvec3 &eyePositionInWorldCoords,
+ *											const vector<LightSourcePtr> &lights, 
  *											const Fragment &fragment,
- *											const dmat4 &viewingMatrix)
+ *											const rmat4 &viewingMatrix)
  * @brief	Process the fragment, leaving the results in the framebuffer.
  * @param [in,out]	frameBuffer	                The frame buffer
  * @param 		  	eyePositionInWorldCoords	The eye position in world coordinates.
@@ -93,18 +114,18 @@ color FragmentOps::applyBlending(double alpha, const color &srcColor, const colo
  * @param           eyeFrame                    The camera's frame.
  */
 
-//void FragmentOps::processFragment(FrameBuffer& frameBuffer, const dvec3& eyePositionInWorldCoords,
-//	const vector<LightSourcePtr> lights,
+//void FragmentOps::processFragment(FrameBuffer& frameBuffer, const rvec3& eyePositionInWorldCoords,
+//	const vector<LightSourcePtr> &lights,
 //	const Fragment& fragment,
 //	const Frame& eyeFrame) {
-//	const dvec3& eyePos = eyePositionInWorldCoords;
+//	const rvec3& eyePos = eyePositionInWorldCoords;
 //
-//	double Z = fragment.windowPos.z;
+//	real Z = fragment.windowPos.z;
 //	int X = (int)fragment.windowPos.x;
 //	int Y = (int)fragment.windowPos.y;
 //	DEBUG_PIXEL = (X == xDebug && Y == yDebug);
 //
-//	double currentZ = frameBuffer.getDepth(X, Y);
+//	real currentZ = frameBuffer.getDepth(X, Y);
 //	if (Z < currentZ)
 //	{
 //		color C = applyLighting(fragment, eyePos, lights, eyeFrame);
@@ -113,20 +134,22 @@ color FragmentOps::applyBlending(double alpha, const color &srcColor, const colo
 //	}
 //}
 
-void FragmentOps::processFragment(FrameBuffer& frameBuffer, const dvec3& eyePositionInWorldCoords,
-    const vector<LightSourcePtr> lights,
+void FragmentOps::processFragment(FrameBuffer& frameBuffer, const rvec3& eyePositionInWorldCoords,
+    const vector<LightSourcePtr> &lights,
     const Fragment& fragment,
     const Frame& eyeFrame) {
-    const dvec3& eyePos = eyePositionInWorldCoords;
+    const rvec3& eyePos = eyePositionInWorldCoords;
 
-    double Z = fragment.windowPos.z;
+    real Z = fragment.windowPos.z;
     int X = (int)fragment.windowPos.x;
     int Y = (int)fragment.windowPos.y;
-    double oldZ = frameBuffer.getDepth(X, Y);
+    real oldZ = frameBuffer.getDepth(X, Y);
     bool passDepthTest = Z < oldZ;
 
     if (!performDepthTest || passDepthTest) {
-        color result = fragment.material.ambient;
+        depthCullStats.fragmentsShaded.fetch_add(1, std::memory_order_relaxed);
+        color result = performLighting ? applyLighting(fragment, eyePos, lights, eyeFrame)
+                                       : fragment.material.ambient;
         if (!readonlyColorBuffer) {
             frameBuffer.setColor(X, Y, result);
         }
@@ -134,4 +157,248 @@ void FragmentOps::processFragment(FrameBuffer& frameBuffer, const dvec3& eyePosi
             frameBuffer.setDepth(X, Y, Z);
         }
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @fn	Fragment FragmentBatch::getFragment(int i) const
+ * @brief	Gathers one fragment of the batch.
+ * @param	i	Index of the fragment.
+ * @return	The i'th fragment.
+ */
+
+Fragment FragmentBatch::getFragment(int i) const {
+	Fragment fragment;
+	fragment.windowPos = rvec3(x[i], y[i], depth[i]);
+	fragment.worldNormal = rvec3(worldNormal[0][i], worldNormal[1][i], worldNormal[2][i]);
+	fragment.worldPos = rvec3(worldPos[0][i], worldPos[1][i], worldPos[2][i]);
+	fragment.material.ambient = color(ambient[0][i], ambient[1][i], ambient[2][i]);
+	fragment.material.diffuse = color(diffuse[0][i], diffuse[1][i], diffuse[2][i]);
+	fragment.material.specular = color(specular[0][i], specular[1][i], specular[2][i]);
+	fragment.material.shininess = shininess[i];
+	fragment.material.alpha = alpha[i];
+	return fragment;
+}
+
+/**
+ * @fn	void FragmentBatch::keep(const int which[], int numToKeep)
+ * @brief	Compacts the batch down to the given fragments, preserving their order.
+ * @param	which	 	Increasing indices of the fragments to keep.
+ * @param	numToKeep	Number of fragments to keep.
+ */
+
+void FragmentBatch::keep(const int which[], int numToKeep) {
+	for (int k = 0; k < numToKeep; k++) {
+		int i = which[k];
+		if (i == k) {
+			continue;
+		}
+		x[k] = x[i];
+		y[k] = y[i];
+		depth[k] = depth[i];
+		for (int c = 0; c < 3; c++) {
+			worldNormal[c][k] = worldNormal[c][i];
+			worldPos[c][k] = worldPos[c][i];
+			ambient[c][k] = ambient[c][i];
+			diffuse[c][k] = diffuse[c][i];
+			specular[c][k] = specular[c][i];
+		}
+		shininess[k] = shininess[i];
+		alpha[k] = alpha[i];
+	}
+	count = numToKeep;
+}
+
+/**
+ * @fn	void FragmentOps::applyLighting(const FragmentBatch &batch,
+ *										const vector<LightSourcePtr> &lights,
+ *										const Frame &eyeFrame,
+ *										real rgb[3][FRAGMENT_BATCH_SIZE])
+ * @brief	Applies the lighting to a batch of fragments. Positional lights and spot lights
+ * 			evaluate the same equations as totalColor, one light at a time across the whole
+ * 			batch. Any other kind of light falls back to its illuminate method.
+ * @param 	   	batch   	The fragments.
+ * @param 	   	lights  	The vector of lights in the scene.
+ * @param 	   	eyeFrame	The camera's frame.
+ * @param [out]	rgb			The unclamped colors of the fragments, by channel.
+ */
+
+void FragmentOps::applyLighting(const FragmentBatch &batch,
+								const vector<LightSourcePtr> &lights,
+								const Frame &eyeFrame,
+								real rgb[3][FRAGMENT_BATCH_SIZE]) {
+	const int N = batch.count;
+	const real *px = batch.worldPos[0], *py = batch.worldPos[1], *pz = batch.worldPos[2];
+	const real *nx = batch.worldNormal[0], *ny = batch.worldNormal[1], *nz = batch.worldNormal[2];
+
+	// Unit vectors toward the eye
+	real vx[FRAGMENT_BATCH_SIZE], vy[FRAGMENT_BATCH_SIZE], vz[FRAGMENT_BATCH_SIZE];
+	for (int i = 0; i < N; i++) {
+		vx[i] = eyeFrame.origin.x - px[i];
+		vy[i] = eyeFrame.origin.y - py[i];
+		vz[i] = eyeFrame.origin.z - pz[i];
+		real invLength = real(1.0) / std::sqrt(vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i]);
+		vx[i] *= invLength;
+		vy[i] *= invLength;
+		vz[i] *= invLength;
+	}
+	for (int c = 0; c < 3; c++) {
+		for (int i = 0; i < N; i++) {
+			rgb[c][i] = 0.0;
+		}
+	}
+
+	for (const LightSourcePtr &lightSource : lights) {
+		const PositionalLight *light = dynamic_cast<const PositionalLight *>(lightSource);
+		if (light == nullptr) {
+			for (int i = 0; i < N; i++) {
+				Fragment fragment = batch.getFragment(i);
+				color C = lightSource->illuminate(fragment.worldPos, fragment.worldNormal,
+													fragment.material, eyeFrame, false);
+				for (int c = 0; c < 3; c++) {
+					rgb[c][i] += C[c];
+				}
+			}
+			continue;
+		}
+		if (!light->isOn) {
+			continue;
+		}
+
+		const rvec3 lightPos = light->actualPosition(eyeFrame);
+		const LightATParams &at = light->atParams;
+		const bool attenuationOn = light->attenuationIsTurnedOn;
+		const SpotLight *spot = dynamic_cast<const SpotLight *>(light);
+		const rvec3 spotDir = spot != nullptr ? glm::normalize(spot->spotDir) : rvec3(0, 0, 0);
+		const real cosHalfFOV = spot != nullptr ? std::cos(spot->fov / 2) : real(0.0);
+
+		real diffuseFactor[FRAGMENT_BATCH_SIZE], specularFactor[FRAGMENT_BATCH_SIZE];
+		real lightFactor[FRAGMENT_BATCH_SIZE], visible[FRAGMENT_BATCH_SIZE];
+		for (int i = 0; i < N; i++) {
+			real lx = lightPos.x - px[i], ly = lightPos.y - py[i], lz = lightPos.z - pz[i];
+			real distance = std::sqrt(lx * lx + ly * ly + lz * lz);
+			real invDistance = real(1.0) / distance;
+			lx *= invDistance;
+			ly *= invDistance;
+			lz *= invDistance;
+
+			real nDotL = lx * nx[i] + ly * ny[i] + lz * nz[i];
+			real rx = 2 * nDotL * nx[i] - lx;
+			real ry = 2 * nDotL * ny[i] - ly;
+			real rz = 2 * nDotL * nz[i] - lz;
+			real vDotR = glm::clamp(vx[i] * rx + vy[i] * ry + vz[i] * rz, real(0.0), real(1.0));
+
+			diffuseFactor[i] = glm::max(real(0.0), nDotL);
+			specularFactor[i] = std::pow(vDotR, batch.shininess[i]);
+			lightFactor[i] = attenuationOn ? at.factor(distance) : real(1.0);
+			visible[i] = (spot == nullptr ||
+							-(spotDir.x * lx + spotDir.y * ly + spotDir.z * lz) > cosHalfFOV) ? real(1.0) : real(0.0);
+		}
+
+		for (int c = 0; c < 3; c++) {
+			const real la = light->lightColor.ambient[c];
+			const real ld = light->lightColor.diffuse[c];
+			const real ls = light->lightColor.specular[c];
+			for (int i = 0; i < N; i++) {
+				real amb = glm::clamp(batch.ambient[c][i] * la, real(0.0), real(1.0));
+				real diff = glm::clamp(batch.diffuse[c][i] * ld * diffuseFactor[i], real(0.0), real(1.0));
+				real spec = glm::clamp(batch.specular[c][i] * ls * specularFactor[i], real(0.0), real(1.0));
+				real total = glm::clamp(amb + lightFactor[i] * (diff + spec), real(0.0), real(1.0));
+				rgb[c][i] += visible[i] * total;
+			}
+		}
+	}
+}
+
+/**
+ * @fn	void FragmentOps::processFragments(FrameBuffer &frameBuffer,
+ *											const rvec3 &eyePositionInWorldCoords,
+ *											const vector<LightSourcePtr> &lights,
+ *											FragmentBatch &batch,
+ *											const Frame &eyeFrame)
+ * @brief	Process a batch of fragments, such as those the rasterizer produces for one
+ * 			block of a triangle, leaving the results in the framebuffer. Gives the same
+ * 			results as calling processFragment on each fragment, which is what happens
+ * 			when batchFragments is false.
+ * @param [in,out]	frameBuffer	                The frame buffer
+ * @param 		  	eyePositionInWorldCoords	The eye position in world coordinates.
+ * @param 		  	lights						Vector of lights in scene.
+ * @param [in,out]	batch						Fragments to be processed. Fragments failing
+ * 												the depth test are removed.
+ * @param           eyeFrame                    The camera's frame.
+ */
+
+void FragmentOps::processFragments(FrameBuffer &frameBuffer, const rvec3 &eyePositionInWorldCoords,
+									const vector<LightSourcePtr> &lights,
+									FragmentBatch &batch,
+									const Frame &eyeFrame) {
+	if (!batchFragments) {
+		for (int i = 0; i < batch.count; i++) {
+			processFragment(frameBuffer, eyePositionInWorldCoords, lights, batch.getFragment(i), eyeFrame);
+		}
+		return;
+	}
+
+	int pixel[FRAGMENT_BATCH_SIZE];
+	for (int i = 0; i < batch.count; i++) {
+		pixel[i] = frameBuffer.pixelIndex(batch.x[i], batch.y[i]);
+	}
+
+	if (performDepthTest && !batch.depthTested) {
+		int passed[FRAGMENT_BATCH_SIZE];
+		int numPassed = 0;
+		for (int i = 0; i < batch.count; i++) {
+			passed[numPassed] = i;
+			numPassed += batch.depth[i] < frameBuffer.getDepthAt(pixel[i]) ? 1 : 0;
+		}
+		if (numPassed < batch.count) {
+			for (int k = 0; k < numPassed; k++) {
+				pixel[k] = pixel[passed[k]];
+			}
+			batch.keep(passed, numPassed);
+		}
+	}
+	const int N = batch.count;
+	depthCullStats.fragmentsShaded.fetch_add(N, std::memory_order_relaxed);
+
+	if (!readonlyColorBuffer) {
+		real rgb[3][FRAGMENT_BATCH_SIZE];
+		if (performLighting) {
+			applyLighting(batch, lights, eyeFrame, rgb);
+		} else {
+			for (int c = 0; c < 3; c++) {
+				for (int i = 0; i < N; i++) {
+					rgb[c][i] = batch.ambient[c][i];
+				}
+			}
+		}
+
+		for (int c = 0; c < 3; c++) {
+			for (int i = 0; i < N; i++) {
+				rgb[c][i] = glm::clamp(rgb[c][i], real(0.0), real(1.0));
+			}
+		}
+		if (frameBuffer.getFormat().color == ColorFormat::RGBA_FLOAT) {
+			for (int i = 0; i < N; i++) {
+				frameBuffer.setColorAt(pixel[i], rgb[0][i], rgb[1][i], rgb[2][i]);
+			}
+		} else {
+			GLubyte bytes[FRAGMENT_BATCH_SIZE][BYTES_PER_PIXEL];
+			for (int c = 0; c < 3; c++) {
+				for (int i = 0; i < N; i++) {
+					bytes[i][c] = (GLubyte)(rgb[c][i] * 255);
+				}
+			}
+			for (int i = 0; i < N; i++) {
+				frameBuffer.setColorAt(pixel[i], bytes[i]);
+			}
+		}
+	}
+	if (!readonlyDepthBuffer) {
+		for (int i = 0; i < N; i++) {
+			frameBuffer.setDepthAt(pixel[i], batch.depth[i]);
+		}
+		for (int i = 0; i < N; i++) {
+			frameBuffer.depthChangedAt(batch.x[i], batch.y[i]);
+		}
+	}
+}
@@ -8,6 +8,7 @@
  ****************************************************/
 
 #pragma once
+#include <atomic>
 #include "framebuffer.h"
 #include "light.h"
 
@@ -24,16 +25,16 @@ enum class FogType { NO_FOG, LINEAR_FOG, EXPONENTIAL_FOG, EXPONENTIAL_2_FOG };
  */
 
 struct FogParams {
-	double start, end, density;
+	real start, end, density;
 	FogType type;
-	color color;
+	::color color;
 	FogParams() {
 		start = 0.0;
 		end = 1.0;
 		density = 1.0;
 		type = FogType::NO_FOG;
 	}
-	double fogFactor(const dvec3 &fragPos, const dvec3 &eyePos) const;
+	real fogFactor(const rvec3 &fragPos, const rvec3 &eyePos) const;
 };
 
 /**
@@ -43,10 +44,53 @@ struct FogParams {
  */
 
 struct Fragment {
-	dvec3 windowPos;	//!< (x, y) is window coordinate. z is depth.
+	rvec3 windowPos;	//!< (x, y) is window coordinate. z is depth.
 	Material material;	//!< Material to use
-	dvec3 worldNormal;	//!< Transformed normal vector from early in pipeline
-	dvec3 worldPos;		//!< Saved position from early in the pipeline
+	rvec3 worldNormal;	//!< Transformed normal vector from early in pipeline
+	rvec3 worldPos;		//!< Saved position from early in the pipeline
+};
+
+const int FRAGMENT_BATCH_SIZE = 64;		//!< Maximum number of fragments in a FragmentBatch.
+
+/**
+ * @struct	FragmentBatch
+ * @brief	A batch of fragments in structure-of-arrays form. Each stage of fragment
+ * 			processing is then a loop over contiguous arrays, which the compiler can
+ * 			vectorize. Every fragment must lie inside the window, and no two fragments
+ * 			in a batch may share a pixel.
+ */
+
+struct FragmentBatch {
+	int count;									//!< Number of fragments in the batch.
+	int x[FRAGMENT_BATCH_SIZE];					//!< Window x coordinates.
+	int y[FRAGMENT_BATCH_SIZE];					//!< Window y coordinates.
+	real depth[FRAGMENT_BATCH_SIZE];			//!< Window depths.
+	real worldNormal[3][FRAGMENT_BATCH_SIZE];	//!< x, y and z of the transformed normals.
+	real worldPos[3][FRAGMENT_BATCH_SIZE];		//!< x, y and z of the saved world positions.
+	real ambient[3][FRAGMENT_BATCH_SIZE];		//!< r, g and b of the ambient material property.
+	real diffuse[3][FRAGMENT_BATCH_SIZE];		//!< r, g and b of the diffuse material property.
+	real specular[3][FRAGMENT_BATCH_SIZE];		//!< r, g and b of the specular material property.
+	real shininess[FRAGMENT_BATCH_SIZE];		//!< Shininess material property.
+	real alpha[FRAGMENT_BATCH_SIZE];			//!< Alpha material property.
+	bool depthTested;							//!< True ==> every fragment has already passed the depth test.
+	FragmentBatch() : count(0), depthTested(false) {}
+	Fragment getFragment(int i) const;
+	void keep(const int which[], int numToKeep);
+};
+
+/**
+ * @struct	DepthCullStats
+ * @brief	Counts of the work the depth test saved, to measure overdraw. Safe to update
+ * 			from several threads.
+ */
+
+struct DepthCullStats {
+	std::atomic<long long> trianglesCulled;			//!< Triangles the coarse depth buffer showed to be hidden.
+	std::atomic<long long> blocksCulled;			//!< Raster blocks the coarse depth buffer showed to be hidden.
+	std::atomic<long long> fragmentsRejected;		//!< Fragments failing the early depth test, never interpolated.
+	std::atomic<long long> fragmentsInterpolated;	//!< Fragments whose attributes were interpolated.
+	std::atomic<long long> fragmentsShaded;			//!< Fragments passing the depth test, which are then shaded.
+	void reset();
 };
 
 /**
@@ -59,17 +103,30 @@ class FragmentOps {
 		static bool performDepthTest;		//!< True ==> use depth buffer. Typically true
 		static bool readonlyDepthBuffer;	//!< True ==> rendering will not affect depth buffer. Typically false
 		static bool readonlyColorBuffer;	//!< True ==> rendering will not affect color buffer. Typically false
+		static bool performLighting;		//!< True ==> Phong lighting from every light. False ==> ambient material only. Typically false
+		static bool batchFragments;			//!< True ==> batches take the vectorized path. False ==> one fragment at a time, for debugging. Typically true
+		static bool earlyDepthTest;			//!< True ==> the rasterizer tests depth before interpolating the other attributes. Typically true
+		static bool hierarchicalDepthTest;	//!< True ==> the rasterizer skips triangles and blocks that the coarse depth buffer shows are hidden. Typically true
+		static DepthCullStats depthCullStats;	//!< Work saved by the depth tests.
 		static FogParams fogParams;			//!< Parameters controlling fog effects.
-		static void processFragment(FrameBuffer &frameBuffer, const dvec3 &eyePositionInWorldCoords,
-									const vector<LightSourcePtr> lights, 
+		static void processFragment(FrameBuffer &frameBuffer, const rvec3 &eyePositionInWorldCoords,
+									const vector<LightSourcePtr> &lights, 
 									const Fragment &fragment,
 									const Frame &eyeFrame);
+		static void processFragments(FrameBuffer &frameBuffer, const rvec3 &eyePositionInWorldCoords,
+									const vector<LightSourcePtr> &lights,
+									FragmentBatch &batch,
+									const Frame &eyeFrame);
 	protected:
 		static color applyFog(const color &destColor,
-											const dvec3 &eyePos, const dvec3 &fragPos);
-		static color applyBlending(double alpha, const color &src, const color &dest);
+											const rvec3 &eyePos, const rvec3 &fragPos);
+		static color applyBlending(real alpha, const color &src, const color &dest);
 		static color applyLighting(const Fragment &fragment, 
-									const dvec3 &eyePositionInWorldCoords,
+									const rvec3 &eyePositionInWorldCoords,
 									const vector<LightSourcePtr> &lights,
 									const Frame &eyeFrame);
+		static void applyLighting(const FragmentBatch &batch,
+									const vector<LightSourcePtr> &lights,
+									const Frame &eyeFrame,
+									real rgb[3][FRAGMENT_BATCH_SIZE]);
 };
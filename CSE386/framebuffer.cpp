@@ -7,18 +7,25 @@
  * permission is granted.
  ****************************************************/
 
+#include <fstream>
 #include "defs.h"
 #include "utilities.h"
 #include "framebuffer.h"
 
+const unsigned int FrameBuffer::DEPTH24_MAX;
+
 /**
- * @fn	FrameBuffer::FrameBuffer(const int width, const int height)
+ * @fn	FrameBuffer::FrameBuffer(const int width, const int height, const FrameBufferFormat &format)
  * @brief	Constructor
  * @param	width 	The width.
  * @param	height	The height.
+ * @param	format	The storage format.
  */
 
-FrameBuffer::FrameBuffer(const int width, const int height) {
+FrameBuffer::FrameBuffer(const int width, const int height, const FrameBufferFormat &format)
+	: format(format), colorBuffer(nullptr), floatColorBuffer(nullptr), depthBuffer(nullptr),
+		floatDepthBuffer(nullptr), depth24Buffer(nullptr), hiZ(nullptr), hiZDirty(nullptr),
+		rowStart(nullptr), columnOffset(nullptr) {
 	setFrameBufferSize(width, height);
 }
 
@@ -29,7 +36,14 @@ FrameBuffer::FrameBuffer(const int width, const int height) {
 
 FrameBuffer::~FrameBuffer() {
 	delete[] colorBuffer;
+	delete[] floatColorBuffer;
 	delete[] depthBuffer;
+	delete[] floatDepthBuffer;
+	delete[] depth24Buffer;
+	delete[] hiZ;
+	delete[] hiZDirty;
+	delete[] rowStart;
+	delete[] columnOffset;
 }
 
 /**
@@ -44,11 +58,74 @@ void FrameBuffer::setFrameBufferSize(int width, int height) {
     //MAZwindow = Window(width, height);
 	this->width = width;
 	this->height = height;
-	int area = width * height;
+	const int T = FRAMEBUFFER_TILE_SIZE;
+	tilesAcross = (width + T - 1) / T;
+	tilesUp = (height + T - 1) / T;
+	if (format.layout == PixelLayout::TILED) {
+		numPixels = tilesAcross * tilesUp * T * T;
+	} else {
+		numPixels = width * height;
+	}
+	bytesPerPixel = format.color == ColorFormat::RGBA8 ? 4 : BYTES_PER_PIXEL;
+
 	delete [] colorBuffer;
+	delete [] floatColorBuffer;
 	delete [] depthBuffer;
-	colorBuffer = new GLubyte[area * BYTES_PER_PIXEL];
-	depthBuffer = new double[area];
+	delete [] floatDepthBuffer;
+	delete [] depth24Buffer;
+	delete [] hiZ;
+	delete [] hiZDirty;
+	delete [] rowStart;
+	delete [] columnOffset;
+	colorBuffer = nullptr;
+	floatColorBuffer = nullptr;
+	depthBuffer = nullptr;
+	floatDepthBuffer = nullptr;
+	depth24Buffer = nullptr;
+
+	if (format.color == ColorFormat::RGBA_FLOAT) {
+		floatColorBuffer = new float[numPixels * 4];
+	} else {
+		colorBuffer = new GLubyte[numPixels * bytesPerPixel];
+	}
+	switch (format.depth) {
+	case DepthFormat::FLOAT32:	floatDepthBuffer = new float[numPixels]; break;
+	case DepthFormat::UNORM24:	depth24Buffer = new unsigned int[numPixels]; break;
+	default:					depthBuffer = new real[numPixels]; break;
+	}
+	hiZ = new real[tilesAcross * tilesUp];
+	hiZDirty = new unsigned char[tilesAcross * tilesUp];
+	std::fill(hiZDirty, hiZDirty + tilesAcross * tilesUp, 1);
+
+	// A tiled index is the tile's first pixel plus the Morton code of (u, v) within it.
+	// The code interleaves the bits of u and v, so it is the sum of u's bits spread to
+	// the even positions and v's bits spread to the odd ones.
+	rowStart = new int[height];
+	columnOffset = new int[width];
+	for (int y = 0; y < height; y++) {
+		int v = y % T;
+		rowStart[y] = format.layout == PixelLayout::TILED ?
+						(y / T) * tilesAcross * T * T + (((v & 1) << 1) | ((v & 2) << 2) | ((v & 4) << 3)) :
+						y * width;
+	}
+	for (int x = 0; x < width; x++) {
+		int u = x % T;
+		columnOffset[x] = format.layout == PixelLayout::TILED ?
+							(x / T) * T * T + ((u & 1) | ((u & 2) << 1) | ((u & 4) << 2)) :
+							x;
+	}
+}
+
+/**
+ * @fn	size_t FrameBuffer::getMemorySize() const
+ * @brief	Gets the number of bytes taken by the color and depth buffers.
+ * @return	The size of the buffers.
+ */
+
+size_t FrameBuffer::getMemorySize() const {
+	size_t colorBytes = format.color == ColorFormat::RGBA_FLOAT ? 4 * sizeof(float) : bytesPerPixel;
+	size_t depthBytes = format.depth == DepthFormat::REAL ? sizeof(real) : 4;
+	return numPixels * (colorBytes + depthBytes);
 }
 
 /**
@@ -64,32 +141,298 @@ void FrameBuffer::setClearColor(const color &clear) {
 	clearColor = color(clearColorUB[0], clearColorUB[1], clearColorUB[2]);
 }
 
+/**
+ * @fn	static void fillPattern(void *dest, int count, const void *pattern, size_t patternSize)
+ * @brief	Fills an array with copies of a pattern. After the first copy, each memcpy
+ * 			doubles the filled part, so the work is done in a few large vectorized copies
+ * 			rather than one small copy per pixel.
+ * @param [out]	dest	   	The array.
+ * @param 	   	count	   	Number of copies.
+ * @param 	   	pattern	   	The pattern.
+ * @param 	   	patternSize	Size of the pattern, in bytes.
+ */
+
+static void fillPattern(void *dest, int count, const void *pattern, size_t patternSize) {
+	if (count <= 0) {
+		return;
+	}
+	unsigned char *bytes = (unsigned char *)dest;
+	const size_t total = count * patternSize;
+	std::memcpy(bytes, pattern, patternSize);
+	for (size_t filled = patternSize; filled < total; filled *= 2) {
+		std::memcpy(bytes + filled, bytes, glm::min(filled, total - filled));
+	}
+}
+
 /**
  * @fn	void FrameBuffer::clearColorAndDepthBuffers()
  * @brief	Clears the color and depth buffers
  */
 
 void FrameBuffer::clearColorAndDepthBuffers() {
-	for (int y = 0; y < height; ++y) {
-		for (int x = 0; x < width; ++x) {
-			std::memcpy(colorBuffer + BYTES_PER_PIXEL * (x + y * width),
-				clearColorUB, BYTES_PER_PIXEL);
+	if (format.color == ColorFormat::RGBA_FLOAT) {
+		const float rgba[4] = { clearColorUB[0] / 255.0f, clearColorUB[1] / 255.0f, clearColorUB[2] / 255.0f, 1.0f };
+		fillPattern(floatColorBuffer, numPixels, rgba, sizeof(rgba));
+	} else {
+		const GLubyte rgba[4] = { clearColorUB[0], clearColorUB[1], clearColorUB[2], 255 };
+		fillPattern(colorBuffer, numPixels, rgba, bytesPerPixel);
+	}
+	const float floatFarthest = 1.0f;
+	const unsigned int depth24Farthest = DEPTH24_MAX;
+	const real farthest = 1.0;
+	switch (format.depth) {
+	case DepthFormat::FLOAT32:	fillPattern(floatDepthBuffer, numPixels, &floatFarthest, sizeof(float)); break;
+	case DepthFormat::UNORM24:	fillPattern(depth24Buffer, numPixels, &depth24Farthest, sizeof(unsigned int)); break;
+	default:					fillPattern(depthBuffer, numPixels, &farthest, sizeof(real)); break;
+	}
+	if (numPixels > 0) {
+		std::fill(hiZ, hiZ + tilesAcross * tilesUp, getDepthAt(0));
+		std::fill(hiZDirty, hiZDirty + tilesAcross * tilesUp, 0);
+	}
+}
+
+/**
+ * @fn	real FrameBuffer::getTileMaxDepth(int tile) const
+ * @brief	Gets the farthest depth in a FRAMEBUFFER_TILE_SIZE square tile, recomputing it if
+ * 			the tile's depths have changed since it was last computed.
+ * @param	tile	The tile, numbered row by row from the bottom left.
+ * @return	The farthest depth in the tile.
+ */
+
+real FrameBuffer::getTileMaxDepth(int tile) const {
+	if (hiZDirty[tile]) {
+		const int T = FRAMEBUFFER_TILE_SIZE;
+		int x0 = (tile % tilesAcross) * T, y0 = (tile / tilesAcross) * T;
+		int x1 = std::min(x0 + T, width), y1 = std::min(y0 + T, height);
+		real farthest = getDepthAt(pixelIndex(x0, y0));
+		for (int y = y0; y < y1; y++) {
+			for (int x = x0; x < x1; x++) {
+				farthest = std::max(farthest, getDepthAt(pixelIndex(x, y)));
+			}
+		}
+		hiZ[tile] = farthest;
+		hiZDirty[tile] = 0;
+	}
+	return hiZ[tile];
+}
+
+/**
+ * @fn	bool FrameBuffer::isOccluded(int xMin, int yMin, int xMax, int yMax, real depth) const
+ * @brief	Conservatively determines if nothing at a depth, or farther, could pass the
+ * 			depth test anywhere in a rectangle, using the farthest depth of each tile the
+ * 			rectangle touches. Tiles are recomputed lazily, so concurrent callers must work
+ * 			on rectangles that share no tile.
+ * @param	xMin 	The left edge of the rectangle.
+ * @param	yMin 	The bottom edge of the rectangle.
+ * @param	xMax 	The right edge of the rectangle, inclusive.
+ * @param	yMax 	The top edge of the rectangle, inclusive.
+ * @param	depth	The nearest depth that would be drawn in the rectangle.
+ * @return	True if every pixel of the rectangle already holds a depth no farther than depth.
+ */
+
+bool FrameBuffer::isOccluded(int xMin, int yMin, int xMax, int yMax, real depth) const {
+	const int T = FRAMEBUFFER_TILE_SIZE;
+	for (int ty = yMin / T; ty <= yMax / T; ty++) {
+		for (int tx = xMin / T; tx <= xMax / T; tx++) {
+			if (depth < getTileMaxDepth(ty * tilesAcross + tx)) {
+				return false;
+			}
 		}
 	}
-	int area = width * height;
-	const int SZ = area;
-	std::fill(depthBuffer, depthBuffer + SZ, 1.0);
+	return true;
 }
 
 /**
  * @fn	void FrameBuffer::showColorBuffer() const
- * @brief	Shows the contents of the color buffer to screen.
+ * @brief	Shows the contents of the color buffer to screen. Does nothing in
+ * 			headless (CONSOLE_ONLY) builds.
  */
 
 void FrameBuffer::showColorBuffer() const {
+#ifndef CONSOLE_ONLY
+	static vector<GLubyte> rgb;
 	glRasterPos2d(-1, -1);
-	glDrawPixels(width, height, GL_RGB, GL_UNSIGNED_BYTE, colorBuffer);
+	glDrawPixels(width, height, GL_RGB, GL_UNSIGNED_BYTE, getRGBRows(rgb));
 	glFlush();
+#endif
+}
+
+/**
+ * @fn	const GLubyte *FrameBuffer::getRGBRows(vector<GLubyte> &scratch) const
+ * @brief	Gets the color buffer as RGB8 rows, starting with the bottom of the window. In
+ * 			the default format that is the color buffer itself; otherwise the colors are
+ * 			resolved into scratch.
+ * @param [in,out]	scratch	Storage for resolved colors.
+ * @return	The rows.
+ */
+
+const GLubyte *FrameBuffer::getRGBRows(vector<GLubyte> &scratch) const {
+	if (format.color == ColorFormat::RGB8 && format.layout == PixelLayout::LINEAR) {
+		return colorBuffer;
+	}
+	scratch.resize((size_t)BYTES_PER_PIXEL * width * height);
+	GLubyte *dest = scratch.data();
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++, dest += BYTES_PER_PIXEL) {
+			int index = pixelIndex(x, y);
+			if (format.color == ColorFormat::RGBA_FLOAT) {
+				const float *src = floatColorBuffer + 4 * index;
+				for (int c = 0; c < BYTES_PER_PIXEL; c++) {
+					dest[c] = (GLubyte)(glm::clamp(src[c], 0.0f, 1.0f) * 255);
+				}
+			} else {
+				const GLubyte *src = colorBuffer + bytesPerPixel * index;
+				dest[0] = src[0];
+				dest[1] = src[1];
+				dest[2] = src[2];
+			}
+		}
+	}
+	return scratch.data();
+}
+
+/**
+ * @fn	bool FrameBuffer::writePPM(const std::string &fileName) const
+ * @brief	Writes the color buffer to a binary (P6) PPM file.
+ * @param	fileName	Name of the file to create.
+ * @return	True iff the file was written.
+ */
+
+bool FrameBuffer::writePPM(const std::string &fileName) const {
+	std::ofstream out(fileName, std::ios::binary);
+	if (!out) {
+		return false;
+	}
+	vector<GLubyte> scratch;
+	const GLubyte *rows = getRGBRows(scratch);
+	out << "P6\n" << width << " " << height << "\n255\n";
+	// Row 0 of the color buffer is the bottom of the window; files start at the top.
+	for (int y = height - 1; y >= 0; y--) {
+		out.write((const char *)(rows + BYTES_PER_PIXEL * y * width), BYTES_PER_PIXEL * width);
+	}
+	return (bool)out;
+}
+
+/**
+ * @fn	static unsigned int crc32(unsigned int crc, const unsigned char *data, size_t length)
+ * @brief	Updates a PNG chunk CRC with more bytes.
+ * @param	crc   	The CRC so far. Start with 0.
+ * @param	data  	The bytes.
+ * @param	length	Number of bytes.
+ * @return	The updated CRC.
+ */
+
+static unsigned int crc32(unsigned int crc, const unsigned char *data, size_t length) {
+	static const struct Table {
+		unsigned int values[256];
+		Table() {
+			for (unsigned int n = 0; n < 256; n++) {
+				unsigned int c = n;
+				for (int k = 0; k < 8; k++) {
+					c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+				}
+				values[n] = c;
+			}
+		}
+	} table;
+	crc = ~crc;
+	for (size_t i = 0; i < length; i++) {
+		crc = table.values[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+/**
+ * @fn	static void writePNGChunk(std::ofstream &out, const char *type, const vector<unsigned char> &data)
+ * @brief	Writes one PNG chunk: length, type, data and CRC.
+ * @param [in,out]	out 	The file.
+ * @param 		  	type	The four character chunk type.
+ * @param 		  	data	The chunk's data.
+ */
+
+static void writePNGChunk(std::ofstream &out, const char *type, const vector<unsigned char> &data) {
+	unsigned int length = (unsigned int)data.size();
+	unsigned char header[8] = { (unsigned char)(length >> 24), (unsigned char)(length >> 16),
+								(unsigned char)(length >> 8), (unsigned char)length,
+								(unsigned char)type[0], (unsigned char)type[1],
+								(unsigned char)type[2], (unsigned char)type[3] };
+	unsigned int crc = crc32(0, header + 4, 4);
+	if (length > 0) {
+		crc = crc32(crc, data.data(), length);
+	}
+	unsigned char trailer[4] = { (unsigned char)(crc >> 24), (unsigned char)(crc >> 16),
+								(unsigned char)(crc >> 8), (unsigned char)crc };
+	out.write((const char *)header, 8);
+	out.write((const char *)data.data(), length);
+	out.write((const char *)trailer, 4);
+}
+
+/**
+ * @fn	bool FrameBuffer::writePNG(const std::string &fileName) const
+ * @brief	Writes the color buffer to an RGB PNG file. The image data is stored
+ * 			uncompressed (deflate "stored" blocks), so no compression library is
+ * 			needed. The files are about as big as a PPM.
+ * @param	fileName	Name of the file to create.
+ * @return	True iff the file was written.
+ */
+
+bool FrameBuffer::writePNG(const std::string &fileName) const {
+	std::ofstream out(fileName, std::ios::binary);
+	if (!out) {
+		return false;
+	}
+
+	// Each scanline starts with filter type 0 (none). Rows go top to bottom.
+	const size_t rowBytes = BYTES_PER_PIXEL * width;
+	vector<GLubyte> scratch;
+	const GLubyte *rows = getRGBRows(scratch);
+	vector<unsigned char> raw;
+	raw.reserve((rowBytes + 1) * height);
+	for (int y = height - 1; y >= 0; y--) {
+		const GLubyte *row = rows + BYTES_PER_PIXEL * y * width;
+		raw.push_back(0);
+		raw.insert(raw.end(), row, row + rowBytes);
+	}
+
+	// zlib stream made of stored blocks of at most 65535 bytes, then the Adler-32.
+	vector<unsigned char> idat = { 0x78, 0x01 };
+	const size_t MAX_BLOCK = 65535;
+	size_t pos = 0;
+	do {
+		size_t length = glm::min(MAX_BLOCK, raw.size() - pos);
+		bool isLast = pos + length == raw.size();
+		idat.push_back(isLast ? 1 : 0);
+		idat.push_back((unsigned char)length);
+		idat.push_back((unsigned char)(length >> 8));
+		idat.push_back((unsigned char)~length);
+		idat.push_back((unsigned char)(~length >> 8));
+		idat.insert(idat.end(), raw.begin() + pos, raw.begin() + pos + length);
+		pos += length;
+	} while (pos < raw.size());
+
+	unsigned int a = 1, b = 0;
+	for (size_t i = 0; i < raw.size(); i++) {
+		a = (a + raw[i]) % 65521;
+		b = (b + a) % 65521;
+	}
+	unsigned int adler = (b << 16) | a;
+	idat.push_back((unsigned char)(adler >> 24));
+	idat.push_back((unsigned char)(adler >> 16));
+	idat.push_back((unsigned char)(adler >> 8));
+	idat.push_back((unsigned char)adler);
+
+	vector<unsigned char> ihdr = { (unsigned char)(width >> 24), (unsigned char)(width >> 16),
+									(unsigned char)(width >> 8), (unsigned char)width,
+									(unsigned char)(height >> 24), (unsigned char)(height >> 16),
+									(unsigned char)(height >> 8), (unsigned char)height,
+									8, 2, 0, 0, 0 };		// 8 bits, RGB, deflate, no filter, no interlace
+
+	const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	out.write((const char *)signature, 8);
+	writePNGChunk(out, "IHDR", ihdr);
+	writePNGChunk(out, "IDAT", idat);
+	writePNGChunk(out, "IEND", vector<unsigned char>());
+	return (bool)out;
 }
 
 /**
@@ -105,13 +448,31 @@ void FrameBuffer::setColor(int x, int y, const color &rgb) {
 		return;
 	}
 
-	color clampedColor = glm::clamp(rgb, 0.0, 1.0);
+	color clampedColor = glm::clamp(rgb, real(0.0), real(1.0));
+	setColorAt(pixelIndex(x, y), clampedColor.r, clampedColor.g, clampedColor.b);
+}
 
-	GLubyte c[] = { (GLubyte)(clampedColor.r * 255),
-					(GLubyte)(clampedColor.g * 255),
-					(GLubyte)(clampedColor.b * 255) };
+/**
+ * @fn	void FrameBuffer::setColorAt(int index, real r, real g, real b)
+ * @brief	Sets the color of the pixel at an index from pixelIndex. Float color buffers
+ * 			keep the full value; the others store it in bytes.
+ * @param	index	The index of the pixel.
+ * @param	r	 	Red, in [0, 1].
+ * @param	g	 	Green, in [0, 1].
+ * @param	b	 	Blue, in [0, 1].
+ */
 
-	std::memcpy(colorBuffer + BYTES_PER_PIXEL * (x + y * width), c, BYTES_PER_PIXEL);
+void FrameBuffer::setColorAt(int index, real r, real g, real b) {
+	if (format.color == ColorFormat::RGBA_FLOAT) {
+		float *dest = floatColorBuffer + 4 * index;
+		dest[0] = (float)r;
+		dest[1] = (float)g;
+		dest[2] = (float)b;
+		dest[3] = 1.0f;
+	} else {
+		GLubyte c[] = { (GLubyte)(r * 255), (GLubyte)(g * 255), (GLubyte)(b * 255) };
+		setColorAt(index, c);
+	}
 }
 
 /**
@@ -123,13 +484,18 @@ void FrameBuffer::setColor(int x, int y, const color &rgb) {
  */
 
 color FrameBuffer::getColor(int x, int y) const {
-	double red, green, blue;
-
-	if (checkInWindow(x, y)) {
+	real red, green, blue;
+
+	if (checkInWindow(x, y) && format.color == ColorFormat::RGBA_FLOAT) {
+		const float *c = floatColorBuffer + 4 * pixelIndex(x, y);
+		red = c[0];
+		green = c[1];
+		blue = c[2];
+	} else if (checkInWindow(x, y)) {
 		GLubyte c[BYTES_PER_PIXEL];
 
 		// Retrieve color values from the color buffer
-		std::memcpy(c, colorBuffer + BYTES_PER_PIXEL * (x + y * width), BYTES_PER_PIXEL);
+		std::memcpy(c, colorBuffer + bytesPerPixel * pixelIndex(x, y), BYTES_PER_PIXEL);
 
 		// Convert individual color components back to doubleing point values
 		red = c[0] / 255.0;
@@ -144,56 +510,57 @@ color FrameBuffer::getColor(int x, int y) const {
 }
 
 /**
-* @fn	void FrameBuffer::setDepth(int x, int y, double depth)
+* @fn	void FrameBuffer::setDepth(int x, int y, real depth)
 * @brief	Sets a depth at (x, y)
 * @param	x	 	The x coordinate.
 * @param	y	 	The y coordinate.
 * @param	depth	The new depth.
 */
 
-void FrameBuffer::setDepth(double x, double y, double depth) {
+void FrameBuffer::setDepth(real x, real y, real depth) {
 	setDepth((int)(x), (int)(y), depth);
 }
 
 /**
- * @fn	void FrameBuffer::setDepth(int x, int y, double depth)
+ * @fn	void FrameBuffer::setDepth(int x, int y, real depth)
  * @brief	Sets a depth at (x, y)
  * @param	x	 	The x coordinate.
  * @param	y	 	The y coordinate.
  * @param	depth	The new depth.
  */
 
-void FrameBuffer::setDepth(int x, int y, double depth) {
+void FrameBuffer::setDepth(int x, int y, real depth) {
 	if (checkInWindow(x, y)) {
-		depthBuffer[y * width + x] = depth;
+		setDepthAt(pixelIndex(x, y), depth);
+		depthChangedAt(x, y);
 	}
 }
 
 /**
-* @fn	double FrameBuffer::getDepth(double x, double y) const
+* @fn	real FrameBuffer::getDepth(real x, real y) const
 * @brief	Gets a depth at (x, y)
 * @param	x	The x coordinate.
 * @param	y	The y coordinate.
 * @return	The depth at (x, y).
 */
 
-double FrameBuffer::getDepth(int x, int y) const {
+real FrameBuffer::getDepth(int x, int y) const {
 	if (checkInWindow(x, y)) {
-		return depthBuffer[y * width + x];
+		return getDepthAt(pixelIndex(x, y));
 	} else {
 		return 0.0;
 	}
 }
 
 /**
- * @fn	double FrameBuffer::getDepth(double x, double y) const
+ * @fn	real FrameBuffer::getDepth(real x, real y) const
  * @brief	Gets a depth at (x, y)
  * @param	x	The x coordinate.
  * @param	y	The y coordinate.
  * @return	The depth at (x, y).
  */
 
-double FrameBuffer::getDepth(double x, double y) const {
+real FrameBuffer::getDepth(real x, real y) const {
 	return getDepth((int)(x), (int)(y));
 }
 
@@ -211,7 +578,7 @@ bool FrameBuffer::checkInWindow(int x, int y) const {
 }
 
 /**
- * @fn	void FrameBuffer::setPixel(int x, int y, const color &C, double depth)
+ * @fn	void FrameBuffer::setPixel(int x, int y, const color &C, real depth)
  * @brief	Sets a pixel's color and depth values
  * @param	x	 	Window x coordinate.
  * @param	y	 	Window y coordinate.
@@ -219,53 +586,53 @@ bool FrameBuffer::checkInWindow(int x, int y) const {
  * @param	depth	The depth to set
  */
 
-void FrameBuffer::setPixel(int x, int y, const color &C, double depth) {
+void FrameBuffer::setPixel(int x, int y, const color &C, real depth) {
 	setDepth(x, y, depth);
 	setColor(x, y, C);
 }
 
-double computeAq(const QuadricParameters &qParams, const Ray &ray) {
-	const double &A = qParams.A;
-	const double &B = qParams.B;
-	const double &C = qParams.C;
-	const double &J = qParams.J;
-	const double twoA = 2.0 * A;
-	const double twoB = 2.0 * B;
-	const double twoC = 2.0 * C;
-	dvec3 Ro = ray.origin;
-	const dvec3 &Rd = ray.dir;
+real computeAq(const QuadricParameters &qParams, const Ray &ray) {
+	const real &A = qParams.A;
+	const real &B = qParams.B;
+	const real &C = qParams.C;
+	const real &J = qParams.J;
+	const real twoA = 2.0 * A;
+	const real twoB = 2.0 * B;
+	const real twoC = 2.0 * C;
+	rvec3 Ro = ray.origin;
+	const rvec3 &Rd = ray.dir;
 
 	return A * glm::pow(Rd.x, 2) +
 			B * glm::pow(Rd.y, 2) +
 			C * glm::pow(Rd.z, 2);
 }
 
-double computeBq(const QuadricParameters &qParams, const Ray &ray) {
-	const double &A = qParams.A;
-	const double &B = qParams.B;
-	const double &C = qParams.C;
-	const double &J = qParams.J;
-	const double twoA = 2.0 * A;
-	const double twoB = 2.0 * B;
-	const double twoC = 2.0 * C;
-	dvec3 Ro = ray.origin;
-	const dvec3 &Rd = ray.dir;
+real computeBq(const QuadricParameters &qParams, const Ray &ray) {
+	const real &A = qParams.A;
+	const real &B = qParams.B;
+	const real &C = qParams.C;
+	const real &J = qParams.J;
+	const real twoA = 2.0 * A;
+	const real twoB = 2.0 * B;
+	const real twoC = 2.0 * C;
+	rvec3 Ro = ray.origin;
+	const rvec3 &Rd = ray.dir;
 
 	return twoA * Ro.x*Rd.x +
 		twoB * Ro.y*Rd.y +
 		twoC * Ro.z*Rd.z;
 }
 
-double computeCq(const QuadricParameters &qParams, const Ray &ray) {
-	const double &A = qParams.A;
-	const double &B = qParams.B;
-	const double &C = qParams.C;
-	const double &J = qParams.J;
-	const double twoA = 2.0 * A;
-	const double twoB = 2.0 * B;
-	const double twoC = 2.0 * C;
-	dvec3 Ro = ray.origin;
-	const dvec3 &Rd = ray.dir;
+real computeCq(const QuadricParameters &qParams, const Ray &ray) {
+	const real &A = qParams.A;
+	const real &B = qParams.B;
+	const real &C = qParams.C;
+	const real &J = qParams.J;
+	const real twoA = 2.0 * A;
+	const real twoB = 2.0 * B;
+	const real twoC = 2.0 * C;
+	rvec3 Ro = ray.origin;
+	const rvec3 &Rd = ray.dir;
 
 	return A * glm::pow(Ro.x, 2.0) +
 		B * glm::pow(Ro.y, 2.0) +
@@ -273,14 +640,14 @@ double computeCq(const QuadricParameters &qParams, const Ray &ray) {
 		J;
 }
 
-double solve(double A, double B, double C) {
-	double D = B * B - 4 * A*C;
+real solve(real A, real B, real C) {
+	real D = B * B - 4 * A*C;
 	if (D < 0) return -1.0;
 	return (-B + std::sqrt(D)) / (2.0 * A);
 }
 
 /**
- * @fn	void FrameBuffer::showAxes(int x, int y, const Ray &ray, double thickness)
+ * @fn	void FrameBuffer::showAxes(int x, int y, const Ray &ray, real thickness)
  * @brief	Inserts a R, G, or B pixel if the ray hits the X, Y, or Z axis.
  * @param	x   The x coordinate in the framebuffer
  * @param	y   The y coordinate in the framebuffer
@@ -288,39 +655,39 @@ double solve(double A, double B, double C) {
  * @param	thickness how wide the axes should appear
  */
 
-void FrameBuffer::showAxes(int x, int y, const Ray &ray, double thickness) {
-	color currColor = getColor(x, y);
+void FrameBuffer::showAxes(int x, int y, const Ray &ray, real thickness) {
+	const int W = 2;
+	if (x % W != 0 || y % W != 0) {		// color every other pixel
+		return;
+	}
 	static const QuadricParameters X = QuadricParameters::cylinderXQParams(thickness);
 	static const QuadricParameters Y = QuadricParameters::cylinderYQParams(thickness);
 	static const QuadricParameters Z = QuadricParameters::cylinderZQParams(thickness);
-	const double AqX = computeAq(X, ray);
-	const double BqX = computeBq(X, ray);
-	const double CqX = computeCq(X, ray);
-	const double AqY = computeAq(Y, ray);
-	const double BqY = computeBq(Y, ray);
-	const double CqY = computeCq(Y, ray);
-	const double AqZ = computeAq(Z, ray);
-	const double BqZ = computeBq(Z, ray);
-	const double CqZ = computeCq(Z, ray);
-	const double tX = solve(AqX, BqX, CqX);
-	const double tY = solve(AqY, BqY, CqY);
-	const double tZ = solve(AqZ, BqZ, CqZ);
-	const dvec3 Xintercept = ray.getPoint(tX);
-	const dvec3 Yintercept = ray.getPoint(tY);
-	const dvec3 Zintercept = ray.getPoint(tZ);
-	const int W = 2;
-	if (x % W == 0 && y % W == 0) {		// color every other pixel
-		if (tX >= 0 && Xintercept.x >= 0) {
-			setColor(x, y, red);
-		} else if (tY > 0 && Yintercept.y >= 0) {
-			setColor(x, y, green);
-		} else if (tZ > 0 && Zintercept.z >= 0) {
-			setColor(x, y, blue);
-		}
+	const real AqX = computeAq(X, ray);
+	const real BqX = computeBq(X, ray);
+	const real CqX = computeCq(X, ray);
+	const real AqY = computeAq(Y, ray);
+	const real BqY = computeBq(Y, ray);
+	const real CqY = computeCq(Y, ray);
+	const real AqZ = computeAq(Z, ray);
+	const real BqZ = computeBq(Z, ray);
+	const real CqZ = computeCq(Z, ray);
+	const real tX = solve(AqX, BqX, CqX);
+	const real tY = solve(AqY, BqY, CqY);
+	const real tZ = solve(AqZ, BqZ, CqZ);
+	const rvec3 Xintercept = ray.getPoint(tX);
+	const rvec3 Yintercept = ray.getPoint(tY);
+	const rvec3 Zintercept = ray.getPoint(tZ);
+	if (tX >= 0 && Xintercept.x >= 0) {
+		setColor(x, y, red);
+	} else if (tY > 0 && Yintercept.y >= 0) {
+		setColor(x, y, green);
+	} else if (tZ > 0 && Zintercept.z >= 0) {
+		setColor(x, y, blue);
 	}
 }
 
-void dot(FrameBuffer &fb, int x, int y, int W, const color &C, double Z) {
+void dot(FrameBuffer &fb, int x, int y, int W, const color &C, real Z) {
 	for (int col = x - W; col <= x + W; col++) {
 		for (int row = y - W; row <= y + W; row++) {
 			if (row >= 0 && row < fb.getWindowHeight() &&
@@ -332,7 +699,7 @@ void dot(FrameBuffer &fb, int x, int y, int W, const color &C, double Z) {
 }
 
 /**
- * @fn	void FrameBuffer::showAxes(const dmat4 &VM, const dmat4 &PM, const dmat4 &VPM, const BoundingBoxi &viewport, double thickness)
+ * @fn	void FrameBuffer::showAxes(const rmat4 &VM, const rmat4 &PM, const rmat4 &VPM, const BoundingBoxi &viewport, real thickness)
  * @brief	Displays axes.
  * @param	VM	viewing matrix
  * @param	PM	projection matrix
@@ -340,20 +707,20 @@ void dot(FrameBuffer &fb, int x, int y, int W, const color &C, double Z) {
  * @param	viewport	viewport
  */
 
-void FrameBuffer::showAxes(const dmat4 &VM, const dmat4 &PM, const dmat4 &VPM,
+void FrameBuffer::showAxes(const rmat4 &VM, const rmat4 &PM, const rmat4 &VPM,
 							const BoundingBoxi &viewport) {
-	const double LEN = 10;
-	const double INC = 0.1;
+	const real LEN = 10;
+	const real INC = 0.1;
 	const static color C[] = { red, green, blue };
-	for (double i = 0.0; i <= LEN; i += INC) {
-		vector<dvec4> pts = { dvec4(i, 0.0, 0.0, 1.0), 
-								dvec4(0.0, i, 0.0, 1.0), 
-								dvec4(0.0, 0.0, i, 1.0)
+	for (real i = 0.0; i <= LEN; i += INC) {
+		vector<rvec4> pts = { rvec4(i, 0.0, 0.0, 1.0), 
+								rvec4(0.0, i, 0.0, 1.0), 
+								rvec4(0.0, 0.0, i, 1.0)
 							};
 		for (size_t j = 0; j < pts.size(); j++) {
-			dvec4 eye = VM * pts[j];
-			dvec4 proj = PM * eye;
-			dvec4 clip;
+			rvec4 eye = VM * pts[j];
+			rvec4 proj = PM * eye;
+			rvec4 clip;
 			if (proj.w >= 0) {
 				clip = proj / proj.w;
 			} else {
@@ -364,13 +731,13 @@ void FrameBuffer::showAxes(const dmat4 &VM, const dmat4 &PM, const dmat4 &VPM,
 			}
 			const int W = 1;
 			if (std::abs(clip.x) <= 1.0 && std::abs(clip.y) <= 1.0 && std::abs(clip.z) <= 1.0) {
-				dvec4 window = VPM * clip;
+				rvec4 window = VPM * clip;
 				int rx = viewport.lx + viewport.width - 1;
 				int ry = viewport.ly + viewport.height- 1;
 
-				int x = (int)glm::clamp(window.x, (double)viewport.lx, (double)rx);
-				int y = (int)glm::clamp(window.y, (double)viewport.ly, (double)ry);
-				double currZ = getDepth(x, y);
+				int x = (int)glm::clamp(window.x, (real)viewport.lx, (real)rx);
+				int y = (int)glm::clamp(window.y, (real)viewport.ly, (real)ry);
+				real currZ = getDepth(x, y);
 				//if (std::abs(window.z - currZ) < 0.01) {
 				if (std::abs(window.z - currZ) < 0.01 || window.z < currZ) {
 					dot(*this, x, y, 1, C[j], window.z);
@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <string>
 #include "defs.h"
 #include "ishape.h"
 #include "colorandmaterials.h"
@@ -18,18 +19,70 @@
 #endif
 
 const int BYTES_PER_PIXEL = 3;			//!< RGB requires 3 bytes.
+const int FRAMEBUFFER_TILE_SIZE = 8;	//!< Width and height, in pixels, of the tiles of PixelLayout::TILED.
+
+/**
+ * @enum	ColorFormat
+ * @brief	How the color buffer stores a pixel.
+ */
+
+enum class ColorFormat {
+	RGB8,			//!< 3 bytes. Can be drawn or written out without conversion.
+	RGBA8,			//!< 4 bytes, so every pixel is one aligned 32-bit word. Alpha is always 255.
+	RGBA_FLOAT		//!< 4 floats. Keeps colors at full precision until they are written out.
+};
+
+/**
+ * @enum	DepthFormat
+ * @brief	How the depth buffer stores a pixel.
+ */
+
+enum class DepthFormat {
+	REAL,			//!< A real, the same precision as the rest of the math.
+	FLOAT32,		//!< A 32-bit float.
+	UNORM24			//!< 24-bit fixed point over [-1, 1], in the low bits of a 32-bit word.
+};
+
+/**
+ * @enum	PixelLayout
+ * @brief	Order of the pixels in memory.
+ */
+
+enum class PixelLayout {
+	LINEAR,			//!< Row by row, from the bottom of the window.
+	TILED			//!< FRAMEBUFFER_TILE_SIZE square tiles, row by row, each in Morton (Z) order,
+					//!< so a tile of the rasterizer or ray tracer touches only a few cache lines.
+};
+
+/**
+ * @struct	FrameBufferFormat
+ * @brief	The storage format of a framebuffer. The default is the classic one: RGB8 color,
+ * 			REAL depth and linear layout, 11 bytes per pixel in the double build. RGBA8 color
+ * 			with FLOAT32 or UNORM24 depth takes 8.
+ */
+
+struct FrameBufferFormat {
+	ColorFormat color;		//!< Color buffer format.
+	DepthFormat depth;		//!< Depth buffer format.
+	PixelLayout layout;		//!< Pixel order of both buffers.
+	FrameBufferFormat(ColorFormat color = ColorFormat::RGB8, DepthFormat depth = DepthFormat::REAL,
+						PixelLayout layout = PixelLayout::LINEAR)
+		: color(color), depth(depth), layout(layout) {}
+};
 
 /**
  * @struct	FrameBuffer
  * @brief	Represents a framebuffer. Two identically sized 2D arrays. The color
  * 			buffer stores the colors and the depth buffer stores the corresponding
- * 			depth at each pixel.
+ * 			depth at each pixel, in the formats given by a FrameBufferFormat.
  */
 
 struct FrameBuffer {
-	FrameBuffer(const int width, const int height);
+	FrameBuffer(const int width, const int height, const FrameBufferFormat &format = FrameBufferFormat());
 	~FrameBuffer();
 	void setFrameBufferSize(int width, int height);
+	const FrameBufferFormat &getFormat() const { return format; }
+	size_t getMemorySize() const;
 	void setClearColor(const color &clearColor);
 	color getClearColor() const { return clearColor; }
 	void setColor(int x, int y, const color &C);
@@ -37,24 +90,106 @@ struct FrameBuffer {
 
 	void clearColorAndDepthBuffers();
 	void showColorBuffer() const;
+	bool writePPM(const std::string &fileName) const;
+	bool writePNG(const std::string &fileName) const;
 	int getWindowWidth() const { return width; }
 	int getWindowHeight() const { return height; }
 
-	void setDepth(double x, double y, double depth);
-	void setDepth(int x, int y, double depth);
-	double getDepth(int x, int y) const;
-	double getDepth(double x, double y) const;
+	void setDepth(real x, real y, real depth);
+	void setDepth(int x, int y, real depth);
+	real getDepth(int x, int y) const;
+	real getDepth(real x, real y) const;
 
-	void showAxes(int x, int y, const Ray &ray, double thickness);
-	void showAxes(const dmat4 &VM, const dmat4 &PM, const dmat4 &VPM,
+	void showAxes(int x, int y, const Ray &ray, real thickness);
+	void showAxes(const rmat4 &VM, const rmat4 &PM, const rmat4 &VPM,
 					const BoundingBoxi &viewport);
-	void setPixel(int x, int y, const color &C, double depth);
+	void setPixel(int x, int y, const color &C, real depth);
+
+	/**
+	 * @fn	int pixelIndex(int x, int y) const
+	 * @brief	Index of (x, y) for the unchecked accessors below, which are meant for
+	 * 			batched fragment processing. (x, y) must be inside the window. In either
+	 * 			layout the index is the sum of a part that depends only on the row and a
+	 * 			part that depends only on the column, both looked up in tables, so no
+	 * 			pixel pays for a branch on the layout or for building a Morton index.
+	 * @param	x	The x coordinate.
+	 * @param	y	The y coordinate.
+	 * @return	The index of the pixel.
+	 */
+
+	int pixelIndex(int x, int y) const {
+		return rowStart[y] + columnOffset[x];
+	}
+	real getDepthAt(int index) const {
+		switch (format.depth) {
+		case DepthFormat::FLOAT32:	return floatDepthBuffer[index];
+		case DepthFormat::UNORM24:	return depth24Buffer[index] * (real(2.0) / DEPTH24_MAX) - 1;
+		default:					return depthBuffer[index];
+		}
+	}
+	void setDepthAt(int index, real depth) {
+		switch (format.depth) {
+		case DepthFormat::FLOAT32:	floatDepthBuffer[index] = (float)depth; break;
+		case DepthFormat::UNORM24:	depth24Buffer[index] = toDepth24(depth); break;
+		default:					depthBuffer[index] = depth; break;
+		}
+	}
+	void setColorAt(int index, const GLubyte rgb[BYTES_PER_PIXEL]) {
+		if (format.color == ColorFormat::RGBA_FLOAT) {
+			float *dest = floatColorBuffer + 4 * index;
+			dest[0] = rgb[0] / 255.0f;
+			dest[1] = rgb[1] / 255.0f;
+			dest[2] = rgb[2] / 255.0f;
+			dest[3] = 1.0f;
+			return;
+		}
+		GLubyte *dest = colorBuffer + bytesPerPixel * index;
+		dest[0] = rgb[0];
+		dest[1] = rgb[1];
+		dest[2] = rgb[2];
+		if (format.color == ColorFormat::RGBA8) {
+			dest[3] = 255;
+		}
+	}
+	void setColorAt(int index, real r, real g, real b);
+
+	/**
+	 * @fn	void depthChangedAt(int x, int y)
+	 * @brief	Records that the depth of pixel (x, y) was changed through setDepthAt, so that
+	 * 			the coarse depth of its tile must be recomputed before it is next used.
+	 * @param	x	The x coordinate.
+	 * @param	y	The y coordinate.
+	 */
+
+	void depthChangedAt(int x, int y) {
+		hiZDirty[(y / FRAMEBUFFER_TILE_SIZE) * tilesAcross + x / FRAMEBUFFER_TILE_SIZE] = 1;
+	}
+	bool isOccluded(int xMin, int yMin, int xMax, int yMax, real depth) const;
 protected:
+	static const unsigned int DEPTH24_MAX = 0xFFFFFF;	//!< UNORM24 value of depth 1.
+	static unsigned int toDepth24(real depth) {
+		real d = glm::clamp(depth, real(-1.0), real(1.0));
+		return (unsigned int)((d + 1) * (DEPTH24_MAX / real(2.0)) + real(0.5));
+	}
 	bool checkInWindow(int x, int y) const;
+	real getTileMaxDepth(int tile) const;
+	const GLubyte *getRGBRows(vector<GLubyte> &scratch) const;
+	FrameBufferFormat format;				//!< Storage format
 	int width;								//!< width of framebuffer
 	int height;								//!< height of framebuffer
+	int tilesAcross;						//!< Tiles in a row
+	int tilesUp;							//!< Tiles in a column
+	int numPixels;							//!< Pixels stored, including those padding out partial tiles
+	int bytesPerPixel;						//!< Bytes per pixel of colorBuffer
 	GLubyte clearColorUB[BYTES_PER_PIXEL];	//!< Clear color, as unsigned bytes
 	color clearColor;						//!< Clear color
-	GLubyte *colorBuffer;					//!< 2D array for holding colors
-	double *depthBuffer;					//!< 2D array for holding depths
+	GLubyte *colorBuffer;					//!< 2D array for holding RGB8 or RGBA8 colors
+	float *floatColorBuffer;				//!< 2D array for holding RGBA_FLOAT colors
+	real *depthBuffer;						//!< 2D array for holding REAL depths
+	float *floatDepthBuffer;				//!< 2D array for holding FLOAT32 depths
+	unsigned int *depth24Buffer;			//!< 2D array for holding UNORM24 depths
+	real *hiZ;								//!< Coarse depth buffer: the farthest depth in each tile
+	unsigned char *hiZDirty;				//!< Per tile, 1 ==> hiZ must be recomputed
+	int *rowStart;							//!< Per row, the part of pixelIndex that depends on y
+	int *columnOffset;						//!< Per column, the part of pixelIndex that depends on x
 };
\ No newline at end of file
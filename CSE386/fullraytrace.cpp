@@ -20,38 +20,42 @@
 #include "rasterization.h"
 
 
-Image im1("usflag.ppm");
-Image im2("amongus.ppm");
+TexturePtr im1 = TextureCache::global().get("usflag.ppm");
+TexturePtr im2 = TextureCache::global().get("amongus.ppm");
 
 int currLight = 0;
-double angle = 0.5;
+real angle = 0.5;
 const int MAX = 10;
-double z = -MAX;
-double inc = 0.25;
+real z = -MAX;
+real inc = 0.25;
 bool isAnimated = false;
 int numReflections = 0;
 int antiAliasing = 1;
+enum AntiAliasingMode { FIXED_AA, ADAPTIVE_AA, PROGRESSIVE_AA };
+AntiAliasingMode antiAliasingMode = FIXED_AA;
+const real ADAPTIVE_THRESHOLD = 0.1;
+SampleBuffer progressiveSamples;
 bool multiViewOn = false;
 int numViewports = 3;
-double spotDirX = 0;
-double spotDirY = -1;
-double spotDirZ = 0;
+real spotDirX = 0;
+real spotDirY = -1;
+real spotDirZ = 0;
 
-dvec3 cameraPos1(6, 6, 6);
-dvec3 cameraFocus1 = ORIGIN3D;
-dvec3 cameraUp1 = Y_AXIS;
-dvec3 cameras[3][3] = { 
+rvec3 cameraPos1(6, 6, 6);
+rvec3 cameraFocus1 = ORIGIN3D;
+rvec3 cameraUp1 = Y_AXIS;
+rvec3 cameras[3][3] = { 
 	{cameraPos1, cameraFocus1, cameraUp1},
-	{dvec3(0, 3, 10), cameraFocus1, cameraUp1},
-	{dvec3(10, 3, 4), cameraFocus1 + dvec3(0, 2, -3), cameraUp1}
+	{rvec3(0, 3, 10), cameraFocus1, cameraUp1},
+	{rvec3(10, 3, 4), cameraFocus1 + rvec3(0, 2, -3), cameraUp1}
 };
 
-double cameraFOV = glm::radians(100.0);
+real cameraFOV = glm::radians(100.0);
 
 vector<PositionalLightPtr> lights = {
-						new PositionalLight(dvec3(10, 10, 10), pureWhiteLight),
-						new SpotLight(dvec3(0, 10, 0), 
-										dvec3(spotDirX,spotDirY,spotDirZ), 
+						new PositionalLight(rvec3(10, 10, 10), pureWhiteLight),
+						new SpotLight(rvec3(0, 10, 0), 
+										rvec3(spotDirX,spotDirY,spotDirZ), 
 										glm::radians(65.0), 
 										pureWhiteLight)
 };
@@ -60,7 +64,7 @@ PositionalLightPtr posLight = lights[0];
 SpotLightPtr spotLight = (SpotLightPtr)lights[1];
 
 FrameBuffer frameBuffer(WINDOW_WIDTH, WINDOW_HEIGHT);
-RayTracer rayTrace(lightGray);
+RayTracer rayTrace(lightGray, 0);			// one render thread per core
 PerspectiveCamera pCamera(cameraPos1, cameraFocus1, cameraUp1, cameraFOV, 
 							WINDOW_WIDTH, WINDOW_HEIGHT);
 IScene scene(&pCamera);
@@ -85,7 +89,7 @@ void render() {
 		 
 			pCamera = PerspectiveCamera(cameras[i][0], cameras[i][1], cameras[i][2], cameraFOV, width, height);
 			rayTrace.raytraceScene(frameBuffer, numReflections, scene, antiAliasing,
-				dvec2(width * (i / 2), height * (i % 2)), dvec2(width + width * (i / 2), height + height * (i % 2)));
+				rvec2(width * (i / 2), height * (i % 2)), rvec2(width + width * (i / 2), height + height * (i % 2)));
 		}
 	}
 	else
@@ -97,14 +101,23 @@ void render() {
 		int right = frameBuffer.getWindowWidth() - 1;
 		int bottom = 0;
 		int top = frameBuffer.getWindowHeight() - 1;
-		double N = 6.0;*/
+		real N = 6.0;*/
 		pCamera = PerspectiveCamera(cameras[camera][0], cameras[camera][1], cameras[camera][2], cameraFOV, width, height);
-		rayTrace.raytraceScene(frameBuffer, numReflections, scene, antiAliasing, dvec2(0, 0), dvec2(width, height));
+		if (antiAliasingMode == ADAPTIVE_AA) {
+			long long numRays = rayTrace.raytraceSceneAdaptive(frameBuffer, numReflections, scene, antiAliasing,
+																ADAPTIVE_THRESHOLD, rvec2(0, 0), rvec2(width, height));
+			cout << "Rays per pixel: " << (real)numRays / (width * height) << endl;
+		} else if (antiAliasingMode == PROGRESSIVE_AA) {
+			rayTrace.raytraceScenePass(frameBuffer, numReflections, scene, antiAliasing,
+										progressiveSamples, rvec2(0, 0), rvec2(width, height));
+		} else {
+			rayTrace.raytraceScene(frameBuffer, numReflections, scene, antiAliasing, rvec2(0, 0), rvec2(width, height));
+		}
 	}
 	
 
 	int frameEndTime = glutGet(GLUT_ELAPSED_TIME); // Get end time
-	double totalTimeSec = (frameEndTime - frameStartTime) / 1000.0;
+	real totalTimeSec = (frameEndTime - frameStartTime) / 1000.0;
 	cout << "Render time: " << totalTimeSec << " sec." << endl;
 }
 
@@ -113,14 +126,14 @@ void resize(int width, int height) {
 	glutPostRedisplay();
 } 
 
-IPlane *plane = new IPlane(dvec3(0.0, -2.0, 0.0), dvec3(0.0, 1.0, 0.0));
-IPlane *clearPlane = new IPlane(dvec3(0.0, 0.0, 0.0), dvec3(0.0, 0.0, -1.0));
-ISphere *sphere1 = new ISphere(dvec3(0.0, 4.0, 0.0), 2.0);
-IClosedCylinderY *closedCylinder = new IClosedCylinderY(dvec3(2.0, 0.0, 3.0), 2.0, 5.0);
-ICylinderY *cylinderY = new ICylinderY(dvec3(-4.0, 0.0, 5.0), 2.0, 3.0);
-ICylinderZ *cylinderZ = new ICylinderZ(dvec3(5.0, 0.0, -2.0), 2.0, 3.0);
-IConeY *cone = new IConeY(dvec3(1.0, 4.0, 4.0), 1.0, 2.0);
-IDisk *disk1 = new IDisk(dvec3(-8, 0, 3), dvec3(0, 0, 1), 3);
+IPlane *plane = new IPlane(rvec3(0.0, -2.0, 0.0), rvec3(0.0, 1.0, 0.0));
+IPlane *clearPlane = new IPlane(rvec3(0.0, 0.0, 0.0), rvec3(0.0, 0.0, -1.0));
+ISphere *sphere1 = new ISphere(rvec3(0.0, 4.0, 0.0), 2.0);
+IClosedCylinderY *closedCylinder = new IClosedCylinderY(rvec3(2.0, 0.0, 3.0), 2.0, 5.0);
+ICylinderY *cylinderY = new ICylinderY(rvec3(-4.0, 0.0, 5.0), 2.0, 3.0);
+ICylinderZ *cylinderZ = new ICylinderZ(rvec3(5.0, 0.0, -2.0), 2.0, 3.0);
+IConeY *cone = new IConeY(rvec3(1.0, 4.0, 4.0), 1.0, 2.0);
+IDisk *disk1 = new IDisk(rvec3(-8, 0, 3), rvec3(0, 0, 1), 3);
 
 
 void buildScene() {
@@ -128,16 +141,17 @@ void buildScene() {
 	scene.addTransparentObject(new VisibleIShape(clearPlane, Material(red, red, red, 0.0)), 0.25);
 	scene.addOpaqueObject(new VisibleIShape(sphere1, gold));
 	scene.addOpaqueObject(new VisibleIShape(closedCylinder, greenRubber));
-	scene.addOpaqueObject(new VisibleIShape(cylinderY, copper, &im1));
+	scene.addOpaqueObject(new VisibleIShape(cylinderY, copper, im1));
 	scene.addOpaqueObject(new VisibleIShape(cylinderZ, polishedBronze));
 	scene.addOpaqueObject(new VisibleIShape(cone, yellowRubber));
-	//scene.addOpaqueObject(new VisibleIShape(disk1, silver, &im2));
+	//scene.addOpaqueObject(new VisibleIShape(disk1, silver, im2));
 
 	scene.addLight(lights[0]);
 	scene.addLight(lights[1]);
+	scene.finalize();
 }
 
-void incrementClamp(double &v, double delta, double lo, double hi) {
+void incrementClamp(real &v, real delta, real lo, real hi) {
 	v = glm::clamp(v + delta, lo, hi);
 }
 
@@ -155,14 +169,17 @@ void timer(int id) {
 			inc = MAX - inc;
 		}
 	}
-	clearPlane->a = dvec3(0, 0, z);
+	clearPlane->a = rvec3(0, 0, z);
+	if (isAnimated) {
+		progressiveSamples.reset();
+	}
 	glutTimerFunc(TIME_INTERVAL, timer, 0);
 	glutPostRedisplay();
 }
 
 void keyboard(unsigned char key, int x, int y) {
 	int W, H;
-	const double INC = 0.5;
+	const real INC = 0.5;
 	switch (key) {
 	case 'A':
 	case 'a':	currLight = 0;
@@ -240,7 +257,10 @@ void keyboard(unsigned char key, int x, int y) {
 				cout << cameraFOV << endl;
 				break;
 	case 'M':
-	case 'm':	break;
+	case 'm':	antiAliasingMode = (AntiAliasingMode)((antiAliasingMode + 1) % 3);
+				cout << (antiAliasingMode == FIXED_AA ? "Fixed" :
+						antiAliasingMode == ADAPTIVE_AA ? "Adaptive" : "Progressive") << " anti aliasing" << endl;
+				break;
 	case '+':	antiAliasing = 3; 
 				cout << "Anti aliasing: " << antiAliasing << endl;
 				break;
@@ -264,6 +284,7 @@ void keyboard(unsigned char key, int x, int y) {
 		cout << (int)key << "unmapped key pressed." << endl;
 	}
 
+	progressiveSamples.reset();
 	glutPostRedisplay();
 }
 
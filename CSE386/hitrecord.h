@@ -12,7 +12,7 @@
 #include <vector>
 #include "defs.h"
 #include "colorandmaterials.h"
-#include "image.h"
+#include "texture.h"
 #include "utilities.h"
 
 /**
@@ -21,12 +21,13 @@
  */
 
 struct HitRecord {
-	double t;				//!< the t value where the intersection took place.
-	dvec3 interceptPt;		//!< the (x,y,z) value where the intersection took place.
-	dvec3 normal;			//!< the normal vector at the intersection point.
+	real t;				//!< the t value where the intersection took place.
+	rvec3 interceptPt;		//!< the (x,y,z) value where the intersection took place.
+	rvec3 normal;			//!< the normal vector at the intersection point.
 	Material material;		//!< the Material value of the object.
-	Image *texture;			//!< the texture associated with this object, if any.
-	double u, v;			//!< (u,v) correpsonding to intersection point.
+	const Texture *texture;	//!< the texture associated with this object, if any. Owned by the object.
+	real u, v;			//!< (u,v) correpsonding to intersection point.
+	real uvPerUnit;			//!< change in (u,v) per unit of distance across the surface. Used to filter the texture.
 
 	/**
 	 * @fn	HitRecord()
@@ -36,6 +37,7 @@ struct HitRecord {
 	HitRecord() {
 		t = FLT_MAX;
 		u = v = 0;
+		uvPerUnit = 0;
 		texture = nullptr; 
 	}
 
@@ -9,101 +9,665 @@
 
 #include <iostream>
 #include <fstream>
-#include <utility>
-#include <set>
+#include <cstdlib>
+#include <cstring>
+#include <new>
 #include "utilities.h"
 #include "image.h"
 
-static unsigned int getNextChar(std::ifstream &input, string &str) {
-	const int N = 2000;
-	char buf;
-	input.read(&buf, 1);
-	unsigned int result = (unsigned char)buf;
-	return result;
+/**
+ * @fn	static bool readFile(const std::string &fileName, vector<unsigned char> &bytes)
+ * @brief	Reads a whole file into memory with a single read.
+ * @param 	   	fileName	Name of the file.
+ * @param [out]	bytes   	The contents of the file.
+ * @return	True iff the file was read.
+ */
+
+static bool readFile(const std::string &fileName, vector<unsigned char> &bytes) {
+	std::ifstream input(fileName, std::ios::binary | std::ios::ate);
+	if (!input) {
+		return false;
+	}
+	std::streamoff size = input.tellg();
+	input.seekg(0);
+	bytes.resize((size_t)size);
+	return size == 0 || (bool)input.read((char *)bytes.data(), size);
 }
 
-static void p3(std::ifstream &input, Image &im) {
-	const int N = 100;
-	char buf[N + 1];
+/**
+ * @fn	static void buildSampleTable(int maxValue, int numEntries, vector<real> &table)
+ * @brief	Builds the table that converts integer samples in [0, maxValue] to [0, 1], so
+ * 			that each conversion is a lookup rather than a division. Entries past maxValue,
+ * 			which a malformed file could contain, convert to 1.
+ * @param 	   	maxValue  	The largest sample value.
+ * @param 	   	numEntries	Entries in the table, enough for every value a sample can hold.
+ * @param [out]	table	  	The table.
+ */
 
-	int maxValue;
-	input >> im.W >> im.H >> maxValue;
-	input.getline(buf, N);
+static void buildSampleTable(int maxValue, int numEntries, vector<real> &table) {
+	table.assign(numEntries, 1.0);
+	for (int i = 0; i <= maxValue && i < numEntries; i++) {
+		table[i] = map((real)i, 0.0, (real)maxValue, 0.0, 1.0);
+	}
+}
 
-	im.pixels = new color[im.W*im.H];
-	color *p = im.pixels;
-	for (int row = 0; row < im.H; row++) {
-		for (int col = 0; col < im.W; col++, p++) {
-			int r, g, b;
-			input >> r >> g >> b;
-			double R = map((double)r, 0.0, (double)maxValue, 0.0, 1.0);
-			double G = map((double)g, 0.0, (double)maxValue, 0.0, 1.0);
-			double B = map((double)b, 0.0, (double)maxValue, 0.0, 1.0);
-			*p = color(R, G, B);
+const size_t MAX_IMAGE_PIXELS = (size_t)1 << 27;	//!< Larger images are rejected rather than allocated.
+
+/**
+ * @fn	static bool isValidImageSize(int W, int H)
+ * @brief	Checks image dimensions read from a file header before anything is
+ * 			allocated for them.
+ * @param	W	The width.
+ * @param	H	The height.
+ * @return	True iff both are positive and the image has at most MAX_IMAGE_PIXELS pixels.
+ */
+
+static bool isValidImageSize(int W, int H) {
+	return W > 0 && H > 0 && (size_t)W * (size_t)H <= MAX_IMAGE_PIXELS;
+}
+
+/**
+ * @fn	static void convertSamples(const unsigned char *samples, int bytesPerSample, const vector<real> &table, Image &im)
+ * @brief	Fills the image's pixels from packed big-endian RGB samples of 1 or 2 bytes.
+ * @param 		  	samples			The samples, 3 per pixel.
+ * @param 		  	bytesPerSample	1 or 2.
+ * @param 		  	table			Sample conversion table.
+ * @param [in,out]	im				The image. W and H must be set.
+ */
+
+static void convertSamples(const unsigned char *samples, int bytesPerSample, const vector<real> &table, Image &im) {
+	const size_t numPixels = (size_t)im.W * im.H;
+	im.pixels = new color[numPixels];
+	if (bytesPerSample == 1) {
+		for (size_t i = 0; i < numPixels; i++, samples += 3) {
+			im.pixels[i] = color(table[samples[0]], table[samples[1]], table[samples[2]]);
+		}
+	} else {
+		for (size_t i = 0; i < numPixels; i++, samples += 6) {
+			im.pixels[i] = color(table[(samples[0] << 8) | samples[1]],
+								table[(samples[2] << 8) | samples[3]],
+								table[(samples[4] << 8) | samples[5]]);
 		}
 	}
 }
 
-static void p6(std::ifstream &input, Image &im) {
-	const int N = 100;
-	char buf[N + 1];
+/**
+ * @fn	static bool readPPMNumber(const vector<unsigned char> &bytes, size_t &pos, int &value)
+ * @brief	Reads an unsigned decimal number from a PPM file, skipping the whitespace and
+ * 			comments before it.
+ * @param 		  	bytes	The file.
+ * @param [in,out]	pos  	Position in the file.
+ * @param [out]   	value	The number.
+ * @return	True iff a number was found.
+ */
 
+static bool readPPMNumber(const vector<unsigned char> &bytes, size_t &pos, int &value) {
+	const size_t size = bytes.size();
+	while (pos < size && (unsigned int)(bytes[pos] - '0') > 9u) {
+		if (bytes[pos] == '#') {
+			while (pos < size && bytes[pos] != '\n') {
+				pos++;
+			}
+		} else if (bytes[pos] == ' ' || (bytes[pos] >= '\t' && bytes[pos] <= '\r')) {
+			pos++;
+		} else {
+			return false;
+		}
+	}
+	if (pos >= size) {
+		return false;
+	}
+	value = 0;
+	for (; pos < size && (unsigned int)(bytes[pos] - '0') <= 9u; pos++) {
+		value = glm::min(10 * value + (bytes[pos] - '0'), 100000000);	// saturates rather than overflowing
+	}
+	return true;
+}
+
+/**
+ * @fn	static bool loadPPM(const vector<unsigned char> &bytes, Image &im)
+ * @brief	Decodes a P3 or P6 PPM file, with 8 or 16 bit samples.
+ * @param 		  	bytes	The file.
+ * @param [in,out]	im   	The image.
+ * @return	True iff the file could be decoded.
+ */
+
+static bool loadPPM(const vector<unsigned char> &bytes, Image &im) {
+	if (bytes.size() < 2 || bytes[0] != 'P' || (bytes[1] != '3' && bytes[1] != '6')) {
+		return false;
+	}
+	size_t pos = 2;
 	int maxValue;
-	input >> im.W >> im.H >> maxValue;
-	input.getline(buf, N);
+	if (!readPPMNumber(bytes, pos, im.W) || !readPPMNumber(bytes, pos, im.H) ||
+		!readPPMNumber(bytes, pos, maxValue) || !isValidImageSize(im.W, im.H) ||
+		maxValue <= 0 || maxValue > 65535) {
+		return false;
+	}
+	const int bytesPerSample = maxValue < 256 ? 1 : 2;
+	vector<real> table;
+	buildSampleTable(maxValue, bytes[1] == '3' ? maxValue + 1 : (bytesPerSample == 1 ? 256 : 65536), table);
+	const size_t numSamples = 3 * (size_t)im.W * im.H;
+
+	if (bytes[1] == '6') {
+		// A single whitespace character separates the header from the samples
+		pos++;
+		if (pos + numSamples * bytesPerSample > bytes.size()) {
+			return false;
+		}
+		convertSamples(bytes.data() + pos, bytesPerSample, table, im);
+		return true;
+	}
+
+	// Each sample takes at least a digit and a separator
+	if (numSamples > bytes.size() / 2) {
+		return false;
+	}
+	vector<unsigned char> samples(2 * numSamples);
+	for (size_t i = 0; i < numSamples; i++) {
+		int value;
+		if (!readPPMNumber(bytes, pos, value) || value > maxValue) {
+			return false;
+		}
+		samples[2 * i] = (unsigned char)(value >> 8);
+		samples[2 * i + 1] = (unsigned char)value;
+	}
+	convertSamples(samples.data(), 2, table, im);
+	return true;
+}
+
+/**
+ * @struct	BitReader
+ * @brief	Reads the least-significant-bit-first bit stream of deflate. Reading past the
+ * 			end yields zeros and sets overrun.
+ */
+
+struct BitReader {
+	const unsigned char *data;	//!< The stream.
+	size_t size;				//!< Bytes in the stream.
+	size_t pos;					//!< Next byte to load into buffer.
+	unsigned long long buffer;	//!< Bits loaded but not yet read.
+	int count;					//!< Number of bits in buffer.
+	BitReader(const unsigned char *data, size_t size)
+		: data(data), size(size), pos(0), buffer(0), count(0) {}
+	bool overrun() const { return pos > size && (pos - size) * 8 > (size_t)count; }
+	void refill() {
+		while (count <= 56) {
+			buffer |= (unsigned long long)(pos < size ? data[pos] : 0) << count;
+			pos++;
+			count += 8;
+		}
+	}
+	unsigned int peek(int n) {
+		if (count < n) {
+			refill();
+		}
+		return (unsigned int)(buffer & ((1ULL << n) - 1));
+	}
+	void skip(int n) {
+		buffer >>= n;
+		count -= n;
+	}
+	unsigned int bits(int n) {
+		unsigned int value = peek(n);
+		skip(n);
+		return value;
+	}
+};
+
+/**
+ * @struct	HuffmanTable
+ * @brief	Lookup table for decoding a canonical Huffman code of deflate. Indexed by the
+ * 			next maxLength bits of the stream, each entry holds a symbol and the length of
+ * 			its code; length 0 marks a bit pattern that is not a code.
+ */
 
-	im.pixels = new color[im.W*im.H];
-	string buffer;
+struct HuffmanTable {
+	vector<unsigned short> entries;	//!< (length << 9) | symbol.
+	int maxLength;					//!< Length of the longest code.
+
+	/**
+	 * @fn	bool build(const unsigned char lengths[], int numSymbols)
+	 * @brief	Builds the table from the code length of each symbol.
+	 * @param	lengths   	Code lengths, 0 for unused symbols.
+	 * @param	numSymbols	Number of symbols.
+	 * @return	False if the lengths do not describe a valid code.
+	 */
+
+	bool build(const unsigned char lengths[], int numSymbols) {
+		const int MAX_BITS = 15;
+		int counts[MAX_BITS + 1] = { 0 };
+		maxLength = 1;
+		for (int s = 0; s < numSymbols; s++) {
+			counts[lengths[s]]++;
+			maxLength = glm::max(maxLength, (int)lengths[s]);
+		}
+		int nextCode[MAX_BITS + 1];
+		int code = 0;
+		counts[0] = 0;
+		for (int len = 1; len <= MAX_BITS; len++) {
+			code = (code + counts[len - 1]) << 1;
+			nextCode[len] = code;
+			if (counts[len] > (1 << len)) {
+				return false;
+			}
+		}
+		entries.assign((size_t)1 << maxLength, 0);
+		for (int s = 0; s < numSymbols; s++) {
+			int len = lengths[s];
+			if (len == 0) {
+				continue;
+			}
+			int c = nextCode[len]++;
+			if (c >= (1 << len)) {
+				return false;
+			}
+			// Codes are stored most significant bit first, but read from the low bits
+			int reversed = 0;
+			for (int i = 0; i < len; i++) {
+				reversed |= ((c >> i) & 1) << (len - 1 - i);
+			}
+			for (int i = reversed; i < (1 << maxLength); i += 1 << len) {
+				entries[i] = (unsigned short)((len << 9) | s);
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @fn	int decode(BitReader &in) const
+	 * @brief	Reads one symbol.
+	 * @param [in,out]	in	The stream.
+	 * @return	The symbol, or -1 if the bits are not a code.
+	 */
+
+	int decode(BitReader &in) const {
+		unsigned short entry = entries[in.peek(maxLength)];
+		int len = entry >> 9;
+		if (len == 0) {
+			return -1;
+		}
+		in.skip(len);
+		return entry & 0x1FF;
+	}
+};
+
+/**
+ * @fn	static bool inflateBlock(BitReader &in, const HuffmanTable &lengthCodes, const HuffmanTable &distanceCodes, vector<unsigned char> &out, size_t &n)
+ * @brief	Decodes the compressed data of one deflate block.
+ * @param [in,out]	in			 	The stream.
+ * @param 		  	lengthCodes  	The literal/length code.
+ * @param 		  	distanceCodes	The distance code.
+ * @param [in,out]	out			 	The decompressed data, which the block is appended to. Grown
+ * 									as needed, so it may be longer than the data.
+ * @param [in,out]	n			 	Number of bytes of out that hold data.
+ * @return	True iff the block was valid.
+ */
+
+static bool inflateBlock(BitReader &in, const HuffmanTable &lengthCodes, const HuffmanTable &distanceCodes,
+							vector<unsigned char> &out, size_t &n) {
+	static const unsigned short LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27,
+													31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	static const unsigned char LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+													2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	static const unsigned short DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+													193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097,
+													6145, 8193, 12289, 16385, 24577 };
+	static const unsigned char DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+													6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+	const int MAX_MATCH = 258;
+	while (!in.overrun()) {
+		if (n + MAX_MATCH > out.size()) {
+			out.resize(glm::max(2 * out.size(), n + MAX_MATCH));
+		}
+		int symbol = lengthCodes.decode(in);
+		if (symbol < 0) {
+			return false;
+		} else if (symbol < 256) {
+			out[n++] = (unsigned char)symbol;
+		} else if (symbol == 256) {
+			return true;
+		} else {
+			symbol -= 257;
+			if (symbol >= 29) {
+				return false;
+			}
+			int length = LENGTH_BASE[symbol] + in.bits(LENGTH_EXTRA[symbol]);
+			int distanceSymbol = distanceCodes.decode(in);
+			if (distanceSymbol < 0 || distanceSymbol >= 30) {
+				return false;
+			}
+			size_t distance = DISTANCE_BASE[distanceSymbol] + in.bits(DISTANCE_EXTRA[distanceSymbol]);
+			if (distance > n) {
+				return false;
+			}
+			// The copy may overlap what it produces, so it goes a byte at a time
+			unsigned char *to = out.data() + n;
+			const unsigned char *from = to - distance;
+			for (int i = 0; i < length; i++) {
+				to[i] = from[i];
+			}
+			n += length;
+		}
+	}
+	return false;
+}
+
+/**
+ * @fn	static bool inflateZlib(const vector<unsigned char> &data, vector<unsigned char> &out)
+ * @brief	Decompresses a zlib stream (RFC 1950 wrapping RFC 1951 deflate). The checksum is
+ * 			not verified.
+ * @param 	   	data	The compressed stream.
+ * @param [out]	out 	The decompressed data. Its capacity going in is the first guess at
+ * 						the decompressed size.
+ * @return	True iff the stream could be decompressed.
+ */
+
+static bool inflateZlib(const vector<unsigned char> &data, vector<unsigned char> &out) {
+	if (data.size() < 2 || (data[0] & 0x0F) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 0x20)) {
+		return false;
+	}
+	BitReader in(data.data() + 2, data.size() - 2);
+	HuffmanTable lengthCodes, distanceCodes;
+	size_t n = 0;
+	out.resize(out.capacity());
+	bool isLast;
+	do {
+		isLast = in.bits(1) == 1;
+		int type = in.bits(2);
+		if (type == 0) {
+			// Stored: skip to a byte boundary, then copy straight from the stream
+			in.skip(in.count % 8);
+			unsigned int length = in.bits(16);
+			unsigned int complement = in.bits(16);
+			size_t start = in.pos - in.count / 8;
+			if ((length ^ 0xFFFF) != complement || start + length > in.size) {
+				return false;
+			}
+			if (n + length > out.size()) {
+				out.resize(glm::max(2 * out.size(), n + length));
+			}
+			std::memcpy(out.data() + n, in.data + start, length);
+			n += length;
+			in.pos = start + length;
+			in.buffer = 0;
+			in.count = 0;
+		} else if (type == 1) {
+			unsigned char lengths[288 + 30];
+			std::memset(lengths, 8, 144);
+			std::memset(lengths + 144, 9, 112);
+			std::memset(lengths + 256, 7, 24);
+			std::memset(lengths + 280, 8, 8);
+			std::memset(lengths + 288, 5, 30);
+			lengthCodes.build(lengths, 288);
+			distanceCodes.build(lengths + 288, 30);
+			if (!inflateBlock(in, lengthCodes, distanceCodes, out, n)) {
+				return false;
+			}
+		} else if (type == 2) {
+			static const unsigned char ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+			int numLengthCodes = in.bits(5) + 257;
+			int numDistanceCodes = in.bits(5) + 1;
+			int numCodeLengthCodes = in.bits(4) + 4;
+			unsigned char codeLengths[19] = { 0 };
+			for (int i = 0; i < numCodeLengthCodes; i++) {
+				codeLengths[ORDER[i]] = (unsigned char)in.bits(3);
+			}
+			HuffmanTable codeLengthCodes;
+			if (!codeLengthCodes.build(codeLengths, 19)) {
+				return false;
+			}
+			unsigned char lengths[288 + 32] = { 0 };
+			int numLengths = 0;
+			while (numLengths < numLengthCodes + numDistanceCodes) {
+				int symbol = codeLengthCodes.decode(in);
+				int repeat = 0;
+				unsigned char value = 0;
+				if (symbol < 0) {
+					return false;
+				} else if (symbol < 16) {
+					lengths[numLengths++] = (unsigned char)symbol;
+					continue;
+				} else if (symbol == 16) {
+					if (numLengths == 0) {
+						return false;
+					}
+					value = lengths[numLengths - 1];
+					repeat = 3 + in.bits(2);
+				} else if (symbol == 17) {
+					repeat = 3 + in.bits(3);
+				} else {
+					repeat = 11 + in.bits(7);
+				}
+				if (numLengths + repeat > numLengthCodes + numDistanceCodes) {
+					return false;
+				}
+				std::memset(lengths + numLengths, value, repeat);
+				numLengths += repeat;
+			}
+			if (!lengthCodes.build(lengths, numLengthCodes) ||
+				!distanceCodes.build(lengths + numLengthCodes, numDistanceCodes) ||
+				!inflateBlock(in, lengthCodes, distanceCodes, out, n)) {
+				return false;
+			}
+		} else {
+			return false;
+		}
+	} while (!isLast && !in.overrun());
+	out.resize(n);
+	return !in.overrun();
+}
+
+/**
+ * @fn	static unsigned int readBigEndian32(const unsigned char *p)
+ * @brief	Reads a 32-bit big-endian number.
+ * @param	p	The first byte.
+ * @return	The number.
+ */
+
+static unsigned int readBigEndian32(const unsigned char *p) {
+	return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
+}
+
+/**
+ * @fn	static void unfilterPNGRows(vector<unsigned char> &raw, size_t rowBytes, int height, size_t bytesPerPixel)
+ * @brief	Undoes the per-row filters of non-interlaced PNG image data, in place. Each
+ * 			row's filter type byte is left in front of the row.
+ * @param [in,out]	raw			 	The image data.
+ * @param 		  	rowBytes	 	Bytes in a row, not counting the filter type.
+ * @param 		  	height		 	Number of rows.
+ * @param 		  	bytesPerPixel	Bytes in a pixel, rounded up to 1.
+ * @return	False if a row has an unknown filter type.
+ */
+
+static bool unfilterPNGRows(vector<unsigned char> &raw, size_t rowBytes, int height, size_t bytesPerPixel) {
+	const size_t bpp = bytesPerPixel;
+	const vector<unsigned char> zeros(rowBytes, 0);
+	for (int y = 0; y < height; y++) {
+		unsigned char *row = raw.data() + (size_t)y * (rowBytes + 1);
+		const unsigned char *prior = y == 0 ? zeros.data() : row - rowBytes;
+		unsigned char *cur = row + 1;
+		switch (row[0]) {
+		case 0:
+			break;
+		case 1:
+			for (size_t i = bpp; i < rowBytes; i++) {
+				cur[i] += cur[i - bpp];
+			}
+			break;
+		case 2:
+			for (size_t i = 0; i < rowBytes; i++) {
+				cur[i] += prior[i];
+			}
+			break;
+		case 3:
+			for (size_t i = 0; i < rowBytes; i++) {
+				int left = i >= bpp ? cur[i - bpp] : 0;
+				cur[i] += (unsigned char)((left + prior[i]) / 2);
+			}
+			break;
+		case 4:
+			for (size_t i = 0; i < rowBytes; i++) {
+				int a = i >= bpp ? cur[i - bpp] : 0;
+				int b = prior[i];
+				int c = i >= bpp ? prior[i - bpp] : 0;
+				int p = a + b - c;
+				int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+				cur[i] += (unsigned char)(pa <= pb && pa <= pc ? a : (pb <= pc ? b : c));
+			}
+			break;
+		default:
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @fn	static bool loadPNG(const vector<unsigned char> &bytes, Image &im, string &problem)
+ * @brief	Decodes a non-interlaced PNG file of any color type. Gray images become
+ * 			gray colors, and alpha is ignored.
+ * @param 		  	bytes  	The file.
+ * @param [in,out]	im	   	The image.
+ * @param [out]   	problem	Why the file could not be decoded.
+ * @return	True iff the file could be decoded.
+ */
+
+static bool loadPNG(const vector<unsigned char> &bytes, Image &im, string &problem) {
+	int bitDepth = 0, colorType = -1;
+	vector<unsigned char> compressed;
+	vector<color> palette;
+	size_t pos = 8;
+	while (pos + 12 <= bytes.size()) {
+		size_t length = readBigEndian32(&bytes[pos]);
+		const unsigned char *type = &bytes[pos + 4];
+		const unsigned char *data = &bytes[pos + 8];
+		if (pos + 12 + length > bytes.size()) {
+			break;
+		}
+		if (std::memcmp(type, "IHDR", 4) == 0 && length >= 13) {
+			im.W = (int)readBigEndian32(data);
+			im.H = (int)readBigEndian32(data + 4);
+			bitDepth = data[8];
+			colorType = data[9];
+			if (data[12] != 0) {
+				problem = "interlaced PNG files are not supported";
+				return false;
+			}
+		} else if (std::memcmp(type, "PLTE", 4) == 0) {
+			for (size_t i = 0; i + 2 < length; i += 3) {
+				palette.push_back(color(data[i] / 255.0, data[i + 1] / 255.0, data[i + 2] / 255.0));
+			}
+		} else if (std::memcmp(type, "IDAT", 4) == 0) {
+			compressed.insert(compressed.end(), data, data + length);
+		} else if (std::memcmp(type, "IEND", 4) == 0) {
+			break;
+		}
+		pos += 12 + length;
+	}
+
+	int channels;
+	switch (colorType) {
+	case 0:	channels = 1; break;
+	case 2:	channels = 3; break;
+	case 3:	channels = 1; break;
+	case 4:	channels = 2; break;
+	case 6:	channels = 4; break;
+	default:
+		problem = "missing or unknown PNG header";
+		return false;
+	}
+	bool depthOK = bitDepth == 8 || bitDepth == 16 ||
+					((colorType == 0 || colorType == 3) && (bitDepth == 1 || bitDepth == 2 || bitDepth == 4));
+	if (!depthOK || !isValidImageSize(im.W, im.H) || (colorType == 3 && palette.empty())) {
+		problem = "unsupported PNG format";
+		return false;
+	}
+
+	const int bitsPerPixel = channels * bitDepth;
+	const size_t rowBytes = ((size_t)im.W * bitsPerPixel + 7) / 8;
+	vector<unsigned char> raw;
+	if (!inflateZlib(compressed, raw) || raw.size() < (rowBytes + 1) * im.H ||
+		!unfilterPNGRows(raw, rowBytes, im.H, (size_t)glm::max(1, bitsPerPixel / 8))) {
+		problem = "corrupt PNG image data";
+		return false;
+	}
+
+	vector<real> table;
+	buildSampleTable((1 << bitDepth) - 1, 1 << bitDepth, table);
+	im.pixels = new color[(size_t)im.W * im.H];
 	color *p = im.pixels;
-	for (int row = 0; row < im.H; row++) {
-		for (int col = 0; col < im.W; col++, p++) {
-			int r, g, b;
-			r = getNextChar(input, buffer);
-			g = getNextChar(input, buffer);
-			b = getNextChar(input, buffer);
-			double R = map((double)r, 0.0, (double)maxValue, 0.0, 1.0);
-			double G = map((double)g, 0.0, (double)maxValue, 0.0, 1.0);
-			double B = map((double)b, 0.0, (double)maxValue, 0.0, 1.0);
-			*p = color(R, G, B);
+	for (int y = 0; y < im.H; y++) {
+		const unsigned char *row = raw.data() + (size_t)y * (rowBytes + 1) + 1;
+		if (bitDepth == 8 && colorType == 2) {
+			for (int x = 0; x < im.W; x++, row += 3) {
+				*p++ = color(table[row[0]], table[row[1]], table[row[2]]);
+			}
+			continue;
+		}
+		for (int x = 0; x < im.W; x++) {
+			int sample[4];
+			for (int c = 0; c < channels; c++) {
+				int index = x * channels + c;
+				if (bitDepth == 16) {
+					sample[c] = (row[2 * index] << 8) | row[2 * index + 1];
+				} else if (bitDepth == 8) {
+					sample[c] = row[index];
+				} else {
+					int bit = index * bitDepth;
+					sample[c] = (row[bit / 8] >> (8 - bitDepth - bit % 8)) & ((1 << bitDepth) - 1);
+				}
+			}
+			if (colorType == 3) {
+				*p++ = sample[0] < (int)palette.size() ? palette[sample[0]] : black;
+			} else if (channels < 3) {
+				*p++ = color(table[sample[0]], table[sample[0]], table[sample[0]]);
+			} else {
+				*p++ = color(table[sample[0]], table[sample[1]], table[sample[2]]);
+			}
 		}
 	}
+	return true;
 }
 
 /**
- * @fn	Image::Image(char *ppmFileName)
- * @brief	Constructs and image given the name of a PPM file. The file must be
- * 			P3 or P6.
- * @param [in,out]	ppmFileName	Filename of the ppm file.
+ * @fn	Image::Image(std::string fileName)
+ * @brief	Constructs an image from a PPM (P3 or P6, 8 or 16 bit) or PNG file. The
+ * 			format is determined from the file's contents. The file is read with a
+ * 			single bulk read and its samples converted through a lookup table.
+ * @param	fileName	Name of the image file.
  */
 
-Image::Image(std::string ppmFileName) : W(0), H(0) {
-	const int N = 100;
-	char buf1[N + 1];
-	char buf2[N + 1];
-    std::ifstream input(ppmFileName.c_str(), std::ios::binary);
-	input.getline(buf1, N);
-	int type = 3;
-	pixels = nullptr;
-
-	while (input.peek() == '#') {
-		input.getline(buf2, N);
-	}
-	string header(buf1);
-	header = header.substr(0, 2);
-	if (header == "P3") {
-		p3(input, *this);
-	} else if (header == "P6") {
-		p6(input, *this);
-	} else {
-		std::cerr << "Problem with PPM file: " << ppmFileName << "(" << header << ")" << endl;
+Image::Image(std::string fileName) : W(0), H(0), pixels(nullptr) {
+	vector<unsigned char> bytes;
+	if (!readFile(fileName, bytes)) {
+		std::cerr << "Could not read image file: " << fileName << endl;
 		return;
 	}
 
-	input.close();
+	const unsigned char PNG_SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	bool loaded;
+	string problem;
+	try {
+		if (bytes.size() >= 8 && std::memcmp(bytes.data(), PNG_SIGNATURE, 8) == 0) {
+			loaded = loadPNG(bytes, *this, problem);
+		} else {
+			loaded = loadPPM(bytes, *this);
+			problem = "not a valid P3 or P6 file";
+		}
+	} catch (const std::bad_alloc &) {
+		loaded = false;
+		problem = "not enough memory";
+	}
+	if (!loaded) {
+		std::cerr << "Problem with image file: " << fileName << " (" << problem << ")" << endl;
+		delete[] pixels;
+		pixels = nullptr;
+		W = H = 0;
+	}
 }
 
 /**
- * @fn	color Image::getPixelUV(double u, double v) const
+ * @fn	color Image::getPixelUV(real u, real v) const
  * @brief	Gets the color that corresponds to the coordinate (u, v). This is
  * 			done by finding the texel whose center is closest to (u, v). In the
  * 			event of a tie, picks one of these.
@@ -112,7 +676,7 @@ Image::Image(std::string ppmFileName) : W(0), H(0) {
  * @return	The color corresponding to the position (u, v).
  */
 
-color Image::getPixelUV(double u, double v) const {
+color Image::getPixelUV(real u, real v) const {
 	int x = glm::clamp((int)(W * u), 0, W-1);
 	int y = glm::clamp((int)(H * v), 0, H-1);
 	return pixels[y * W + x];
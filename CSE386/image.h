@@ -14,13 +14,14 @@
 
 /**
  * @struct	Image
- * @brief	Represents a rectangular RGB image.
+ * @brief	Represents a rectangular RGB image, loaded from a PPM or PNG file. If the
+ * 			file cannot be loaded, W and H are 0 and pixels is nullptr.
  */
 
 struct Image {
 	int W, H;
 	color *pixels;
-	Image(std::string ppmFileName);
+	Image(std::string fileName);
 	~Image() { delete[] pixels; }
-	color getPixelUV(double u, double v) const;
+	color getPixelUV(real u, real v) const;
 };
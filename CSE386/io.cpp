@@ -15,23 +15,23 @@ char nextChar(istream& is) {
 	return is.peek();
 }
 
-bool ae(double a, double b) {
+bool ae(real a, real b) {
 	return glm::abs(a - b) <= 0.01;
 }
-bool ave(const dvec2& v1, const dvec2& v2) {
+bool ave(const rvec2& v1, const rvec2& v2) {
 	return ae(v1.x, v2.x) && ae(v1.y, v2.y);
 }
-bool ave(const dvec3& v1, const dvec3& v2) {
+bool ave(const rvec3& v1, const rvec3& v2) {
 	return ae(v1.x, v2.x) && ae(v1.y, v2.y) && ae(v1.z, v2.z);
 }
 
-bool equal(double a, double b) { return ae(a, b); }
+bool equal(real a, real b) { return ae(a, b); }
 bool equal(int a, int b) { return a == b; }
 bool equal(bool a, bool b) { return a == b; }
-bool equal(dvec2 a, dvec2 b) { return ave(a, b); }
+bool equal(rvec2 a, rvec2 b) { return ave(a, b); }
 bool equal(const glm::ivec2& a, const glm::ivec2& b) { return a == b; }
 bool equal(const glm::ivec3& a, const glm::ivec3& b) { return a == b; }
-bool equal(const dvec3& a, const dvec3& b) { return ave(a, b); }
+bool equal(const rvec3& a, const rvec3& b) { return ave(a, b); }
 
 ostream& operator << (ostream& os, const Material& mat) {
 	os << mat.ambient << ' ' << mat.diffuse << ' ' << mat.specular << ' ' << mat.shininess;
@@ -84,12 +84,12 @@ istream& operator >> (std::istream& is, LightColor& L) {
 */
 
 ostream& operator << (ostream& os, const LightATParams& at) {
-	os << dvec3(at.constant, at.linear, at.quadratic);
+	os << rvec3(at.constant, at.linear, at.quadratic);
 	return os;
 }
 
 istream& operator >> (std::istream& is, LightATParams& params) {
-	dvec3 atParams;
+	rvec3 atParams;
 	is >> atParams;
 	params.constant = atParams[0];
 	params.linear = atParams[1];
@@ -97,7 +97,7 @@ istream& operator >> (std::istream& is, LightATParams& params) {
 	return is;
 }
 
-bool equal(const dmat4& a, const dmat4& b) {
+bool equal(const rmat4& a, const rmat4& b) {
 	for (int r = 0; r < 4; r++)
 		for (int c = 0; c < 4; c++)
 			if (!ae(a[c][r], b[c][r]))
@@ -105,31 +105,31 @@ bool equal(const dmat4& a, const dmat4& b) {
 	return true;
 }
 /**
-* @fn	ostream &operator << (ostream &os, const dvec2 &V)
+* @fn	ostream &operator << (ostream &os, const rvec2 &V)
 * @brief	Output stream for vec2.
 * @param	os		Output stream.
 * @param	V		The vector.
 */
 
-ostream& operator << (ostream& os, const dvec2& V) {
+ostream& operator << (ostream& os, const rvec2& V) {
 	os << "[ " << V.x << " " << V.y << " ]";
 	return os;
 }
 
 /**
-* @fn	ostream &operator << (ostream &os, const dvec3 &V)
+* @fn	ostream &operator << (ostream &os, const rvec3 &V)
 * @brief	Output stream for vec3.
 * @param	os		Output stream.
 * @param	V		The vector.
 */
 
-ostream& operator << (ostream& os, const dvec3& V) {
+ostream& operator << (ostream& os, const rvec3& V) {
 	os << std::setprecision(10);
 	os << "[ " << V.x << " " << V.y << " " << V.z << " ]";
 	return os;
 }
 
-bool equal(const vector<dvec3>& v1, const vector<dvec3>& v2) {
+bool equal(const vector<rvec3>& v1, const vector<rvec3>& v2) {
 	if (v1.size() != v2.size())
 		return false;
 	for (int i = 0; i < v1.size(); i++) {
@@ -149,54 +149,54 @@ ostream& operator << (ostream& os, const glm::ivec2& V) {
 	return os;
 }
 
-istream& operator >> (istream& is, dvec2& V) {
+istream& operator >> (istream& is, rvec2& V) {
 	char ch;
 	is >> ch >> V.x >> V.y >> ch;
 	return is;
 }
-istream& operator >> (istream& is, dvec3& V) {
+istream& operator >> (istream& is, rvec3& V) {
 	char ch;
 	is >> ch >> V.x >> V.y >> V.z >> ch;
 	return is;
 }
-istream& operator >> (istream& is, dvec4& V) {
+istream& operator >> (istream& is, rvec4& V) {
 	char ch;
 	is >> ch >> V.x >> V.y >> V.z >> V.w >> ch;
 	return is;
 }
 
 /**
-* @fn	ostream &operator << (ostream &os, const dvec4 &V)
+* @fn	ostream &operator << (ostream &os, const rvec4 &V)
 * @brief	Output stream for vec4.
 * @param	os		Output stream.
 * @param	V		The vector.
 */
 
-ostream& operator << (ostream& os, const dvec4& V) {
+ostream& operator << (ostream& os, const rvec4& V) {
 	os << "[ " << V.x << " " << V.y << " " << V.z << " " << V.w << " ]";
 	return os;
 }
 
 /**
-* @fn	ostream &operator << (ostream &os, const dmat3 &M)
+* @fn	ostream &operator << (ostream &os, const rmat3 &M)
 * @brief	Output stream for mat3.
 * @param	os		Output stream.
 * @param	M		The matrix.
 */
 
-ostream& operator << (ostream& os, const dmat2& M) {
+ostream& operator << (ostream& os, const rmat2& M) {
 	const int N = 2;
 	os << "[ ";
 	for (int row = 0; row < N; row++) {
-		os << dvec2(M[0][row], M[1][row]) << endl;
+		os << rvec2(M[0][row], M[1][row]) << endl;
 	}
 	os << "] ";
 	return os;
 }
 
-istream& operator >> (istream& is, dmat2& M) {
+istream& operator >> (istream& is, rmat2& M) {
 	const int N = 2;
-	dvec3 R[N];
+	rvec3 R[N];
 	char ch1, ch2;
 	is >> ch1 >> R[0] >> R[1] >> ch2;
 	for (int row = 0; row < N; row++) {
@@ -208,25 +208,25 @@ istream& operator >> (istream& is, dmat2& M) {
 }
 
 /**
-* @fn	ostream &operator << (ostream &os, const dmat3 &M)
+* @fn	ostream &operator << (ostream &os, const rmat3 &M)
 * @brief	Output stream for mat3.
 * @param	os		Output stream.
 * @param	M		The matrix.
 */
 
-ostream& operator << (ostream& os, const dmat3& M) {
+ostream& operator << (ostream& os, const rmat3& M) {
 	const int N = 3;
 	os << "[ ";
 	for (int row = 0; row < N; row++) {
-		os << dvec3(M[0][row], M[1][row], M[2][row]) << endl;
+		os << rvec3(M[0][row], M[1][row], M[2][row]) << endl;
 	}
 	os << "] ";
 	return os;
 }
 
-istream& operator >> (istream& is, dmat3& M) {
+istream& operator >> (istream& is, rmat3& M) {
 	const int N = 3;
-	dvec3 R[N];
+	rvec3 R[N];
 	char ch1, ch2;
 	is >> ch1 >> R[0] >> R[1] >> R[2] >> ch2;
 	for (int row = 0; row < N; row++) {
@@ -238,25 +238,25 @@ istream& operator >> (istream& is, dmat3& M) {
 }
 
 /**
-* @fn	ostream &operator << (ostream &os, const dmat4 &M)
+* @fn	ostream &operator << (ostream &os, const rmat4 &M)
 * @brief	Output stream for mat4.
 * @param	os		Output stream.
 * @param	M		The matrix.
 */
 
-ostream& operator << (ostream& os, const dmat4& M) {
+ostream& operator << (ostream& os, const rmat4& M) {
 	const int N = 4;
 	os << "[ ";
 	for (int row = 0; row < N; row++) {
-		os << dvec4(M[0][row], M[1][row], M[2][row], M[3][row]) << endl;
+		os << rvec4(M[0][row], M[1][row], M[2][row], M[3][row]) << endl;
 	}
 	os << "] ";
 	return os;
 }
 
-istream& operator >> (istream& is, dmat4& M) {
+istream& operator >> (istream& is, rmat4& M) {
 	const int N = 4;
-	dvec4 R[N];
+	rvec4 R[N];
 	char ch1, ch2;
 	is >> ch1 >> R[0] >> R[1] >> R[2] >> R[3] >> ch2;
 	for (int row = 0; row < N; row++) {
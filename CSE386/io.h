@@ -11,23 +11,23 @@
 
 std::string getLine(std::istream& in);
 
-bool ae(double a, double b);
-bool ave(const dvec2& v1, const dvec2& v2);
-bool ave(const dvec3& v1, const dvec3& v2);
+bool ae(real a, real b);
+bool ave(const rvec2& v1, const rvec2& v2);
+bool ave(const rvec3& v1, const rvec3& v2);
 
-bool equal(double a, double b);
+bool equal(real a, real b);
 
 bool equal(int a, int b);
 
 bool equal(bool a, bool b);
 
-bool equal(dvec2 a, dvec2 b);
+bool equal(rvec2 a, rvec2 b);
 
 bool equal(const glm::ivec2& a, const glm::ivec2& b);
 
 bool equal(const glm::ivec3& a, const glm::ivec3& b);
 
-bool equal(const dvec3& a, const dvec3& b);
+bool equal(const rvec3& a, const rvec3& b);
 
 ostream& operator << (ostream& os, const Material& mat);
 istream& operator >> (std::istream& is, Material& mat);
@@ -53,28 +53,28 @@ bool ave(const vector<T>& v1, const vector<T>& v2) {
 	return true;
 }
 
-bool equal(const vector<dvec3>&, const vector<dvec3>&);
+bool equal(const vector<rvec3>&, const vector<rvec3>&);
 
 char nextChar(istream& is);
 
-bool equal(const dmat4& a, const dmat4& b);
+bool equal(const rmat4& a, const rmat4& b);
 
 // Simple streaming for vectors and matrices.
 istream& operator >> (istream& os, glm::ivec2& V);
 ostream& operator << (ostream& os, const glm::ivec2& V);
-istream& operator >> (istream& os, dvec2& V);
-ostream& operator << (ostream& os, const dvec2& v);
-
-ostream& operator << (ostream& os, const dvec3& v);
-istream& operator >> (istream& os, dvec3& V);
-istream& operator >> (istream& os, dvec4& V);
-
-ostream& operator << (ostream& os, const dvec4& v);
-ostream& operator << (ostream& os, const dmat2& v);
-ostream& operator << (ostream& os, const dmat3& v);
-istream& operator >> (istream& is, dmat3& v);
-ostream& operator << (ostream& os, const dmat4& v);
-istream& operator >> (istream& is, dmat4& v);
+istream& operator >> (istream& os, rvec2& V);
+ostream& operator << (ostream& os, const rvec2& v);
+
+ostream& operator << (ostream& os, const rvec3& v);
+istream& operator >> (istream& os, rvec3& V);
+istream& operator >> (istream& os, rvec4& V);
+
+ostream& operator << (ostream& os, const rvec4& v);
+ostream& operator << (ostream& os, const rmat2& v);
+ostream& operator << (ostream& os, const rmat3& v);
+istream& operator >> (istream& is, rmat3& v);
+ostream& operator << (ostream& os, const rmat4& v);
+istream& operator >> (istream& is, rmat4& v);
 
 template <class T>
 ostream& operator << (ostream& os, const vector<T>& V) {
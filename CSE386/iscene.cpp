@@ -15,10 +15,23 @@
  * @param [in,out]	theCamera	The camera to use.
  */
 
-IScene::IScene(RaytracingCamera *theCamera) {
+IScene::IScene(RaytracingCamera *theCamera)
+	: opaqueBVH(opaqueObjs), transparentBVH(transparentObjs) {
 	camera = theCamera;
 }
 
+/**
+ * @fn	void IScene::finalize()
+ * @brief	Builds the bounding volume hierarchies over the opaque and transparent
+ * 			objects. Call once the scene is built, and again after moving any object.
+ * 			Until then, rays are tested against every object.
+ */
+
+void IScene::finalize() {
+	opaqueBVH.build();
+	transparentBVH.build();
+}
+
 /**
  * @fn	void IScene::addOpaqueObject(const VisibleIShapePtr obj)
  * @brief	Adds an visible object to the scene
@@ -30,13 +43,13 @@ void IScene::addOpaqueObject(const VisibleIShapePtr obj) {
 }
 
 /**
- * @fn	void IScene::addTransparentObject(const VisibleIShapePtr obj, double alpha)
+ * @fn	void IScene::addTransparentObject(const VisibleIShapePtr obj, real alpha)
  * @brief	Adds a transparent object to the scene
  * @param	obj  	The transparent object to be added.
  * @param	alpha	The alpha value of the object.
  */
 
-void IScene::addTransparentObject(const VisibleIShapePtr obj, double alpha) {
+void IScene::addTransparentObject(const VisibleIShapePtr obj, real alpha) {
 	obj->material.alpha = alpha;
 	transparentObjs.push_back(obj);
 }
@@ -16,6 +16,7 @@
 #include "light.h"
 #include "eshape.h"
 #include "ishape.h"
+#include "bvh.h"
 
 /**
  * @struct	IScene
@@ -26,9 +27,15 @@ struct IScene {
 	vector<PositionalLightPtr> lights;				//!< All the positional lights in the scene
 	vector<VisibleIShapePtr> opaqueObjs;			//!< All the visible objects in the scene
 	vector<VisibleIShapePtr> transparentObjs;		//!< All the transparent objects in the scene
+	BVH opaqueBVH;									//!< Hierarchy over opaqueObjs
+	BVH transparentBVH;								//!< Hierarchy over transparentObjs
 	RaytracingCamera *camera;						//!< The one camera in the scene
 	IScene(RaytracingCamera *theCamera);
+	// Not copyable: a copy's BVHs would still refer to this scene's object lists.
+	IScene(const IScene &) = delete;
+	IScene &operator=(const IScene &) = delete;
+	void finalize();
 	void addOpaqueObject(const VisibleIShapePtr obj);
-	void addTransparentObject(const VisibleIShapePtr obj, double alpha);
+	void addTransparentObject(const VisibleIShapePtr obj, real alpha);
 	void addLight(const PositionalLightPtr light);
 };
@@ -20,7 +20,7 @@ IShape::IShape() {
 }
 
 /**
- * @fn	void IShape::getTexCoords(const dvec3 &pt, double &u, double &v) const
+ * @fn	void IShape::getTexCoords(const rvec3 &pt, real &u, real &v) const
  * @brief	Computes the tex coordinate of a point on the surface. The default
  * 			return value is (0, 0)
  * @param 		  	pt	The coordinate to process
@@ -28,32 +28,174 @@ IShape::IShape() {
  * @param [in,out]	v 	The v, in (u, v).
  */
 
-void IShape::getTexCoords(const dvec3 &pt, double &u, double &v) const {
+void IShape::getTexCoords(const rvec3 &pt, real &u, real &v) const {
 	u = v = 0;
 }
 
 /**
- * @fn	dvec3 IShape::movePointOffSurface(const dvec3 &pt, const dvec3 &n)
+ * @fn	bool IShape::occludes(const Ray &ray, real tMax) const
+ * @brief	Determines if the ray hits the shape somewhere before tMax. Used for
+ * 			shadow feelers, which do not need to know what was hit or where.
+ * 			Subclasses override this to skip computing the intercept and normal.
+ * @param	ray 	The ray.
+ * @param	tMax	Hits at or beyond this distance are ignored.
+ * @return	True iff the ray hits the shape at some t in [0, tMax).
+ */
+
+bool IShape::occludes(const Ray &ray, real tMax) const {
+	HitRecord hit;
+	findClosestIntersection(ray, hit);
+	return hit.t < tMax;
+}
+
+/**
+ * @fn	void IShape::findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const
+ * @brief	Finds, for every ray in the packet, the t value of the closest intersection.
+ * 			The default intersects the rays one at a time. Subclasses override this
+ * 			with a kernel that handles the whole packet at once. Either way, the t
+ * 			values are exactly those findClosestIntersection would produce.
+ * @param 		  	packet	The rays.
+ * @param [in,out]	t	  	The t values; FLT_MAX where a ray misses.
+ */
+
+void IShape::findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const {
+	for (int i = 0; i < PACKET_SIZE; i++) {
+		HitRecord hit;
+		findClosestIntersection(packet.rays[i], hit);
+		t[i] = hit.t;
+	}
+}
+
+/**
+ * @fn	rvec3 IShape::movePointOffSurface(const rvec3 &pt, const rvec3 &n)
  * @brief	Compute point that is slightly off surface.
  * @param	pt	Intersection point.
  * @param	n 	Normal vector at pt.
  * @return	The point that is approximately EPSILON off the surface.
  */
 
-dvec3 IShape::movePointOffSurface(const dvec3 &pt, const dvec3 &n) {
+rvec3 IShape::movePointOffSurface(const rvec3 &pt, const rvec3 &n) {
 	return pt + EPSILON * n;
 }
 
 /**
- * @fn	VisibleIShape::VisibleIShape(IShapePtr shapePtr, const Material &mat)
+ * @fn	bool IShape::getBoundingBox(AABB &box) const
+ * @brief	Computes an axis-aligned box enclosing the shape. The default is to
+ * 			report the shape as unbounded.
+ * @param [in,out]	box	The bounding box, if there is one.
+ * @return	True iff the shape is bounded.
+ */
+
+bool IShape::getBoundingBox(AABB & /*box*/) const {
+	return false;
+}
+
+/**
+ * @fn	RayPacket::RayPacket(const Ray rays[PACKET_SIZE])
+ * @brief	Gathers PACKET_SIZE rays into a packet.
+ * @param	rays	The rays. The packet refers to this array.
+ */
+
+RayPacket::RayPacket(const Ray rays[PACKET_SIZE])
+	: rays(rays) {
+	for (int i = 0; i < PACKET_SIZE; i++) {
+		ox[i] = rays[i].origin.x;
+		oy[i] = rays[i].origin.y;
+		oz[i] = rays[i].origin.z;
+		dx[i] = rays[i].dir.x;
+		dy[i] = rays[i].dir.y;
+		dz[i] = rays[i].dir.z;
+	}
+}
+
+/**
+ * @fn	bool RayPacket::isCoherent() const
+ * @brief	Determines if the rays all travel into the same octant. Packets of
+ * 			primary rays through neighboring pixels nearly always do. When they
+ * 			do not, the rays are better traced one at a time.
+ * @return	True iff the signs of the direction components agree across the packet.
+ */
+
+bool RayPacket::isCoherent() const {
+	for (int i = 1; i < PACKET_SIZE; i++) {
+		if ((dx[i] < 0) != (dx[0] < 0) || (dy[i] < 0) != (dy[0] < 0) || (dz[i] < 0) != (dz[0] < 0)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @fn	AABB::AABB()
+ * @brief	Constructs an empty box.
+ */
+
+AABB::AABB()
+	: lo(FLT_MAX, FLT_MAX, FLT_MAX), hi(-FLT_MAX, -FLT_MAX, -FLT_MAX) {
+}
+
+/**
+ * @fn	AABB::AABB(const rvec3 &lo, const rvec3 &hi)
+ * @brief	Constructs a box from two opposite corners.
+ * @param	lo	Corner with the smallest coordinates.
+ * @param	hi	Corner with the largest coordinates.
+ */
+
+AABB::AABB(const rvec3 &lo, const rvec3 &hi)
+	: lo(lo), hi(hi) {
+}
+
+/**
+ * @fn	void AABB::expand(const AABB &other)
+ * @brief	Grows this box so that it also encloses other.
+ * @param	other	The box to enclose.
+ */
+
+void AABB::expand(const AABB &other) {
+	lo = glm::min(lo, other.lo);
+	hi = glm::max(hi, other.hi);
+}
+
+/**
+ * @fn	bool AABB::intersects(const Ray &ray, const rvec3 &invDir, real tMax, real &tEntry) const
+ * @brief	Slab test. Determines if the ray passes through the box somewhere in [0, tMax].
+ * @param 		  	ray   	The ray.
+ * @param 		  	invDir	1 / ray.dir, computed once per ray.
+ * @param 		  	tMax  	Intersections further than this are of no interest.
+ * @param [in,out]	tEntry	The t value where the ray enters the box (0 if it starts inside).
+ * @return	True iff the ray passes through the box in [0, tMax].
+ */
+
+bool AABB::intersects(const Ray &ray, const rvec3 &invDir, real tMax, real &tEntry) const {
+	real tNear = 0.0;
+	real tFar = tMax;
+	for (int i = 0; i < 3; i++) {
+		real t1 = (lo[i] - ray.origin[i]) * invDir[i];
+		real t2 = (hi[i] - ray.origin[i]) * invDir[i];
+		if (t1 > t2) {
+			std::swap(t1, t2);
+		}
+		tNear = t1 > tNear ? t1 : tNear;
+		tFar = t2 < tFar ? t2 : tFar;
+		if (tNear > tFar) {
+			return false;
+		}
+	}
+	tEntry = tNear;
+	return true;
+}
+
+/**
+ * @fn	VisibleIShape::VisibleIShape(IShapePtr shapePtr, const Material &mat, TexturePtr tex)
  * @brief	Represents an visible, implicit shape.
  * @param	shapePtr	Pointer to the implicit shape.
  * @param	mat			Material
+ * @param	tex			Texture, if any, shared with any other shapes using it.
  */
 
-VisibleIShape::VisibleIShape(IShapePtr shapePtr, const Material &mat, Image *image)
+VisibleIShape::VisibleIShape(IShapePtr shapePtr, const Material &mat, TexturePtr tex)
 	: material(mat), shape(shapePtr) {
-	texture = image;
+	texture = tex;
 }
 
 /**
@@ -82,13 +224,44 @@ void VisibleIShape::findClosestIntersection(const Ray &ray, HitRecord &hit) cons
 
 		hit.material = material;
 
-		hit.texture = texture;
+		hit.texture = texture.get();
 		if (hit.texture != nullptr) {
 			shape->getTexCoords(hit.interceptPt, hit.u, hit.v);
+			hit.uvPerUnit = getTexCoordRate(hit.interceptPt, hit.normal, hit.u, hit.v);
 		}
 	}
 }
 
+/**
+ * @fn	real VisibleIShape::getTexCoordRate(const rvec3 &pt, const rvec3 &n, real u, real v) const
+ * @brief	Estimates how fast the texture coordinates change across the surface, by
+ * 			stepping a short distance along two tangents. Differences are taken
+ * 			modulo 1, so a step across the seam of a wrapped parameterization does
+ * 			not count as a jump across the whole texture.
+ * @param	pt	The point on the surface.
+ * @param	n 	The normal at pt.
+ * @param	u 	The u in the (u, v) texture coordinates of pt.
+ * @param	v 	The v in the (u, v) texture coordinates of pt.
+ * @return	The larger of the two rates, in (u, v) units per unit of distance.
+ */
+
+real VisibleIShape::getTexCoordRate(const rvec3 &pt, const rvec3 &n, real u, real v) const {
+	const real STEP = 1.0E-3;
+	rvec3 t1 = glm::normalize(glm::cross(n, std::abs(n.x) < 0.9 ? X_AXIS : Y_AXIS));
+	rvec3 t2 = glm::cross(n, t1);
+	real rate = 0;
+	for (const rvec3 &t : { t1, t2 }) {
+		real u2, v2;
+		shape->getTexCoords(pt + STEP * t, u2, v2);
+		real du = u2 - u;
+		real dv = v2 - v;
+		du -= std::round(du);
+		dv -= std::round(dv);
+		rate = std::max(rate, std::sqrt(du * du + dv * dv) / STEP);
+	}
+	return rate;
+}
+
 /**
  * @fn	HitRecord VisibleIShape::findIntersection(const Ray &ray, const vector<VisibleIShapePtr> &surfaces)
  * @brief	Searches for the first intersection
@@ -115,6 +288,31 @@ void VisibleIShape::findIntersection(const Ray &ray, const vector<VisibleIShapeP
 	}
 }
 
+/**
+ * @fn	bool VisibleIShape::findAnyIntersection(const Ray &ray, const vector<VisibleIShapePtr> &surfaces,
+ *												real tMax, VisibleIShapePtr *blocker)
+ * @brief	Determines if the ray hits any of the surfaces before tMax. Stops at the
+ * 			first blocker found, which need not be the closest one.
+ * @param	ray			   	The ray.
+ * @param	surfaces	   	The surfaces in the scene.
+ * @param	tMax		   	Hits at or beyond this distance are ignored.
+ * @param [out]	blocker	If not nullptr, receives the surface that was hit.
+ * @return	True iff some surface is hit at some t in [0, tMax).
+ */
+
+bool VisibleIShape::findAnyIntersection(const Ray &ray, const vector<VisibleIShapePtr> &surfaces,
+											real tMax, VisibleIShapePtr *blocker) {
+	for (unsigned int i = 0; i < surfaces.size(); i++) {
+		if (surfaces[i]->occludes(ray, tMax)) {
+			if (blocker != nullptr) {
+				*blocker = surfaces[i];
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
 /**
  * @fn	IDisk::IDisk()
  * @brief	Implicit representation of an implicit disk. Create a unit circle, centered
@@ -126,14 +324,14 @@ IDisk::IDisk()
 }
 
 /**
- * @fn	IDisk::IDisk(const dvec3 &pos, const dvec3 &normal, double rad)
+ * @fn	IDisk::IDisk(const rvec3 &pos, const rvec3 &normal, real rad)
  * @brief	Implicit representation of an implicit disk.
  * @param	pos   	Center of disk.
  * @param	normal	Normal vector of disk.
  * @param	rad   	Radius of disk.
  */
 
-IDisk::IDisk(const dvec3 &pos, const dvec3 &normal, double rad)
+IDisk::IDisk(const rvec3 &pos, const rvec3 &normal, real rad)
 	: IShape(), center(pos), n(normal), radius(rad) {
 }
 
@@ -160,72 +358,139 @@ void IDisk::findClosestIntersection(const Ray &ray, HitRecord &hit) const {
 }
 
 /**
- * @fn	void IDisk::getTexCoords(const dvec3& pt, double& u, double& v) const
+ * @fn	bool IDisk::occludes(const Ray &ray, real tMax) const
+ * @brief	Determines if the ray hits the disk before tMax.
+ * @param	ray 	The ray.
+ * @param	tMax	Hits at or beyond this distance are ignored.
+ * @return	True iff the ray hits the disk at some t in [0, tMax).
+ */
+
+bool IDisk::occludes(const Ray &ray, real tMax) const {
+	IPlane plane(center, n);
+	real denom = glm::dot(ray.dir, plane.n);
+	if (denom == 0) {
+		return false;
+	}
+	real t = glm::dot(-plane.n, ray.origin - plane.a) / denom;
+	return t >= 0 && t < tMax && glm::distance(ray.origin + ray.dir*t, center) <= radius;
+}
+
+/**
+ * @fn	void IDisk::findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const
+ * @brief	Packet version of findClosestIntersection.
+ * @param 		  	packet	The rays.
+ * @param [in,out]	t	  	The t values; FLT_MAX where a ray misses.
+ */
+
+void IDisk::findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const {
+	IPlane plane(center, n);
+	plane.findPacketIntersections(packet, t);
+	for (int i = 0; i < PACKET_SIZE; i++) {
+		real x = center.x - (packet.ox[i] + packet.dx[i] * t[i]);
+		real y = center.y - (packet.oy[i] + packet.dy[i] * t[i]);
+		real z = center.z - (packet.oz[i] + packet.dz[i] * t[i]);
+		if (t[i] != FLT_MAX && std::sqrt(x * x + y * y + z * z) > radius) {
+			t[i] = FLT_MAX;
+		}
+	}
+}
+
+/**
+ * @fn	void IDisk::getTexCoords(const rvec3& pt, real& u, real& v) const
  * @brief	Determines the tex coords for a surface coordinate (x, y, z)
  * @param 		  	pt	The surface point
  * @param [in,out]	u	The U coordinate
  * @param [in,out]	v	The V coordinate
  */
 
-void IDisk::getTexCoords(const dvec3& pt, double& u, double& v) const {
+void IDisk::getTexCoords(const rvec3& pt, real& u, real& v) const {
 	u = map(pt.x, center.x - radius, center.x + radius, 0.0, 1.0);
 	v = map(pt.y, center.y - radius, center.y + radius, 0.0, 1.0);
 	v = 1.0 - v;
 }
 
 /**
- * @fn	ISphere::ISphere(const dvec3 & position, double radius)
+ * @fn	bool IDisk::getBoundingBox(AABB &box) const
+ * @brief	Computes the axis-aligned box enclosing the disk.
+ * @param [in,out]	box	The bounding box.
+ * @return	True, since disks are bounded.
+ */
+
+bool IDisk::getBoundingBox(AABB &box) const {
+	rvec3 N = glm::normalize(n);
+	rvec3 extent(radius * std::sqrt(glm::max(0.0, 1.0 - N.x * N.x)),
+				radius * std::sqrt(glm::max(0.0, 1.0 - N.y * N.y)),
+				radius * std::sqrt(glm::max(0.0, 1.0 - N.z * N.z)));
+	box = AABB(center - extent, center + extent);
+	return true;
+}
+
+/**
+ * @fn	ISphere::ISphere(const rvec3 & position, real radius)
  * @brief	Implicit representation of a 3D sphere.
  * @param	position	The center of the sphere.
  * @param	radius  	The radius of the sphere.
  */
 
-ISphere::ISphere(const dvec3 &position, double radius)
+ISphere::ISphere(const rvec3 &position, real radius)
 	: IQuadricSurface(QuadricParameters::sphereQParams(radius), position) {
 }
 
 /**
- * @fn	void ISphere::getTexCoords(const dvec3 &pt, double &u, double &v) const
+ * @fn	void ISphere::getTexCoords(const rvec3 &pt, real &u, real &v) const
  * @brief	Gets texture coordinates for a point on the surface.
  * @param 		  	pt	The point on the surface.
  * @param [in,out]	u 	The u in the (u, v) texture coordinates.
  * @param [in,out]	v 	The v in the (u, v) texture coordinates.
  */
 
-void ISphere::getTexCoords(const dvec3 &pt, double &u, double &v) const {
-	double az, el;
-	double R;
-	dvec3 delta = pt - center;
+void ISphere::getTexCoords(const rvec3 &pt, real &u, real &v) const {
+	real az, el;
+	real R;
+	rvec3 delta = pt - center;
 	computeAzimuthAndElevationFromXYZ(delta, R, az, el);
 	u = map(az, -PI, PI, 0.0, 1.0);
 	v = 1.0 - map(el, -PI_2, PI_2, 0.0, 1.0);
 }
 
+/**
+ * @fn	bool ISphere::getBoundingBox(AABB &box) const
+ * @brief	Computes the axis-aligned box enclosing the sphere.
+ * @param [in,out]	box	The bounding box.
+ * @return	True, since spheres are bounded.
+ */
+
+bool ISphere::getBoundingBox(AABB &box) const {
+	real R = std::sqrt(-qParams.J);
+	box = AABB(center - rvec3(R, R, R), center + rvec3(R, R, R));
+	return true;
+}
+
 /**
  * @fn	QuadricParameters::QuadricParameters()
  * @brief	Default constructor
  */
 
 QuadricParameters::QuadricParameters()
-	: QuadricParameters(vector<double> {1, 1, 1, 0, 0, 0, 0, 0, 0, -1}) {
+	: QuadricParameters(vector<real> {1, 1, 1, 0, 0, 0, 0, 0, 0, -1}) {
 }
 
 /**
- * @fn	QuadricParameters::QuadricParameters(const vector<double> &items)
+ * @fn	QuadricParameters::QuadricParameters(const vector<real> &items)
  * @brief	Constructor using 10 values.
  * @param	items	The items.
  */
 
-QuadricParameters::QuadricParameters(const vector<double> &items)
+QuadricParameters::QuadricParameters(const vector<real> &items)
 			: A(items[0]), B(items[1]), C(items[2]), D(items[3]),
 				E(items[4]), F(items[5]), G(items[6]), H(items[7]),
 				I(items[8]), J(items[9]) {
 }
 
 /**
- * @fn	QuadricParameters::QuadricParameters(double a, double b, double c, double d, 
- *											double e, double , double g, double h, double i, 
- *											double j)
+ * @fn	QuadricParameters::QuadricParameters(real a, real b, real c, real d, 
+ *											real e, real , real g, real h, real i, 
+ *											real j)
  * @brief	Constructor
  * @param	a	Quadric parameter A.
  * @param	b	Quadric parameter B.
@@ -239,102 +504,102 @@ QuadricParameters::QuadricParameters(const vector<double> &items)
  * @param	j	Quadric parameter J.
  */
 
-QuadricParameters::QuadricParameters(double a, double b, double c, double d, double e, double f,
-									double g, double h, double i, double j)
-				: QuadricParameters(vector<double> {a, b, c, d, e, f, g, h, i, j}) {
+QuadricParameters::QuadricParameters(real a, real b, real c, real d, real e, real f,
+									real g, real h, real i, real j)
+				: QuadricParameters(vector<real> {a, b, c, d, e, f, g, h, i, j}) {
 }
 
 /**
- * @fn	QuadricParameters QuadricParameters::cylinderXQParams(double R)
+ * @fn	QuadricParameters QuadricParameters::cylinderXQParams(real R)
  * @brief	Constructs the parameters for a cylinder oriented along the x axis.
  * @param	R	Radius of cylinder.
  * @return	The QuadricParameters.
  */
 
-QuadricParameters QuadricParameters::cylinderXQParams(double R) {
-	double R2 = R * R;
+QuadricParameters QuadricParameters::cylinderXQParams(real R) {
+	real R2 = R * R;
 	return QuadricParameters(0.0, 1.0 / R2, 1.0 / R2, 0, 0, 0, 0, 0, 0, -1);
 }
 
 /**
- * @fn	QuadricParameters QuadricParameters::cylinderYQParams(double R)
+ * @fn	QuadricParameters QuadricParameters::cylinderYQParams(real R)
  * @brief	Constructs the parameters for a cylinder oriented along the y axis.
  * @param	R	Radius of cylinder.
  * @return	The QuadricParameters.
  */
 
-QuadricParameters QuadricParameters::cylinderYQParams(double R) {
-	double R2 = R * R;
+QuadricParameters QuadricParameters::cylinderYQParams(real R) {
+	real R2 = R * R;
 	return QuadricParameters(1.0 / R2, 0, 1.0 / R2, 0, 0, 0, 0, 0, 0, -1);
 }
 
 /**
- * @fn	QuadricParameters QuadricParameters::cylinderZQParams(double R)
+ * @fn	QuadricParameters QuadricParameters::cylinderZQParams(real R)
  * @brief	Constructs the parameters for a cylinder oriented along the z axis.
  * @param	R	Radius of cylinder.
  * @return	The QuadricParameters.
  */
 
-QuadricParameters QuadricParameters::cylinderZQParams(double R) {
-	double R2 = R * R;
+QuadricParameters QuadricParameters::cylinderZQParams(real R) {
+	real R2 = R * R;
 	return QuadricParameters(1.0 / R2, 1.0 / R2, 0, 0, 0, 0, 0, 0, 0, -1);
 }
 
 /**
- * @fn	QuadricParameters QuadricParameters::sphereQParams(double R)
+ * @fn	QuadricParameters QuadricParameters::sphereQParams(real R)
  * @brief	Constructs the parameters for a sphere centered on the origin.
  * @param	R	Radius of cylinder.
  * @return	The QuadricParameters.
  */
 
-QuadricParameters QuadricParameters::sphereQParams(double R) {
-	double R2 = R * R;
+QuadricParameters QuadricParameters::sphereQParams(real R) {
+	real R2 = R * R;
 	return QuadricParameters(1, 1, 1, 0, 0, 0, 0, 0, 0, -R2);
 }
 
 /**
- * @fn	QuadricParameters QuadricParameters::ellipsoidQParams(dvec3 sz)
+ * @fn	QuadricParameters QuadricParameters::ellipsoidQParams(rvec3 sz)
  * @brief	Ellipoid parameters
  * @param	sz	Size of ellipsoid.
  * @return	The QuadricParameters.
  */
 
-QuadricParameters QuadricParameters::ellipsoidQParams(const dvec3 &sz) {
-	dvec3 size = sz * sz;
+QuadricParameters QuadricParameters::ellipsoidQParams(const rvec3 &sz) {
+	rvec3 size = sz * sz;
 	return QuadricParameters(1.0 / size.x, 1.0 / size.y, 1.0 / size.z,
 							0, 0, 0, 0, 0, 0, -1);
 }
 
 /**
- * @fn	QuadricParameters QuadricParameters::cylinderXQParams(double R)
+ * @fn	QuadricParameters QuadricParameters::cylinderXQParams(real R)
  * @brief	Constructs the parameters for a cylinder oriented along the x axis.
  * @param	R	Radius of cylinder.
  * @return	The QuadricParameters.
  */
 
-QuadricParameters QuadricParameters::coneYQParams(double R, double H) {
-	double R2 = R * R / H / H;
+QuadricParameters QuadricParameters::coneYQParams(real R, real H) {
+	real R2 = R * R / H / H;
 	return QuadricParameters(1.0 / R2, -1.0, 1.0 / R2, 0, 0, 0, 0, 0, 0, 0);
 }
 
 /**
- * @fn	IPlane::IPlane(const dvec3 &point, const dvec3 &normal)
+ * @fn	IPlane::IPlane(const rvec3 &point, const rvec3 &normal)
  * @brief	Constructor
  * @param	point 	The point.
  * @param	normal	The normal.
  */
 
-IPlane::IPlane(const dvec3 &point, const dvec3 &normal)
+IPlane::IPlane(const rvec3 &point, const rvec3 &normal)
 	: IShape(), a(point), n(normalize(normal)) {
 }
 
 /**
- * @fn	IPlane::IPlane(const vector<dvec3> &vertices)
+ * @fn	IPlane::IPlane(const vector<rvec3> &vertices)
  * @brief	Constructor
  * @param	vertices	The three vertices.
  */
 
-IPlane::IPlane(const vector<dvec3> &vertices)
+IPlane::IPlane(const vector<rvec3> &vertices)
 				: IShape() {
 	a = vertices[0];
 	n = glm::normalize(glm::cross(vertices[2] - vertices[1], vertices[0] - vertices[1]));
@@ -351,26 +616,26 @@ IPlane::IPlane()
 }
 
 /**
- * @fn	IPlane::IPlane(const dvec3 &p0, const dvec3 &p1, const dvec3 &p2)
+ * @fn	IPlane::IPlane(const rvec3 &p0, const rvec3 &p1, const rvec3 &p2)
  * @brief	Constructor
  * @param	p0	The p 0.
- * @param	p1	The first dvec3.
- * @param	p2	The second dvec3.
+ * @param	p1	The first rvec3.
+ * @param	p2	The second rvec3.
  */
 
-IPlane::IPlane(const dvec3 &p0, const dvec3 &p1, const dvec3 &p2)
+IPlane::IPlane(const rvec3 &p0, const rvec3 &p1, const rvec3 &p2)
 				: IShape(), a(p1), n(glm::normalize(glm::cross(p2 - p1, p0 - p1))) {
 }
 
 
 /**
- * @fn	bool IPlane::onFrontSide(const dvec3 &point) const
+ * @fn	bool IPlane::onFrontSide(const rvec3 &point) const
  * @brief	Determines if point is on the "front side of plane"
  * @param	point	The point.
  * @return	True if it succeeds, false if it fails.
  */
 
-bool IPlane::onFrontSide(const dvec3 &point) const {
+bool IPlane::onFrontSide(const rvec3 &point) const {
 	// If dot product is positive the point is on the "positive" side of the plane
 	bool onFront = glm::dot(point.xyz() - a, n) >= 0.0;
 	return onFront;
@@ -412,23 +677,56 @@ void IPlane::findClosestIntersection(const Ray &ray, HitRecord &hit) const {
 }
 
 /**
- * @fn	void IPlane::findIntersection(const dvec3 &p1, const dvec3 &p2, double &t) const
+ * @fn	bool IPlane::occludes(const Ray &ray, real tMax) const
+ * @brief	Determines if the ray hits the plane before tMax.
+ * @param	ray 	The ray.
+ * @param	tMax	Hits at or beyond this distance are ignored.
+ * @return	True iff the ray hits the plane at some t in [0, tMax).
+ */
+
+bool IPlane::occludes(const Ray &ray, real tMax) const {
+	real denom = glm::dot(ray.dir, n);
+	if (denom == 0) {
+		return false;
+	}
+	real t = glm::dot(-n, ray.origin - a) / denom;
+	return t >= 0 && t < tMax;
+}
+
+/**
+ * @fn	void IPlane::findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const
+ * @brief	Packet version of findClosestIntersection.
+ * @param 		  	packet	The rays.
+ * @param [in,out]	t	  	The t values; FLT_MAX where a ray misses.
+ */
+
+void IPlane::findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const {
+	for (int i = 0; i < PACKET_SIZE; i++) {
+		real denom = packet.dx[i] * n.x + packet.dy[i] * n.y + packet.dz[i] * n.z;
+		real numer = -n.x * (packet.ox[i] - a.x) + -n.y * (packet.oy[i] - a.y) + -n.z * (packet.oz[i] - a.z);
+		real tPlane = numer / denom;
+		t[i] = (denom == 0 || tPlane < 0) ? FLT_MAX : tPlane;
+	}
+}
+
+/**
+ * @fn	void IPlane::findIntersection(const rvec3 &p1, const rvec3 &p2, real &t) const
  * @brief	Searches for the first intersection between a line segment. Used in the pipeline.
  * @param 	p1	The first point
  * @param 	p2	The second piont.
  * @param [in,out]	t 	The value of t where the intersection takes place.
  */
 
-void IPlane::findIntersection(const dvec3 &p1, const dvec3 &p2, double &t) const {
-	double d1 = glm::dot(p1.xyz() - a, n);
-	double d2 = glm::dot(p2.xyz() - a, n);
+void IPlane::findIntersection(const rvec3 &p1, const rvec3 &p2, real &t) const {
+	real d1 = glm::dot(p1.xyz() - a, n);
+	real d2 = glm::dot(p2.xyz() - a, n);
 
 	// Find the parameter of the intercept with the plane
 	t = d1 / (d1 - d2);
 }
 
 /**
-* @fn	dvec3 normalFrom3Points(const dvec3 &pt0, const dvec3 &pt1, const dvec3 &pt2)
+* @fn	rvec3 normalFrom3Points(const rvec3 &pt0, const rvec3 &pt1, const rvec3 &pt2)
 * @brief	Computes a unit-length normal vector from 3 points, specified in counterclockwise order.
 * @param	pt0	The first point.
 * @param	pt1	The second point.
@@ -436,23 +734,23 @@ void IPlane::findIntersection(const dvec3 &p1, const dvec3 &p2, double &t) const
 * @return	Normal vector.
 */
 
-dvec3 normalFrom3Points(const dvec3& pt0, const dvec3& pt1, const dvec3& pt2) {
-	dvec3 v1 = pt1 - pt0;
-	dvec3 v2 = pt2 - pt0;
-	dvec3 cross = glm::normalize(glm::cross(v1, v2));
+rvec3 normalFrom3Points(const rvec3& pt0, const rvec3& pt1, const rvec3& pt2) {
+	rvec3 v1 = pt1 - pt0;
+	rvec3 v2 = pt2 - pt0;
+	rvec3 cross = glm::normalize(glm::cross(v1, v2));
 	return cross;
 }
 
 /**
-* @fn	dvec3 normalFrom3Points(const vector<dvec3> pts)
+* @fn	rvec3 normalFrom3Points(const vector<rvec3> pts)
 * @brief	Computes a unit-length normal vector from 3 points, specified in counterclockwise order.
 * @param	pts	The points.
 * @return	The normal vector.
 */
 
-dvec3 normalFrom3Points(const vector<dvec3>& pts) {
+rvec3 normalFrom3Points(const vector<rvec3>& pts) {
 	/* CSE 386 - todo  */
-	return dvec3();
+	return rvec3();
 }
 
 /**
@@ -466,11 +764,11 @@ dvec3 normalFrom3Points(const vector<dvec3>& pts) {
 *			are introduced).
 * Some tests that can be put into main:
 int main(int argc, char *argv[]) {
-	IPlane p1(dvec3(0, 0, 0), dvec3(0, 1, 0));
-	IPlane p2(dvec3(1, 0, 1), dvec3(0, 2, 0));
-	IPlane p3(dvec3(0, 1, 0), dvec3(0, 1, 0));
-	IPlane p4(dvec3(0, 0, 0), dvec3(1, 1, 0));
-	IPlane p5(dvec3(-1, 1, 0), dvec3(1, 1, 0));
+	IPlane p1(rvec3(0, 0, 0), rvec3(0, 1, 0));
+	IPlane p2(rvec3(1, 0, 1), rvec3(0, 2, 0));
+	IPlane p3(rvec3(0, 1, 0), rvec3(0, 1, 0));
+	IPlane p4(rvec3(0, 0, 0), rvec3(1, 1, 0));
+	IPlane p5(rvec3(-1, 1, 0), rvec3(1, 1, 0));
 
 	IPlane planes[] = { p1, p2, p3, p4, p5 };
 	for (int i = 0; i < 5; i++) {
@@ -494,13 +792,13 @@ bool equalPlanes(const IPlane& p1, const IPlane& p2) {
 }
 
 /**
- * @fn	IQuadricSurface::IQuadricSurface(const QuadricParameters &params, const dvec3 &position)
+ * @fn	IQuadricSurface::IQuadricSurface(const QuadricParameters &params, const rvec3 &position)
  * @brief	Constructs an implicit representation of a QuadricSurface.
  * @param	params  	Options for controlling the operation.
  * @param	position	The position.
  */
 
-IQuadricSurface::IQuadricSurface(const QuadricParameters &params, const dvec3 &position)
+IQuadricSurface::IQuadricSurface(const QuadricParameters &params, const rvec3 &position)
 								: IShape(), qParams(params), center(position) {
 	twoA = 2.0 * qParams.A;
 	twoB = 2.0 * qParams.B;
@@ -508,29 +806,29 @@ IQuadricSurface::IQuadricSurface(const QuadricParameters &params, const dvec3 &p
 }
 
 /**
- * @fn	IQuadricSurface::IQuadricSurface(const vector<double> &params, const dvec3 &position)
+ * @fn	IQuadricSurface::IQuadricSurface(const vector<real> &params, const rvec3 &position)
  * @brief	Constructs an implicit representation of a QuadricSurface.
  * @param	params  	Quadric parameters.
  * @param	position	The position of the quadric.
  */
 
-IQuadricSurface::IQuadricSurface(const vector<double> &params,
-								const dvec3 &position) 
+IQuadricSurface::IQuadricSurface(const vector<real> &params,
+								const rvec3 &position) 
 					: IQuadricSurface(QuadricParameters(params), position) {
 }
 
 /**
- * @fn	IQuadricSurface::IQuadricSurface(const dvec3 &position)
+ * @fn	IQuadricSurface::IQuadricSurface(const rvec3 &position)
  * @brief	Constructs an implicit representation of a QuadricSurface.
  * @param	position	The position of the quadric.
  */
 
-IQuadricSurface::IQuadricSurface(const dvec3 &position)
+IQuadricSurface::IQuadricSurface(const rvec3 &position)
 					: IQuadricSurface(QuadricParameters(), position) {
 }
 
 /**
- * @fn	void IQuadricSurface::computeAqBqCq(const Ray &ray, double &Aq, double &Bq, double &Cq) const
+ * @fn	void IQuadricSurface::computeAqBqCq(const Ray &ray, real &Aq, real &Bq, real &Cq) const
  * @brief	Calculates the aq bq cq
  * @param 		  	ray	The ray.
  * @param [in,out]	Aq 	The aq.
@@ -538,19 +836,19 @@ IQuadricSurface::IQuadricSurface(const dvec3 &position)
  * @param [in,out]	Cq 	The cq.
  */
 
-void IQuadricSurface::computeAqBqCq(const Ray &ray, double &Aq, double &Bq, double &Cq) const {
-	dvec3 Ro = ray.origin - center;
-	const dvec3 &Rd = ray.dir;
-	const double &A = qParams.A;
-	const double &B = qParams.B;
-	const double &C = qParams.C;
-	const double &D = qParams.D;
-	const double &E = qParams.E;
-	const double &F = qParams.F;
-	const double &G = qParams.G;
-	const double &H = qParams.H;
-	const double &I = qParams.I;
-	const double &J = qParams.J;
+void IQuadricSurface::computeAqBqCq(const Ray &ray, real &Aq, real &Bq, real &Cq) const {
+	rvec3 Ro = ray.origin - center;
+	const rvec3 &Rd = ray.dir;
+	const real &A = qParams.A;
+	const real &B = qParams.B;
+	const real &C = qParams.C;
+	const real &D = qParams.D;
+	const real &E = qParams.E;
+	const real &F = qParams.F;
+	const real &G = qParams.G;
+	const real &H = qParams.H;
+	const real &I = qParams.I;
+	const real &J = qParams.J;
 	Aq = A * (Rd.x*Rd.x) +
 		B * (Rd.y*Rd.y) +
 		C * (Rd.z*Rd.z) +
@@ -587,25 +885,112 @@ void IQuadricSurface::computeAqBqCq(const Ray &ray, double &Aq, double &Bq, doub
  */
 
 int IQuadricSurface::findIntersections(const Ray &ray, HitRecord hits[2]) const {
-	double Aq, Bq, Cq;
+	real roots[2];
+	int numIntersections = findRoots(ray, roots);
+
+	for (int i = 0; i < numIntersections; i++) {
+		const real &t = roots[i];
+		hits[i].t = t;
+		hits[i].interceptPt = ray.origin + t * ray.dir;
+		const rvec3 &intercept = hits[i].interceptPt;
+		hits[i].normal = normal(intercept);
+	}
+
+	return numIntersections;
+}
+
+/**
+ * @fn	int IQuadricSurface::findRoots(const Ray &ray, real roots[2]) const
+ * @brief	Identifies the t values of the intersections that appear in front of the
+ * 			ray's origin, sorted by distance. Unlike findIntersections, the intercept
+ * 			points and normals are not computed.
+ * @param	ray  	The ray.
+ * @param	roots	The t values.
+ * @return	The number of t values found.
+ */
+
+int IQuadricSurface::findRoots(const Ray &ray, real roots[2]) const {
+	real Aq, Bq, Cq;
 	computeAqBqCq(ray, Aq, Bq, Cq);
-	double roots[2];
+	real allRoots[2];
 
-	int numRoots = quadratic(Aq, Bq, Cq, roots);
-	int numIntersections = 0;
+	int numRoots = quadratic(Aq, Bq, Cq, allRoots);
+	int numInFront = 0;
 
 	for (int i = 0; i < numRoots; i++) {
-		if (roots[i] > 0) {
-			const double &t = roots[i];
-			hits[numIntersections].t = t;
-			hits[numIntersections].interceptPt = ray.origin + t * ray.dir;
-			const dvec3 &intercept = hits[numIntersections].interceptPt;
-			hits[numIntersections].normal = normal(intercept);
-			numIntersections++;
+		if (allRoots[i] > 0) {
+			roots[numInFront++] = allRoots[i];
 		}
 	}
 
-	return numIntersections;
+	return numInFront;
+}
+
+/**
+ * @fn	void IQuadricSurface::findPacketRoots(const RayPacket &packet, real t0[PACKET_SIZE], real t1[PACKET_SIZE]) const
+ * @brief	Packet version of findRoots. Performs the same arithmetic as
+ * 			computeAqBqCq and quadratic, so the roots are identical.
+ * @param 		  	packet	The rays.
+ * @param [in,out]	t0	  	The nearest root in front of each ray; FLT_MAX if none.
+ * @param [in,out]	t1	  	The second root in front of each ray; FLT_MAX if none.
+ */
+
+void IQuadricSurface::findPacketRoots(const RayPacket &packet, real t0[PACKET_SIZE], real t1[PACKET_SIZE]) const {
+	const real &A = qParams.A;
+	const real &B = qParams.B;
+	const real &C = qParams.C;
+	const real &D = qParams.D;
+	const real &E = qParams.E;
+	const real &F = qParams.F;
+	const real &G = qParams.G;
+	const real &H = qParams.H;
+	const real &I = qParams.I;
+	const real &J = qParams.J;
+	for (int i = 0; i < PACKET_SIZE; i++) {
+		real Rox = packet.ox[i] - center.x;
+		real Roy = packet.oy[i] - center.y;
+		real Roz = packet.oz[i] - center.z;
+		real Rdx = packet.dx[i];
+		real Rdy = packet.dy[i];
+		real Rdz = packet.dz[i];
+		real Aq = A * (Rdx*Rdx) +
+			B * (Rdy*Rdy) +
+			C * (Rdz*Rdz) +
+			D * (Rdx * Rdy) +
+			E * (Rdx * Rdz) +
+			F * (Rdy * Rdz);
+		real Bq = twoA * Rox*Rdx +
+			twoB * Roy*Rdy +
+			twoC * Roz*Rdz +
+			D * (Rox * Rdy + Roy * Rdx) +
+			E * (Rox * Rdz + Roz * Rdx) +
+			F * (Roy * Rdz + Roz * Rdy) +
+			G * Rdx + H * Rdy + I * Rdz;
+		real Cq = A * (Rox * Rox) +
+			B * (Roy * Roy) +
+			C * (Roz * Roz) +
+			D * (Rox * Roy) +
+			E * (Rox * Roz) +
+			F * (Roy * Roz) +
+			G * Rox +
+			H * Roy +
+			I * Roz + J;
+
+		real determinant = Bq * Bq - 4 * Aq * Cq;
+		real sq = std::sqrt(glm::max(determinant, real(0.0)));
+		real root1 = (-Bq - sq) / (2 * Aq);
+		real root2 = (-Bq + sq) / (2 * Aq);
+		real lo = FLT_MAX, hi = FLT_MAX;
+		if (approximatelyZero(determinant)) {
+			lo = -Bq / (2 * Aq);
+		} else if (determinant > 0) {
+			lo = glm::min(root1, root2);
+			hi = glm::max(root1, root2);
+		}
+
+		t0[i] = lo > 0 ? lo : (hi > 0 ? hi : FLT_MAX);
+		t1[i] = lo > 0 ? hi : FLT_MAX;
+	}
 }
 
 /**
@@ -616,7 +1001,7 @@ int IQuadricSurface::findIntersections(const Ray &ray, HitRecord hits[2]) const
  */
 
 void IQuadricSurface::findClosestIntersection(const Ray &ray, HitRecord &hit) const {
-	static HitRecord hits[2];
+	HitRecord hits[2];
 	hit.t = FLT_MAX;
 
 	int numIntercepts = findIntersections(ray, hits);
@@ -638,32 +1023,57 @@ void IQuadricSurface::findClosestIntersection(const Ray &ray, HitRecord &hit) co
 }
 
 /**
- * @fn	dvec3 IQuadricSurface::normal(const dvec3 &P) const
+ * @fn	bool IQuadricSurface::occludes(const Ray &ray, real tMax) const
+ * @brief	Determines if the ray hits the quadric before tMax.
+ * @param	ray 	The ray.
+ * @param	tMax	Hits at or beyond this distance are ignored.
+ * @return	True iff the ray hits the quadric at some t in (0, tMax).
+ */
+
+bool IQuadricSurface::occludes(const Ray &ray, real tMax) const {
+	real roots[2];
+	return findRoots(ray, roots) > 0 && roots[0] < tMax;
+}
+
+/**
+ * @fn	void IQuadricSurface::findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const
+ * @brief	Packet version of findClosestIntersection.
+ * @param 		  	packet	The rays.
+ * @param [in,out]	t	  	The t values; FLT_MAX where a ray misses.
+ */
+
+void IQuadricSurface::findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const {
+	real t1[PACKET_SIZE];
+	findPacketRoots(packet, t, t1);
+}
+
+/**
+ * @fn	rvec3 IQuadricSurface::normal(const rvec3 &P) const
  * @brief	Normals the given p
- * @param	P	A dvec3 to process.
- * @return	A dvec3.
- */
-
-dvec3 IQuadricSurface::normal(const dvec3 &P) const {
-	const double &A = qParams.A;
-	const double &B = qParams.B;
-	const double &C = qParams.C;
-	const double &D = qParams.D;
-	const double &E = qParams.E;
-	const double &F = qParams.F;
-	const double &G = qParams.G;
-	const double &H = qParams.H;
-	const double &I = qParams.I;
-	const double &J = qParams.J;
-	dvec3 pt = P - center;
-	dvec3 normal(twoA * pt.x + D * pt.y + E * pt.z + G,
+ * @param	P	A rvec3 to process.
+ * @return	A rvec3.
+ */
+
+rvec3 IQuadricSurface::normal(const rvec3 &P) const {
+	const real &A = qParams.A;
+	const real &B = qParams.B;
+	const real &C = qParams.C;
+	const real &D = qParams.D;
+	const real &E = qParams.E;
+	const real &F = qParams.F;
+	const real &G = qParams.G;
+	const real &H = qParams.H;
+	const real &I = qParams.I;
+	const real &J = qParams.J;
+	rvec3 pt = P - center;
+	rvec3 normal(twoA * pt.x + D * pt.y + E * pt.z + G,
 					twoB * pt.y + D * pt.x + F * pt.z + H,
 					twoC * pt.z + E * pt.x + F * pt.y + I);
 	return glm::normalize(normal);
 }
 
 /**
- * @fn	ICylinder::ICylinder(const dvec3 &pos, double R, double L, const QuadricParameters &qParams)
+ * @fn	ICylinder::ICylinder(const rvec3 &pos, real R, real L, const QuadricParameters &qParams)
  * @brief	Constructs an implicit representation of a cylinder.
  * @param	pos	   	The position.
  * @param	R	   	Radius.
@@ -671,14 +1081,14 @@ dvec3 IQuadricSurface::normal(const dvec3 &P) const {
  * @param	qParams	Quadric parameters.
  */
 
-ICylinder::ICylinder(const dvec3 &pos, double R, double L,
+ICylinder::ICylinder(const rvec3 &pos, real R, real L,
 					const QuadricParameters &qParams)
 	: IQuadricSurface(qParams, pos), radius(R), length(L) {
 }
 
 
 /**
- * @fn	ICone::ICone(const dvec3 &pos, double R, double H, const QuadricParameters &qParams)
+ * @fn	ICone::ICone(const rvec3 &pos, real R, real H, const QuadricParameters &qParams)
  * @brief	Constructs an implicit representation of a cylinder.
  * @param	pos	   	The position.
  * @param	R	   	Radius at the base of the cone.
@@ -686,12 +1096,12 @@ ICylinder::ICylinder(const dvec3 &pos, double R, double L,
  * @param	qParams	Quadric parameters.
  */
 
-ICone::ICone(const dvec3& pos, double R, double H, const QuadricParameters& qParams)
+ICone::ICone(const rvec3& pos, real R, real H, const QuadricParameters& qParams)
 	: IQuadricSurface(qParams, pos), radius(R), height(H) {
 }
 
 /**
- * @fn	IConeY::IConeY(const dvec3 &pos, double rad, double height)
+ * @fn	IConeY::IConeY(const rvec3 &pos, real rad, real height)
  * @brief	Constructor for a cone oriented with the y axis. There is no
  *          "bottom-lid" to the cone. The center of cone's base will sit at
  *          pos, with a radius of rad at the base. The height will be H.
@@ -700,8 +1110,8 @@ ICone::ICone(const dvec3& pos, double R, double H, const QuadricParameters& qPar
  * @param	H   The height of the cone.
  */
 
-IConeY::IConeY(const dvec3& pos, double rad, double H)
-	: ICone(pos + dvec3(0.0, H, 0.0), rad, H, QuadricParameters::coneYQParams(rad, H)) {
+IConeY::IConeY(const rvec3& pos, real rad, real H)
+	: ICone(pos + rvec3(0.0, H, 0.0), rad, H, QuadricParameters::coneYQParams(rad, H)) {
 }
 
 /**
@@ -712,7 +1122,7 @@ IConeY::IConeY(const dvec3& pos, double rad, double H)
  */
 
 void IConeY::findClosestIntersection(const Ray& ray, HitRecord& hit) const {
-	static HitRecord hits[2];
+	HitRecord hits[2];
 	int numHits = IQuadricSurface::findIntersections(ray, hits);
 
 	if (numHits == 0) {
@@ -729,16 +1139,68 @@ void IConeY::findClosestIntersection(const Ray& ray, HitRecord& hit) const {
 	}
 }
 
+/**
+ * @fn	bool IConeY::occludes(const Ray &ray, real tMax) const
+ * @brief	Determines if the ray hits the cone before tMax.
+ * @param	ray 	The ray.
+ * @param	tMax	Hits at or beyond this distance are ignored.
+ * @return	True iff the ray hits the cone at some t in (0, tMax).
+ */
+
+bool IConeY::occludes(const Ray &ray, real tMax) const {
+	real roots[2];
+	int numRoots = findRoots(ray, roots);
+	for (int i = 0; i < numRoots && roots[i] < tMax; i++) {
+		real y = ray.origin.y + roots[i] * ray.dir.y;
+		if (glm::distance(center.y - height / 2, y) <= height / 2) {
+			return true;
+		}
+	}
+	return false;
+}
 
 /**
- * @fn	ICylinderY::ICylinderY(const dvec3 &pos, double rad, double len)
+ * @fn	void IConeY::findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const
+ * @brief	Packet version of findClosestIntersection.
+ * @param 		  	packet	The rays.
+ * @param [in,out]	t	  	The t values; FLT_MAX where a ray misses.
+ */
+
+void IConeY::findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const {
+	real t0[PACKET_SIZE], t1[PACKET_SIZE];
+	findPacketRoots(packet, t0, t1);
+	for (int i = 0; i < PACKET_SIZE; i++) {
+		real y0 = packet.oy[i] + t0[i] * packet.dy[i];
+		real y1 = packet.oy[i] + t1[i] * packet.dy[i];
+		bool in0 = t0[i] != FLT_MAX && glm::distance(center.y - height / 2, y0) <= height / 2;
+		bool in1 = t1[i] != FLT_MAX && glm::distance(center.y - height / 2, y1) <= height / 2;
+		t[i] = in0 ? t0[i] : (in1 ? t1[i] : FLT_MAX);
+	}
+}
+
+
+/**
+ * @fn	bool IConeY::getBoundingBox(AABB &box) const
+ * @brief	Computes the axis-aligned box enclosing the cone. The center of the
+ * 			underlying quadric is the tip; the base sits height below it.
+ * @param [in,out]	box	The bounding box.
+ * @return	True, since cones are bounded.
+ */
+
+bool IConeY::getBoundingBox(AABB &box) const {
+	box = AABB(center - rvec3(radius, height, radius), center + rvec3(radius, 0.0, radius));
+	return true;
+}
+
+/**
+ * @fn	ICylinderY::ICylinderY(const rvec3 &pos, real rad, real len)
  * @brief	Constructor
  * @param	pos	The position.
  * @param	rad	The radians. //radius?
  * @param	len	The length.
  */
 
-ICylinderY::ICylinderY(const dvec3 &pos, double rad, double len)
+ICylinderY::ICylinderY(const rvec3 &pos, real rad, real len)
 	: ICylinder(pos, rad, len, QuadricParameters::cylinderYQParams(rad)) {
 }
 
@@ -750,7 +1212,7 @@ ICylinderY::ICylinderY(const dvec3 &pos, double rad, double len)
  */
 
 void ICylinderY::findClosestIntersection(const Ray &ray, HitRecord &hit) const {
-	static HitRecord hits[2];
+	HitRecord hits[2];
 	int numHits = IQuadricSurface::findIntersections(ray, hits);
 
 	if (numHits == 0) {
@@ -767,31 +1229,83 @@ void ICylinderY::findClosestIntersection(const Ray &ray, HitRecord &hit) const {
 }
 
 /**
-* @fn	void ICylinderY::getTexCoords(const dvec3 &pt, double &u, double &v) const
+ * @fn	bool ICylinderY::occludes(const Ray &ray, real tMax) const
+ * @brief	Determines if the ray hits the cylinder before tMax.
+ * @param	ray 	The ray.
+ * @param	tMax	Hits at or beyond this distance are ignored.
+ * @return	True iff the ray hits the cylinder at some t in (0, tMax).
+ */
+
+bool ICylinderY::occludes(const Ray &ray, real tMax) const {
+	real roots[2];
+	int numRoots = findRoots(ray, roots);
+	for (int i = 0; i < numRoots && roots[i] < tMax; i++) {
+		real y = ray.origin.y + roots[i] * ray.dir.y;
+		if (glm::distance(center.y, y) <= length / 2) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @fn	void ICylinderY::findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const
+ * @brief	Packet version of findClosestIntersection.
+ * @param 		  	packet	The rays.
+ * @param [in,out]	t	  	The t values; FLT_MAX where a ray misses.
+ */
+
+void ICylinderY::findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const {
+	real t0[PACKET_SIZE], t1[PACKET_SIZE];
+	findPacketRoots(packet, t0, t1);
+	for (int i = 0; i < PACKET_SIZE; i++) {
+		real y0 = packet.oy[i] + t0[i] * packet.dy[i];
+		real y1 = packet.oy[i] + t1[i] * packet.dy[i];
+		bool in0 = t0[i] != FLT_MAX && glm::distance(center.y, y0) <= length / 2;
+		bool in1 = t1[i] != FLT_MAX && glm::distance(center.y, y1) <= length / 2;
+		t[i] = in0 ? t0[i] : (in1 ? t1[i] : FLT_MAX);
+	}
+}
+
+/**
+ * @fn	bool ICylinderY::getBoundingBox(AABB &box) const
+ * @brief	Computes the axis-aligned box enclosing the cylinder, including any lids.
+ * @param [in,out]	box	The bounding box.
+ * @return	True, since the cylinder has finite length.
+ */
+
+bool ICylinderY::getBoundingBox(AABB &box) const {
+	rvec3 extent(radius, length / 2, radius);
+	box = AABB(center - extent, center + extent);
+	return true;
+}
+
+/**
+* @fn	void ICylinderY::getTexCoords(const rvec3 &pt, real &u, real &v) const
 * @brief	Gets tex coordinates
 * @param 		  	pt	The point.
 * @param [in,out]	u 	Tex coordinate u.
 * @param [in,out]	v 	Tex coordinate v.
 */
 
-void ICylinderY::getTexCoords(const dvec3& pt, double& u, double& v) const {
-	u = glm::clamp(map(directionInRadians(center.x, center.z, pt.x, pt.z), 0, 2 * PI, 0, 1), 0.0, 1.0);
-	v = glm::clamp(map(pt.y, center.y - length / 2, center.y + length / 2, 0, 1), 0.0, 1.0);
+void ICylinderY::getTexCoords(const rvec3& pt, real& u, real& v) const {
+	u = glm::clamp(map(directionInRadians(center.x, center.z, pt.x, pt.z), 0, 2 * PI, 0, 1), real(0.0), real(1.0));
+	v = glm::clamp(map(pt.y, center.y - length / 2, center.y + length / 2, 0, 1), real(0.0), real(1.0));
 	v = 1 - v;
 }
 
 /**
- * @fn	IClosedCylinderY::IClosedCylinderY(const dvec3 &pos, double rad, double len)
+ * @fn	IClosedCylinderY::IClosedCylinderY(const rvec3 &pos, real rad, real len)
  * @brief	Constructor
  * @param	pos	The position.
  * @param	rad	The radians. //radius?
  * @param	len	The length.
  */
 
-IClosedCylinderY::IClosedCylinderY(const dvec3& pos, double rad, double len)
+IClosedCylinderY::IClosedCylinderY(const rvec3& pos, real rad, real len)
 	: ICylinderY(pos, rad, len) {
-	top = IDisk(pos + dvec3(0, len / 2, 0), dvec3(0, 1, 0), rad);
-	bottom = IDisk(pos - dvec3(0, len / 2, 0), dvec3(0, -1, 0), rad);
+	top = IDisk(pos + rvec3(0, len / 2, 0), rvec3(0, 1, 0), rad);
+	bottom = IDisk(pos - rvec3(0, len / 2, 0), rvec3(0, -1, 0), rad);
 }
 
 /**
@@ -802,10 +1316,10 @@ IClosedCylinderY::IClosedCylinderY(const dvec3& pos, double rad, double len)
  */
 
 void IClosedCylinderY::findClosestIntersection(const Ray& ray, HitRecord& hit) const {
-	static HitRecord hits[2];
+	HitRecord hits[2];
 	int numHits = IQuadricSurface::findIntersections(ray, hits);
 
-	static HitRecord diskHits[2];
+	HitRecord diskHits[2];
 	top.findClosestIntersection(ray, diskHits[0]);
 	bottom.findClosestIntersection(ray, diskHits[1]);
 
@@ -832,26 +1346,55 @@ void IClosedCylinderY::findClosestIntersection(const Ray& ray, HitRecord& hit) c
 }
 
 /**
-* @fn	void IClosedCylinderY::getTexCoords(const dvec3 &pt, double &u, double &v) const
+ * @fn	bool IClosedCylinderY::occludes(const Ray &ray, real tMax) const
+ * @brief	Determines if the ray hits the cylinder or either lid before tMax.
+ * @param	ray 	The ray.
+ * @param	tMax	Hits at or beyond this distance are ignored.
+ * @return	True iff the ray hits the closed cylinder at some t in [0, tMax).
+ */
+
+bool IClosedCylinderY::occludes(const Ray &ray, real tMax) const {
+	return ICylinderY::occludes(ray, tMax) || top.occludes(ray, tMax) || bottom.occludes(ray, tMax);
+}
+
+/**
+ * @fn	void IClosedCylinderY::findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const
+ * @brief	Packet version of findClosestIntersection.
+ * @param 		  	packet	The rays.
+ * @param [in,out]	t	  	The t values; FLT_MAX where a ray misses.
+ */
+
+void IClosedCylinderY::findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const {
+	real topT[PACKET_SIZE], bottomT[PACKET_SIZE];
+	ICylinderY::findPacketIntersections(packet, t);
+	top.findPacketIntersections(packet, topT);
+	bottom.findPacketIntersections(packet, bottomT);
+	for (int i = 0; i < PACKET_SIZE; i++) {
+		t[i] = glm::min(t[i], glm::min(topT[i], bottomT[i]));
+	}
+}
+
+/**
+* @fn	void IClosedCylinderY::getTexCoords(const rvec3 &pt, real &u, real &v) const
 * @brief	Gets tex coordinates
 * @param 		  	pt	The point.
 * @param [in,out]	u 	Tex coordinate u.
 * @param [in,out]	v 	Tex coordinate v.
 */
 
-void IClosedCylinderY::getTexCoords(const dvec3& pt, double& u, double& v) const {
+void IClosedCylinderY::getTexCoords(const rvec3& pt, real& u, real& v) const {
 	ICylinderY::getTexCoords(pt, u, v);
 }
 
 /**
- * @fn	ICylinderZ::ICylinderZ(const dvec3 &pos, double rad, double len)
+ * @fn	ICylinderZ::ICylinderZ(const rvec3 &pos, real rad, real len)
  * @brief	Constructor
  * @param	pos	The position.
  * @param	rad	The radians.
  * @param	len	The length.
  */
 
-ICylinderZ::ICylinderZ(const dvec3 &pos, double rad, double len)
+ICylinderZ::ICylinderZ(const rvec3 &pos, real rad, real len)
 	: ICylinder(pos, rad, len, QuadricParameters::cylinderZQParams(rad)) {
 }
 
@@ -864,7 +1407,7 @@ ICylinderZ::ICylinderZ(const dvec3 &pos, double rad, double len)
 
 void ICylinderZ::findClosestIntersection(const Ray &ray,
 										HitRecord &hit) const {
-	static HitRecord hits[2];
+	HitRecord hits[2];
 	int numHits = IQuadricSurface::findIntersections(ray, hits);
 
 	if (numHits == 0) {
@@ -882,12 +1425,77 @@ void ICylinderZ::findClosestIntersection(const Ray &ray,
 }
 
 /**
- * @fn	IEllipsoid::IEllipsoid(const dvec3 &position, const dvec3 &sz)
+ * @fn	bool ICylinderZ::occludes(const Ray &ray, real tMax) const
+ * @brief	Determines if the ray hits the cylinder before tMax.
+ * @param	ray 	The ray.
+ * @param	tMax	Hits at or beyond this distance are ignored.
+ * @return	True iff the ray hits the cylinder at some t in (0, tMax).
+ */
+
+bool ICylinderZ::occludes(const Ray &ray, real tMax) const {
+	real roots[2];
+	int numRoots = findRoots(ray, roots);
+	for (int i = 0; i < numRoots && roots[i] < tMax; i++) {
+		real z = ray.origin.z + roots[i] * ray.dir.z;
+		if (glm::distance(center.z, z) <= length / 2) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @fn	void ICylinderZ::findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const
+ * @brief	Packet version of findClosestIntersection.
+ * @param 		  	packet	The rays.
+ * @param [in,out]	t	  	The t values; FLT_MAX where a ray misses.
+ */
+
+void ICylinderZ::findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const {
+	real t0[PACKET_SIZE], t1[PACKET_SIZE];
+	findPacketRoots(packet, t0, t1);
+	for (int i = 0; i < PACKET_SIZE; i++) {
+		real z0 = packet.oz[i] + t0[i] * packet.dz[i];
+		real z1 = packet.oz[i] + t1[i] * packet.dz[i];
+		bool in0 = t0[i] != FLT_MAX && glm::distance(center.z, z0) <= length / 2;
+		bool in1 = t1[i] != FLT_MAX && glm::distance(center.z, z1) <= length / 2;
+		t[i] = in0 ? t0[i] : (in1 ? t1[i] : FLT_MAX);
+	}
+}
+
+/**
+ * @fn	bool ICylinderZ::getBoundingBox(AABB &box) const
+ * @brief	Computes the axis-aligned box enclosing the cylinder.
+ * @param [in,out]	box	The bounding box.
+ * @return	True, since the cylinder has finite length.
+ */
+
+bool ICylinderZ::getBoundingBox(AABB &box) const {
+	rvec3 extent(radius, radius, length / 2);
+	box = AABB(center - extent, center + extent);
+	return true;
+}
+
+/**
+ * @fn	IEllipsoid::IEllipsoid(const rvec3 &position, const rvec3 &sz)
  * @brief	Constructs an implicit representation of an ellipsoid.
  * @param	position	The center of ellipsoid.
  * @param	sz			The size of ellipsoid.
  */
 
-IEllipsoid::IEllipsoid(const dvec3 &position, const dvec3 &sz)
+IEllipsoid::IEllipsoid(const rvec3 &position, const rvec3 &sz)
 	: IQuadricSurface(QuadricParameters::ellipsoidQParams(sz), position) {
 }
+
+/**
+ * @fn	bool IEllipsoid::getBoundingBox(AABB &box) const
+ * @brief	Computes the axis-aligned box enclosing the ellipsoid.
+ * @param [in,out]	box	The bounding box.
+ * @return	True, since ellipsoids are bounded.
+ */
+
+bool IEllipsoid::getBoundingBox(AABB &box) const {
+	rvec3 extent(1.0 / std::sqrt(qParams.A), 1.0 / std::sqrt(qParams.B), 1.0 / std::sqrt(qParams.C));
+	box = AABB(center - extent, center + extent);
+	return true;
+}
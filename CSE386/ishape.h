@@ -22,16 +22,50 @@ typedef VisibleIShape *VisibleIShapePtr;
  */
 
 struct Ray {
-	dvec3 origin;		//!< starting point for this ray
-	dvec3 dir;			//!< direction for this ray, given it's origin
-	Ray(const dvec3 &rayOrigin, const dvec3 &rayDirection) :
+	rvec3 origin;		//!< starting point for this ray
+	rvec3 dir;			//!< direction for this ray, given it's origin
+	Ray() : origin(ORIGIN3D), dir(-Z_AXIS) {
+	}
+	Ray(const rvec3 &rayOrigin, const rvec3 &rayDirection) :
 		origin(rayOrigin), dir(glm::normalize(rayDirection)) {
 	}
-	dvec3 getPoint(double t) const {
+	rvec3 getPoint(real t) const {
 		return origin + t * dir;
 	}
 };
 
+const int PACKET_SIZE = 4;		//!< Number of rays traced together in a RayPacket.
+
+/**
+ * @struct	RayPacket
+ * @brief	PACKET_SIZE rays stored as a structure of arrays, so that the packet
+ * 			intersection kernels run the same arithmetic on every ray of the packet
+ * 			and the compiler can turn each kernel loop into vector instructions.
+ */
+
+struct RayPacket {
+	real ox[PACKET_SIZE], oy[PACKET_SIZE], oz[PACKET_SIZE];	//!< ray origins
+	real dx[PACKET_SIZE], dy[PACKET_SIZE], dz[PACKET_SIZE];	//!< ray directions
+	const Ray *rays;		//!< the rays themselves, for the scalar fallback
+	RayPacket(const Ray rays[PACKET_SIZE]);
+	bool isCoherent() const;
+};
+
+/**
+ * @struct	AABB
+ * @brief	An axis-aligned bounding box in 3D. A default constructed box is empty.
+ */
+
+struct AABB {
+	rvec3 lo;		//!< corner with the smallest x, y and z values
+	rvec3 hi;		//!< corner with the largest x, y and z values
+	AABB();
+	AABB(const rvec3 &lo, const rvec3 &hi);
+	void expand(const AABB &other);
+	rvec3 centroid() const { return (lo + hi) / real(2.0); }
+	bool intersects(const Ray &ray, const rvec3 &invDir, real tMax, real &tEntry) const;
+};
+
 /**
  * @struct	IShape
  * @brief	Base class for all implicit shapes.
@@ -40,8 +74,11 @@ struct Ray {
 struct IShape {
 	IShape();
 	virtual void findClosestIntersection(const Ray &ray, HitRecord &hit) const = 0;
-	virtual void getTexCoords(const dvec3 &pt, double &u, double &v) const;
-	static dvec3 movePointOffSurface(const dvec3 &pt, const dvec3 &n);
+	virtual bool occludes(const Ray &ray, real tMax) const;
+	virtual void findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const;
+	virtual void getTexCoords(const rvec3 &pt, real &u, real &v) const;
+	virtual bool getBoundingBox(AABB &box) const;
+	static rvec3 movePointOffSurface(const rvec3 &pt, const rvec3 &n);
 };
 
 /**
@@ -52,11 +89,15 @@ struct IShape {
 struct VisibleIShape {
 	Material material;	//!< Material for this shape.
 	IShapePtr shape;	//!< Pointer to underlying implicit shape.
-	Image *texture;		//!< Texture associated with this shape, if any.
-	VisibleIShape(IShapePtr shapePtr, const Material &mat, Image *image = nullptr);
+	TexturePtr texture;	//!< Texture associated with this shape, if any.
+	VisibleIShape(IShapePtr shapePtr, const Material &mat, TexturePtr tex = nullptr);
 	void findClosestIntersection(const Ray &ray, HitRecord &hit) const;
+	real getTexCoordRate(const rvec3 &pt, const rvec3 &n, real u, real v) const;
+	bool occludes(const Ray &ray, real tMax) const { return shape->occludes(ray, tMax); }
 	static void findIntersection(const Ray &ray, const vector<VisibleIShapePtr> &surfaces,
 								HitRecord &theHit);
+	static bool findAnyIntersection(const Ray &ray, const vector<VisibleIShapePtr> &surfaces,
+								real tMax, VisibleIShapePtr *blocker = nullptr);
 };
 
 /**
@@ -65,20 +106,22 @@ struct VisibleIShape {
  */
 
 struct IPlane : public IShape {
-	dvec3 a;	//!< point on the plane
-	dvec3 n;	//!< plane's normal vector
+	rvec3 a;	//!< point on the plane
+	rvec3 n;	//!< plane's normal vector
 	IPlane();
-	IPlane(const dvec3 &point, const dvec3 &normal);
-	IPlane(const vector<dvec3> &vertices);
-	IPlane(const dvec3 &p1, const dvec3 &p2, const dvec3 &p3);
+	IPlane(const rvec3 &point, const rvec3 &normal);
+	IPlane(const vector<rvec3> &vertices);
+	IPlane(const rvec3 &p1, const rvec3 &p2, const rvec3 &p3);
 	virtual void findClosestIntersection(const Ray &ray, HitRecord &hit) const;
-	bool onFrontSide(const dvec3 &point) const;
-	void findIntersection(const dvec3 &p1, const dvec3 &p2, double &t) const;
+	virtual bool occludes(const Ray &ray, real tMax) const;
+	virtual void findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const;
+	bool onFrontSide(const rvec3 &point) const;
+	void findIntersection(const rvec3 &p1, const rvec3 &p2, real &t) const;
 };
 
 bool equalPlanes(const IPlane& a, const IPlane& b);
-dvec3 normalFrom3Points(const dvec3& pt1, const dvec3& pt2, const dvec3& pt3);
-dvec3 normalFrom3Points(const vector<dvec3>& pts);
+rvec3 normalFrom3Points(const rvec3& pt1, const rvec3& pt2, const rvec3& pt3);
+rvec3 normalFrom3Points(const vector<rvec3>& pts);
 
 /**
  * @struct	IDisk
@@ -88,12 +131,15 @@ dvec3 normalFrom3Points(const vector<dvec3>& pts);
 
 struct IDisk : public IShape {
 	IDisk();
-	IDisk(const dvec3 &position, const dvec3 &n, double rad);
+	IDisk(const rvec3 &position, const rvec3 &n, real rad);
 	virtual void findClosestIntersection(const Ray &ray, HitRecord &hit) const;
-	virtual void getTexCoords(const dvec3& pt, double& u, double& v) const;
-	dvec3 center;	//!< center point of disk
-	dvec3 n;		//!< normal vector of disk
-	double radius;
+	virtual bool occludes(const Ray &ray, real tMax) const;
+	virtual void findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const;
+	virtual void getTexCoords(const rvec3& pt, real& u, real& v) const;
+	virtual bool getBoundingBox(AABB &box) const;
+	rvec3 center;	//!< center point of disk
+	rvec3 n;		//!< normal vector of disk
+	real radius;
 };
 
 /**
@@ -102,17 +148,17 @@ struct IDisk : public IShape {
  */
 
 struct QuadricParameters {
-	double A, B, C, D, E, F, G, H, I, J;
+	real A, B, C, D, E, F, G, H, I, J;
 	QuadricParameters();
-	QuadricParameters(const vector<double> &items);
-	QuadricParameters(double a, double b, double c, double d, double e, double f,
-						double g, double h, double i, double j);
-	static QuadricParameters cylinderXQParams(double R);
-	static QuadricParameters cylinderYQParams(double R);
-	static QuadricParameters cylinderZQParams(double R);
-	static QuadricParameters coneYQParams(double R, double H);
-	static QuadricParameters sphereQParams(double R);
-	static QuadricParameters ellipsoidQParams(const dvec3 &sz);
+	QuadricParameters(const vector<real> &items);
+	QuadricParameters(real a, real b, real c, real d, real e, real f,
+						real g, real h, real i, real j);
+	static QuadricParameters cylinderXQParams(real R);
+	static QuadricParameters cylinderYQParams(real R);
+	static QuadricParameters cylinderZQParams(real R);
+	static QuadricParameters coneYQParams(real R, real H);
+	static QuadricParameters sphereQParams(real R);
+	static QuadricParameters ellipsoidQParams(const rvec3 &sz);
 };
 
 /**
@@ -122,21 +168,25 @@ struct QuadricParameters {
  */
 
 struct IQuadricSurface : public IShape {
-	dvec3 center;	//!< center of quadric
+	rvec3 center;	//!< center of quadric
 	IQuadricSurface(const QuadricParameters &params,
-					const dvec3 &position);
-	IQuadricSurface(const vector<double> &params,
-					const dvec3 & position);
-	IQuadricSurface(const dvec3 & position);
+					const rvec3 &position);
+	IQuadricSurface(const vector<real> &params,
+					const rvec3 & position);
+	IQuadricSurface(const rvec3 & position);
 	virtual void findClosestIntersection(const Ray &ray, HitRecord &hit) const;
+	virtual bool occludes(const Ray &ray, real tMax) const;
+	virtual void findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const;
 	int findIntersections(const Ray &ray, HitRecord hits[2]) const;
-	dvec3 normal(const dvec3 &pt) const;
-	virtual void computeAqBqCq(const Ray &ray, double &Aq, double &Bq, double &Cq) const;
+	int findRoots(const Ray &ray, real roots[2]) const;
+	void findPacketRoots(const RayPacket &packet, real t0[PACKET_SIZE], real t1[PACKET_SIZE]) const;
+	rvec3 normal(const rvec3 &pt) const;
+	virtual void computeAqBqCq(const Ray &ray, real &Aq, real &Bq, real &Cq) const;
 protected:
 	QuadricParameters qParams;		//!< The parameters that make up the quadric
-	double twoA;					//!< 2*A
-	double twoB;					//!< 2*B
-	double twoC;					//!< 2*C
+	real twoA;					//!< 2*A
+	real twoB;					//!< 2*B
+	real twoC;					//!< 2*C
 };
 
 /**
@@ -145,8 +195,9 @@ protected:
  */
 
 struct ISphere : IQuadricSurface {
-	ISphere(const dvec3 &position, double radius);
-	virtual void getTexCoords(const dvec3 &pt, double &u, double &v) const;
+	ISphere(const rvec3 &position, real radius);
+	virtual void getTexCoords(const rvec3 &pt, real &u, real &v) const;
+	virtual bool getBoundingBox(AABB &box) const;
 };
 
 /**
@@ -155,8 +206,8 @@ struct ISphere : IQuadricSurface {
  */
 
 struct ICylinder : public IQuadricSurface {
-	double radius, length;
-	ICylinder(const dvec3 &position, double R, double len, const QuadricParameters &qParams);
+	real radius, length;
+	ICylinder(const rvec3 &position, real R, real len, const QuadricParameters &qParams);
 	virtual void findClosestIntersection(const Ray &ray, HitRecord &hit) const = 0;
 };
 
@@ -166,8 +217,8 @@ struct ICylinder : public IQuadricSurface {
  */
 
 struct ICone : public IQuadricSurface {
-	double radius, height;
-	ICone(const dvec3& position, double R, double H, const QuadricParameters& qParams);
+	real radius, height;
+	ICone(const rvec3& position, real R, real H, const QuadricParameters& qParams);
 };
 
 /**
@@ -176,8 +227,11 @@ struct ICone : public IQuadricSurface {
  */
 
 struct IConeY : public ICone {
-	IConeY(const dvec3& position, double R, double H);
+	IConeY(const rvec3& position, real R, real H);
 	virtual void findClosestIntersection(const Ray& ray, HitRecord& hit) const;
+	virtual bool occludes(const Ray &ray, real tMax) const;
+	virtual void findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const;
+	virtual bool getBoundingBox(AABB &box) const;
 };
 
 /**
@@ -186,9 +240,12 @@ struct IConeY : public ICone {
  */
 
 struct ICylinderY : public ICylinder {
-	ICylinderY(const dvec3 &position, double R, double len);
+	ICylinderY(const rvec3 &position, real R, real len);
 	virtual void findClosestIntersection(const Ray &ray, HitRecord &hit) const;
-	void getTexCoords(const dvec3 &pt, double &u, double &v) const;
+	virtual bool occludes(const Ray &ray, real tMax) const;
+	virtual void findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const;
+	virtual bool getBoundingBox(AABB &box) const;
+	void getTexCoords(const rvec3 &pt, real &u, real &v) const;
 };
 
 /**
@@ -198,9 +255,11 @@ struct ICylinderY : public ICylinder {
 
 struct IClosedCylinderY : public ICylinderY {
 	IDisk top, bottom;
-	IClosedCylinderY(const dvec3& position, double R, double len);
+	IClosedCylinderY(const rvec3& position, real R, real len);
 	virtual void findClosestIntersection(const Ray& ray, HitRecord& hit) const;
-	void getTexCoords(const dvec3& pt, double& u, double& v) const;
+	virtual bool occludes(const Ray &ray, real tMax) const;
+	virtual void findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const;
+	void getTexCoords(const rvec3& pt, real& u, real& v) const;
 };
 
 /* CSE 386 - To create */
@@ -210,8 +269,11 @@ struct IClosedCylinderY : public ICylinderY {
  */
 
 struct ICylinderZ : public ICylinder {
-	ICylinderZ(const dvec3 &position, double R, double len);
+	ICylinderZ(const rvec3 &position, real R, real len);
 	virtual void findClosestIntersection(const Ray &ray, HitRecord &hit) const;
+	virtual bool occludes(const Ray &ray, real tMax) const;
+	virtual void findPacketIntersections(const RayPacket &packet, real t[PACKET_SIZE]) const;
+	virtual bool getBoundingBox(AABB &box) const;
 };
 
 /**
@@ -220,5 +282,6 @@ struct ICylinderZ : public ICylinder {
  */
 
 struct IEllipsoid : public IQuadricSurface {
-	IEllipsoid(const dvec3& position, const dvec3& sz);
+	IEllipsoid(const rvec3& position, const rvec3& sz);
+	virtual bool getBoundingBox(AABB &box) const;
 };
\ No newline at end of file
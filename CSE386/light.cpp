@@ -19,11 +19,11 @@
   */
 
 color ambientColor(const color &mat, const color &lightAmbient) {
-	return glm::clamp(mat * lightAmbient, 0.0, 1.0);
+	return glm::clamp(mat * lightAmbient, real(0.0), real(1.0));
 }
 
 /**
- * @fn	color diffuseColor(const color &mat, const color &light, const dvec3 &l, const dvec3 &n)
+ * @fn	color diffuseColor(const color &mat, const color &light, const rvec3 &l, const rvec3 &n)
  * @brief	Computes diffuse color produce by a single light at a single point.
  * @param	mat		 	Material.
  * @param	lightDiffuse	 	The light color.
@@ -33,14 +33,14 @@ color ambientColor(const color &mat, const color &lightAmbient) {
  */
 
 color diffuseColor(const color &mat, const color &lightDiffuse,
-					const dvec3 &l, const dvec3 &n) {
-	double dp = glm::max(0.0, glm::dot(l, n));
-	return glm::clamp(mat * lightDiffuse * dp, 0.0, 1.0);
+					const rvec3 &l, const rvec3 &n) {
+	real dp = glm::max(real(0.0), glm::dot(l, n));
+	return glm::clamp(mat * lightDiffuse * dp, real(0.0), real(1.0));
 }
 
 /**
- * @fn	color specularColor(const color &mat, const color &light, double shininess, 
- *							const dvec3 &r, const dvec3 &v)
+ * @fn	color specularColor(const color &mat, const color &light, real shininess, 
+ *							const rvec3 &r, const rvec3 &v)
  * @brief	Computes specular color produce by a single light at a single point.
  * @param	mat		 	Material.
  * @param	lightSpecular	 	The light's color.
@@ -51,15 +51,15 @@ color diffuseColor(const color &mat, const color &lightDiffuse,
  */
 
 color specularColor(const color &mat, const color &lightSpecular,
-					double shininess,
-					const dvec3 &r, const dvec3 &v) {
-	return glm::clamp( mat * lightSpecular * std::pow(glm::clamp(glm::dot(v, r), 0.0, 1.0), shininess) , 0.0, 1.0 );
+					real shininess,
+					const rvec3 &r, const rvec3 &v) {
+	return glm::clamp( mat * lightSpecular * std::pow(glm::clamp(glm::dot(v, r), real(0.0), real(1.0)), shininess) , real(0.0), real(1.0) );
 }
 
 /**
  * @fn	color totalColor(const Material &mat, const LightColor &lightColor, 
- *						const dvec3 &viewingDir, const dvec3 &normal, 
- *						const dvec3 &lightPos, const dvec3 &intersectionPt, 
+ *						const rvec3 &viewingDir, const rvec3 &normal, 
+ *						const rvec3 &lightPos, const rvec3 &intersectionPt, 
  *						bool attenuationOn, const LightAttenuationParameters &ATparams)
  * @brief	Color produced by a single light at a single point.
  * @param	mat			  	Material.
@@ -74,16 +74,16 @@ color specularColor(const color &mat, const color &lightSpecular,
  */
  
 color totalColor(const Material &mat, const LightColor &lightColor,
-				const dvec3 &v, const dvec3 &n,
-				const dvec3 &lightPos, const dvec3 &intersectionPt,
+				const rvec3 &v, const rvec3 &n,
+				const rvec3 &lightPos, const rvec3 &intersectionPt,
 				bool attenuationOn, 
 				const LightATParams &ATparams) {
 
 	color total;
-	dvec3 lightVec = glm::normalize(lightPos - intersectionPt);
-	double lightDistance = glm::distance(lightPos, intersectionPt);
-	double AT = ATparams.factor(lightDistance);
-	dvec3 reflectionVec = 2 * glm::dot(lightVec, n) * n - lightVec;
+	rvec3 lightVec = glm::normalize(lightPos - intersectionPt);
+	real lightDistance = glm::distance(lightPos, intersectionPt);
+	real AT = ATparams.factor(lightDistance);
+	rvec3 reflectionVec = 2 * glm::dot(lightVec, n) * n - lightVec;
 
 	color ambColor = ambientColor(mat.ambient, lightColor.ambient);
 	color diffColor = diffuseColor(mat.diffuse, lightColor.diffuse, lightVec, n);
@@ -98,12 +98,12 @@ color totalColor(const Material &mat, const LightColor &lightColor,
 		total = ambColor + diffColor + specColor;
 	}
 	
-	return glm::clamp(total, 0.0, 1.0);
+	return glm::clamp(total, real(0.0), real(1.0));
 }
 
 /**
- * @fn	color PositionalLight::illuminate(const dvec3 &interceptWorldCoords, 
- *										const dvec3 &normal, const Material &material, 
+ * @fn	color PositionalLight::illuminate(const rvec3 &interceptWorldCoords, 
+ *										const rvec3 &normal, const Material &material, 
  *										const Frame &eyeFrame, bool inShadow) const
  * @brief	Computes the color this light produces in RAYTRACING applications.
  * @param	interceptWorldCoords	(x, y, z) at the intercept point.
@@ -114,8 +114,8 @@ color totalColor(const Material &mat, const LightColor &lightColor,
  * @return	The color produced at the intercept point, given this light.
  */
 
-color PositionalLight::illuminate(const dvec3& interceptWorldCoords,
-									const dvec3& normal,
+color PositionalLight::illuminate(const rvec3& interceptWorldCoords,
+									const rvec3& normal,
 									const Material& material,
 									const Frame& eyeFrame, bool inShadow) const {
 
@@ -145,13 +145,13 @@ color PositionalLight::illuminate(const dvec3& interceptWorldCoords,
 *			raw position. Or, it will be the position relative to the camera's
 *			frame (transformed into the world coordinate frame).
 */
-dvec3 PositionalLight::actualPosition(const Frame& eyeFrame) const {
+rvec3 PositionalLight::actualPosition(const Frame& eyeFrame) const {
 	return isTiedToWorld ? pos : eyeFrame.toWorldCoords(pos);
 }
 
 /**
- * @fn	color SpotLight::illuminate(const dvec3 &interceptWorldCoords, 
- *									const dvec3 &normal, const Material &material, 
+ * @fn	color SpotLight::illuminate(const rvec3 &interceptWorldCoords, 
+ *									const rvec3 &normal, const Material &material, 
  *									const Frame &eyeFrame, bool inShadow) const
  * @brief	Computes the color this light produces in raytracing applications.
  * @param	interceptWorldCoords				The surface properties of the intercept point.
@@ -162,8 +162,8 @@ dvec3 PositionalLight::actualPosition(const Frame& eyeFrame) const {
  * @return	The color produced at the intercept point, given this light.
  */
 
-color SpotLight::illuminate(const dvec3 &interceptWorldCoords,
-							const dvec3 &normal,
+color SpotLight::illuminate(const rvec3 &interceptWorldCoords,
+							const rvec3 &normal,
 							const Material &material,
 							const Frame &eyeFrame, bool inShadow) const {
 
@@ -178,19 +178,19 @@ color SpotLight::illuminate(const dvec3 &interceptWorldCoords,
 }
 
 /**
-* @fn	void setDir (double dx, double dy, double dz)
+* @fn	void setDir (real dx, real dy, real dz)
 * @brief	Sets the direction of the spotlight.
 * @param	dx		x component of the direction
 * @param	dy		y component of the direction
 * @param	dz		z component of the direction
 */
 
-void SpotLight::setDir(double dx, double dy, double dz) {
-	spotDir = glm::normalize(dvec3(dx, dy, dz));
+void SpotLight::setDir(real dx, real dy, real dz) {
+	spotDir = glm::normalize(rvec3(dx, dy, dz));
 }
 
 /**
-* @fn	bool inCone(const dvec3& spotPos, const dvec3& spotDir, double spotFOV, const dvec3& intercept)
+* @fn	bool inCone(const rvec3& spotPos, const rvec3& spotDir, real spotFOV, const rvec3& intercept)
 * @brief	Determines if an intercept point falls within a spotlight's cone.
 * @param	spotPos		where the spotlight is positioned
 * @param	spotDir		normalized direction of spotlight's pointing direction
@@ -198,13 +198,13 @@ void SpotLight::setDir(double dx, double dy, double dz) {
 * @param	intercept	the position of the intercept.
 */
 
-bool inCone(const dvec3& spotPos, const dvec3& spotDir, double spotFOV, const dvec3& intercept) {
+bool inCone(const rvec3& spotPos, const rvec3& spotDir, real spotFOV, const rvec3& intercept) {
 	//if (std::acos(glm::dot(glm::normalize(spotDir), glm::normalize(intercept - spotPos))) <= spotFOV/2)
 	return glm::dot(glm::normalize(spotDir), glm::normalize(intercept - spotPos)) > std::cos(spotFOV / 2);
 }
 
 /**
-* @fn	bool inShadow(const dvec3& lightPos, const dvec3& intercept, const dvec3& normal, const vector<VisibleIShapePtr> objects)
+* @fn	bool inShadow(const rvec3& lightPos, const rvec3& intercept, const rvec3& normal, const vector<VisibleIShapePtr> objects)
 * @brief	Determines if an intercept point falls in a shadow.
 * @param	lightPos		where the spotlight is positioned //(positional light?)
 * @param	intercept	the position of the intercept.
@@ -212,18 +212,330 @@ bool inCone(const dvec3& spotPos, const dvec3& spotDir, double spotFOV, const dv
 * @param	objects		the collection of opaque objects in the scene
 */
 
-bool inShadow(const dvec3& lightPos, const dvec3& intercept, const dvec3& normal, const vector<VisibleIShapePtr>& objects) {
+bool inShadow(const rvec3& lightPos, const rvec3& intercept, const rvec3& normal, const vector<VisibleIShapePtr>& objects) {
 
-	HitRecord objectHit;
-	dvec3 raisedPt = IShape::movePointOffSurface(intercept, normal);
+	rvec3 raisedPt = IShape::movePointOffSurface(intercept, normal);
 	Ray feeler = Ray(raisedPt, glm::normalize(lightPos - raisedPt));
 
-	VisibleIShape::findIntersection(feeler, objects, objectHit);
+	return VisibleIShape::findAnyIntersection(feeler, objects, glm::distance(raisedPt, lightPos));
+}
 
-	if (objectHit.t < glm::distance(raisedPt, lightPos))
-	{
-		return true;
+/**
+* @fn	bool inShadow(const rvec3& lightPos, const rvec3& intercept, const rvec3& normal, const BVH& objects)
+* @brief	Determines if an intercept point falls in a shadow, using a bounding volume
+* 			hierarchy over the opaque objects.
+* @param	lightPos	where the light is positioned
+* @param	intercept	the position of the intercept.
+* @param	normal		the normal vector at the intercept point
+* @param	objects		hierarchy over the opaque objects in the scene
+*/
+
+bool inShadow(const rvec3& lightPos, const rvec3& intercept, const rvec3& normal, const BVH& objects) {
+	rvec3 raisedPt = IShape::movePointOffSurface(intercept, normal);
+	Ray feeler = Ray(raisedPt, glm::normalize(lightPos - raisedPt));
+
+	return objects.findAnyIntersection(feeler, glm::distance(raisedPt, lightPos));
+}
+
+
+/**
+ * @fn	color ResolvedLight::illuminate(const rvec3 &pt, const rvec3 &n, const Material &material,
+ *										const rvec3 &eyePos, bool inShadow) const
+ * @brief	Computes the color this light produces at a point, exactly as the light's
+ * 			own illuminate() does, for a point the light reaches.
+ * @param	pt		 	(x, y, z) of the point.
+ * @param	n		 	The normal vector.
+ * @param	material 	The object's material properties.
+ * @param	eyePos   	The camera position.
+ * @param	inShadow 	true if the point is in a shadow.
+ * @return	The color produced at the point, given this light.
+ */
+
+color ResolvedLight::illuminate(const rvec3 &pt, const rvec3 &n, const Material &material,
+								const rvec3 &eyePos, bool inShadow) const {
+	if (inShadow) {
+		return ambientColor(material.ambient, light->lightColor.ambient);
+	}
+	return totalColor(material, light->lightColor, glm::normalize(eyePos - pt), n,
+						position, pt, light->attenuationIsTurnedOn, light->atParams);
+}
+
+/**
+ * @fn	static real attenuationRange(const LightATParams &params)
+ * @brief	Finds the distance beyond which attenuation is below MIN_ATTENUATION.
+ * @param	params	The attenuation parameters.
+ * @return	The distance, or FLT_MAX if attenuation never gets that low.
+ */
+
+static real attenuationRange(const LightATParams &params) {
+	const real c = params.constant - 1 / MIN_ATTENUATION;
+	if (c >= 0) {
+		return 0;
+	}
+	if (params.quadratic > 0) {
+		const real b = params.linear;
+		return (-b + std::sqrt(b * b - 4 * params.quadratic * c)) / (2 * params.quadratic);
+	}
+	if (params.linear > 0) {
+		return -c / params.linear;
+	}
+	return FLT_MAX;
+}
+
+bool FrameLights::cacheOccluders = true;
+ShadowCacheStats FrameLights::shadowCacheStats;
+std::atomic<unsigned int> FrameLights::nextId(1);
+
+/**
+ * @fn	void ShadowCacheStats::reset()
+ * @brief	Sets every count to zero.
+ */
+
+void ShadowCacheStats::reset() {
+	feelers = 0;
+	occluded = 0;
+	cacheHits = 0;
+}
+
+/**
+ * @struct	OccluderCache
+ * @brief	One thread's last occluder of each light of one FrameLights, and the
+ * 			counts it has not yet added to FrameLights::shadowCacheStats. The counts
+ * 			are added when the thread moves on to another FrameLights, when that
+ * 			FrameLights is destroyed, and when the thread exits.
+ */
+
+struct OccluderCache {
+	unsigned int owner;					//!< id of the FrameLights the entries belong to. 0 ==> none.
+	const BVH *occluders;				//!< The occluders the entries were found in.
+	vector<VisibleIShapePtr> lastBlocker;	//!< Per light, the object that last blocked a feeler, or nullptr.
+	long long feelers, occluded, cacheHits;	//!< Counts not yet in FrameLights::shadowCacheStats.
+	OccluderCache() : owner(0), occluders(nullptr), feelers(0), occluded(0), cacheHits(0) {}
+	~OccluderCache() {
+		flush();
+	}
+	void flush() {
+		ShadowCacheStats &stats = FrameLights::shadowCacheStats;
+		stats.feelers.fetch_add(feelers, std::memory_order_relaxed);
+		stats.occluded.fetch_add(occluded, std::memory_order_relaxed);
+		stats.cacheHits.fetch_add(cacheHits, std::memory_order_relaxed);
+		feelers = occluded = cacheHits = 0;
+	}
+};
+
+static thread_local OccluderCache occluderCache;
+
+/**
+ * @fn	FrameLights::FrameLights(const vector<PositionalLightPtr> &lights, const Frame &eyeFrame)
+ * @brief	Resolves the lights for the current camera position, and builds the grid
+ * 			over the lights that have a range. Build a new one whenever the lights
+ * 			or the camera change, typically once per frame.
+ * @param	lights  	The scene's lights.
+ * @param	eyeFrame	The coordinate frame of the camera.
+ */
+
+FrameLights::FrameLights(const vector<PositionalLightPtr> &lights, const Frame &eyeFrame)
+	: id(nextId++), numUnbounded(0), boundedAmbient(black), eyePos(eyeFrame.origin) {
+	vector<ResolvedLight> bounded;
+	for (const PositionalLight *light : lights) {
+		if (!light->isOn) {
+			continue;
+		}
+		ResolvedLight L;
+		L.light = light;
+		L.position = light->actualPosition(eyeFrame);
+		const SpotLight *spot = dynamic_cast<const SpotLight *>(light);
+		L.isSpot = spot != nullptr;
+		L.spotDir = L.isSpot ? glm::normalize(spot->spotDir) : rvec3(0, 0, 0);
+		L.cosHalfFOV = L.isSpot ? std::cos(spot->fov / 2) : real(-1);
+		L.range = !L.isSpot && light->attenuationIsTurnedOn ? attenuationRange(light->atParams) : FLT_MAX;
+		if (L.range == FLT_MAX) {
+			resolved.push_back(L);
+		} else {
+			bounded.push_back(L);
+			boundedAmbient += light->lightColor.ambient;
+		}
+	}
+	numUnbounded = (int)resolved.size();
+	resolved.insert(resolved.end(), bounded.begin(), bounded.end());
+	buildGrid();
+}
+
+/**
+ * @fn	FrameLights::~FrameLights()
+ * @brief	Adds the calling thread's counts for these lights to shadowCacheStats.
+ * 			Worker threads add theirs when they exit.
+ */
+
+FrameLights::~FrameLights() {
+	if (occluderCache.owner == id) {
+		occluderCache.flush();
+		occluderCache.owner = 0;
+	}
+}
+
+/**
+ * @fn	void FrameLights::buildGrid()
+ * @brief	Builds a uniform grid over the ranges of the lights that have one. Each
+ * 			cell lists the lights whose range, as a box, overlaps it.
+ */
+
+void FrameLights::buildGrid() {
+	cells[0] = cells[1] = cells[2] = 1;
+	cellStart.clear();
+	cellLights.clear();
+	const int numBounded = (int)resolved.size() - numUnbounded;
+	if (numBounded == 0) {
+		return;
+	}
+
+	rvec3 lo = resolved[numUnbounded].position;
+	rvec3 hi = lo;
+	for (int i = numUnbounded; i < (int)resolved.size(); i++) {
+		const rvec3 reach(resolved[i].range, resolved[i].range, resolved[i].range);
+		lo = glm::min(lo, resolved[i].position - reach);
+		hi = glm::max(hi, resolved[i].position + reach);
 	}
+	const int perAxis = glm::clamp(2 * (int)std::ceil(std::cbrt((real)numBounded)), 1, MAX_LIGHT_GRID_CELLS);
+	gridLo = lo;
+	for (int k = 0; k < 3; k++) {
+		const real extent = hi[k] - lo[k];
+		cells[k] = extent > 0 ? perAxis : 1;
+		cellSize[k] = extent > 0 ? extent / cells[k] : real(1);
+	}
+
+	// Count the lights in each cell, then place them.
+	cellStart.assign(cells[0] * cells[1] * cells[2] + 1, 0);
+	for (int pass = 0; pass < 2; pass++) {
+		vector<int> next(cellStart.begin(), cellStart.end() - 1);
+		for (int i = numUnbounded; i < (int)resolved.size(); i++) {
+			const rvec3 reach(resolved[i].range, resolved[i].range, resolved[i].range);
+			int first[3], last[3];
+			getCellRange(resolved[i].position - reach, resolved[i].position + reach, first, last);
+			for (int z = first[2]; z <= last[2]; z++) {
+				for (int y = first[1]; y <= last[1]; y++) {
+					for (int x = first[0]; x <= last[0]; x++) {
+						int cell = (z * cells[1] + y) * cells[0] + x;
+						if (pass == 0) {
+							cellStart[cell + 1]++;
+						} else {
+							cellLights[next[cell]++] = i;
+						}
+					}
+				}
+			}
+		}
+		if (pass == 0) {
+			for (size_t c = 1; c < cellStart.size(); c++) {
+				cellStart[c] += cellStart[c - 1];
+			}
+			cellLights.resize(cellStart.back());
+		}
+	}
+}
+
+/**
+ * @fn	void FrameLights::getCellRange(const rvec3 &lo, const rvec3 &hi, int first[3], int last[3]) const
+ * @brief	Finds the cells a box overlaps, clamped to the grid.
+ * @param	lo   	Corner of the box with the smallest coordinates.
+ * @param	hi   	Corner of the box with the largest coordinates.
+ * @param	first	The first cell along each axis.
+ * @param	last 	The last cell along each axis.
+ */
+
+void FrameLights::getCellRange(const rvec3 &lo, const rvec3 &hi, int first[3], int last[3]) const {
+	for (int k = 0; k < 3; k++) {
+		first[k] = glm::clamp((int)std::floor((lo[k] - gridLo[k]) / cellSize[k]), 0, cells[k] - 1);
+		last[k] = glm::clamp((int)std::floor((hi[k] - gridLo[k]) / cellSize[k]), 0, cells[k] - 1);
+	}
+}
 
+/**
+ * @fn	bool FrameLights::isShadowed(int lightIndex, const rvec3 &pt, const rvec3 &n,
+ *									const BVH &occluders) const
+ * @brief	Determines if a point is in the shadow of one light, as inShadow does. The
+ * 			object that last blocked a feeler toward the light, on this thread, is
+ * 			tested first.
+ * @param	lightIndex	Index of the light in resolved.
+ * @param	pt		  	(x, y, z) of the point.
+ * @param	n		  	The normal vector at the point.
+ * @param	occluders 	The objects that cast shadows.
+ * @return	True iff the point is in the light's shadow.
+ */
+
+bool FrameLights::isShadowed(int lightIndex, const rvec3 &pt, const rvec3 &n, const BVH &occluders) const {
+	const rvec3 &lightPos = resolved[lightIndex].position;
+	rvec3 raisedPt = IShape::movePointOffSurface(pt, n);
+	Ray feeler = Ray(raisedPt, glm::normalize(lightPos - raisedPt));
+	real tMax = glm::distance(raisedPt, lightPos);
+
+	OccluderCache &cache = occluderCache;
+	if (cache.owner != id || cache.occluders != &occluders) {
+		cache.flush();
+		cache.owner = id;
+		cache.occluders = &occluders;
+		cache.lastBlocker.assign(resolved.size(), nullptr);
+	}
+	cache.feelers++;
+	VisibleIShapePtr &last = cache.lastBlocker[lightIndex];
+	if (cacheOccluders && last != nullptr && last->occludes(feeler, tMax)) {
+		cache.occluded++;
+		cache.cacheHits++;
+		return true;
+	}
+	if (occluders.findAnyIntersection(feeler, tMax, &last)) {
+		cache.occluded++;
+		return true;
+	}
 	return false;
-}
\ No newline at end of file
+}
+
+/**
+ * @fn	color FrameLights::illuminate(const rvec3 &pt, const rvec3 &n, const Material &material,
+ *									const BVH *occluders) const
+ * @brief	Computes the color all the lights produce at a point. Shadow feelers are
+ * 			only cast toward lights that reach the point. The ambient colors of the
+ * 			lights with a range are added as one sum, which matches adding them one
+ * 			at a time as long as no product of material and light color exceeds 1.
+ * @param	pt		 	(x, y, z) of the point.
+ * @param	n		 	The normal vector.
+ * @param	material 	The object's material properties.
+ * @param	occluders	The objects that cast shadows. nullptr ==> the point is in
+ * 						shadow of every light, e.g., on a transparent surface.
+ * @return	The sum of the colors produced by each light.
+ */
+
+color FrameLights::illuminate(const rvec3 &pt, const rvec3 &n, const Material &material,
+								const BVH *occluders) const {
+	color total = material.ambient * boundedAmbient;
+	for (int i = 0; i < numUnbounded; i++) {
+		const ResolvedLight &L = resolved[i];
+		if (L.isSpot && !L.inCone(pt)) {
+			continue;
+		}
+		bool shadowed = occluders == nullptr || isShadowed(i, pt, n, *occluders);
+		total += L.illuminate(pt, n, material, eyePos, shadowed);
+	}
+
+	if (occluders == nullptr || cellLights.empty()) {
+		return total;
+	}
+	int c[3];
+	for (int k = 0; k < 3; k++) {
+		real f = (pt[k] - gridLo[k]) / cellSize[k];
+		if (!(f >= 0 && f < cells[k])) {
+			return total;
+		}
+		c[k] = (int)f;
+	}
+	const int cell = (c[2] * cells[1] + c[1]) * cells[0] + c[0];
+	for (int j = cellStart[cell]; j < cellStart[cell + 1]; j++) {
+		const ResolvedLight &L = resolved[cellLights[j]];
+		if (glm::distance(pt, L.position) >= L.range || isShadowed(cellLights[j], pt, n, *occluders)) {
+			continue;
+		}
+		total += L.illuminate(pt, n, material, eyePos, false) -
+					ambientColor(material.ambient, L.light->lightColor.ambient);
+	}
+	return total;
+}
@@ -8,11 +8,13 @@
  ****************************************************/
 
 #pragma once
+#include <atomic>
 #include <iostream>
 #include <vector>
 #include "defs.h"
 #include "hitrecord.h"
 #include "ishape.h"
+#include "bvh.h"
 
  /**
   * @struct	LightATParams
@@ -20,13 +22,13 @@
   */
 
 struct LightATParams {
-	double constant, linear, quadratic;	//!< Parameters controlling attenuation.
-	LightATParams(double C, double L, double Q) {
+	real constant, linear, quadratic;	//!< Parameters controlling attenuation.
+	LightATParams(real C, real L, real Q) {
 		constant = C;
 		linear = L;
 		quadratic = Q;
 	}
-	double factor(double distance) const {
+	real factor(real distance) const {
 		return 1.0 / (constant + linear * distance + quadratic * distance * distance);
 	}
 };
@@ -44,7 +46,7 @@ struct LightColor {
 	LightColor(const color& oneColor)
 		: ambient(oneColor), diffuse(oneColor), specular(oneColor) {
 	}
-	LightColor(const vector<double>& C)
+	LightColor(const vector<real>& C)
 		: LightColor(color(C[0], C[1], C[2]),
 			color(C[3], C[4], C[5]),
 			color(C[6], C[7], C[8])) {
@@ -61,8 +63,8 @@ struct LightSource {
 	LightSource() {
 		isOn = true;
 	}
-	virtual color illuminate(const dvec3& interceptWorldCoords,
-		const dvec3& normal,
+	virtual color illuminate(const rvec3& interceptWorldCoords,
+		const rvec3& normal,
 		const Material& material,
 		const Frame& eyeFrame, bool inShadow) const = 0;
 };
@@ -73,13 +75,13 @@ struct LightSource {
  */
 
 struct PositionalLight : public LightSource {
-	dvec3 pos;					//!< The position of the light.
+	rvec3 pos;					//!< The position of the light.
 	bool attenuationIsTurnedOn;	//!< true if attenuation is active.
 	bool isTiedToWorld;			//!< true if the position is in world (or eye) coordinates.
 	LightATParams atParams;
 	LightColor lightColor;
 
-	PositionalLight(const dvec3& position, const LightColor& color)
+	PositionalLight(const rvec3& position, const LightColor& color)
 		: LightSource(), lightColor(color), pos(position), atParams(0.0, 1.0, 0.0) {
 		attenuationIsTurnedOn = false;
 		isTiedToWorld = true;
@@ -90,9 +92,9 @@ struct PositionalLight : public LightSource {
 	void setAttenuationParams(const LightATParams& params) {
 		atParams = params;
 	}
-	dvec3 actualPosition(const Frame& eyeFrame) const;
-	virtual color illuminate(const dvec3& interceptWorldCoords,
-		const dvec3& normal,
+	rvec3 actualPosition(const Frame& eyeFrame) const;
+	virtual color illuminate(const rvec3& interceptWorldCoords,
+		const rvec3& normal,
 		const Material& material,
 		const Frame& eyeFrame, bool inShadow) const;
 };
@@ -103,36 +105,117 @@ struct PositionalLight : public LightSource {
  */
 
 struct SpotLight : public PositionalLight {
-	double fov;				//!< Field of view of the light.
-	dvec3 spotDir;			//!< Direction of spotlight.
-	SpotLight(const dvec3& position, const dvec3& dir,
-		double angleInRadians, const LightColor& lightColor)
+	real fov;				//!< Field of view of the light.
+	rvec3 spotDir;			//!< Direction of spotlight.
+	SpotLight(const rvec3& position, const rvec3& dir,
+		real angleInRadians, const LightColor& lightColor)
 		: PositionalLight(position, lightColor), spotDir(dir),
 		fov(angleInRadians) {
 	}
-	virtual color illuminate(const dvec3& interceptWorldCoords,
-		const dvec3& normal,
+	virtual color illuminate(const rvec3& interceptWorldCoords,
+		const rvec3& normal,
 		const Material& material,
 		const Frame& eyeFrame, bool inShadow) const;
-	void setDir(double dx, double dy, double dz);
+	void setDir(real dx, real dy, real dz);
 };
 
-const LightColor pureWhiteLight(vector<double>{1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0});
+const LightColor pureWhiteLight(vector<real>{1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0});
 
 color ambientColor(const color& matAmbient, const color& lightAmbient);
 color diffuseColor(const color& matDiffuse, const color& lightDiffuse,
-	const dvec3& l, const dvec3& n);
+	const rvec3& l, const rvec3& n);
 color specularColor(const color& mat, const color& light,
-	double shininess,
-	const dvec3& r, const dvec3& v);
+	real shininess,
+	const rvec3& r, const rvec3& v);
 color totalColor(const Material& mat, const LightColor& lightColor,
-	const dvec3& v, const dvec3& n,
-	const dvec3& lightPos, const dvec3& intersectionPt,
+	const rvec3& v, const rvec3& n,
+	const rvec3& lightPos, const rvec3& intersectionPt,
 	bool attenuationOn,
 	const LightATParams& ATparams);
-bool inCone(const dvec3& spotPos, const dvec3& spotDir, double spotFOV, const dvec3& intercept);
-bool inShadow(const dvec3& lightPos, const dvec3& intercept, const dvec3& normal, const vector<VisibleIShapePtr>& objects);
+bool inCone(const rvec3& spotPos, const rvec3& spotDir, real spotFOV, const rvec3& intercept);
+bool inShadow(const rvec3& lightPos, const rvec3& intercept, const rvec3& normal, const vector<VisibleIShapePtr>& objects);
+bool inShadow(const rvec3& lightPos, const rvec3& intercept, const rvec3& normal, const BVH& objects);
 
 typedef LightSource* LightSourcePtr;
 typedef PositionalLight* PositionalLightPtr;
-typedef SpotLight* SpotLightPtr;
\ No newline at end of file
+typedef SpotLight* SpotLightPtr;
+
+const real MIN_ATTENUATION = 1.0 / 1024;	//!< Where attenuation is below this, a light adds only its ambient color.
+const int MAX_LIGHT_GRID_CELLS = 16;		//!< Most cells along each axis of a FrameLights grid.
+
+/**
+ * @struct	ResolvedLight
+ * @brief	A positional or spot light with everything that does not depend on the
+ * 			point being lit worked out once per frame.
+ */
+
+struct ResolvedLight {
+	const PositionalLight *light;	//!< The light, for its colors and attenuation.
+	rvec3 position;					//!< Position in world coordinates.
+	bool isSpot;					//!< True ==> only points inside the cone are lit.
+	rvec3 spotDir;					//!< Normalized direction of a spot light.
+	real cosHalfFOV;				//!< Cosine of half the spot light's field of view.
+	real range;						//!< Farther away, attenuation is below MIN_ATTENUATION. FLT_MAX if unattenuated.
+	bool inCone(const rvec3 &pt) const {
+		return glm::dot(spotDir, glm::normalize(pt - position)) > cosHalfFOV;
+	}
+	color illuminate(const rvec3 &pt, const rvec3 &n, const Material &material,
+						const rvec3 &eyePos, bool inShadow) const;
+};
+
+/**
+ * @struct	ShadowCacheStats
+ * @brief	Counts of the shadow feelers cast by FrameLights, and of how many the
+ * 			last occluder cache answered. Safe to update from several threads.
+ */
+
+struct ShadowCacheStats {
+	std::atomic<long long> feelers;		//!< Shadow feelers cast.
+	std::atomic<long long> occluded;	//!< Feelers that were blocked.
+	std::atomic<long long> cacheHits;	//!< Blocked feelers found by testing only the cached occluder.
+	void reset();
+};
+
+/**
+ * @struct	FrameLights
+ * @brief	A scene's lights, resolved once per frame for use in ray tracing. Lights
+ * 			that are off are dropped. Positional lights with attenuation have a
+ * 			limited range, and are found through a uniform grid over their ranges,
+ * 			so lighting a point only visits the ones that can reach it. Outside its
+ * 			range, such a light adds only its ambient color, which is summed over
+ * 			all of them in advance. Other lights reach every point and are always
+ * 			visited, though a spot light is skipped, shadow feeler included, for
+ * 			points outside its cone.
+ *
+ * 			Each thread remembers, for each light, the object that last blocked a
+ * 			shadow feeler toward it, and tests that object before searching the
+ * 			occluders. Neighboring points are usually shadowed by the same object,
+ * 			so most blocked feelers are settled by a single intersection test. The
+ * 			occluders passed to illuminate() must not change while a FrameLights
+ * 			is in use.
+ */
+
+struct FrameLights {
+	static bool cacheOccluders;					//!< True ==> test the last occluder of each light first. Typically true
+	static ShadowCacheStats shadowCacheStats;	//!< Shadow feelers cast, and how many the cache answered.
+	FrameLights(const vector<PositionalLightPtr> &lights, const Frame &eyeFrame);
+	~FrameLights();
+	color illuminate(const rvec3 &pt, const rvec3 &n, const Material &material,
+						const BVH *occluders) const;
+	int getNumLights() const { return (int)resolved.size(); }
+protected:
+	unsigned int id;				//!< Distinguishes this from other FrameLights in threads' occluder caches.
+	vector<ResolvedLight> resolved;	//!< Lights that reach everywhere, then those with a range.
+	int numUnbounded;				//!< Number of lights that reach everywhere.
+	color boundedAmbient;			//!< Sum of the ambient colors of the lights with a range.
+	rvec3 eyePos;					//!< Camera position in world coordinates.
+	rvec3 gridLo;					//!< Lowest corner of the grid.
+	rvec3 cellSize;					//!< Size of a grid cell.
+	int cells[3];					//!< Number of cells along x, y and z.
+	vector<int> cellStart;			//!< Lights of cell i are cellLights[cellStart[i], cellStart[i + 1]).
+	vector<int> cellLights;			//!< Indices into resolved, grouped by cell.
+	void buildGrid();
+	void getCellRange(const rvec3 &lo, const rvec3 &hi, int first[3], int last[3]) const;
+	bool isShadowed(int lightIndex, const rvec3 &pt, const rvec3 &n, const BVH &occluders) const;
+	static std::atomic<unsigned int> nextId;	//!< id of the next FrameLights.
+};
@@ -0,0 +1,294 @@
+/****************************************************
+ * 2016-2021 Eric Bachmann and Mike Zmuda
+ * All Rights Reserved.
+ * NOTICE:
+ * Dissemination of this information or reproduction
+ * of this material is prohibited unless prior written
+ * permission is granted.
+ ****************************************************/
+
+/*
+ * Headless renderer. Builds a scene, renders it without opening a window,
+ * writes the framebuffer to a PPM or PNG file and reports how long it took.
+ * Meant for batch rendering and performance regression runs.
+ *
+ * Build it with CONSOLE_ONLY defined, so that neither GLUT nor OpenGL is
+ * needed, together with the library sources (everything except the other
+ * drivers). For example:
+ *
+ *	g++ -std=c++17 -O2 -DCONSOLE_ONLY -pthread camera.cpp colorandmaterials.cpp
+ *		defs.cpp eshape.cpp fragmentops.cpp framebuffer.cpp image.cpp io.cpp
+ *		iscene.cpp ishape.cpp bvh.cpp light.cpp rasterization.cpp raytracer.cpp
+ *		texture.cpp utilities.cpp vertexops.cpp vertextdata.cpp offlinerender.cpp -o offlinerender
+ *
+ * Usage: offlinerender [options]
+ *	-pipeline		render with VertexOps::render instead of the ray tracer
+ *	-lit			pipeline: Phong lighting instead of ambient color only
+ *	-scalar			pipeline: process fragments one at a time instead of in batches
+ *	-noearlyz		pipeline: test depth after interpolating every attribute
+ *	-nohiz			pipeline: do not cull hidden triangles and blocks with the coarse depth buffer
+ *	-color C		color buffer format: rgb8, rgba8 or float (default rgb8)
+ *	-zbuffer Z		depth buffer format: real, float or 24 (default real)
+ *	-tiled			store the framebuffer in 8 x 8 tiles instead of rows
+ *	-size W H		image size (default 800 600)
+ *	-aa N			N x N rays per pixel (default 1)
+ *	-adaptive T		trace N x N rays only in pixels that differ from a neighbor by more than T
+ *	-depth D		reflection depth (default 1)
+ *	-threads T		render threads; 0 means one per core (default 0)
+ *	-frames F		number of times to render the image (default 1)
+ *	-noshadowcache	ray tracer: search every occluder for each shadow feeler, without trying the last one first
+ *	-texturebudget M	megabytes of texture pages kept in memory (default 256)
+ *	-o FILE			output file; .png or .ppm (default render.ppm)
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include "defs.h"
+#include "io.h"
+#include "ishape.h"
+#include "eshape.h"
+#include "framebuffer.h"
+#include "raytracer.h"
+#include "iscene.h"
+#include "light.h"
+#include "image.h"
+#include "camera.h"
+#include "vertexops.h"
+
+TexturePtr im1 = TextureCache::global().get("usflag.ppm");
+
+int width = 800;
+int height = 600;
+int antiAliasing = 1;
+int numReflections = 1;
+int numThreads = 0;
+int numFrames = 1;
+real adaptiveThreshold = -1.0;		// < 0 ==> fixed N x N supersampling
+bool usePipeline = false;
+FrameBufferFormat frameBufferFormat;
+string outputFileName = "render.ppm";
+
+vector<PositionalLightPtr> lights = {
+						new PositionalLight(rvec3(10, 10, 10), pureWhiteLight),
+						new SpotLight(rvec3(0, 10, 0), rvec3(0, -1, 0),
+										glm::radians(65.0), pureWhiteLight)
+};
+
+/**
+ * @fn	void buildScene(IScene &scene)
+ * @brief	Builds the scene used by fullraytrace.cpp.
+ * @param [in,out]	scene	The scene to fill.
+ */
+
+void buildScene(IScene &scene) {
+	IPlane *plane = new IPlane(rvec3(0.0, -2.0, 0.0), rvec3(0.0, 1.0, 0.0));
+	IPlane *clearPlane = new IPlane(rvec3(0.0, 0.0, -10.0), rvec3(0.0, 0.0, -1.0));	// where fullraytrace starts it
+	ISphere *sphere1 = new ISphere(rvec3(0.0, 4.0, 0.0), 2.0);
+	IClosedCylinderY *closedCylinder = new IClosedCylinderY(rvec3(2.0, 0.0, 3.0), 2.0, 5.0);
+	ICylinderY *cylinderY = new ICylinderY(rvec3(-4.0, 0.0, 5.0), 2.0, 3.0);
+	ICylinderZ *cylinderZ = new ICylinderZ(rvec3(5.0, 0.0, -2.0), 2.0, 3.0);
+	IConeY *cone = new IConeY(rvec3(1.0, 4.0, 4.0), 1.0, 2.0);
+
+	scene.addOpaqueObject(new VisibleIShape(plane, tin));
+	scene.addTransparentObject(new VisibleIShape(clearPlane, Material(red, red, red, 0.0)), 0.25);
+	scene.addOpaqueObject(new VisibleIShape(sphere1, gold));
+	scene.addOpaqueObject(new VisibleIShape(closedCylinder, greenRubber));
+	scene.addOpaqueObject(new VisibleIShape(cylinderY, copper, im1));
+	scene.addOpaqueObject(new VisibleIShape(cylinderZ, polishedBronze));
+	scene.addOpaqueObject(new VisibleIShape(cone, yellowRubber));
+
+	scene.addLight(lights[0]);
+	scene.addLight(lights[1]);
+	scene.finalize();
+}
+
+/**
+ * @fn	real raytrace(FrameBuffer &frameBuffer)
+ * @brief	Ray traces the scene into the framebuffer numFrames times.
+ * @param [in,out]	frameBuffer	The framebuffer.
+ * @return	Number of primary rays traced.
+ */
+
+real raytrace(FrameBuffer &frameBuffer) {
+	PerspectiveCamera camera(rvec3(6, 6, 6), ORIGIN3D, Y_AXIS, glm::radians(100.0), width, height);
+	IScene scene(&camera);
+	buildScene(scene);
+	RayTracer rayTracer(lightGray, numThreads);
+
+	real numRays = 0;
+	for (int i = 0; i < numFrames; i++) {
+		if (adaptiveThreshold >= 0.0) {
+			numRays += rayTracer.raytraceSceneAdaptive(frameBuffer, numReflections, scene, antiAliasing,
+														adaptiveThreshold, rvec2(0, 0), rvec2(width, height));
+		} else {
+			rayTracer.raytraceScene(frameBuffer, numReflections, scene, antiAliasing,
+									rvec2(0, 0), rvec2(width, height));
+			numRays += (real)width * height * antiAliasing * antiAliasing;
+		}
+	}
+	return numRays;
+}
+
+/**
+ * @fn	void rasterize(FrameBuffer &frameBuffer)
+ * @brief	Renders the objects of exercisepipelineshadinghiddensurfaces.cpp into the
+ * 			framebuffer numFrames times using the object-order pipeline.
+ * @param [in,out]	frameBuffer	The framebuffer.
+ */
+
+void rasterize(FrameBuffer &frameBuffer) {
+	VertexOps::numThreads = numThreads;
+	vector<LightSourcePtr> pipelineLights = { new PositionalLight(rvec3(0, 10, 4), pureWhiteLight) };
+	PipelineMatrices pipeMats;
+	pipeMats.viewingMatrix = glm::lookAt(rvec3(0, 5, 5), rvec3(0, 0, 0), Y_AXIS);
+	pipeMats.projectionMatrix = glm::perspective(PI_3, (real)width / height, real(0.5), real(80.0));
+	pipeMats.viewportMatrix = VertexOps::getViewportTransformation(0, width, 0, height);
+
+	rvec4 A(-1, -1, 0, 1);
+	rvec4 B(+1, -1, 0, 1);
+	rvec4 C(0, +1, 0, 1);
+	EShapeData board = EShape::createECheckerBoard(copper, polishedCopper, 10, 10, 10);
+	EShapeData tri1 = EShape::createETriangle(gold, A, B, C);
+	EShapeData tri2 = EShape::createETriangle(polishedCopper, A, B, C);
+	EShapeData tri3 = EShape::createETriangle(cyanPlastic, A, B, C);
+	EShapeData cone = EShape::createECone(pewter, 8);
+
+	for (int i = 0; i < numFrames; i++) {
+		frameBuffer.clearColorAndDepthBuffers();
+		VertexOps::render(frameBuffer, board, pipelineLights, rmat4(), pipeMats, true);
+		VertexOps::render(frameBuffer, tri1, pipelineLights, T(0, 2, 0) * S(5, 2, 1), pipeMats, true);
+		VertexOps::render(frameBuffer, tri2, pipelineLights, T(-1, 0, 0) * Ry(-PI_3) * S(10, 3, 1), pipeMats, true);
+		VertexOps::render(frameBuffer, tri3, pipelineLights, T(0, 1, 0) * S(8, 1, 1) * Ry(PI_4) * Rz(PI_2), pipeMats, true);
+		VertexOps::render(frameBuffer, cone, pipelineLights, T(-3, 0, 3), pipeMats, true);
+	}
+}
+
+/**
+ * @fn	bool parseArguments(int argc, char *argv[])
+ * @brief	Reads the command line options into the globals above.
+ * @return	False if the command line could not be understood.
+ */
+
+bool parseArguments(int argc, char *argv[]) {
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "-pipeline") {
+			usePipeline = true;
+		} else if (arg == "-lit") {
+			FragmentOps::performLighting = true;
+		} else if (arg == "-scalar") {
+			FragmentOps::batchFragments = false;
+		} else if (arg == "-noearlyz") {
+			FragmentOps::earlyDepthTest = false;
+		} else if (arg == "-nohiz") {
+			FragmentOps::hierarchicalDepthTest = false;
+		} else if (arg == "-noshadowcache") {
+			FrameLights::cacheOccluders = false;
+		} else if (arg == "-color" && hasValue) {
+			string value = argv[++i];
+			if (value == "rgb8") {
+				frameBufferFormat.color = ColorFormat::RGB8;
+			} else if (value == "rgba8") {
+				frameBufferFormat.color = ColorFormat::RGBA8;
+			} else if (value == "float") {
+				frameBufferFormat.color = ColorFormat::RGBA_FLOAT;
+			} else {
+				return false;
+			}
+		} else if (arg == "-zbuffer" && hasValue) {
+			string value = argv[++i];
+			if (value == "real") {
+				frameBufferFormat.depth = DepthFormat::REAL;
+			} else if (value == "float") {
+				frameBufferFormat.depth = DepthFormat::FLOAT32;
+			} else if (value == "24") {
+				frameBufferFormat.depth = DepthFormat::UNORM24;
+			} else {
+				return false;
+			}
+		} else if (arg == "-tiled") {
+			frameBufferFormat.layout = PixelLayout::TILED;
+		} else if (arg == "-size" && i + 2 < argc) {
+			width = atoi(argv[++i]);
+			height = atoi(argv[++i]);
+		} else if (arg == "-aa" && hasValue) {
+			antiAliasing = atoi(argv[++i]);
+		} else if (arg == "-adaptive" && hasValue) {
+			adaptiveThreshold = atof(argv[++i]);
+		} else if (arg == "-depth" && hasValue) {
+			numReflections = atoi(argv[++i]);
+		} else if (arg == "-threads" && hasValue) {
+			numThreads = atoi(argv[++i]);
+		} else if (arg == "-frames" && hasValue) {
+			numFrames = atoi(argv[++i]);
+		} else if (arg == "-texturebudget" && hasValue) {
+			TextureCache::global().setMemoryBudget((size_t)(atof(argv[++i]) * 1024 * 1024));
+		} else if (arg == "-o" && hasValue) {
+			outputFileName = argv[++i];
+		} else {
+			return false;
+		}
+	}
+	return width > 0 && height > 0 && antiAliasing > 0 && numFrames > 0;
+}
+
+int main(int argc, char *argv[]) {
+	if (!parseArguments(argc, argv)) {
+		std::cerr << "Usage: " << argv[0] << " [-pipeline] [-lit] [-scalar] [-noearlyz] [-nohiz] [-color rgb8|rgba8|float] "
+					<< "[-zbuffer real|float|24] [-tiled] [-size W H] [-aa N] [-adaptive T] [-depth D] "
+					<< "[-threads T] [-frames F] [-noshadowcache] [-texturebudget M] [-o file.ppm|file.png]" << endl;
+		return 1;
+	}
+
+	FrameBuffer frameBuffer(width, height, frameBufferFormat);
+	frameBuffer.setClearColor(lightGray);
+	frameBuffer.clearColorAndDepthBuffers();
+
+	auto startTime = std::chrono::steady_clock::now();
+	real numRays = 0;
+	if (usePipeline) {
+		rasterize(frameBuffer);
+	} else {
+		numRays = raytrace(frameBuffer);
+	}
+	real totalTimeSec = std::chrono::duration<real>(std::chrono::steady_clock::now() - startTime).count();
+
+	cout << "Rendered " << numFrames << " frame(s) of " << width << "x" << height
+		<< (usePipeline ? " with the pipeline" : " with the ray tracer")
+		<< " in " << totalTimeSec << " sec (" << totalTimeSec / numFrames << " sec/frame)" << endl;
+	if (usePipeline) {
+		const DepthCullStats &stats = FragmentOps::depthCullStats;
+		real pixels = (real)numFrames * width * height;
+		cout << "Fragments per pixel: " << stats.fragmentsInterpolated / pixels << " interpolated, "
+			<< stats.fragmentsShaded / pixels << " shaded; "
+			<< stats.fragmentsRejected / pixels << " rejected by the early depth test" << endl;
+		cout << "Culled by the coarse depth buffer: " << stats.trianglesCulled / numFrames << " triangles, "
+			<< stats.blocksCulled / numFrames << " blocks per frame" << endl;
+	} else {
+		cout << "Primary rays: " << numRays / numFrames << " per frame ("
+			<< numRays / ((real)numFrames * width * height) << " per pixel), "
+			<< numRays / totalTimeSec << " per sec" << endl;
+		const ShadowCacheStats &shadows = FrameLights::shadowCacheStats;
+		real feelers = (real)glm::max(shadows.feelers.load(), 1LL);
+		real occluded = (real)glm::max(shadows.occluded.load(), 1LL);
+		cout << "Shadow feelers: " << shadows.feelers / numFrames << " per frame, "
+			<< 100 * shadows.occluded / feelers << "% blocked; last occluder cache found "
+			<< 100 * shadows.cacheHits / occluded << "% of blockers (" << 100 * shadows.cacheHits / feelers
+			<< "% of feelers)" << endl;
+		const TextureCacheStats &stats = TextureCache::global().stats;
+		cout << "Textures: " << stats.filesLoaded << " file(s) loaded, " << stats.pagesEvicted << " pages evicted, "
+			<< stats.pagesLoaded << " read back; " << TextureCache::global().getResidentSize() / 1024 << " KB resident" << endl;
+	}
+
+	size_t dot = outputFileName.rfind('.');
+	bool isPNG = dot != string::npos && outputFileName.substr(dot) == ".png";
+	bool written = isPNG ? frameBuffer.writePNG(outputFileName) : frameBuffer.writePPM(outputFileName);
+	if (!written) {
+		std::cerr << "Could not write " << outputFileName << endl;
+		return 1;
+	}
+	cout << "Wrote " << outputFileName << endl;
+	return 0;
+}
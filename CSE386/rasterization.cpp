@@ -7,11 +7,12 @@
  * permission is granted.
  ****************************************************/
 
+#include <algorithm>
 #include <cmath>
 #include "rasterization.h"
 
 /**
-* @fn	template <class T> T barycentricWeighting(double w1, double w2, double w3, 
+* @fn	template <class T> T barycentricWeighting(real w1, real w2, real w3, 
 *													const T &i1, const T &i2, const T &i3)
 * @brief	Computes the Barycentric weighting of three values.
 * @tparam	T	Generic type parameter.
@@ -25,7 +26,7 @@
 */
 
 template <class T>
-T barycentricWeighting(double w1, double w2, double w3, const T &i1, const T &i2, const T &i3) {
+T barycentricWeighting(real w1, real w2, real w3, const T &i1, const T &i2, const T &i3) {
 	return w1*i1 + w2*i2 + w3*i3;
 }
 
@@ -50,7 +51,7 @@ static void drawVerticalLine(FrameBuffer &fb, int x, int bottom, int top, const
 	bottom = bottom < 0 ? 0 : bottom;
 	top = top >= H ? H - 1 : top;
 	for (int y = bottom; y <= top; y++) {
-		if (inRectangle((double)x, (double)y, 0.0, 0.0, W-1.0, H-1.0))
+		if (inRectangle((real)x, (real)y, 0.0, 0.0, W-1.0, H-1.0))
 			fb.setColor(x, y, rgb);
 	}
 }
@@ -75,13 +76,13 @@ static void drawHorizontalLine(FrameBuffer &fb, int y, int left, int right, cons
 	left = left < 0 ? 0 : left;
 	right = right >= W ? W - 1 : right;
 	for (int x = left; x <= right; x++) {
-		if (inRectangle((double)x, (double)y, 0.0, 0.0, W - 1.0, H - 1.0))
+		if (inRectangle((real)x, (real)y, 0.0, 0.0, W - 1.0, H - 1.0))
 			fb.setColor(x, y, rgb);
 	}
 }
 
 /**
- * @fn	void drawBresenhamLine(FrameBuffer &fb, const dvec2 &p1, const dvec2 &p2, const color &rgb)
+ * @fn	void drawBresenhamLine(FrameBuffer &fb, const rvec2 &p1, const rvec2 &p2, const color &rgb)
  * @brief	Draw line using bresenham's algorithm
  * @param [in,out]	fb 	Framebuffer.
  * @param 		  	p1 	First point.
@@ -90,8 +91,8 @@ static void drawHorizontalLine(FrameBuffer &fb, int y, int left, int right, cons
  */
 
 static void drawBresenhamLine(FrameBuffer &fb, 
-						const dvec2 &p1, 
-						const dvec2 &p2, const color &rgb) {
+						const rvec2 &p1, 
+						const rvec2 &p2, const color &rgb) {
 	const int H = fb.getWindowHeight();
 	const int W = fb.getWindowWidth();
 
@@ -108,7 +109,7 @@ static void drawBresenhamLine(FrameBuffer &fb,
 
 	int err = dx - dy;
 
-	if (inRectangle((double)x0, (double)y0, 0.0, 0.0, W - 1.0, H - 1.0)) {
+	if (inRectangle((real)x0, (real)y0, 0.0, 0.0, W - 1.0, H - 1.0)) {
 		fb.setColor(x0, y0, rgb);
 	}
 
@@ -124,14 +125,14 @@ static void drawBresenhamLine(FrameBuffer &fb,
 			y0 += sy;
 		}
 
-		if (inRectangle((double)x0, (double)y0, 0.0, 0.0, W - 1.0, H - 1.0)) {
+		if (inRectangle((real)x0, (real)y0, 0.0, 0.0, W - 1.0, H - 1.0)) {
 			fb.setColor(x0, y0, rgb);
 		}
 	}
 }
 
 /**
- * @fn	void drawLine(FrameBuffer &fb, const dvec2 &A, const dvec2 &B, const color &rgb)
+ * @fn	void drawLine(FrameBuffer &fb, const rvec2 &A, const rvec2 &B, const color &rgb)
  * @brief	Draw line
  * @param [in,out]	fb 	Framebuffer.
  * @param 		  	A  	First endpoint.
@@ -139,7 +140,7 @@ static void drawBresenhamLine(FrameBuffer &fb,
  * @param 		  	rgb	Color.
  */
 
-void drawLine(FrameBuffer &fb, const dvec2 &A, const dvec2 &B, const color &rgb) {
+void drawLine(FrameBuffer &fb, const rvec2 &A, const rvec2 &B, const color &rgb) {
 	if (A.x == B.x) {
 		drawVerticalLine(fb, (int)A.x, (int)A.y, (int)B.y, rgb);
 	} else if (A.y == B.y) {
@@ -161,12 +162,12 @@ void drawLine(FrameBuffer &fb, const dvec2 &A, const dvec2 &B, const color &rgb)
  */
 
 void drawLine(FrameBuffer &frameBuffer, int x1, int y1, int x2, int y2, const color &C) {
-	drawLine(frameBuffer, dvec2(x1, y1), dvec2(x2, y2), C);
+	drawLine(frameBuffer, rvec2(x1, y1), rvec2(x2, y2), C);
 }
 
 /**
- * @fn	void drawArc(FrameBuffer &fb, const dvec2 &center, double R, 
- *						double startRads, double lengthInRads, const color &rgb)
+ * @fn	void drawArc(FrameBuffer &fb, const rvec2 &center, real R, 
+ *						real startRads, real lengthInRads, const color &rgb)
  * @brief	Draw arc on xy plane, using traditional x-y axis orientation. Zero degrees is
  * 			+x axis, 90 degrees, is +y axis, etc.
  * @param [in,out]	fb				Framebuffer.
@@ -177,29 +178,29 @@ void drawLine(FrameBuffer &frameBuffer, int x1, int y1, int x2, int y2, const co
  * @param 		  	rgb				Color.
  */
 
-void drawArc(FrameBuffer &fb, const dvec2 &center, double R,
-					double startRads, double lengthInRads, const color &rgb) {
-	double lengthInPixels = 2 * PI * R;
+void drawArc(FrameBuffer &fb, const rvec2 &center, real R,
+					real startRads, real lengthInRads, const color &rgb) {
+	real lengthInPixels = 2 * PI * R;
 	int DIV = (int)std::fmax((lengthInPixels / 5), 4);
-	double radInc = lengthInRads / DIV;
+	real radInc = lengthInRads / DIV;
 	for (int i = 0; i < DIV; i++) {
-		double a1 = startRads + i * radInc;
-		double a2 = a1 + radInc;
-		dvec2 pt1 = pointOnCircle(center, R, a1);
-		dvec2 pt2 = pointOnCircle(center, R, a2);
+		real a1 = startRads + i * radInc;
+		real a2 = a1 + radInc;
+		rvec2 pt1 = pointOnCircle(center, R, a1);
+		rvec2 pt2 = pointOnCircle(center, R, a2);
 		drawLine(fb, pt1, pt2, rgb);
 	}
 }
 
 /**
- * @fn	void drawWirePolygon(FrameBuffer &fb, const vector<dvec3> &pts, const color &rgb)
+ * @fn	void drawWirePolygon(FrameBuffer &fb, const vector<rvec3> &pts, const color &rgb)
  * @brief	Draw wire polygon
  * @param [in,out]	fb 	Framebuffere.
  * @param 		  	pts	The vertices of the polygon.
  * @param 		  	rgb	Color.
  */
 
-void drawWirePolygon(FrameBuffer &fb, const vector<dvec3> &pts, const color &rgb) {
+void drawWirePolygon(FrameBuffer &fb, const vector<rvec3> &pts, const color &rgb) {
 	for (unsigned int i = 1; i < pts.size(); i++) {
 		drawLine(fb, pts[i - 1].xy(), pts[i].xy(), rgb);
 	}
@@ -222,8 +223,8 @@ void drawAxisOnWindow(FrameBuffer &fb) {
 }
 
 /**
- * @fn	double cheapNonPerspectiveCorrectInterpolationForLines(const dvec2 &start, const dvec2 &end, 
- *																const dvec2 &online)
+ * @fn	real cheapNonPerspectiveCorrectInterpolationForLines(const rvec2 &start, const rvec2 &end, 
+ *																const rvec2 &online)
  * @brief	Cheap non perspective correct interpolation for lines
  * @param	start 	The starting vertex.
  * @param	end   	The ending vertex
@@ -231,15 +232,15 @@ void drawAxisOnWindow(FrameBuffer &fb) {
  * @return	Interpolated value.
  */
 
-static double cheapNonPerspectiveCorrectInterpolationForLines(const dvec2 &start, const dvec2 &end, 
-																const dvec2 &online) {
+static real cheapNonPerspectiveCorrectInterpolationForLines(const rvec2 &start, const rvec2 &end, 
+																const rvec2 &online) {
 	return glm::length(online - start) / glm::length(end - start);
 }
 
 /**
- * @fn	void drawVerticalLine(FrameBuffer &frameBuffer, const dvec3 &eyePos, 
+ * @fn	void drawVerticalLine(FrameBuffer &frameBuffer, const rvec3 &eyePos, 
  *									const vector<LightSourcePtr> &lights, 
- *									VertexData v0, VertexData v1, const dmat4 &viewingMatrix)
+ *									VertexData v0, VertexData v1, const rmat4 &viewingMatrix)
  * @brief	Draw vertical line
  * @param [in,out]	frameBuffer  	Framebuffer.
  * @param 		  	eyePos		 	Eye position.
@@ -249,37 +250,37 @@ static double cheapNonPerspectiveCorrectInterpolationForLines(const dvec2 &start
  * @param 		  	eyeFrame	    The camera's frame.
  */
 
-static void drawVerticalLine(FrameBuffer &frameBuffer, const dvec3 &eyePos,
+static void drawVerticalLine(FrameBuffer &frameBuffer, const rvec3 &eyePos,
 						const vector<LightSourcePtr> &lights, VertexData v0, VertexData v1,
 						const Frame &eyeFrame) {
 	if (v1.pos.y < v0.pos.y) {
 		std::swap(v0, v1);
 	}
 
-	double zDifference = v1.pos.z - v0.pos.z;
+	real zDifference = v1.pos.z - v0.pos.z;
 
-	for (double y = v0.pos.y; y < v1.pos.y; y++) {
+	for (real y = v0.pos.y; y < v1.pos.y; y++) {
 		// Interpolate vertex attributes
-		double weight = cheapNonPerspectiveCorrectInterpolationForLines(v0.pos.xy(), 
+		real weight = cheapNonPerspectiveCorrectInterpolationForLines(v0.pos.xy(), 
 																		v1.pos.xy(), 
-																		dvec2(v0.pos.x, y));
+																		rvec2(v0.pos.x, y));
 
 		Fragment fragment;
 
 		// Interpolate vertex attributes using alpha, beta, and gamma weights
-		double oneMinusW = 1.0 - weight;
+		real oneMinusW = 1.0 - weight;
 		fragment.material = weightedAverage(oneMinusW, v0.material, weight, v1.material);
-		double z = weightedAverage(oneMinusW, v0.pos.z, weight, v1.pos.z);
+		real z = weightedAverage(oneMinusW, v0.pos.z, weight, v1.pos.z);
 		fragment.worldNormal = weightedAverage(oneMinusW, v0.normal, weight, v1.normal);
 		fragment.worldPos = weightedAverage(oneMinusW, v0.worldPos, weight, v1.worldPos);
-		fragment.windowPos = dvec3(v0.pos.x, y, z);
+		fragment.windowPos = rvec3(v0.pos.x, y, z);
 
 		FragmentOps::processFragment(frameBuffer, eyePos, lights, fragment, eyeFrame);
 	}
 }
 
 /**
- * @fn	static void drawHorizontalLine(FrameBuffer &frameBuffer, const dvec3 &eyePos, 
+ * @fn	static void drawHorizontalLine(FrameBuffer &frameBuffer, const rvec3 &eyePos, 
  *										const vector<LightSourcePtr> &lights, 
  *										VertexData v0, VertexData v1, const Frame &eyeFrame)
  * @brief	Draw horizontal line
@@ -291,34 +292,34 @@ static void drawVerticalLine(FrameBuffer &frameBuffer, const dvec3 &eyePos,
  * @param 		  	eyeFrame		The camera frame.
  */
 
-static void drawHorizontalLine(FrameBuffer &frameBuffer, const dvec3 &eyePos,
+static void drawHorizontalLine(FrameBuffer &frameBuffer, const rvec3 &eyePos,
 								const vector<LightSourcePtr> &lights, VertexData v0, VertexData v1,
 								const Frame &eyeFrame) {
 	if (v1.pos.x < v0.pos.x) {
 		std::swap(v0, v1);
 	}
 
-	for (double x = v0.pos.x; x < v1.pos.x; x++) {
+	for (real x = v0.pos.x; x < v1.pos.x; x++) {
 		// Interpolate vertex attributes
-		double weight = cheapNonPerspectiveCorrectInterpolationForLines(v0.pos.xy(), 
+		real weight = cheapNonPerspectiveCorrectInterpolationForLines(v0.pos.xy(), 
 																		v1.pos.xy(), 
-																		dvec2(x, v0.pos.y));
+																		rvec2(x, v0.pos.y));
 
 		Fragment fragment;
 
 		// Interpolate vertex attributes using alpha, beta, and gamma weights
 		fragment.material = weightedAverage(1.0 - weight, v0.material, weight, v1.material);
-		double z = weightedAverage(1 - weight, v0.pos.z, weight, v1.pos.z);
+		real z = weightedAverage(1 - weight, v0.pos.z, weight, v1.pos.z);
 		fragment.worldNormal = weightedAverage(1.0 - weight, v0.normal, weight, v1.normal);
 		fragment.worldPos = weightedAverage(1.0 - weight, v0.worldPos, weight, v1.worldPos);
-		fragment.windowPos = dvec3(x, v1.pos.y, z);
+		fragment.windowPos = rvec3(x, v1.pos.y, z);
 
 		FragmentOps::processFragment(frameBuffer, eyePos, lights, fragment, eyeFrame);
 	}
 }
 
 /**
- * @fn	static void midPointLine(FrameBuffer &frameBuffer, const dvec3 &eyePos, const vector<LightSourcePtr> &lights, VertexData v0, VertexData v1, const dmat4 &viewingMatrix)
+ * @fn	static void midPointLine(FrameBuffer &frameBuffer, const rvec3 &eyePos, const vector<LightSourcePtr> &lights, VertexData v0, VertexData v1, const rmat4 &viewingMatrix)
  * @brief	Middle point line
  * @param [in,out]	frameBuffer  	Framebuffer.
  * @param 		  	eyePos		 	Eye position.
@@ -328,7 +329,7 @@ static void drawHorizontalLine(FrameBuffer &frameBuffer, const dvec3 &eyePos,
  * @param 		  	eyeFrame		The camera frame.
  */
 
-static void midPointLine(FrameBuffer &frameBuffer, const dvec3 &eyePos, 
+static void midPointLine(FrameBuffer &frameBuffer, const rvec3 &eyePos, 
 					const vector<LightSourcePtr> &lights, VertexData v0, VertexData v1,
 					const Frame &eyeFrame) {
 	if (v1.pos.x < v0.pos.x) {
@@ -336,32 +337,32 @@ static void midPointLine(FrameBuffer &frameBuffer, const dvec3 &eyePos,
 	}
 
 	// Calculate slope of the line
-	double m = (v1.pos.y - v0.pos.y) / (v1.pos.x - v0.pos.x);
+	real m = (v1.pos.y - v0.pos.y) / (v1.pos.x - v0.pos.x);
 
 	if (m > 0 && m < 1.0) { // For slope in (0,1] More "run" than "rise"
-		double y = v0.pos.y;
+		real y = v0.pos.y;
 
-		for (double x = v0.pos.x; x < v1.pos.x; x += 1.0) {
+		for (real x = v0.pos.x; x < v1.pos.x; x += 1.0) {
 
 			// Interpolate vertex attributes
-			double weight = cheapNonPerspectiveCorrectInterpolationForLines(v0.pos.xy(), 
+			real weight = cheapNonPerspectiveCorrectInterpolationForLines(v0.pos.xy(), 
 																			v1.pos.xy(), 
-																			dvec2(x, y));
+																			rvec2(x, y));
 
 			Fragment fragment;
 
 			// Interpolate vertex attributes using alpha, beta, and gamma weights
 			fragment.material = weightedAverage(1.0 - weight, v0.material, weight, v1.material);
-			double z = weightedAverage(1 - weight, v0.pos.z, weight, v1.pos.z);
+			real z = weightedAverage(1 - weight, v0.pos.z, weight, v1.pos.z);
 			fragment.worldNormal = weightedAverage(1.0 - weight, v0.normal, weight, v1.normal);
 			fragment.worldPos = weightedAverage(1.0 - weight, v0.worldPos, weight, v1.worldPos);
-			fragment.windowPos = dvec3(x, y, z);
+			fragment.windowPos = rvec3(x, y, z);
 
 			FragmentOps::processFragment(frameBuffer, eyePos, lights, fragment, eyeFrame);
 
 			// Evaluate the implicit equation for the line to determine if
 			// the line will be above the midpoint between the pixel centers.
-			double fXY = (v0.pos.y - v1.pos.y) * (x + 1.0) +
+			real fXY = (v0.pos.y - v1.pos.y) * (x + 1.0) +
 				(v1.pos.x - v0.pos.x) * (y + 0.5) +
 				v0.pos.x * v1.pos.y - v1.pos.x * v0.pos.y;
 
@@ -370,29 +371,29 @@ static void midPointLine(FrameBuffer &frameBuffer, const dvec3 &eyePos,
 			}
 		}
 	} else if (m > 1) { // For slope in (1,infinity] More "run" than "rise"
-		double x = v0.pos.x;
+		real x = v0.pos.x;
 
-		for (double y = v0.pos.y; y < v1.pos.y; y += 1.0) {
+		for (real y = v0.pos.y; y < v1.pos.y; y += 1.0) {
 
 			// Interpolate vertex attributes
-			double weight = cheapNonPerspectiveCorrectInterpolationForLines(v0.pos.xy(), 
+			real weight = cheapNonPerspectiveCorrectInterpolationForLines(v0.pos.xy(), 
 																			v1.pos.xy(), 
-																			dvec2(x, y));
+																			rvec2(x, y));
 
 			Fragment fragment;
 
 			// Interpolate vertex attributes using alpha, beta, and gamma weights
 			fragment.material = weightedAverage(1.0 - weight, v0.material, weight, v1.material);
-			double z = weightedAverage(1 - weight, v0.pos.z, weight, v1.pos.z);
+			real z = weightedAverage(1 - weight, v0.pos.z, weight, v1.pos.z);
 			fragment.worldNormal = weightedAverage(1.0 - weight, v0.normal, weight, v1.normal);
 			fragment.worldPos = weightedAverage(1.0 - weight, v0.worldPos, weight, v1.worldPos);
-			fragment.windowPos = dvec3(x, y, z);
+			fragment.windowPos = rvec3(x, y, z);
 
 			FragmentOps::processFragment(frameBuffer, eyePos, lights, fragment, eyeFrame);
 
 			// Evaluate the implicit equation for the line to determine if
 			// the line will be left or right the midpoint between the pixel centers.
-			double fXY = (v0.pos.y - v1.pos.y) * (x + 0.5) +
+			real fXY = (v0.pos.y - v1.pos.y) * (x + 0.5) +
 				(v1.pos.x - v0.pos.x) * (y + 1.0) +
 				v0.pos.x * v1.pos.y - v1.pos.x * v0.pos.y;
 
@@ -401,29 +402,29 @@ static void midPointLine(FrameBuffer &frameBuffer, const dvec3 &eyePos,
 			}
 		}
 	} else if (m >= -1.0 && m < 0) { // For slope in [-1,0) More "run" than "rise"
-		double y = v0.pos.y;
-		double x = v0.pos.x;
+		real y = v0.pos.y;
+		real x = v0.pos.x;
 
-		for (double x = v0.pos.x; x < v1.pos.x; x += 1.0) {
+		for (real x = v0.pos.x; x < v1.pos.x; x += 1.0) {
 			// Interpolate vertex attributes
-			double weight = cheapNonPerspectiveCorrectInterpolationForLines(v0.pos.xy(), 
+			real weight = cheapNonPerspectiveCorrectInterpolationForLines(v0.pos.xy(), 
 																			v1.pos.xy(), 
-																			dvec2(x, y));
+																			rvec2(x, y));
 
 			Fragment fragment;
 
 			// Interpolate vertex attributes using alpha, beta, and gamma weights
 			fragment.material = weightedAverage(1.0 - weight, v0.material, weight, v1.material);
-			double z = weightedAverage(1 - weight, v0.pos.z, weight, v1.pos.z);
+			real z = weightedAverage(1 - weight, v0.pos.z, weight, v1.pos.z);
 			fragment.worldNormal = weightedAverage(1.0 - weight, v0.normal, weight, v1.normal);
 			fragment.worldPos = weightedAverage(1.0 - weight, v0.worldPos, weight, v1.worldPos);
-			fragment.windowPos = dvec3(x, y, z);
+			fragment.windowPos = rvec3(x, y, z);
 
 			FragmentOps::processFragment(frameBuffer, eyePos, lights, fragment, eyeFrame);
 
 			// Evaluate the implicit equation for the line to determine if
 			// the line will be below the midpoint between the pixel centers.
-			double fXY = (v0.pos.y - v1.pos.y) * (x + 1.0) +
+			real fXY = (v0.pos.y - v1.pos.y) * (x + 1.0) +
 				(v1.pos.x - v0.pos.x) * (y - 0.5) +
 				v0.pos.x * v1.pos.y - v1.pos.x * v0.pos.y;
 
@@ -432,29 +433,29 @@ static void midPointLine(FrameBuffer &frameBuffer, const dvec3 &eyePos,
 			}
 		}
 	} else if (m < -1) { // For slope in [-infinity,-1) More "run" than "rise"
-		double x = v0.pos.x;
+		real x = v0.pos.x;
 
-		for (double y = v0.pos.y; y > v1.pos.y; y -= 1.0) {
+		for (real y = v0.pos.y; y > v1.pos.y; y -= 1.0) {
 
 			// Interpolate vertex attributes
-			double weight = cheapNonPerspectiveCorrectInterpolationForLines(v0.pos.xy(), 
+			real weight = cheapNonPerspectiveCorrectInterpolationForLines(v0.pos.xy(), 
 																			v1.pos.xy(), 
-																			dvec2(x, y));
+																			rvec2(x, y));
 
 			Fragment fragment;
 
 			// Interpolate vertex attributes using alpha, beta, and gamma weights
 			fragment.material = weightedAverage(1.0 - weight, v0.material, weight, v1.material);
-			double z = weightedAverage(1 - weight, v0.pos.z, weight, v1.pos.z);
+			real z = weightedAverage(1 - weight, v0.pos.z, weight, v1.pos.z);
 			fragment.worldNormal = weightedAverage(1.0 - weight, v0.normal, weight, v1.normal);
 			fragment.worldPos = weightedAverage(1.0 - weight, v0.worldPos, weight, v1.worldPos);
-			fragment.windowPos = dvec3(x, y, z);
+			fragment.windowPos = rvec3(x, y, z);
 
 			FragmentOps::processFragment(frameBuffer, eyePos, lights, fragment, eyeFrame);
 
 			// Evaluate the implicit equation for the line to determine if
 			// the line will be left or right the midpoint between the pixel centers.
-			double fXY = (v0.pos.y - v1.pos.y) * (x + 0.5) +
+			real fXY = (v0.pos.y - v1.pos.y) * (x + 0.5) +
 				(v1.pos.x - v0.pos.x) * (y - 1.0) +
 				v0.pos.x * v1.pos.y - v1.pos.x * v0.pos.y;
 
@@ -466,7 +467,7 @@ static void midPointLine(FrameBuffer &frameBuffer, const dvec3 &eyePos,
 }
 
 /**
- * @fn	void drawLine(FrameBuffer &frameBuffer, const dvec3 &eyePos, 
+ * @fn	void drawLine(FrameBuffer &frameBuffer, const rvec3 &eyePos, 
  *						const vector<LightSourcePtr> &lights,
  *						const VertexData &v0, const VertexData &v1, const Frame &eyeFrame)
  * @brief	Draw line
@@ -478,7 +479,7 @@ static void midPointLine(FrameBuffer &frameBuffer, const dvec3 &eyePos,
  * @param 		  	eyeFrame		The camera frame.
  */
 
-void drawLine(FrameBuffer &frameBuffer, const dvec3 &eyePos, 
+void drawLine(FrameBuffer &frameBuffer, const rvec3 &eyePos, 
 				const vector<LightSourcePtr> &lights, 
 				const VertexData &v0, const VertexData &v1,
 					const Frame &eyeFrame) {
@@ -492,7 +493,7 @@ void drawLine(FrameBuffer &frameBuffer, const dvec3 &eyePos,
 }
 
 /**
- * @fn	void drawManyLines(FrameBuffer &frameBuffer, const dvec3 &eyePos, 
+ * @fn	void drawManyLines(FrameBuffer &frameBuffer, const rvec3 &eyePos, 
  *							const vector<LightSourcePtr> &lights, 
  *							const vector<VertexData> &vertices, const Frame &eyeFrame)
  * @brief	Draw many lines
@@ -503,7 +504,7 @@ void drawLine(FrameBuffer &frameBuffer, const dvec3 &eyePos,
  * @param 		  	eyeFrame		The camera frame.
  */
 
-void drawManyLines(FrameBuffer &frameBuffer, const dvec3 &eyePos,
+void drawManyLines(FrameBuffer &frameBuffer, const rvec3 &eyePos,
 					const vector<LightSourcePtr> &lights, 
 					const vector<VertexData> &vertices,
 					const Frame &eyeFrame) {
@@ -513,7 +514,7 @@ void drawManyLines(FrameBuffer &frameBuffer, const dvec3 &eyePos,
 }
 
 /**
- * @fn	void drawWireFrameTriangle(FrameBuffer &frameBuffer, const dvec3 &eyePos, 
+ * @fn	void drawWireFrameTriangle(FrameBuffer &frameBuffer, const rvec3 &eyePos, 
  *									const vector<LightSourcePtr> &lights,
  *									const VertexData &v0, const VertexData &v1, const VertexData &v2, 
  *									const Frame &eyeFrame)
@@ -528,7 +529,7 @@ void drawManyLines(FrameBuffer &frameBuffer, const dvec3 &eyePos,
  */
 
 void drawWireFrameTriangle(FrameBuffer &frameBuffer,
-							const dvec3 &eyePos,
+							const rvec3 &eyePos,
 							const vector<LightSourcePtr> &lights, 
 							const VertexData &v0, 
 							const VertexData &v1, 
@@ -540,7 +541,7 @@ void drawWireFrameTriangle(FrameBuffer &frameBuffer,
 }
 
 /**
- * @fn	void drawManyWireFrameTriangles(FrameBuffer &frameBuffer, const dvec3 &eyePos,
+ * @fn	void drawManyWireFrameTriangles(FrameBuffer &frameBuffer, const rvec3 &eyePos,
  *										const vector<LightSourcePtr> &lights, 
  *										const vector<VertexData> &vertices, const Frame &eyeFrame)
  * @brief	Draw many wire frame triangles
@@ -552,7 +553,7 @@ void drawWireFrameTriangle(FrameBuffer &frameBuffer,
  */
 
 void drawManyWireFrameTriangles(FrameBuffer &frameBuffer, 
-									const dvec3 &eyePos,
+									const rvec3 &eyePos,
 									const vector<LightSourcePtr> &lights,
 									const vector<VertexData> &vertices,
 									const Frame& eyeFrame) {
@@ -563,68 +564,203 @@ void drawManyWireFrameTriangles(FrameBuffer &frameBuffer,
 }
 
 /**
- * @fn	static inline double f01(const VertexData &v0, const VertexData &v1, const VertexData &v2, double x, double y)
- * @brief	Computes f01. Implicit equation for the line between v0 and v1.
- * @see		*** page in textbook.
- * @param	v0	v0.
- * @param	v1	v1.
- * @param	v2	v2.
- * @param	x 	x coordinate.
- * @param	y 	y coordinate.
- * @return	f01.
+ * @brief	Number of fractional bits used when snapping window coordinates to the
+ * 			fixed-point grid of the triangle rasterizer.
  */
 
-static inline double f01(const VertexData &v0, const VertexData &v1, const VertexData &v2, 
-							double x, double y) {
-	return (v0.pos.y - v1.pos.y) * x + (v1.pos.x - v0.pos.x) * y +
-		(v0.pos.x * v1.pos.y) - (v1.pos.x * v0.pos.y);
+static const int SUBPIXEL_BITS = 8;
+static const long long SUBPIXEL_SCALE = 1LL << SUBPIXEL_BITS;
 
+/**
+ * @brief	Width and height, in pixels, of the blocks the triangle rasterizer tests
+ * 			against the edges before doing any per-pixel work.
+ */
+
+static const int RASTER_BLOCK_SIZE = 8;
+
+/**
+ * @brief	Allowance for rounding in the interpolated depths, when comparing a triangle's
+ * 			nearest depth against the coarse depth buffer.
+ */
+
+static const real HIZ_EPSILON = real(1.0e-5);
+
+/**
+ * @fn	static inline long long toFixed(real v)
+ * @brief	Snaps a window coordinate to the rasterizer's fixed-point grid.
+ * @param	v	The window coordinate.
+ * @return	v in units of 1/SUBPIXEL_SCALE pixels.
+ */
+
+static inline long long toFixed(real v) {
+	return std::llround(v * (real)SUBPIXEL_SCALE);
 }
 
 /**
- * @fn	static inline double f12(const VertexData &v0, const VertexData &v1, const VertexData &v2, 
- *									double x, double y)
- * @brief	Computes f12. Implicit equation for the line between v1 and v2.
- * @see		*** page in textbook.
- * @param	v0	v0.
- * @param	v1	v1.
- * @param	v2	v2.
- * @param	x 	x coordinate.
- * @param	y 	y coordinate.
- * @return	f12.
+ * @struct	EdgeFunction
+ * @brief	Fixed-point implicit equation of one triangle edge, E(X, Y) = A*X + B*Y + C,
+ * 			oriented so that it is positive on the triangle's side of the edge. Because
+ * 			the arithmetic is exact, two triangles sharing an edge always agree on which
+ * 			pixels lie on it. Window coordinates must stay within +/- 2^20 pixels.
  */
 
-static inline double f12(const VertexData &v0, const VertexData &v1, const VertexData &v2, 
-							double x, double y) {
-	return (v1.pos.y - v2.pos.y) * x + (v2.pos.x - v1.pos.x) * y +
-		(v1.pos.x * v2.pos.y) - (v2.pos.x * v1.pos.y);
+struct EdgeFunction {
+	long long A, B, C;	//!< Coefficients, in fixed-point units.
+	long long stepX;	//!< Change in E when x advances one pixel.
+	long long stepY;	//!< Change in E when y advances one pixel.
+	long long bias;		//!< Smallest value of E that covers a pixel. 1 if the edge is not owned.
+	long long blockStepX;	//!< Change in E when x advances one block.
+	long long blockStepY;	//!< Change in E when y advances one block.
+	long long blockMin;	//!< Offset from a block's first pixel to its smallest E.
+	long long blockMax;	//!< Offset from a block's first pixel to its largest E.
+
+	/**
+	 * @fn	EdgeFunction(long long xa, long long ya, long long xb, long long yb, long long orientation)
+	 * @brief	Constructs the edge from a to b.
+	 * @param	xa, ya			Fixed-point coordinates of a.
+	 * @param	xb, yb			Fixed-point coordinates of b.
+	 * @param	orientation 	+1 or -1, the sign of the triangle's area.
+	 */
+
+	EdgeFunction(long long xa, long long ya, long long xb, long long yb, long long orientation) {
+		A = orientation * (ya - yb);
+		B = orientation * (xb - xa);
+		C = orientation * (xa * yb - xb * ya);
+		stepX = A * SUBPIXEL_SCALE;
+		stepY = B * SUBPIXEL_SCALE;
+		blockStepX = RASTER_BLOCK_SIZE * stepX;
+		blockStepY = RASTER_BLOCK_SIZE * stepY;
+		const long long LAST = RASTER_BLOCK_SIZE - 1;
+		blockMin = std::min(0LL, LAST * stepX) + std::min(0LL, LAST * stepY);
+		blockMax = std::max(0LL, LAST * stepX) + std::max(0LL, LAST * stepY);
+		// Pixels exactly on the edge belong to the triangle on the same side as
+		// the off-screen point (-1, -1).
+		bias = evaluate(-1, -1) > 0 ? 0 : 1;
+	}
+
+	/**
+	 * @fn	long long evaluate(int x, int y) const
+	 * @brief	Evaluates the edge function at pixel (x, y).
+	 * @param	x	The x coordinate.
+	 * @param	y	The y coordinate.
+	 * @return	E(x, y).
+	 */
+
+	long long evaluate(int x, int y) const {
+		return A * (x * SUBPIXEL_SCALE) + B * (y * SUBPIXEL_SCALE) + C;
+	}
+
+	/**
+	 * @fn	bool rejectsBlock(long long e) const
+	 * @brief	Determines if no pixel of a block is on the triangle's side of this edge.
+	 * @param	e	Value of E at the block's first pixel.
+	 * @return	True iff the edge covers none of the block.
+	 */
 
+	bool rejectsBlock(long long e) const {
+		return e + blockMax < bias;
+	}
+
+	/**
+	 * @fn	bool acceptsBlock(long long e) const
+	 * @brief	Determines if every pixel of a block is on the triangle's side of this edge.
+	 * @param	e	Value of E at the block's first pixel.
+	 * @return	True iff the edge covers all of the block.
+	 */
+
+	bool acceptsBlock(long long e) const {
+		return e + blockMin >= bias;
+	}
+
+	/**
+	 * @fn	void clipSpan(long long e, int &lo, int &hi) const
+	 * @brief	Narrows [lo, hi], a range of pixel offsets along a row, to the pixels this
+	 * 			edge covers. Empty when lo > hi.
+	 * @param 		  	e 	Value of E at offset 0.
+	 * @param [in,out]	lo	First offset.
+	 * @param [in,out]	hi	Last offset.
+	 */
+
+	void clipSpan(long long e, int &lo, int &hi) const {
+		e -= bias;
+		if (stepX > 0) {
+			if (e < 0) {
+				long long first = (-e + stepX - 1) / stepX;
+				lo = first > hi ? hi + 1 : std::max(lo, (int)first);
+			}
+		} else if (stepX < 0) {
+			if (e < 0) {
+				hi = lo - 1;
+			} else {
+				long long last = e / -stepX;
+				hi = last < lo ? lo - 1 : std::min(hi, (int)last);
+			}
+		} else if (e < 0) {
+			hi = lo - 1;
+		}
+	}
+};
+
+/**
+ * @fn	static inline void interpolateChannel(real out[], int count, const real alpha[],
+ *												const real beta[], const real gamma[],
+ *												real a0, real a1, real a2)
+ * @brief	Computes the Barycentric weighting of one scalar vertex attribute for a run of
+ * 			fragments.
+ * @param [out]	out  	The interpolated values.
+ * @param 	   	count	Number of fragments.
+ * @param 	   	alpha	Weights of v0.
+ * @param 	   	beta 	Weights of v1.
+ * @param 	   	gamma	Weights of v2.
+ * @param 	   	a0   	The attribute at v0.
+ * @param 	   	a1   	The attribute at v1.
+ * @param 	   	a2   	The attribute at v2.
+ */
+
+static inline void interpolateChannel(real out[], int count, const real alpha[],
+										const real beta[], const real gamma[],
+										real a0, real a1, real a2) {
+	for (int i = 0; i < count; i++) {
+		out[i] = alpha[i] * a0 + beta[i] * a1 + gamma[i] * a2;
+	}
 }
 
 /**
- * @fn	static inline double f20(const VertexData &v0, const VertexData &v1, const VertexData &v2, 
- *									double x, double y)
- * @brief	Computes f20. Implicit equation for the line between v2 and v0.
- * @see		*** page in textbook.
- * @param	v0	v0.
- * @param	v1	v1.
- * @param	v2	v2.
- * @param	x 	x coordinate.
- * @param	y 	y coordinate.
- * @return	f02.
+ * @fn	static void interpolateBatch(FragmentBatch &batch, const real alpha[], const real beta[],
+ *										const real gamma[], const VertexData &v0,
+ *										const VertexData &v1, const VertexData &v2)
+ * @brief	Fills in the attributes of a batch of fragments, whose window coordinates and
+ * 			depths are already set, from the Barycentric weighting of a triangle's vertices.
+ * @param [in,out]	batch	The batch.
+ * @param 		  	alpha	Weights of v0.
+ * @param 		  	beta 	Weights of v1.
+ * @param 		  	gamma	Weights of v2.
+ * @param 		  	v0   	v0.
+ * @param 		  	v1   	v1.
+ * @param 		  	v2   	v2.
  */
 
-static inline double f20(const VertexData &v0, const VertexData &v1, const VertexData &v2, 
-							double x, double y) {
-	return (v2.pos.y - v0.pos.y) * x + (v0.pos.x - v2.pos.x) * y +
-		(v2.pos.x * v0.pos.y) - (v0.pos.x * v2.pos.y);
+static void interpolateBatch(FragmentBatch &batch, const real alpha[], const real beta[],
+								const real gamma[], const VertexData &v0,
+								const VertexData &v1, const VertexData &v2) {
+	const int N = batch.count;
+	const Material &m0 = v0.material, &m1 = v1.material, &m2 = v2.material;
+	for (int c = 0; c < 3; c++) {
+		interpolateChannel(batch.worldNormal[c], N, alpha, beta, gamma, v0.normal[c], v1.normal[c], v2.normal[c]);
+		interpolateChannel(batch.worldPos[c], N, alpha, beta, gamma, v0.worldPos[c], v1.worldPos[c], v2.worldPos[c]);
+		interpolateChannel(batch.ambient[c], N, alpha, beta, gamma, m0.ambient[c], m1.ambient[c], m2.ambient[c]);
+		interpolateChannel(batch.diffuse[c], N, alpha, beta, gamma, m0.diffuse[c], m1.diffuse[c], m2.diffuse[c]);
+		interpolateChannel(batch.specular[c], N, alpha, beta, gamma, m0.specular[c], m1.specular[c], m2.specular[c]);
+	}
+	interpolateChannel(batch.shininess, N, alpha, beta, gamma, m0.shininess, m1.shininess, m2.shininess);
+	interpolateChannel(batch.alpha, N, alpha, beta, gamma, m0.alpha, m1.alpha, m2.alpha);
 }
 
 /**
- * @fn	void drawFilledTriangle(FrameBuffer &frameBuffer, const dvec3 &eyePos, 
+ * @fn	void drawFilledTriangle(FrameBuffer &frameBuffer, const rvec3 &eyePos, 
  *								const vector<LightSourcePtr> &lights, 
  *								const VertexData &v0, const VertexData &v1, const VertexData &v2, 
- *								const dmat4 &viewingMatrix)
+ *								const rmat4 &viewingMatrix)
  * @brief	Draw filled triangle.
  * @param [in,out]	frameBuffer  	Framebuffer.
  * @param 		  	eyePos		 	Eye position.
@@ -635,54 +771,180 @@ static inline double f20(const VertexData &v0, const VertexData &v1, const Verte
  * @param               eyeFrame        The camera's frame.
  */
 
-void drawFilledTriangle(FrameBuffer &frameBuffer, const dvec3 &eyePos,
+void drawFilledTriangle(FrameBuffer &frameBuffer, const rvec3 &eyePos,
 						const vector<LightSourcePtr> &lights,
 						const VertexData &v0, const VertexData &v1, const VertexData &v2,
 						const Frame &eyeFrame) {
-	// Find minimimum and maximum x and y limits for the triangle
-	double xMin = glm::floor(min(v0.pos.x, v1.pos.x, v2.pos.x));
-	double xMax = glm::ceil(max(v0.pos.x, v1.pos.x, v2.pos.x));
-	double yMin = glm::floor(min(v0.pos.y, v1.pos.y, v2.pos.y));
-	double yMax = glm::ceil(max(v0.pos.y, v1.pos.y, v2.pos.y));
-
-	double fAlpha = f12(v0, v1, v2, v0.pos.x, v0.pos.y);
-	double fBeta = f20(v0, v1, v2, v1.pos.x, v1.pos.y);
-	double fGamma = f01(v0, v1, v2, v2.pos.x, v2.pos.y);
-
-	for (double y = yMin; y <= yMax; y++) {
-		for (double x = xMin; x <= xMax; x++) {	
-			// Calculate the weights for inperpolation
-			// If any weight is negative, the fragment is not in the triangle
-			double alpha = f12(v0, v1, v2, x, y) / fAlpha;
-			double beta = f20(v0, v1, v2, x, y) / fBeta;
-			double gamma = f01(v0, v1, v2, x, y) / fGamma;
-
-			// Determine if the pixel position is inside the triangle
-			if (alpha >= 0 && beta >= 0 && gamma >= 0) {
-				if ((alpha > 0 || fAlpha * f12(v0, v1, v2, -1, -1) > 0) &&
-					(beta > 0 || fBeta * f20(v0, v1, v2, -1, -1) > 0) &&
-					(gamma > 0 || fGamma * f01(v0, v1, v2, -1, -1) > 0)) {
-						Fragment fragment;
-
-						// Interpolate vertex attributes using alpha, beta, and gamma weights
-						fragment.material = barycentricWeighting(alpha, beta, gamma,
-																v0.material, v1.material, v2.material);
-						fragment.worldNormal = barycentricWeighting(alpha, beta, gamma,
-																	v0.normal, v1.normal, v2.normal);
-						fragment.worldPos = barycentricWeighting(alpha, beta, gamma,
-																	v0.worldPos, v1.worldPos, v2.worldPos);
-						double z = barycentricWeighting(alpha, beta, gamma,
-														v0.pos.z, v1.pos.z, v2.pos.z);
-						fragment.windowPos = dvec3(x, y, z);
-						FragmentOps::processFragment(frameBuffer, eyePos, lights, fragment, eyeFrame);
+	BoundingBoxi window(0, frameBuffer.getWindowWidth(), 0, frameBuffer.getWindowHeight());
+	drawFilledTriangle(frameBuffer, eyePos, lights, v0, v1, v2, eyeFrame, window);
+}
+
+/**
+ * @fn	void drawFilledTriangle(FrameBuffer &frameBuffer, const rvec3 &eyePos,
+ *								const vector<LightSourcePtr> &lights,
+ *								const VertexData &v0, const VertexData &v1, const VertexData &v2,
+ *								const Frame &eyeFrame, const BoundingBoxi &scissor)
+ * @brief	Draw the part of a filled triangle that falls inside a scissor rectangle. Covers
+ * 			exactly the pixels the unscissored version would cover inside the rectangle, so
+ * 			a triangle drawn tile by tile matches one drawn all at once.
+ * 			The bounding box is walked in RASTER_BLOCK_SIZE square blocks. Blocks entirely
+ * 			outside an edge are skipped, blocks entirely inside all three edges are filled
+ * 			without coverage tests, and the rows of the remaining blocks are clipped to the
+ * 			covered span. Each block's fragments are handed to FragmentOps as one batch.
+ * 			With FragmentOps::hierarchicalDepthTest, the triangle, and then each block, is
+ * 			skipped when the coarse depth buffer shows it is hidden. With
+ * 			FragmentOps::earlyDepthTest, depth is interpolated and tested first, and only
+ * 			the fragments that pass have their other attributes interpolated.
+ * @param [in,out]	frameBuffer  	Framebuffer.
+ * @param 		  	eyePos		 	Eye position.
+ * @param 		  	lights		 	Vector of lights in scene.
+ * @param 		  	v0			 	v0.
+ * @param 		  	v1			 	v1.
+ * @param 		  	v2			 	v2.
+ * @param               eyeFrame        The camera's frame.
+ * @param 		  	scissor		 	The only pixels that may be drawn.
+ */
+
+void drawFilledTriangle(FrameBuffer &frameBuffer, const rvec3 &eyePos,
+						const vector<LightSourcePtr> &lights,
+						const VertexData &v0, const VertexData &v1, const VertexData &v2,
+						const Frame &eyeFrame, const BoundingBoxi &scissor) {
+	// Find minimimum and maximum x and y limits for the triangle, within the window and scissor
+	int left = std::max(0, scissor.lx);
+	int right = std::min(frameBuffer.getWindowWidth(), scissor.lx + scissor.width) - 1;
+	int bottom = std::max(0, scissor.ly);
+	int top = std::min(frameBuffer.getWindowHeight(), scissor.ly + scissor.height) - 1;
+	int xMin = std::max(left, (int)glm::floor(min(v0.pos.x, v1.pos.x, v2.pos.x)));
+	int xMax = std::min(right, (int)glm::ceil(max(v0.pos.x, v1.pos.x, v2.pos.x)));
+	int yMin = std::max(bottom, (int)glm::floor(min(v0.pos.y, v1.pos.y, v2.pos.y)));
+	int yMax = std::min(top, (int)glm::ceil(max(v0.pos.y, v1.pos.y, v2.pos.y)));
+	if (xMin > xMax || yMin > yMax) {
+		return;
+	}
+
+	const bool earlyZ = FragmentOps::performDepthTest && FragmentOps::earlyDepthTest;
+	const bool hierarchicalZ = FragmentOps::performDepthTest && FragmentOps::hierarchicalDepthTest;
+	DepthCullStats &stats = FragmentOps::depthCullStats;
+	const real nearest = min(v0.pos.z, v1.pos.z, v2.pos.z) - HIZ_EPSILON;
+	if (hierarchicalZ && frameBuffer.isOccluded(xMin, yMin, xMax, yMax, nearest)) {
+		stats.trianglesCulled.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	long long x0 = toFixed(v0.pos.x), y0 = toFixed(v0.pos.y);
+	long long x1 = toFixed(v1.pos.x), y1 = toFixed(v1.pos.y);
+	long long x2 = toFixed(v2.pos.x), y2 = toFixed(v2.pos.y);
+	long long area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+	if (area == 0) {
+		return;
+	}
+	long long orientation = area > 0 ? 1 : -1;
+	real invArea = real(1.0) / (real)(orientation * area);
+
+	EdgeFunction e12(x1, y1, x2, y2, orientation);	// alpha
+	EdgeFunction e20(x2, y2, x0, y0, orientation);	// beta
+	EdgeFunction e01(x0, y0, x1, y1, orientation);	// gamma
+
+	// Depth is planar in window coordinates
+	const real z0 = v0.pos.z, z1 = v1.pos.z, z2 = v2.pos.z;
+	const real dzdx = (e12.stepX * z0 + e20.stepX * z1 + e01.stepX * z2) * invArea;
+	const real dzdy = (e12.stepY * z0 + e20.stepY * z1 + e01.stepY * z2) * invArea;
+	long long numBlocksCulled = 0, numRejected = 0, numInterpolated = 0;
+
+	// Reused across calls so batching neither allocates nor constructs fragments per triangle
+	static_assert(RASTER_BLOCK_SIZE * RASTER_BLOCK_SIZE <= FRAGMENT_BATCH_SIZE, "A block must fit in one batch");
+	static thread_local FragmentBatch batch;
+	real alpha[FRAGMENT_BATCH_SIZE], beta[FRAGMENT_BATCH_SIZE], gamma[FRAGMENT_BATCH_SIZE];
+
+	long long blockRow12 = e12.evaluate(xMin, yMin);
+	long long blockRow20 = e20.evaluate(xMin, yMin);
+	long long blockRow01 = e01.evaluate(xMin, yMin);
+
+	for (int by = yMin; by <= yMax; by += RASTER_BLOCK_SIZE,
+				blockRow12 += e12.blockStepY, blockRow20 += e20.blockStepY, blockRow01 += e01.blockStepY) {
+		long long block12 = blockRow12;
+		long long block20 = blockRow20;
+		long long block01 = blockRow01;
+		for (int bx = xMin; bx <= xMax; bx += RASTER_BLOCK_SIZE,
+				block12 += e12.blockStepX, block20 += e20.blockStepX, block01 += e01.blockStepX) {
+			if (e12.rejectsBlock(block12) || e20.rejectsBlock(block20) || e01.rejectsBlock(block01)) {
+				continue;
+			}
+			bool fullyCovered = e12.acceptsBlock(block12) && e20.acceptsBlock(block20) && 
+								e01.acceptsBlock(block01);
+			int lastCol = std::min(RASTER_BLOCK_SIZE - 1, xMax - bx);
+			int lastRow = std::min(RASTER_BLOCK_SIZE - 1, yMax - by);
+			if (hierarchicalZ) {
+				real blockNearest = (block12 * z0 + block20 * z1 + block01 * z2) * invArea +
+									glm::min(real(0.0), lastCol * dzdx) + glm::min(real(0.0), lastRow * dzdy);
+				if (frameBuffer.isOccluded(bx, by, bx + lastCol, by + lastRow, 
+											glm::max(nearest, blockNearest - HIZ_EPSILON))) {
+					numBlocksCulled++;
+					continue;
+				}
+			}
+
+			int n = 0;
+			long long row12 = block12;
+			long long row20 = block20;
+			long long row01 = block01;
+			for (int j = 0; j <= lastRow; j++, row12 += e12.stepY, row20 += e20.stepY, row01 += e01.stepY) {
+				// Offsets from bx of the first and last covered pixels in this row
+				int lo = 0, hi = lastCol;
+				if (!fullyCovered) {
+					e12.clipSpan(row12, lo, hi);
+					e20.clipSpan(row20, lo, hi);
+					e01.clipSpan(row01, lo, hi);
 				}
+
+				long long f12 = row12 + lo * e12.stepX;
+				long long f20 = row20 + lo * e20.stepX;
+				long long f01 = row01 + lo * e01.stepX;
+				for (int i = lo; i <= hi; i++, f12 += e12.stepX, f20 += e20.stepX, f01 += e01.stepX) {
+					batch.x[n] = bx + i;
+					batch.y[n] = by + j;
+					alpha[n] = f12 * invArea;
+					beta[n] = f20 * invArea;
+					gamma[n] = f01 * invArea;
+					n++;
+				}
+			}
+
+			interpolateChannel(batch.depth, n, alpha, beta, gamma, z0, z1, z2);
+			if (earlyZ) {
+				// Compact the batch down to the fragments in front of what is already drawn
+				int numPassed = 0;
+				for (int i = 0; i < n; i++) {
+					bool passed = batch.depth[i] < frameBuffer.getDepthAt(frameBuffer.pixelIndex(batch.x[i], batch.y[i]));
+					batch.x[numPassed] = batch.x[i];
+					batch.y[numPassed] = batch.y[i];
+					batch.depth[numPassed] = batch.depth[i];
+					alpha[numPassed] = alpha[i];
+					beta[numPassed] = beta[i];
+					gamma[numPassed] = gamma[i];
+					numPassed += passed ? 1 : 0;
+				}
+				numRejected += n - numPassed;
+				n = numPassed;
+			}
+
+			if (n > 0) {
+				// Interpolate vertex attributes using alpha, beta, and gamma weights
+				batch.count = n;
+				batch.depthTested = earlyZ;
+				interpolateBatch(batch, alpha, beta, gamma, v0, v1, v2);
+				numInterpolated += n;
+				FragmentOps::processFragments(frameBuffer, eyePos, lights, batch, eyeFrame);
 			}
 		}
 	}
+	stats.blocksCulled.fetch_add(numBlocksCulled, std::memory_order_relaxed);
+	stats.fragmentsRejected.fetch_add(numRejected, std::memory_order_relaxed);
+	stats.fragmentsInterpolated.fetch_add(numInterpolated, std::memory_order_relaxed);
 }
 
 /**
- * @fn	void drawManyFilledTriangles(FrameBuffer &frameBuffer, const dvec3 &eyePos, const vector<LightSourcePtr> &lights, const vector<VertexData> &vertices, const dmat4 &viewingMatrix)
+ * @fn	void drawManyFilledTriangles(FrameBuffer &frameBuffer, const rvec3 &eyePos, const vector<LightSourcePtr> &lights, const vector<VertexData> &vertices, const rmat4 &viewingMatrix)
  * @brief	Draw many filled triangles,
  * @param [in,out]	frameBuffer  	Framebuffer.
  * @param 		  	eyePos		 	Eye position.
@@ -691,7 +953,7 @@ void drawFilledTriangle(FrameBuffer &frameBuffer, const dvec3 &eyePos,
  * @param 		  	eyeFrame    	The camera's frame.
  */
 
-void drawManyFilledTriangles(FrameBuffer &frameBuffer, const dvec3 &eyePos, 
+void drawManyFilledTriangles(FrameBuffer &frameBuffer, const rvec3 &eyePos, 
 							const vector<LightSourcePtr> &lights, const vector<VertexData> &vertices,
 							const Frame &eyeFrame) {
 	for (int i = 0; i < (int)vertices.size() - 2; i += 3) {
@@ -6,23 +6,37 @@
  * of this material is prohibited unless prior written
  * permission is granted.
  ****************************************************/
+#include <cstring>
+#include <random>
+#include <thread>
 #include "raytracer.h"
 #include "ishape.h"
 #include "io.h"
 
+const real REFLECTION_WEIGHT = 0.3;		//!< Fraction of the reflected color added to a surface's color.
+const real ROULETTE_THRESHOLD = 0.1;		//!< Paths worth less than this are subject to Russian roulette.
+const real MIN_TEXTURE_COSINE = 0.1;		//!< Limits how far a texture seen at a grazing angle is blurred.
+
 /**
- * @fn	RayTracer::RayTracer(const color &defa)
+ * @fn	RayTracer::RayTracer(const color &defa, int threads, int tile)
  * @brief	Constructs a raytracers.
  * @param	defa	The clear color.
+ * @param	threads	Number of worker threads. 1 renders serially; 0 uses one thread per core.
+ * @param	tile	Width and height, in pixels, of the tiles handed out to the workers.
  */
 
-RayTracer::RayTracer(const color &defa)
-	: defaultColor(defa) {
+RayTracer::RayTracer(const color &defa, int threads, int tile)
+	: defaultColor(defa), numThreads(threads), tileSize(tile), usePackets(true),
+	minContribution(1.0 / 1024.0), russianRoulette(false) {
 }
 
 /**
  * @fn	void RayTracer::raytraceScene(FrameBuffer &frameBuffer, int depth, const IScene &theScene) const
- * @brief	Raytrace scene
+ * @brief	Raytrace scene. The viewport is cut into tileSize x tileSize tiles. Worker threads
+ * 			repeatedly claim the next unrendered tile until none remain, so a thread that
+ * 			lands on cheap tiles simply renders more of them. Every pixel belongs to exactly
+ * 			one tile, so the workers never write the same part of the framebuffer and the
+ * 			image is identical to the serial one.
  * @param [in,out]	frameBuffer	Framebuffer.
  * @param 		  	depth	   	The current depth of recursion.
  * @param 		  	theScene   	The scene.
@@ -32,130 +46,596 @@ RayTracer::RayTracer(const color &defa)
  */
 
 void RayTracer::raytraceScene(FrameBuffer &frameBuffer, int depth,
-								const IScene &theScene, int N, const dvec2& viewStart, const dvec2& viewEnd) const {
+								const IScene &theScene, int N, const rvec2& viewStart, const rvec2& viewEnd) const {
+	TextureCache::beginFrame();
+	TextureCache::global().trim();
+	const FrameLights lights(theScene.lights, theScene.camera->getFrame());
+	forEachTile((int)viewStart.x, (int)viewStart.y, (int)std::ceil(viewEnd.x), (int)std::ceil(viewEnd.y),
+		[&](int xLo, int yLo, int xHi, int yHi) {
+			raytraceTile(frameBuffer, depth, theScene, lights, N, viewStart, viewEnd, xLo, yLo, xHi, yHi);
+		});
+
+	frameBuffer.showColorBuffer();
+}
+
+/**
+ * @fn	long long RayTracer::raytraceSceneAdaptive(FrameBuffer &frameBuffer, int depth, const IScene &theScene,
+ *												int N, real threshold, const rvec2& viewStart, const rvec2& viewEnd) const
+ * @brief	Raytrace scene with adaptive anti-aliasing. Every pixel first gets one ray
+ * 			through its center. Then each pixel whose color differs from one of its four
+ * 			neighbors by more than threshold, in any channel, is traced again with the
+ * 			same N x N rays raytraceScene would use, so edges and other high contrast
+ * 			areas look exactly as they do with N x N supersampling while flat areas cost
+ * 			a single ray.
+ * @param [in,out]	frameBuffer	Framebuffer.
+ * @param 		  	depth	   	The current depth of recursion.
+ * @param 		  	theScene   	The scene.
+ * @param 		  	N   	    Number of rays per pixel, N x N, in refined pixels.
+ * @param 		  	threshold   Largest difference between neighbors, in [0, 1], that is left alone.
+ * @param 		  	viewStart   The x and y of the lower left pixel of the viewport.
+ * @param 		  	viewEnd   	The x and y of the top right pixel of the viewport.
+ * @return	The number of primary rays traced.
+ */
+
+long long RayTracer::raytraceSceneAdaptive(FrameBuffer &frameBuffer, int depth, const IScene &theScene,
+											int N, real threshold, const rvec2& viewStart, const rvec2& viewEnd) const {
+	TextureCache::beginFrame();
+	TextureCache::global().trim();
+	const RaytracingCamera &camera = *theScene.camera;
+	const FrameLights lights(theScene.lights, camera.getFrame());
+	const int xLo = (int)viewStart.x;
+	const int yLo = (int)viewStart.y;
+	const int xHi = (int)std::ceil(viewEnd.x);
+	const int yHi = (int)std::ceil(viewEnd.y);
+	const int W = glm::max(xHi - xLo, 0);
+	const int H = glm::max(yHi - yLo, 0);
+	vector<color> centers(W * H);
+
+	// One ray through the center of each pixel.
+	forEachTile(xLo, yLo, xHi, yHi, [&](int tileXLo, int tileYLo, int tileXHi, int tileYHi) {
+		for (int y = tileYLo; y < tileYHi; y++) {
+			for (int x0 = tileXLo; x0 < tileXHi; x0 += PACKET_SIZE) {
+				const int count = glm::min(PACKET_SIZE, tileXHi - x0);
+				Ray rays[PACKET_SIZE];
+				int pixelX[PACKET_SIZE], pixelY[PACKET_SIZE];
+				color colors[PACKET_SIZE];
+				for (int i = 0; i < count; i++) {
+					pixelX[i] = x0 + i;
+					pixelY[i] = y;
+					rays[i] = getSampleRay(camera, getCameraPixel(camera, x0 + i, y, viewStart, viewEnd), 1, 0, 0);
+				}
+				traceSamples(rays, pixelX, pixelY, count, theScene, lights, depth, colors);
+				for (int i = 0; i < count; i++) {
+					centers[(y - yLo) * W + (x0 + i - xLo)] = colors[i];
+				}
+			}
+		}
+	});
+
+	// Mark both pixels of every pair of neighbors that differ too much.
+	vector<bool> refine(W * H, false);
+	long long numRefined = 0;
+	if (N > 1) {
+		auto differ = [threshold](const color &a, const color &b) {
+			color d = glm::abs(a - b);
+			return glm::max(d.r, glm::max(d.g, d.b)) > threshold;
+		};
+		for (int y = 0; y < H; y++) {
+			for (int x = 0; x < W; x++) {
+				int i = y * W + x;
+				if (x + 1 < W && differ(centers[i], centers[i + 1])) {
+					refine[i] = refine[i + 1] = true;
+				}
+				if (y + 1 < H && differ(centers[i], centers[i + W])) {
+					refine[i] = refine[i + W] = true;
+				}
+			}
+		}
+		for (int i = 0; i < W * H; i++) {
+			numRefined += refine[i] ? 1 : 0;
+		}
+	}
+
+	// N x N rays in the marked pixels. The samples of one pixel are traced
+	// PACKET_SIZE at a time.
+	forEachTile(xLo, yLo, xHi, yHi, [&](int tileXLo, int tileYLo, int tileXHi, int tileYHi) {
+		for (int y = tileYLo; y < tileYHi; y++) {
+			for (int x = tileXLo; x < tileXHi; x++) {
+				const int i = (y - yLo) * W + (x - xLo);
+				const rvec2 pixel = getCameraPixel(camera, x, y, viewStart, viewEnd);
+				if (!refine[i]) {
+					writePixel(frameBuffer, camera, x, y, pixel, centers[i]);
+					continue;
+				}
+
+				color sum = black;
+				for (int s = 0; s < N * N; s += PACKET_SIZE) {
+					const int count = glm::min(PACKET_SIZE, N * N - s);
+					Ray rays[PACKET_SIZE];
+					int pixelX[PACKET_SIZE], pixelY[PACKET_SIZE];
+					color colors[PACKET_SIZE];
+					for (int j = 0; j < count; j++) {
+						pixelX[j] = x;
+						pixelY[j] = y;
+						rays[j] = getSampleRay(camera, pixel, N, (s + j) / N, (s + j) % N);
+					}
+					traceSamples(rays, pixelX, pixelY, count, theScene, lights, depth, colors);
+					for (int j = 0; j < count; j++) {
+						sum += colors[j];
+					}
+				}
+				writePixel(frameBuffer, camera, x, y, pixel, sum / (real)glm::pow(N, 2.0));
+			}
+		}
+	});
+
+	frameBuffer.showColorBuffer();
+	return (long long)W * H + numRefined * N * N;
+}
+
+/**
+ * @fn	bool RayTracer::raytraceScenePass(FrameBuffer &frameBuffer, int depth, const IScene &theScene,
+ *											int N, SampleBuffer &samples, const rvec2& viewStart, const rvec2& viewEnd) const
+ * @brief	Progressive rendering. Each call traces one more of the N x N rays of every
+ * 			pixel, adds it to the pixel's running sum in samples and displays the
+ * 			average so far. The first call gives a complete, aliased preview at the
+ * 			cost of one ray per pixel; after N x N calls the image is the same as the one
+ * 			raytraceScene produces. samples starts over by itself if the viewport or N
+ * 			change; call samples.reset() when the scene or the camera does.
+ * @param [in,out]	frameBuffer	Framebuffer.
+ * @param 		  	depth	   	The current depth of recursion.
+ * @param 		  	theScene   	The scene.
+ * @param 		  	N   	    Number of rays per pixel for anti-aliasing.
+ * @param [in,out]	samples   	The samples accumulated by the previous passes.
+ * @param 		  	viewStart   The x and y of the lower left pixel of the viewport.
+ * @param 		  	viewEnd   	The x and y of the top right pixel of the viewport.
+ * @return	True iff more passes remain.
+ */
+
+bool RayTracer::raytraceScenePass(FrameBuffer &frameBuffer, int depth, const IScene &theScene,
+									int N, SampleBuffer &samples, const rvec2& viewStart, const rvec2& viewEnd) const {
+	TextureCache::beginFrame();
+	TextureCache::global().trim();
 	const RaytracingCamera &camera = *theScene.camera;
-	const vector<VisibleIShapePtr> &opaqueObjs = theScene.opaqueObjs;
-	const vector<VisibleIShapePtr> &transObjs = theScene.transparentObjs;
-	const vector<PositionalLightPtr> &lights = theScene.lights;
+	const FrameLights lights(theScene.lights, camera.getFrame());
+	const int xLo = (int)viewStart.x;
+	const int yLo = (int)viewStart.y;
+	const int xHi = (int)std::ceil(viewEnd.x);
+	const int yHi = (int)std::ceil(viewEnd.y);
+	const int W = glm::max(xHi - xLo, 0);
+	const int H = glm::max(yHi - yLo, 0);
+
+	if (samples.width != W || samples.height != H || samples.N != N) {
+		samples.width = W;
+		samples.height = H;
+		samples.N = N;
+		samples.numPasses = 0;
+	}
+	if (samples.numPasses >= N * N) {
+		frameBuffer.showColorBuffer();
+		return false;
+	}
+	if (samples.numPasses == 0) {
+		samples.sums.assign(W * H, black);
+	}
+
+	const int r = samples.numPasses / N;
+	const int c = samples.numPasses % N;
+	const int numSamples = samples.numPasses + 1;
+	forEachTile(xLo, yLo, xHi, yHi, [&](int tileXLo, int tileYLo, int tileXHi, int tileYHi) {
+		for (int y = tileYLo; y < tileYHi; y++) {
+			for (int x0 = tileXLo; x0 < tileXHi; x0 += PACKET_SIZE) {
+				const int count = glm::min(PACKET_SIZE, tileXHi - x0);
+				Ray rays[PACKET_SIZE];
+				int pixelX[PACKET_SIZE], pixelY[PACKET_SIZE];
+				rvec2 pixels[PACKET_SIZE];
+				color colors[PACKET_SIZE];
+				for (int i = 0; i < count; i++) {
+					pixelX[i] = x0 + i;
+					pixelY[i] = y;
+					pixels[i] = getCameraPixel(camera, x0 + i, y, viewStart, viewEnd);
+					rays[i] = getSampleRay(camera, pixels[i], N, r, c);
+				}
+				traceSamples(rays, pixelX, pixelY, count, theScene, lights, depth, colors);
+				for (int i = 0; i < count; i++) {
+					color &sum = samples.sums[(y - yLo) * W + (x0 + i - xLo)];
+					sum += colors[i];
+					color average = numSamples == N * N ? sum / (real)glm::pow(N, 2.0) : sum / (real)numSamples;
+					writePixel(frameBuffer, camera, x0 + i, y, pixels[i], average);
+				}
+			}
+		}
+	});
+
+	samples.numPasses++;
+	frameBuffer.showColorBuffer();
+	return samples.numPasses < N * N;
+}
+
+/**
+ * @fn	void RayTracer::forEachTile(int xLo, int yLo, int xHi, int yHi,
+ *									const std::function<void(int, int, int, int)> &renderTile) const
+ * @brief	Cuts [xLo, xHi) x [yLo, yHi) into tileSize x tileSize tiles and calls
+ * 			renderTile on each of them, spread over numThreads threads. Returns once
+ * 			every tile is done.
+ * @param	xLo		  	The left column.
+ * @param	yLo		  	The bottom row.
+ * @param	xHi		  	One past the right column.
+ * @param	yHi		  	One past the top row.
+ * @param	renderTile	Called with the xLo, yLo, xHi, yHi of each tile.
+ */
 
-	for (int y = viewStart.y; y < viewEnd.y; ++y) {
-		for (int x = viewStart.x; x < viewEnd.x; ++x) {
-			color sum = black;
-			int newX = map(x, viewStart.x, viewEnd.x, 0, camera.getNX());
-			int newY = map(y, viewStart.y, viewEnd.y, 0, camera.getNY());
-			Ray ray = camera.getRay(newX, newY);
+void RayTracer::forEachTile(int xLo, int yLo, int xHi, int yHi,
+							const std::function<void(int, int, int, int)> &renderTile) const {
+	int threads = numThreads > 0 ? numThreads : (int)std::thread::hardware_concurrency();
+	const int tile = tileSize > 0 ? tileSize : 16;
+	const int tilesAcross = (xHi - xLo + tile - 1) / tile;
+	const int tilesUp = (yHi - yLo + tile - 1) / tile;
+	const int numTiles = glm::max(tilesAcross, 0) * glm::max(tilesUp, 0);
+	threads = glm::clamp(threads, 1, glm::max(numTiles, 1));
+
+	if (threads == 1) {
+		renderTile(xLo, yLo, xHi, yHi);
+		return;
+	}
+
+	parallelFor(numTiles, threads, [&](int i) {
+		int x = xLo + (i % tilesAcross) * tile;
+		int y = yLo + (i / tilesAcross) * tile;
+		renderTile(x, y, glm::min(x + tile, xHi), glm::min(y + tile, yHi));
+	});
+}
+
+/**
+ * @fn	void RayTracer::raytraceTile(FrameBuffer &frameBuffer, int depth, const IScene &theScene,
+ *									const FrameLights &lights, int N, const rvec2& viewStart, const rvec2& viewEnd,
+ *									int xLo, int yLo, int xHi, int yHi) const
+ * @brief	Raytraces the pixels [xLo, xHi) x [yLo, yHi) of the viewport. Only touches
+ * 			those pixels of the framebuffer. When usePackets is set, the primary rays
+ * 			for PACKET_SIZE neighboring pixels in a row are intersected as one RayPacket.
+ * @param [in,out]	frameBuffer	Framebuffer.
+ * @param 		  	depth	   	The current depth of recursion.
+ * @param 		  	theScene   	The scene.
+ * @param 		  	lights   	The scene's lights, resolved for this frame.
+ * @param 		  	N   	    Number of rays per pixel for anti-aliasing.
+ * @param 		  	viewStart   The x and y of the lower left pixel of the viewport.
+ * @param 		  	viewEnd   	The x and y of the top right pixel of the viewport.
+ * @param 		  	xLo   		The left column of the tile.
+ * @param 		  	yLo   		The bottom row of the tile.
+ * @param 		  	xHi   		One past the right column of the tile.
+ * @param 		  	yHi   		One past the top row of the tile.
+ */
+
+void RayTracer::raytraceTile(FrameBuffer &frameBuffer, int depth,
+								const IScene &theScene, const FrameLights &lights,
+								int N, const rvec2& viewStart, const rvec2& viewEnd,
+								int xLo, int yLo, int xHi, int yHi) const {
+	const RaytracingCamera &camera = *theScene.camera;
+
+	for (int y = yLo; y < yHi; ++y) {
+		for (int x0 = xLo; x0 < xHi; x0 += PACKET_SIZE) {
+			const int width = glm::min(PACKET_SIZE, xHi - x0);
+			int pixelX[PACKET_SIZE], pixelY[PACKET_SIZE];
+			rvec2 pixels[PACKET_SIZE];
+			color sum[PACKET_SIZE];
+			for (int i = 0; i < width; i++) {
+				pixelX[i] = x0 + i;
+				pixelY[i] = y;
+				pixels[i] = getCameraPixel(camera, x0 + i, y, viewStart, viewEnd);
+				sum[i] = black;
+			}
 
 			for (int r = 0; r < N; r++)
 			{
 				for (int c = 0; c < N; c++)
 				{
-					DEBUG_PIXEL = (x == xDebug && y == yDebug);
-					if (DEBUG_PIXEL) {
-						cout << "";
+					Ray rays[PACKET_SIZE];
+					color colors[PACKET_SIZE];
+					for (int i = 0; i < width; i++) {
+						rays[i] = getSampleRay(camera, pixels[i], N, r, c);
+					}
+					traceSamples(rays, pixelX, pixelY, width, theScene, lights, depth, colors);
+					for (int i = 0; i < width; i++) {
+						sum[i] += colors[i];
 					}
+				}
+			}
 
-					int newX = map(x, viewStart.x, viewEnd.x, 0, camera.getNX());
-					int newY = map(y, viewStart.y, viewEnd.y, 0, camera.getNY());
-					Ray ray = camera.getRay(newX + 1 / (2.0 * N) + r * 1.0 / N, 
-						newY + 1 / (2.0 * N) + c * 1.0 / N);
+			for (int i = 0; i < width; i++) {
+				writePixel(frameBuffer, camera, x0 + i, y, pixels[i], sum[i] / (real)glm::pow(N, 2.0));
+			}
+		}
+	}
+}
 
-					color pixelColor = defaultColor;
+/**
+ * @fn	rvec2 RayTracer::getCameraPixel(const RaytracingCamera &camera, int x, int y,
+ *									const rvec2& viewStart, const rvec2& viewEnd) const
+ * @brief	Maps a pixel of the viewport to the corresponding pixel of the camera.
+ * @param	camera   	The camera.
+ * @param	x		 	The x coordinate of the pixel in the framebuffer.
+ * @param	y		 	The y coordinate of the pixel in the framebuffer.
+ * @param	viewStart	The x and y of the lower left pixel of the viewport.
+ * @param	viewEnd  	The x and y of the top right pixel of the viewport.
+ * @return	The (integer) coordinates of the camera's pixel.
+ */
 
-					HitRecord opaqueHit;
-					HitRecord transHit;
+rvec2 RayTracer::getCameraPixel(const RaytracingCamera &camera, int x, int y,
+								const rvec2& viewStart, const rvec2& viewEnd) const {
+	int newX = map(x, viewStart.x, viewEnd.x, 0, camera.getNX());
+	int newY = map(y, viewStart.y, viewEnd.y, 0, camera.getNY());
+	return rvec2(newX, newY);
+}
 
-					VisibleIShape::findIntersection(ray, opaqueObjs, opaqueHit);
-					VisibleIShape::findIntersection(ray, transObjs, transHit);
+/**
+ * @fn	Ray RayTracer::getSampleRay(const RaytracingCamera &camera, const rvec2 &pixel, int N, int r, int c) const
+ * @brief	Gets the ray through sample (r, c) of the N x N grid of samples in a pixel.
+ * @param	camera	The camera.
+ * @param	pixel 	The camera's pixel, from getCameraPixel.
+ * @param	N	  	Size of the grid of samples.
+ * @param	r	  	Column of the sample in the grid.
+ * @param	c	  	Row of the sample in the grid.
+ * @return	The ray.
+ */
 
-					color opaqueColor = traceIndividualRay(ray, theScene, depth + 1);
+Ray RayTracer::getSampleRay(const RaytracingCamera &camera, const rvec2 &pixel, int N, int r, int c) const {
+	return camera.getRay(pixel.x + 1 / (2.0 * N) + r * 1.0 / N,
+						pixel.y + 1 / (2.0 * N) + c * 1.0 / N);
+}
 
-					color transColor;
-					if (transHit.t != FLT_MAX)
-					{
-						for (int i = 0; i < lights.size(); i++)
-						{
-							transColor += lights[i]->illuminate(transHit.interceptPt, transHit.normal, transHit.material,
-								(*theScene.camera).getFrame(), true);
-						}
-					}
+/**
+ * @fn	void RayTracer::traceSamples(const Ray rays[], const int pixelX[], const int pixelY[], int count,
+ *									const IScene &theScene, const FrameLights &lights, int depth, color colors[]) const
+ * @brief	Traces up to PACKET_SIZE primary rays. When usePackets is set and there are
+ * 			PACKET_SIZE of them, they are intersected as one RayPacket.
+ * @param 		  	rays	The rays.
+ * @param 		  	pixelX	The x coordinate of the pixel each ray belongs to.
+ * @param 		  	pixelY	The y coordinate of the pixel each ray belongs to.
+ * @param 		  	count 	Number of rays.
+ * @param 		  	theScene	The scene.
+ * @param 		  	lights	The scene's lights, resolved for this frame.
+ * @param 		  	depth 	The current depth of recursion.
+ * @param [in,out]	colors	The color seen along each ray, clamped to [0, 1].
+ */
 
-					// intersects both opaque and translucent object
-					if (opaqueHit.t != FLT_MAX && transHit.t != FLT_MAX)
-					{
-						// checks if opaque object is in front of translucent
-						if (opaqueHit.t < transHit.t)
-						{
-							pixelColor = opaqueColor;
-						}
-						else
-						{
-							pixelColor = (1 - transHit.material.alpha) * opaqueColor + 
-								transHit.material.alpha * transColor;
-						}
-					}
-					// intersects opaque object only
-					else if (opaqueHit.t != FLT_MAX)
-					{
-						pixelColor = opaqueColor;
-					}
-					// intersects translucent object only
-					else if (transHit.t != FLT_MAX)
-					{
-						pixelColor = (1 - transHit.material.alpha) * defaultColor + transHit.material.alpha * transColor;
-					}
+void RayTracer::traceSamples(const Ray rays[], const int pixelX[], const int pixelY[], int count,
+								const IScene &theScene, const FrameLights &lights, int depth, color colors[]) const {
+	HitRecord opaqueHits[PACKET_SIZE];
+	HitRecord transHits[PACKET_SIZE];
 
-					sum += glm::clamp(pixelColor, 0.0, 1.0);
-				}
-			}
+	if (usePackets && count == PACKET_SIZE) {
+		RayPacket packet(rays);
+		theScene.opaqueBVH.findIntersections(packet, opaqueHits);
+		theScene.transparentBVH.findIntersections(packet, transHits);
+	} else {
+		for (int i = 0; i < count; i++) {
+			theScene.opaqueBVH.findIntersection(rays[i], opaqueHits[i]);
+			theScene.transparentBVH.findIntersection(rays[i], transHits[i]);
+		}
+	}
+
+	for (int i = 0; i < count; i++) {
+		DEBUG_PIXEL = (pixelX[i] == xDebug && pixelY[i] == yDebug);
+		if (DEBUG_PIXEL) {
+			cout << "";
+		}
+
+		color pixelColor = shadePrimaryRay(rays[i], opaqueHits[i], transHits[i], theScene, lights, depth);
+		colors[i] = glm::clamp(pixelColor, real(0.0), real(1.0));
+	}
+}
+
+/**
+ * @fn	void RayTracer::writePixel(FrameBuffer &frameBuffer, const RaytracingCamera &camera, int x, int y,
+ *									const rvec2 &pixel, const color &C) const
+ * @brief	Stores the final color of a pixel and draws the world axes over it.
+ * @param [in,out]	frameBuffer	Framebuffer.
+ * @param 		  	camera	   	The camera.
+ * @param 		  	x		   	The x coordinate of the pixel.
+ * @param 		  	y		   	The y coordinate of the pixel.
+ * @param 		  	pixel	   	The camera's pixel, from getCameraPixel.
+ * @param 		  	C		   	The color.
+ */
+
+void RayTracer::writePixel(FrameBuffer &frameBuffer, const RaytracingCamera &camera, int x, int y,
+							const rvec2 &pixel, const color &C) const {
+	frameBuffer.setColor(x, y, C);
+	frameBuffer.showAxes(x, y, camera.getRay(pixel.x, pixel.y), 0.05);			// Displays R/x, G/y, B/z axes
+}
+
+/**
+ * @fn	color RayTracer::shadePrimaryRay(const Ray &ray, const HitRecord &opaqueHit,
+ *										const HitRecord &transHit, const IScene &theScene,
+ *										const FrameLights &lights, int depth) const
+ * @brief	Computes the color seen along a primary ray, blending the opaque surface
+ * 			behind any transparent surface in front of it. The hits come from the
+ * 			caller's intersection tests, so the primary ray is not intersected with
+ * 			either list again, and the transparent surface is only lit when it is
+ * 			in front of the opaque one.
+ * @param	ray		  	The primary ray.
+ * @param	opaqueHit 	The closest opaque intersection along the ray.
+ * @param	transHit  	The closest transparent intersection along the ray.
+ * @param	theScene  	The scene.
+ * @param	lights    	The scene's lights, resolved for this frame.
+ * @param	depth	  	The current depth of recursion.
+ * @return	The color for this sample, before clamping.
+ */
+
+color RayTracer::shadePrimaryRay(const Ray &ray, const HitRecord &opaqueHit, const HitRecord &transHit,
+									const IScene &theScene, const FrameLights &lights, int depth) const {
+	color pixelColor = defaultColor;
+
+	const bool isBehindTrans = transHit.t != FLT_MAX && !(opaqueHit.t < transHit.t);
+
+	color opaqueColor = black;
+	if (opaqueHit.t != FLT_MAX)
+	{
+		real weight = isBehindTrans ? 1 - transHit.material.alpha : 1.0;
+		opaqueColor = shadeOpaqueHit(ray, opaqueHit, theScene, lights, depth + 1, weight);
+	}
 
-			frameBuffer.setColor(x, y, sum/glm::pow(N, 2.0));
+	color transColor;
+	if (isBehindTrans)
+	{
+		transColor = lights.illuminate(transHit.interceptPt, transHit.normal, transHit.material, nullptr);
+	}
 
-			frameBuffer.showAxes(x, y, ray, 0.05);			// Displays R/x, G/y, B/z axes
+	// intersects both opaque and translucent object
+	if (opaqueHit.t != FLT_MAX && transHit.t != FLT_MAX)
+	{
+		// checks if opaque object is in front of translucent
+		if (opaqueHit.t < transHit.t)
+		{
+			pixelColor = opaqueColor;
+		}
+		else
+		{
+			pixelColor = (1 - transHit.material.alpha) * opaqueColor + 
+				transHit.material.alpha * transColor;
 		}
 	}
+	// intersects opaque object only
+	else if (opaqueHit.t != FLT_MAX)
+	{
+		pixelColor = opaqueColor;
+	}
+	// intersects translucent object only
+	else if (transHit.t != FLT_MAX)
+	{
+		pixelColor = (1 - transHit.material.alpha) * defaultColor + transHit.material.alpha * transColor;
+	}
 
-	frameBuffer.showColorBuffer();
+	return pixelColor;
 }
 
 /**
  * @fn	color RayTracer::traceIndividualRay(const Ray &ray, 
  *											const IScene &theScene,
+ *											const FrameLights &lights,
  *											int recursionLevel) const
  * @brief	Trace an individual ray.
  * @param	ray			  	The ray.
  * @param	theScene	  	The scene.
+ * @param	lights		  	The scene's lights, resolved for this frame.
  * @param	recursionLevel	The recursion level.
  * @return	The color to be displayed as a result of this ray.
  */
 
-color RayTracer::traceIndividualRay(const Ray &ray, const IScene &theScene, int recursionLevel) const {
+color RayTracer::traceIndividualRay(const Ray &ray, const IScene &theScene, const FrameLights &lights,
+										int recursionLevel) const {
 	HitRecord opaqueHit;
 
-	VisibleIShape::findIntersection(ray, theScene.opaqueObjs, opaqueHit);
+	theScene.opaqueBVH.findIntersection(ray, opaqueHit);
 
 	color opaqueColor = black;
 	if (opaqueHit.t != FLT_MAX)
 	{
-		for (int i = 0; i < theScene.lights.size(); i++)
+		opaqueColor = shadeOpaqueHit(ray, opaqueHit, theScene, lights, recursionLevel);
+	}
+	
+	return opaqueColor;
+}
+
+/**
+ * @fn	static unsigned int seedFromRay(const Ray &ray)
+ * @brief	Hashes a ray's origin and direction into a random number seed, so that the
+ * 			random choices made for a sample depend only on the sample, not on which
+ * 			thread traces it or what it traced before.
+ * @param	ray	The ray.
+ * @return	The seed.
+ */
+
+static unsigned int seedFromRay(const Ray &ray) {
+	const real values[6] = { ray.origin.x, ray.origin.y, ray.origin.z, ray.dir.x, ray.dir.y, ray.dir.z };
+	unsigned char bytes[sizeof(values)];
+	std::memcpy(bytes, values, sizeof(values));
+	unsigned int hash = 2166136261u;		// FNV-1a
+	for (unsigned char b : bytes) {
+		hash = (hash ^ b) * 16777619u;
+	}
+	return hash;
+}
+
+/**
+ * @fn	color RayTracer::shadeOpaqueHit(const Ray &ray, const HitRecord &opaqueHit,
+ *										const IScene &theScene, const FrameLights &lights,
+ *										int recursionLevel, real weight) const
+ * @brief	Computes the color of an opaque surface that a ray hits, including the
+ * 			reflections seen in it. The chain of reflections is followed in a loop
+ * 			rather than by recursion. Each bounce carries a throughput, the factor its
+ * 			color is scaled by before it reaches the pixel. The chain ends after
+ * 			recursionLevel - 1 reflections, when a reflected ray misses, or as soon as
+ * 			the next bounce would be worth less than minContribution. With
+ * 			russianRoulette set, bounces worth less than ROULETTE_THRESHOLD are traced
+ * 			only with a probability proportional to their worth, and scaled up to
+ * 			compensate when they are, so deep chains cost little yet stay unbiased.
+ * 			The random numbers are seeded from the ray, so renders are reproducible.
+ * 			Textures are filtered over the area a pixel covers where the ray lands,
+ * 			estimated from the distance travelled since the camera and the angle
+ * 			the ray meets the surface.
+ * @param	ray			  	The ray, which starts at the camera.
+ * @param	opaqueHit	  	The closest opaque intersection along the ray. Must be a hit.
+ * @param	theScene	  	The scene.
+ * @param	lights		  	The scene's lights, resolved for this frame.
+ * @param	recursionLevel	The recursion level.
+ * @param	weight		  	How much the returned color counts in the final pixel, e.g.,
+ * 							less than 1 behind a transparent surface. Only used to
+ * 							decide when to stop.
+ * @return	The color to be displayed as a result of this ray.
+ */
+
+color RayTracer::shadeOpaqueHit(const Ray &ray, const HitRecord &opaqueHit, const IScene &theScene,
+								const FrameLights &lights, int recursionLevel, real weight) const {
+	std::minstd_rand rng(seedFromRay(ray));
+	std::uniform_real_distribution<real> uniform(0.0, 1.0);
+
+	color totalColor = black;
+	real throughput = 1.0;
+	real pathLength = 0;
+	Ray currRay = ray;
+	HitRecord hit = opaqueHit;
+	for (int level = recursionLevel; ; level--)
+	{
+		color localColor = lights.illuminate(hit.interceptPt, hit.normal, hit.material, &theScene.opaqueBVH);
+
+		pathLength += hit.t;
+		if (hit.texture != nullptr)
 		{
-			opaqueColor += theScene.lights[i]->illuminate(opaqueHit.interceptPt, opaqueHit.normal, opaqueHit.material,
-				(*theScene.camera).getFrame(), inShadow(theScene.lights[i]->actualPosition((*theScene.camera).getFrame()),
-					opaqueHit.interceptPt, opaqueHit.normal, theScene.opaqueObjs));
+			real cosine = std::max(std::abs(glm::dot(currRay.dir, hit.normal)), MIN_TEXTURE_COSINE);
+			real footprint = hit.uvPerUnit * (*theScene.camera).getPixelFootprint(pathLength) / cosine;
+			color texel = hit.texture->sample(hit.u, hit.v, footprint);
+			localColor = real(0.5) * texel + real(0.5) * localColor;
 		}
+		totalColor += throughput * localColor;
 
-		if (opaqueHit.texture != nullptr)
+		if (level - 1 <= 0)
 		{
-			color texel = opaqueHit.texture->getPixelUV(opaqueHit.u, opaqueHit.v);
-			opaqueColor = 0.5 * texel + 0.5 * opaqueColor;
+			break;
+		}
+		throughput *= REFLECTION_WEIGHT;
+		real worth = throughput * weight;
+		if (worth < minContribution && !russianRoulette)
+		{
+			break;
+		}
+		if (russianRoulette && worth < ROULETTE_THRESHOLD)
+		{
+			real survival = worth / ROULETTE_THRESHOLD;
+			if (uniform(rng) >= survival)
+			{
+				break;
+			}
+			throughput /= survival;
 		}
 
-		if (recursionLevel - 1 > 0)
+		currRay.origin = IShape::movePointOffSurface(hit.interceptPt, hit.normal);
+		currRay.dir = glm::normalize(currRay.dir - 2 * (glm::dot(currRay.dir, hit.normal)) * hit.normal);
+		theScene.opaqueBVH.findIntersection(currRay, hit);
+		if (hit.t == FLT_MAX)
 		{
-			color newOrigin = IShape::movePointOffSurface(opaqueHit.interceptPt, opaqueHit.normal);
-			color newDirection = ray.dir - 2 * (glm::dot(ray.dir, opaqueHit.normal)) * opaqueHit.normal;
-			opaqueColor += 0.3 * traceIndividualRay(Ray(newOrigin, newDirection), theScene, recursionLevel - 1);
+			break;
 		}
 	}
-	
-	return opaqueColor;
-}
\ No newline at end of file
+
+	return totalColor;
+}
@@ -9,11 +9,28 @@
 
 #pragma once
 
+#include <functional>
 #include "utilities.h"
 #include "framebuffer.h"
 #include "camera.h"
 #include "iscene.h"
 
+/**
+ * @struct	SampleBuffer
+ * @brief	Per-pixel running sums of the samples traced so far by progressive
+ * 			rendering. Call reset() whenever the scene or the camera changes.
+ */
+
+struct SampleBuffer {
+	int width;				//!< Width of the viewport the sums cover.
+	int height;				//!< Height of the viewport the sums cover.
+	int N;					//!< The samples form an N x N grid in each pixel.
+	int numPasses;			//!< Number of samples accumulated in each pixel.
+	vector<color> sums;		//!< Sum of the clamped samples of each pixel, row by row.
+	SampleBuffer() : width(0), height(0), N(0), numPasses(0) {}
+	void reset() { numPasses = 0; }
+};
+
 /**
  * @struct	RayTracer
  * @brief	Encapsulates the functionality of a ray tracer.
@@ -21,9 +38,36 @@
 
 struct RayTracer {
 	color defaultColor;
-	RayTracer(const color &defaultColor);
+	int numThreads;		//!< Worker threads used by raytraceScene. 1 ==> serial, 0 ==> one per core.
+	int tileSize;		//!< Width and height, in pixels, of the tiles handed out to worker threads.
+	bool usePackets;	//!< Trace primary rays through PACKET_SIZE neighboring pixels together.
+	real minContribution;	//!< Reflections that would add less than this to a pixel are not traced.
+	bool russianRoulette;	//!< Randomly end low-contribution reflection chains instead of cutting them off.
+	RayTracer(const color &defaultColor, int numThreads = 1, int tileSize = 16);
 	void raytraceScene(FrameBuffer &frameBuffer, int depth,
-						const IScene &theScene, int N, const dvec2& viewStart, const dvec2& viewEnd) const;
+						const IScene &theScene, int N, const rvec2& viewStart, const rvec2& viewEnd) const;
+	long long raytraceSceneAdaptive(FrameBuffer &frameBuffer, int depth, const IScene &theScene,
+						int N, real threshold, const rvec2& viewStart, const rvec2& viewEnd) const;
+	bool raytraceScenePass(FrameBuffer &frameBuffer, int depth, const IScene &theScene,
+						int N, SampleBuffer &samples, const rvec2& viewStart, const rvec2& viewEnd) const;
 protected:
-	color traceIndividualRay(const Ray &ray, const IScene &theScene, int recursionLevel) const;
+	void forEachTile(int xLo, int yLo, int xHi, int yHi,
+						const std::function<void(int, int, int, int)> &renderTile) const;
+	void raytraceTile(FrameBuffer &frameBuffer, int depth,
+						const IScene &theScene, const FrameLights &lights,
+						int N, const rvec2& viewStart, const rvec2& viewEnd,
+						int xLo, int yLo, int xHi, int yHi) const;
+	rvec2 getCameraPixel(const RaytracingCamera &camera, int x, int y,
+						const rvec2& viewStart, const rvec2& viewEnd) const;
+	Ray getSampleRay(const RaytracingCamera &camera, const rvec2 &pixel, int N, int r, int c) const;
+	void traceSamples(const Ray rays[], const int pixelX[], const int pixelY[], int count,
+						const IScene &theScene, const FrameLights &lights, int depth, color colors[]) const;
+	void writePixel(FrameBuffer &frameBuffer, const RaytracingCamera &camera, int x, int y,
+						const rvec2 &pixel, const color &C) const;
+	color shadePrimaryRay(const Ray &ray, const HitRecord &opaqueHit, const HitRecord &transHit,
+						const IScene &theScene, const FrameLights &lights, int depth) const;
+	color traceIndividualRay(const Ray &ray, const IScene &theScene, const FrameLights &lights,
+						int recursionLevel) const;
+	color shadeOpaqueHit(const Ray &ray, const HitRecord &opaqueHit, const IScene &theScene,
+						const FrameLights &lights, int recursionLevel, real weight = 1.0) const;
 };
\ No newline at end of file
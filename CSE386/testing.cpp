@@ -8,11 +8,11 @@
 
 int main(int argc, char* argv[])
 {
-	dvec3 position = dvec3(2.0, 3.0, 4.0);
-	dvec3 focus = dvec3(-2.0, -3.0, 0);
-	dvec3 upVector = dvec3(0, 1, 0);
+	rvec3 position = rvec3(2.0, 3.0, 4.0);
+	rvec3 focus = rvec3(-2.0, -3.0, 0);
+	rvec3 upVector = rvec3(0, 1, 0);
 
-	dmat4 viewingMatrix = glm::lookAt(position, focus, upVector);
+	rmat4 viewingMatrix = glm::lookAt(position, focus, upVector);
 
 	cout << T(1.0, 2.0, 3.0) << endl;
 }
\ No newline at end of file
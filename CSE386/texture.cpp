@@ -0,0 +1,656 @@
+/****************************************************
+ * 2016-2021 Eric Bachmann and Mike Zmuda
+ * All Rights Reserved.
+ * NOTICE:
+ * Dissemination of this information or reproduction
+ * of this material is prohibited unless prior written
+ * permission is granted.
+ ****************************************************/
+
+#include <algorithm>
+#include <iostream>
+#include "texture.h"
+#include "utilities.h"
+
+/**
+ * @fn	static const real *byteToReal()
+ * @brief	Gets the table converting a channel byte to [0, 1], computed the same way
+ * 			the image loader converts 8 bit samples.
+ * @return	The 256 entry table.
+ */
+
+static const real *byteToReal() {
+	static const struct Table {
+		real values[256];
+		Table() {
+			for (int i = 0; i < 256; i++) {
+				values[i] = map(i, 0, 255, 0, 1);
+			}
+		}
+	} table;
+	return table.values;
+}
+
+/**
+ * @fn	static unsigned int packTexel(const color &C)
+ * @brief	Converts a color to an opaque RGBA8 texel.
+ * @param	C	The color. Each component is clamped to [0, 1].
+ * @return	The packed texel.
+ */
+
+static unsigned int packTexel(const color &C) {
+	unsigned int r = glm::clamp((int)(C.r * 255 + 0.5), 0, 255);
+	unsigned int g = glm::clamp((int)(C.g * 255 + 0.5), 0, 255);
+	unsigned int b = glm::clamp((int)(C.b * 255 + 0.5), 0, 255);
+	return r | (g << 8) | (b << 16) | (255u << 24);
+}
+
+/**
+ * @fn	static color unpackTexel(unsigned int texel)
+ * @brief	Converts an RGBA8 texel to a color. Alpha is dropped.
+ * @param	texel	The packed texel.
+ * @return	The color.
+ */
+
+static color unpackTexel(unsigned int texel) {
+	const real *table = byteToReal();
+	return color(table[texel & 0xFF], table[(texel >> 8) & 0xFF], table[(texel >> 16) & 0xFF]);
+}
+
+/**
+ * @fn	Texture::Texture(const std::string &fileName)
+ * @brief	Loads an image file, in any format Image reads, and builds its mip chain.
+ * 			The image itself is not kept. To share textures and load them lazily,
+ * 			get them from a TextureCache instead.
+ * @param	fileName	Name of the file.
+ */
+
+Texture::Texture(const std::string &fileName)
+	: wrap(TextureWrap::CLAMP), filter(TextureFilter::TRILINEAR), fileName(fileName),
+	  cache(nullptr), loaded(true), numPages(0), pageFile(nullptr) {
+	Image image(fileName);
+	build(image);
+}
+
+/**
+ * @fn	Texture::Texture(const Image &image)
+ * @brief	Builds a texture, and its mip chain, from an image.
+ * @param	image	The image. The texture does not refer to it afterwards.
+ */
+
+Texture::Texture(const Image &image)
+	: wrap(TextureWrap::CLAMP), filter(TextureFilter::TRILINEAR),
+	  cache(nullptr), loaded(true), numPages(0), pageFile(nullptr) {
+	build(image);
+}
+
+/**
+ * @fn	Texture::Texture(const std::string &fileName, TextureCache *cache)
+ * @brief	Constructs a texture managed by a cache. Nothing is read until it is used.
+ * @param	fileName	Name of the file.
+ * @param	cache   	The cache.
+ */
+
+Texture::Texture(const std::string &fileName, TextureCache *cache)
+	: wrap(TextureWrap::CLAMP), filter(TextureFilter::TRILINEAR), fileName(fileName),
+	  cache(cache), loaded(false), numPages(0), pageFile(nullptr) {
+}
+
+/**
+ * @fn	Texture::~Texture()
+ * @brief	Frees the pages, and removes the texture from its cache, if any.
+ */
+
+Texture::~Texture() {
+	if (cache != nullptr) {
+		cache->release(*this);
+	}
+	for (size_t i = 0; i < numPages; i++) {
+		delete[] pages[i].texels.load();
+	}
+	if (pageFile != nullptr) {
+		std::fclose(pageFile);
+	}
+}
+
+/**
+ * @fn	void Texture::build(const Image &image)
+ * @brief	Converts the image to RGBA8 and builds the mip levels, with every page
+ * 			resident. Each level halves the size of the one before, rounding down,
+ * 			until it is 1x1. A texel of a level is the rounded average of the texels
+ * 			of the previous level that it covers, so odd sizes are filtered correctly.
+ * @param	image	The image.
+ */
+
+void Texture::build(const Image &image) {
+	if (image.W <= 0 || image.H <= 0) {
+		return;
+	}
+
+	size_t total = 0;
+	int W = image.W, H = image.H;
+	while (true) {
+		MipLevel level;
+		level.W = W;
+		level.H = H;
+		level.pagesAcross = (W + TEXTURE_PAGE_SIZE - 1) / TEXTURE_PAGE_SIZE;
+		level.firstPage = total;
+		int pagesUp = (H + TEXTURE_PAGE_SIZE - 1) / TEXTURE_PAGE_SIZE;
+		total += (size_t)level.pagesAcross * pagesUp;
+		levels.push_back(level);
+		if (W == 1 && H == 1) {
+			break;
+		}
+		W = std::max(1, W / 2);
+		H = std::max(1, H / 2);
+	}
+	numPages = total;
+	pages.reset(new Page[numPages]);
+	for (size_t i = 0; i < numPages; i++) {
+		pages[i].texels.store(new unsigned int[TEXTURE_PAGE_SIZE * TEXTURE_PAGE_SIZE]());
+		pages[i].lastUsed.store(0);
+		pages[i].onDisk = false;
+	}
+
+	const MipLevel &base = levels[0];
+	for (int y = 0; y < base.H; y++) {
+		for (int x = 0; x < base.W; x++) {
+			store(base, x, y, packTexel(image.pixels[y * base.W + x]));
+		}
+	}
+
+	// Reads the pages directly, so that building does not mark them used.
+	auto texelAt = [this](const MipLevel &level, int x, int y) {
+		size_t page = level.firstPage + (y / TEXTURE_PAGE_SIZE) * level.pagesAcross + x / TEXTURE_PAGE_SIZE;
+		return pages[page].texels.load(std::memory_order_relaxed)[texelIndex(x, y)];
+	};
+	for (size_t i = 1; i < levels.size(); i++) {
+		const MipLevel &src = levels[i - 1];
+		const MipLevel &dst = levels[i];
+		for (int y = 0; y < dst.H; y++) {
+			int y0 = y * src.H / dst.H;
+			int y1 = (y + 1) * src.H / dst.H;
+			for (int x = 0; x < dst.W; x++) {
+				int x0 = x * src.W / dst.W;
+				int x1 = (x + 1) * src.W / dst.W;
+				unsigned int sum[4] = { 0, 0, 0, 0 };
+				for (int sy = y0; sy < y1; sy++) {
+					for (int sx = x0; sx < x1; sx++) {
+						unsigned int texel = texelAt(src, sx, sy);
+						for (int c = 0; c < 4; c++) {
+							sum[c] += (texel >> (8 * c)) & 0xFF;
+						}
+					}
+				}
+				unsigned int count = (x1 - x0) * (y1 - y0);
+				unsigned int texel = 0;
+				for (int c = 0; c < 4; c++) {
+					texel |= ((sum[c] + count / 2) / count) << (8 * c);
+				}
+				store(dst, x, y, texel);
+			}
+		}
+	}
+}
+
+/**
+ * @fn	void Texture::store(const MipLevel &level, int x, int y, unsigned int texel)
+ * @brief	Stores a texel of a level. The page must be resident.
+ * @param	level	The level.
+ * @param	x	 	The column, in [0, level.W).
+ * @param	y	 	The row, in [0, level.H).
+ * @param	texel	The packed texel.
+ */
+
+void Texture::store(const MipLevel &level, int x, int y, unsigned int texel) {
+	size_t page = level.firstPage + (y / TEXTURE_PAGE_SIZE) * level.pagesAcross + x / TEXTURE_PAGE_SIZE;
+	pages[page].texels.load(std::memory_order_relaxed)[texelIndex(x, y)] = texel;
+}
+
+/**
+ * @fn	int Texture::getWidth(int level) const
+ * @brief	Gets the width of a mip level, loading the texture if necessary.
+ * @param	level	The mip level.
+ * @return	The width in texels, or 0 if the texture is empty.
+ */
+
+int Texture::getWidth(int level) const {
+	ensureLoaded();
+	return levels.empty() ? 0 : levels[level].W;
+}
+
+/**
+ * @fn	int Texture::getHeight(int level) const
+ * @brief	Gets the height of a mip level, loading the texture if necessary.
+ * @param	level	The mip level.
+ * @return	The height in texels, or 0 if the texture is empty.
+ */
+
+int Texture::getHeight(int level) const {
+	ensureLoaded();
+	return levels.empty() ? 0 : levels[level].H;
+}
+
+/**
+ * @fn	int Texture::getNumLevels() const
+ * @brief	Gets the number of mip levels, loading the texture if necessary.
+ * @return	The number of levels, or 0 if the texture is empty.
+ */
+
+int Texture::getNumLevels() const {
+	ensureLoaded();
+	return (int)levels.size();
+}
+
+/**
+ * @fn	size_t Texture::getMemorySize() const
+ * @brief	Gets the number of bytes the texture occupies now. Only resident pages
+ * 			count, so a texture that has not been loaded is small.
+ * @return	The size in bytes.
+ */
+
+size_t Texture::getMemorySize() const {
+	size_t size = sizeof(*this) + levels.size() * sizeof(MipLevel) + numPages * sizeof(Page);
+	for (size_t i = 0; i < numPages; i++) {
+		if (pages[i].texels.load() != nullptr) {
+			size += TEXTURE_PAGE_BYTES;
+		}
+	}
+	return size;
+}
+
+/**
+ * @fn	color Texture::getTexel(int level, int x, int y) const
+ * @brief	Gets one texel of a mip level. Coordinates outside the level are wrapped
+ * 			or clamped according to wrap.
+ * @param	level	The mip level, in [0, getNumLevels()).
+ * @param	x	 	The column.
+ * @param	y	 	The row.
+ * @return	The texel's color, or black if the texture is empty.
+ */
+
+color Texture::getTexel(int level, int x, int y) const {
+	ensureLoaded();
+	if (levels.empty()) {
+		return black;
+	}
+	const MipLevel &L = levels[level];
+	if (wrap == TextureWrap::REPEAT) {
+		x = ((x % L.W) + L.W) % L.W;
+		y = ((y % L.H) + L.H) % L.H;
+	} else {
+		x = glm::clamp(x, 0, L.W - 1);
+		y = glm::clamp(y, 0, L.H - 1);
+	}
+	return unpackTexel(fetch(L, x, y));
+}
+
+/**
+ * @fn	color Texture::sample(real u, real v, real footprint) const
+ * @brief	Samples the texture at (u, v), filtered according to filter. A texture
+ * 			from a cache is loaded when it is first sampled.
+ * @param	u		 	The u in (u, v).
+ * @param	v		 	The v in (u, v).
+ * @param	footprint	The width of the area the sample stands for, in (u, v) units,
+ * 						e.g., the size of a pixel projected onto the texture. Used only
+ * 						by TRILINEAR, to choose the mip levels. 0 ==> the full size
+ * 						level.
+ * @return	The filtered color, or black if the texture is empty.
+ */
+
+color Texture::sample(real u, real v, real footprint) const {
+	ensureLoaded();
+	if (levels.empty()) {
+		return black;
+	}
+	if (wrap == TextureWrap::REPEAT) {
+		u -= std::floor(u);
+		v -= std::floor(v);
+	} else {
+		u = glm::clamp(u, real(0), real(1));
+		v = glm::clamp(v, real(0), real(1));
+	}
+
+	switch (filter) {
+	case TextureFilter::NEAREST:
+		return sampleNearest(levels[0], u, v);
+	case TextureFilter::BILINEAR:
+		return sampleBilinear(levels[0], u, v);
+	default:
+		break;
+	}
+
+	real texelsCovered = footprint * std::max(levels[0].W, levels[0].H);
+	if (!(texelsCovered > 1)) {
+		return sampleBilinear(levels[0], u, v);
+	}
+	real lod = std::log2(texelsCovered);
+	int last = (int)levels.size() - 1;
+	if (lod >= last) {
+		return sampleBilinear(levels[last], u, v);
+	}
+	int lo = (int)lod;
+	real t = lod - lo;
+	return (1 - t) * sampleBilinear(levels[lo], u, v) + t * sampleBilinear(levels[lo + 1], u, v);
+}
+
+/**
+ * @fn	int Texture::wrapCoord(int i, int n) const
+ * @brief	Wraps or clamps a texel coordinate that is at most one texel outside
+ * 			[0, n).
+ * @param	i	The coordinate, in [-1, n].
+ * @param	n	The size of the level in that direction.
+ * @return	The coordinate inside [0, n).
+ */
+
+int Texture::wrapCoord(int i, int n) const {
+	if (wrap == TextureWrap::REPEAT) {
+		return i < 0 ? i + n : (i >= n ? i - n : i);
+	}
+	return glm::clamp(i, 0, n - 1);
+}
+
+/**
+ * @fn	color Texture::sampleNearest(const MipLevel &level, real u, real v) const
+ * @brief	Gets the texel whose center is closest to (u, v), as Image::getPixelUV does.
+ * @param	level	The mip level.
+ * @param	u	 	The u in (u, v), already wrapped or clamped to [0, 1].
+ * @param	v	 	The v in (u, v), already wrapped or clamped to [0, 1].
+ * @return	The texel's color.
+ */
+
+color Texture::sampleNearest(const MipLevel &level, real u, real v) const {
+	int x = std::min((int)(level.W * u), level.W - 1);
+	int y = std::min((int)(level.H * v), level.H - 1);
+	return unpackTexel(fetch(level, x, y));
+}
+
+/**
+ * @fn	color Texture::sampleBilinear(const MipLevel &level, real u, real v) const
+ * @brief	Blends the four texels whose centers surround (u, v), weighted by distance.
+ * @param	level	The mip level.
+ * @param	u	 	The u in (u, v), already wrapped or clamped to [0, 1].
+ * @param	v	 	The v in (u, v), already wrapped or clamped to [0, 1].
+ * @return	The blended color.
+ */
+
+color Texture::sampleBilinear(const MipLevel &level, real u, real v) const {
+	// u and v are at least 0, so fx and fy are at least -0.5 and truncating
+	// fx + 1 gives the floor without a library call.
+	real fx = u * level.W - real(0.5);
+	real fy = v * level.H - real(0.5);
+	int x0 = (int)(fx + 1) - 1;
+	int y0 = (int)(fy + 1) - 1;
+	real tx = fx - x0;
+	real ty = fy - y0;
+	int x1 = wrapCoord(x0 + 1, level.W);
+	int y1 = wrapCoord(y0 + 1, level.H);
+	x0 = wrapCoord(x0, level.W);
+	y0 = wrapCoord(y0, level.H);
+
+	const unsigned int texel[4] = { fetch(level, x0, y0), fetch(level, x1, y0),
+									fetch(level, x0, y1), fetch(level, x1, y1) };
+	const real weight[4] = { (1 - tx) * (1 - ty), tx * (1 - ty), (1 - tx) * ty, tx * ty };
+	const real *table = byteToReal();
+	real rgb[3] = { 0, 0, 0 };
+	for (int i = 0; i < 4; i++) {
+		for (int c = 0; c < 3; c++) {
+			rgb[c] += weight[i] * table[(texel[i] >> (8 * c)) & 0xFF];
+		}
+	}
+	return color(rgb[0], rgb[1], rgb[2]);
+}
+
+/**
+ * @fn	void TextureCacheStats::reset()
+ * @brief	Sets every count to 0.
+ */
+
+void TextureCacheStats::reset() {
+	filesLoaded = 0;
+	pagesLoaded = 0;
+	pagesEvicted = 0;
+}
+
+std::atomic<unsigned int> TextureCache::frame(1);
+
+/**
+ * @fn	TextureCache::TextureCache(size_t memoryBudget)
+ * @brief	Constructs an empty cache.
+ * @param	memoryBudget	Bytes of texels the cache tries to keep in memory.
+ */
+
+TextureCache::TextureCache(size_t memoryBudget)
+	: hand(0), budget(memoryBudget), residentSize(0) {
+	stats.reset();
+}
+
+/**
+ * @fn	TextureCache &TextureCache::global()
+ * @brief	Gets the cache shared by the whole program. It is never destroyed, so
+ * 			textures held by static objects may outlive main().
+ * @return	The global cache.
+ */
+
+TextureCache &TextureCache::global() {
+	static TextureCache *cache = new TextureCache();
+	return *cache;
+}
+
+/**
+ * @fn	TexturePtr TextureCache::get(const std::string &fileName)
+ * @brief	Gets the texture for a file. If a handle to it already exists, the
+ * 			texture is shared; otherwise a new one is made, which is not read until
+ * 			it is first used. Safe to call during static initialization.
+ * @param	fileName	Name of the file.
+ * @return	Handle to the texture.
+ */
+
+TexturePtr TextureCache::get(const std::string &fileName) {
+	std::lock_guard<std::mutex> lock(mutex);
+	TexturePtr texture = textures[fileName].lock();
+	if (texture == nullptr) {
+		texture = TexturePtr(new Texture(fileName, this));
+		textures[fileName] = texture;
+	}
+	return texture;
+}
+
+/**
+ * @fn	void TextureCache::setMemoryBudget(size_t bytes)
+ * @brief	Changes the memory budget, evicting pages if it is now exceeded.
+ * @param	bytes	Bytes of texels the cache tries to keep in memory.
+ */
+
+void TextureCache::setMemoryBudget(size_t bytes) {
+	std::lock_guard<std::mutex> lock(mutex);
+	budget = bytes;
+	makeRoom();
+}
+
+/**
+ * @fn	size_t TextureCache::getMemoryBudget() const
+ * @brief	Gets the memory budget.
+ * @return	The budget in bytes.
+ */
+
+size_t TextureCache::getMemoryBudget() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return budget;
+}
+
+/**
+ * @fn	size_t TextureCache::getResidentSize() const
+ * @brief	Gets the memory taken by the resident pages of all textures.
+ * @return	The size in bytes.
+ */
+
+size_t TextureCache::getResidentSize() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return residentSize;
+}
+
+/**
+ * @fn	void TextureCache::trim()
+ * @brief	Evicts pages until the budget is met again. Called after beginFrame(),
+ * 			it undoes the overshoot of the previous frame, since no page has been
+ * 			used in the new one yet.
+ */
+
+void TextureCache::trim() {
+	std::lock_guard<std::mutex> lock(mutex);
+	makeRoom();
+}
+
+/**
+ * @fn	void TextureCache::beginFrame()
+ * @brief	Starts a new frame, so that pages used only in earlier frames may be
+ * 			evicted. No texture may be sampled while this is called.
+ */
+
+void TextureCache::beginFrame() {
+	frame++;
+}
+
+/**
+ * @fn	void TextureCache::load(Texture &texture)
+ * @brief	Reads a texture's file and builds its pages, unless another thread has
+ * 			already done so, then evicts pages if the budget is exceeded.
+ * @param [in,out]	texture	The texture.
+ */
+
+void TextureCache::load(Texture &texture) {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (texture.loaded.load(std::memory_order_relaxed)) {
+		return;
+	}
+	{
+		Image image(texture.fileName);
+		texture.build(image);
+	}
+	stats.filesLoaded++;
+	for (size_t i = 0; i < texture.numPages; i++) {
+		resident.push_back({ &texture, i });
+	}
+	residentSize += texture.numPages * TEXTURE_PAGE_BYTES;
+	texture.loaded.store(true, std::memory_order_release);
+	makeRoom();
+}
+
+/**
+ * @fn	const unsigned int *TextureCache::pageIn(Texture &texture, size_t page)
+ * @brief	Reads an evicted page back from the texture's page file, unless another
+ * 			thread already has, then evicts other pages if the budget is exceeded.
+ * 			The caller has marked the page used, so it is not evicted again.
+ * @param [in,out]	texture	The texture.
+ * @param 		  	page   	Index of the page.
+ * @return	The page's texels.
+ */
+
+const unsigned int *TextureCache::pageIn(Texture &texture, size_t page) {
+	std::lock_guard<std::mutex> lock(mutex);
+	Texture::Page &P = texture.pages[page];
+	unsigned int *texels = P.texels.load();
+	if (texels != nullptr) {
+		return texels;
+	}
+	texels = new unsigned int[TEXTURE_PAGE_SIZE * TEXTURE_PAGE_SIZE]();
+	if (std::fseek(texture.pageFile, (long)(page * TEXTURE_PAGE_BYTES), SEEK_SET) != 0 ||
+		std::fread(texels, TEXTURE_PAGE_BYTES, 1, texture.pageFile) != 1) {
+		std::cerr << "Could not read back texture page of " << texture.fileName << endl;
+	}
+	stats.pagesLoaded++;
+	resident.push_back({ &texture, page });
+	residentSize += TEXTURE_PAGE_BYTES;
+	P.texels.store(texels);
+	makeRoom();
+	return texels;
+}
+
+/**
+ * @fn	void TextureCache::release(Texture &texture)
+ * @brief	Forgets a texture that is being destroyed.
+ * @param [in,out]	texture	The texture.
+ */
+
+void TextureCache::release(Texture &texture) {
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = textures.find(texture.fileName);
+	if (it != textures.end() && it->second.expired()) {
+		textures.erase(it);
+	}
+	for (size_t i = 0; i < resident.size(); ) {
+		if (resident[i].texture == &texture) {
+			resident[i] = resident.back();
+			resident.pop_back();
+			residentSize -= TEXTURE_PAGE_BYTES;
+		} else {
+			i++;
+		}
+	}
+}
+
+/**
+ * @fn	void TextureCache::makeRoom()
+ * @brief	Evicts pages until the budget is met, or every resident page has been
+ * 			used in the current frame. Pages are considered in turn, starting where
+ * 			the last search stopped, as in the clock algorithm. The mutex must be held.
+ */
+
+void TextureCache::makeRoom() {
+	size_t failures = 0;
+	while (residentSize > budget && failures < resident.size()) {
+		if (hand >= resident.size()) {
+			hand = 0;
+		}
+		if (evict(resident[hand])) {
+			resident[hand] = resident.back();
+			resident.pop_back();
+			residentSize -= TEXTURE_PAGE_BYTES;
+			stats.pagesEvicted++;
+			failures = 0;
+		} else {
+			hand++;
+			failures++;
+		}
+	}
+}
+
+/**
+ * @fn	bool TextureCache::evict(const PageRef &ref)
+ * @brief	Drops a page from memory, if it was not used in the current frame. The
+ * 			first time a page is evicted, it is written to the texture's page file.
+ * 			The mutex must be held.
+ * @param	ref	The page.
+ * @return	True if the page was evicted.
+ */
+
+bool TextureCache::evict(const PageRef &ref) {
+	Texture &texture = *ref.texture;
+	Texture::Page &P = texture.pages[ref.page];
+	unsigned int now = getFrame();
+	if (P.lastUsed.load() == now) {
+		return false;
+	}
+	if (!P.onDisk) {
+		if (texture.pageFile == nullptr) {
+			texture.pageFile = std::tmpfile();
+		}
+		if (texture.pageFile == nullptr ||
+			std::fseek(texture.pageFile, (long)(ref.page * TEXTURE_PAGE_BYTES), SEEK_SET) != 0 ||
+			std::fwrite(P.texels.load(), TEXTURE_PAGE_BYTES, 1, texture.pageFile) != 1) {
+			return false;
+		}
+		P.onDisk = true;
+	}
+	// Clearing the pointer before checking the mark again, both sequentially
+	// consistent, guarantees that a reader either sees nullptr or has marked
+	// the page, in which case it is put back.
+	unsigned int *texels = P.texels.exchange(nullptr);
+	if (P.lastUsed.load() == now) {
+		P.texels.store(texels);
+		return false;
+	}
+	delete[] texels;
+	return true;
+}
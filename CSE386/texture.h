@@ -0,0 +1,208 @@
+/****************************************************
+ * 2016-2021 Eric Bachmann and Mike Zmuda
+ * All Rights Reserved.
+ * NOTICE:
+ * Dissemination of this information or reproduction
+ * of this material is prohibited unless prior written
+ * permission is granted.
+ ****************************************************/
+
+#pragma once
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "defs.h"
+#include "colorandmaterials.h"
+#include "image.h"
+
+/**
+ * @enum	TextureWrap
+ * @brief	How texture coordinates outside [0, 1] are treated.
+ */
+
+enum class TextureWrap { REPEAT, CLAMP };
+
+/**
+ * @enum	TextureFilter
+ * @brief	How a texture is sampled. NEAREST picks the closest texel, exactly as
+ * 			Image::getPixelUV does. BILINEAR blends the four closest texels. TRILINEAR
+ * 			blends bilinear samples from the two mip levels that best match the
+ * 			footprint of the sample.
+ */
+
+enum class TextureFilter { NEAREST, BILINEAR, TRILINEAR };
+
+const int TEXTURE_TILE_SIZE = 4;		//!< Texels are stored in 4x4 tiles of 64 bytes, one cache line.
+const int TEXTURE_PAGE_SIZE = 32;		//!< Tiles are grouped into 32x32 texel pages, the unit of loading and eviction.
+const size_t TEXTURE_PAGE_BYTES = TEXTURE_PAGE_SIZE * TEXTURE_PAGE_SIZE * sizeof(unsigned int);	//!< Bytes in one page.
+const size_t DEFAULT_TEXTURE_BUDGET = 256 * 1024 * 1024;	//!< Default memory budget of a TextureCache, in bytes.
+
+struct Texture;
+typedef std::shared_ptr<Texture> TexturePtr;	//!< Reference counted handle to a shared texture.
+
+/**
+ * @struct	TextureCacheStats
+ * @brief	Counts of the work a TextureCache has done. Safe to update from several threads.
+ */
+
+struct TextureCacheStats {
+	std::atomic<long long> filesLoaded;		//!< Image files decoded.
+	std::atomic<long long> pagesLoaded;		//!< Evicted pages read back from disk.
+	std::atomic<long long> pagesEvicted;	//!< Pages dropped from memory to stay within the budget.
+	void reset();
+};
+
+/**
+ * @class	TextureCache
+ * @brief	Loads textures on demand and shares them. Asking for the same file twice
+ * 			gives the same texture, which lives as long as some handle to it does.
+ * 			A texture is not read until it is first used.
+ *
+ * 			The cache keeps the resident pages of all its textures within a memory
+ * 			budget. When it is exceeded, pages not used in the current frame are
+ * 			written to a temporary file, once, and dropped; they are read back from
+ * 			that file when next used. So a texture much larger than the budget
+ * 			streams through memory a page at a time. Pages read during the current
+ * 			frame are never evicted, because other threads may still be reading
+ * 			them, so a frame that touches more than the budget overshoots it until
+ * 			the next frame begins. RayTracer calls beginFrame(), then trim() on the
+ * 			global cache, before each render.
+ */
+
+class TextureCache {
+	public:
+		TextureCacheStats stats;		//!< Work done by this cache.
+		TextureCache(size_t memoryBudget = DEFAULT_TEXTURE_BUDGET);
+		TexturePtr get(const std::string &fileName);
+		void setMemoryBudget(size_t bytes);
+		size_t getMemoryBudget() const;
+		size_t getResidentSize() const;
+		void trim();
+		static void beginFrame();
+		static unsigned int getFrame() { return frame.load(std::memory_order_relaxed); }
+		static TextureCache &global();
+	protected:
+		friend struct Texture;
+
+		/**
+		 * @struct	PageRef
+		 * @brief	Identifies a resident page.
+		 */
+		struct PageRef {
+			Texture *texture;	//!< The texture the page belongs to.
+			size_t page;		//!< Index of the page within the texture.
+		};
+		mutable std::mutex mutex;				//!< Guards everything below.
+		std::map<std::string, std::weak_ptr<Texture>> textures;	//!< Textures by file name.
+		std::vector<PageRef> resident;			//!< Pages that may be evicted.
+		size_t hand;							//!< Where the next search for a page to evict starts.
+		size_t budget;							//!< Memory budget in bytes.
+		size_t residentSize;					//!< Bytes in resident pages.
+		static std::atomic<unsigned int> frame;	//!< Current frame, for every cache.
+
+		void load(Texture &texture);
+		const unsigned int *pageIn(Texture &texture, size_t page);
+		void release(Texture &texture);
+		void makeRoom();
+		bool evict(const PageRef &ref);
+};
+
+/**
+ * @struct	Texture
+ * @brief	An image prepared for sampling. Texels are stored as RGBA8, and a chain of
+ * 			mip levels, each half the size of the one before, is built when the
+ * 			texture is loaded. Each level is stored in 4x4 tiles, in Morton order
+ * 			within a tile, so the texels a bilinear sample reads are usually in the
+ * 			same cache line. Tiles are grouped into pages. Row 0 is the first row of
+ * 			the image file, as in Image. A texture whose image cannot be loaded has
+ * 			no levels, and samples black.
+ *
+ * 			Textures built directly keep all of their pages in memory. Textures
+ * 			obtained from a TextureCache are loaded lazily, and their pages come and
+ * 			go within the cache's budget.
+ */
+
+struct Texture {
+	TextureWrap wrap;		//!< How coordinates outside [0, 1] are treated. Default CLAMP.
+	TextureFilter filter;	//!< How samples are filtered. Default TRILINEAR.
+	Texture(const std::string &fileName);
+	Texture(const Image &image);
+	~Texture();
+	int getWidth(int level = 0) const;
+	int getHeight(int level = 0) const;
+	int getNumLevels() const;
+	size_t getMemorySize() const;
+	color getTexel(int level, int x, int y) const;
+	color sample(real u, real v, real footprint = 0) const;
+protected:
+	friend class TextureCache;
+
+	/**
+	 * @struct	MipLevel
+	 * @brief	Size and position of one mip level within pages.
+	 */
+	struct MipLevel {
+		int W, H;				//!< Size in texels.
+		int pagesAcross;		//!< Number of pages in each row of pages.
+		size_t firstPage;		//!< Index of the level's first page.
+	};
+
+	/**
+	 * @struct	Page
+	 * @brief	A 32x32 block of texels of one level.
+	 */
+	struct Page {
+		std::atomic<unsigned int *> texels;		//!< The texels, or nullptr if evicted.
+		std::atomic<unsigned int> lastUsed;		//!< Frame in which the page was last read.
+		bool onDisk;							//!< True ==> a copy is in the cache's page file.
+	};
+
+	std::string fileName;				//!< File to load from, for textures in a cache.
+	TextureCache *cache;				//!< Cache managing the texture. nullptr ==> not managed.
+	std::atomic<bool> loaded;			//!< True ==> levels and pages are set up.
+	std::vector<MipLevel> levels;		//!< The mip chain. Level 0 is the full size image.
+	std::unique_ptr<Page[]> pages;		//!< Every level's pages.
+	size_t numPages;					//!< Number of pages.
+	FILE *pageFile;						//!< Copies of evicted pages, page i at offset i * TEXTURE_PAGE_BYTES.
+
+	Texture(const std::string &fileName, TextureCache *cache);
+	void build(const Image &image);
+	void ensureLoaded() const {
+		if (!loaded.load(std::memory_order_acquire)) {
+			cache->load(const_cast<Texture &>(*this));
+		}
+	}
+	const unsigned int *getPage(size_t page) const {
+		Page &P = pages[page];
+		if (cache == nullptr) {
+			return P.texels.load(std::memory_order_relaxed);
+		}
+		// Marking the page used before reading the pointer, both sequentially
+		// consistent, guarantees that evict() either sees the mark or has
+		// already cleared the pointer.
+		unsigned int frame = TextureCache::getFrame();
+		if (P.lastUsed.load(std::memory_order_relaxed) != frame) {
+			P.lastUsed.store(frame);
+		}
+		const unsigned int *texels = P.texels.load();
+		return texels != nullptr ? texels : cache->pageIn(const_cast<Texture &>(*this), page);
+	}
+	static int texelIndex(unsigned int x, unsigned int y) {
+		unsigned int tile = ((y % TEXTURE_PAGE_SIZE) / TEXTURE_TILE_SIZE) * (TEXTURE_PAGE_SIZE / TEXTURE_TILE_SIZE) +
+							(x % TEXTURE_PAGE_SIZE) / TEXTURE_TILE_SIZE;
+		return tile * TEXTURE_TILE_SIZE * TEXTURE_TILE_SIZE +
+				((x & 1) | ((y & 1) << 1) | ((x & 2) << 1) | ((y & 2) << 2));
+	}
+	unsigned int fetch(const MipLevel &level, int x, int y) const {
+		size_t page = level.firstPage + (y / TEXTURE_PAGE_SIZE) * level.pagesAcross + x / TEXTURE_PAGE_SIZE;
+		return getPage(page)[texelIndex(x, y)];
+	}
+	void store(const MipLevel &level, int x, int y, unsigned int texel);
+	color sampleNearest(const MipLevel &level, real u, real v) const;
+	color sampleBilinear(const MipLevel &level, real u, real v) const;
+	int wrapCoord(int i, int n) const;
+};
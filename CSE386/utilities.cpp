@@ -11,6 +11,8 @@
 #include <istream>
 #include <iomanip>
 #include <cstdlib>
+#include <atomic>
+#include <thread>
 
 #include "defs.h"
 #include "framebuffer.h"
@@ -18,21 +20,21 @@
 #include "ishape.h"
 
 /**
- * @fn	void swap(double &a, double &b)
+ * @fn	void swap(real &a, real &b)
  * @brief	Swaps that values of two doubleing point numbers, without
  * 			using std.
- * @param [in,out]	a	First double.
- * @param [in,out]	b	Second double.
+ * @param [in,out]	a	First real.
+ * @param [in,out]	b	Second real.
  */
 
-void swap(double &a, double &b) {
-	double tmp = a;
+void swap(real &a, real &b) {
+	real tmp = a;
 	a = b;
 	b = tmp;
 }
 
 /**
- * @fn	bool approximatelyEqual(double a, double b)
+ * @fn	bool approximatelyEqual(real a, real b)
  * @brief	Determines if two values are approximately equal.
  * 			That is, their values within EPSILON of each other.
  * Programming constaint: Use EPSILON defined in defs.h
@@ -41,13 +43,13 @@ void swap(double &a, double &b) {
  * @return	true iff (a-b) is in [-EPSILON, EPSILON].
  */
 
-bool approximatelyEqual(double a, double b) {
-	double diff = glm::abs(a - b);
+bool approximatelyEqual(real a, real b) {
+	real diff = glm::abs(a - b);
 	return diff <= EPSILON;
 }
 
 /**
- * @fn	bool approximatelyZero(double a)
+ * @fn	bool approximatelyZero(real a)
  * @brief	Determines if a value is approximately zero.
  * 			That is, the value is within EPSILON of zero.
  * Programming constaint: Use EPSILON defined in defs.h
@@ -55,12 +57,12 @@ bool approximatelyEqual(double a, double b) {
  * @return	true iff a is in [-EPSILON, EPSILON].
  */
 
-bool approximatelyZero(double a) {
+bool approximatelyZero(real a) {
 	return a >= -EPSILON && a <= EPSILON;
 }
 
 /**
- * @fn	double normalizeDegrees(double degrees)
+ * @fn	real normalizeDegrees(real degrees)
  * @brief	Converts an arbitrary number of degrees to an equivalent
  * 			number of degrees in the range [0, 360). Loops should NOT
  *          be used in this function. Recursion should also not be used.
@@ -73,7 +75,7 @@ bool approximatelyZero(double a) {
  * @test	normalizeDegrees(-721) --> 359
  */
 
-double normalizeDegrees(double degrees) {
+real normalizeDegrees(real degrees) {
 	//use std::fmod for mod instead of %
 	//do seperate checks for negative and positive
 	if (degrees >= 0 || std::fmod(degrees, 360) == 0)
@@ -89,7 +91,7 @@ double normalizeDegrees(double degrees) {
 }
 
 /**
- * @fn	double normalizeRadians(double rads)
+ * @fn	real normalizeRadians(real rads)
  * @brief	Converts an arbitrary number of radians to an equivalent
  * 			number of radians in the range [0, 2*PI). Loops should NOT
  *          be used in this function.
@@ -102,7 +104,7 @@ double normalizeDegrees(double degrees) {
  * @test	normalizeRadians(-31*PI) --> PI
  */
 
-double normalizeRadians(double rads) {
+real normalizeRadians(real rads) {
 	/*converts rad to deg*/
 	/*normalizes deg*/
 	/*converts deg to rad*/
@@ -110,7 +112,7 @@ double normalizeRadians(double rads) {
 }
 
 /**
- * @fn	double rad2deg(double rads)
+ * @fn	real rad2deg(real rads)
  * @brief	Converts radians to degrees.  This function behaves like glm::degrees,
  * without using glm::degrees.
  * Programming constaint: Do not glm::degrees.
@@ -118,12 +120,12 @@ double normalizeRadians(double rads) {
  * @return	Degrees.
  */
 
-double rad2deg(double rads) {
+real rad2deg(real rads) {
 	return rads * (180/PI);
 }
 
 /**
- * @fn	double deg2rad(double degs)
+ * @fn	real deg2rad(real degs)
  * @brief	Converts degrees to radians. This function behaves like glm::radians,
  * without using glm::radians.
  * Programming constaint: Do not use glm::radians.
@@ -131,12 +133,12 @@ double rad2deg(double rads) {
  * @return	Radians.
  */
 
-double deg2rad(double degs) {
+real deg2rad(real degs) {
 	return degs * (PI/180);
 }
 
 /**
-* @fn	double min(double A, double B, double C)
+* @fn	real min(real A, real B, real C)
 * @brief	Determines the minimum of three values, using std::fmin.
 * Programming constaint: Use std::fmin
 * @param	A	First value.
@@ -145,12 +147,12 @@ double deg2rad(double degs) {
 * @return	The minimum value.
 */
 
-double min(double A, double B, double C) {
+real min(real A, real B, real C) {
 	return std::fmin(std::fmin(A,B),C);
 }
 
 /**
-* @fn	double max(double A, double B, double C)
+* @fn	real max(real A, real B, real C)
 * @brief	Determines the maximum of three values, using std::fmax.
 * Programming constaint: Use std::fmax
 * @param	A	First value.
@@ -159,12 +161,12 @@ double min(double A, double B, double C) {
 * @return	The maximum value.
 */
 
-double max(double A, double B, double C) {
+real max(real A, real B, real C) {
 	return std::fmax(std::fmax(A, B), C);
 }
 
 /**
-* @fn	distanceFromOrigin(double x, double y)
+* @fn	distanceFromOrigin(real x, real y)
 * @brief	Determines the distance of the point (x, y) to (0, 0).
 * The distance is defined by sqrt(x^2 + y^2). Note: ^ is not how
 * C++ does exponentiation; you can use std::pow instead.
@@ -177,12 +179,12 @@ double max(double A, double B, double C) {
 * @test	distanceFromOrigin(-10, 30) --> 31.62277660168379256334
 */
 
-double distanceFromOrigin(double x, double y) {
+real distanceFromOrigin(real x, real y) {
 	return std::sqrt(std::pow(x, 2) + std::pow(y, 2));
 }
 
 /**
-* @fn	distanceBetween(double x1, double y1, double x2, double y2)
+* @fn	distanceBetween(real x1, real y1, real x2, real y2)
 * @brief	Determines the distance of the point (x1, y1) to (x2, y2)
 * The distance is defined by sqrt((x1-x2)^2 + (y1-y2)^2). Note: ^ is not how
 * C++ does exponentiation; you can use std::pow instead.
@@ -198,12 +200,12 @@ double distanceFromOrigin(double x, double y) {
 * @test	distanceBetween(54, 1, -34, -99) --> 133.2066064427737
 */
 
-double distanceBetween(double x1, double y1, double x2, double y2) {
+real distanceBetween(real x1, real y1, real x2, real y2) {
 	return std::sqrt(std::pow(x1-x2, 2) + std::pow(y1-y2, 2));
 }
 
 /**
- * @fn	double areaOfTriangle(double a, double b, double c)
+ * @fn	real areaOfTriangle(real a, real b, real c)
  * @brief	Computes the area of triangle using Heron's formula. 
  * @param	a length of first side.
  * @param	b length of second side.
@@ -215,9 +217,9 @@ double distanceBetween(double x1, double y1, double x2, double y2) {
  * @test	areaOfTriangle(3, 4, 50) --> -1
  */
 
-double areaOfTriangle(double a, double b, double c) {
-	double s = (a + b + c) / 2;
-	double answer = std::sqrt(s * (s - a) * (s - b) * (s - c));
+real areaOfTriangle(real a, real b, real c) {
+	real s = (a + b + c) / 2;
+	real answer = std::sqrt(s * (s - a) * (s - b) * (s - c));
 
 	if (glm::isinf(answer) || glm::isnan(answer) || answer <= 0)
 	{
@@ -228,7 +230,7 @@ double areaOfTriangle(double a, double b, double c) {
 }
 
 /**
- * @fn	double areaOfTriangle(double x1, double y1, double x2, double y2, double x3, double y3)
+ * @fn	real areaOfTriangle(real x1, real y1, real x2, real y2, real x3, real y3)
  * @brief	Computes the area of triangle formed by the three vertices (x1, y1), (x2, y2), and
  * (x3, y3). You can assume all vertices are distinct.
  * @param	x1 the x value of the first vertice
@@ -241,29 +243,29 @@ double areaOfTriangle(double a, double b, double c) {
  * @test	areaOfTriangle(0, 0, 3, 0, 0, 4) --> 6
  */
 
-double areaOfTriangle(double x1, double y1, double x2, double y2, double x3, double y3) {
-	double a = distanceBetween(x1, y1, x2, y2);
-	double b = distanceBetween(x2, y2, x3, y3);
-	double c = distanceBetween(x3, y3, x1, y1);
+real areaOfTriangle(real x1, real y1, real x2, real y2, real x3, real y3) {
+	real a = distanceBetween(x1, y1, x2, y2);
+	real b = distanceBetween(x2, y2, x3, y3);
+	real c = distanceBetween(x3, y3, x1, y1);
 
 	return areaOfTriangle(a, b, c);
 }
 /**
- * @fn	void pointOnUnitCircle(double angleRads, double &x, double &y)
+ * @fn	void pointOnUnitCircle(real angleRads, real &x, real &y)
  * @brief	Determines the (x,y) position of a point on the standard
  * 			unit circle.
  * @param 		  	angleRads	The angle in radians.
- * @param [in,out]	x		 	A double to process.
- * @param [in,out]	y		 	A double to process.
+ * @param [in,out]	x		 	A real to process.
+ * @param [in,out]	y		 	A real to process.
  */
 
-void pointOnUnitCircle(double angleRads, double &x, double &y) {
+void pointOnUnitCircle(real angleRads, real &x, real &y) {
 	x = glm::cos(angleRads);
 	y = glm::sin(angleRads);
 }
 
 /**
-* @fn	dvec2 pointOnCircle(const dvec2 &center, double R, double angleRads)
+* @fn	rvec2 pointOnCircle(const rvec2 &center, real R, real angleRads)
 * @brief	Computes the (x,y) value of a point on the circle centered on 'center',
 * 			having radius R. The point is determined by sweeping an arc 'angleRads'.
 * @param	center   	The center of the circle
@@ -272,28 +274,28 @@ void pointOnUnitCircle(double angleRads, double &x, double &y) {
 * @return	The point on the circle.
 */
 
-dvec2 pointOnCircle(const dvec2 &center, double R, double angleRads) {
-	dvec2 answer = dvec2(R * glm::cos(angleRads), R * glm::sin(angleRads));
+rvec2 pointOnCircle(const rvec2 &center, real R, real angleRads) {
+	rvec2 answer = rvec2(R * glm::cos(angleRads), R * glm::sin(angleRads));
 
 	return answer + center;
 }
 
 /**
-* @fn	double directionInRadians(const dvec2 &referencePt, const dvec2 &targetPt)
+* @fn	real directionInRadians(const rvec2 &referencePt, const rvec2 &targetPt)
 * @brief	Compute the direction/heading of 'targetPt', relative
 * 			to referencePt. The return angle should be [0, 2PI)
 * @param	referencePt	Reference point.
 * @param	targetPt	Target point point.
-* @return	A double.
+* @return	A real.
 * @test	directionInRadians((0,0), (2,2)) --> 0.7853981634
 * @test	directionInRadians((2,10), (3,11)) --> 0.7853981634
 * @test	directionInRadians((2,2), (2,0)) --> 4.7123889804
 */
 
-double directionInRadians(const dvec2 &referencePt, const dvec2 &targetPt) {
-	double x = targetPt.x - referencePt.x;
-	double y = targetPt.y - referencePt.y;
-	double answer = glm::atan(y,x);
+real directionInRadians(const rvec2 &referencePt, const rvec2 &targetPt) {
+	real x = targetPt.x - referencePt.x;
+	real y = targetPt.y - referencePt.y;
+	real answer = glm::atan(y,x);
 
 	if (answer < 0)
 	{
@@ -304,48 +306,48 @@ double directionInRadians(const dvec2 &referencePt, const dvec2 &targetPt) {
 }
 
 /**
-* @fn	double directionInRadians(const dvec2 &targetPt)
+* @fn	real directionInRadians(const rvec2 &targetPt)
 * @brief	Compute the direction/heading of 'targetPt', relative
 * 			to the origin. The return angle should be [0, 2PI)
 * @param	targetPt	Target point point.
-* @return	A double.
+* @return	A real.
 * @test	directionInRadians((2,2)) --> 0.7853981634
 * @test	directionInRadians((0,-2)) --> 4.7123889804
 */
-double directionInRadians(const dvec2 &targetPt) {
-	return directionInRadians(dvec2(0,0), targetPt);
+real directionInRadians(const rvec2 &targetPt) {
+	return directionInRadians(rvec2(0,0), targetPt);
 }
 
 /**
-* @fn	double directionInRadians(double x1, double y1, double x2, double y2)
+* @fn	real directionInRadians(real x1, real y1, real x2, real y2)
 * @brief	Compute the direction/heading of (x2, y2), relative
 * 			to (x1, y1). The return angle should be [0, 2PI)
 * @param	x1  x coordinate of the reference point.
 * @param	y1	y coordinate of the reference point.
 * @param    x2    x coordinate of the target point.
 * @param    y2    y coordinate of the target point.
-* @return	A double.
+* @return	A real.
 * @test	directionInRadians(0,0,2,2) --> 0.7853981634
 * @test	directionInRadians(2,10,3,11) --> 0.7853981634
 * @test	directionInRadians(2,2,2,0) --> 4.7123889804
 */
-double directionInRadians(double x1, double y1, double x2, double y2) {
-	return directionInRadians(dvec2(x1, y1), dvec2(x2, y2));
+real directionInRadians(real x1, real y1, real x2, real y2) {
+	return directionInRadians(rvec2(x1, y1), rvec2(x2, y2));
 }
 
 /**
-* @fn	dvec2 doubleIt(const dvec2 &V)
+* @fn	rvec2 doubleIt(const rvec2 &V)
 * @brief	Computes 2*V
 * @param	V	The vector.
 * @return	2*V.
 */
 
-dvec2 doubleIt(const dvec2& V) {
-	return dvec2(2*V.x, 2*V.y);
+rvec2 doubleIt(const rvec2& V) {
+	return rvec2(2*V.x, 2*V.y);
 }
 
 /**
-* @fn	dvec3 myNormalize(const dvec3 &V)
+* @fn	rvec3 myNormalize(const rvec3 &V)
 * @brief	Computes the normalization of V, without calling glm::normalize.
 *           The input vector is not be the zero vector.
 * Programming constaint: Do NOT use glm::normalize
@@ -353,14 +355,14 @@ dvec2 doubleIt(const dvec2& V) {
 * @return	Normalized vector V.
 */
 
-dvec3 myNormalize(const dvec3 &V) {
-	//double magnitude = std::sqrt(std::pow(V.x, 2) + std::pow(V.y, 2) + std::pow(V.z, 2));
-	double mag = glm::length(V);
-	return dvec3(V.x/mag, V.y / mag, V.z / mag);
+rvec3 myNormalize(const rvec3 &V) {
+	//real magnitude = std::sqrt(std::pow(V.x, 2) + std::pow(V.y, 2) + std::pow(V.z, 2));
+	real mag = glm::length(V);
+	return rvec3(V.x/mag, V.y / mag, V.z / mag);
 }
 
 /**
-* @fn	bool isOrthogonal(const dvec3 &a, const dvec3 &b)
+* @fn	bool isOrthogonal(const rvec3 &a, const rvec3 &b)
 * @brief	Determines if two vectors are orthogonal, or nearly orthogonal.
 Two vectors are nearly orthogonal if the cosine of the angle formed by these
 two vectors is approximatelyZero().
@@ -369,13 +371,13 @@ two vectors is approximatelyZero().
 * @return	True iff the two vector are orthogonal.
 */
 
-bool isOrthogonal(const dvec3 &a, const dvec3 &b) {
-	double cosOfA = (glm::dot(a, b) / (glm::length(a) * glm::length(b)));
+bool isOrthogonal(const rvec3 &a, const rvec3 &b) {
+	real cosOfA = (glm::dot(a, b) / (glm::length(a) * glm::length(b)));
 	return approximatelyZero(cosOfA);
 }
 
 /**
-* @fn	bool formAcuteAngle(const dvec3 &a, const dvec3 &b)
+* @fn	bool formAcuteAngle(const rvec3 &a, const rvec3 &b)
 * @brief	Determines if two vectors form an angle that is < 90 degrees
 * Programming constaint: Do NOT use acos, atan, or asin (you CAN use dot, cos, etc)
 * @param	a	The first vector.
@@ -383,48 +385,48 @@ bool isOrthogonal(const dvec3 &a, const dvec3 &b) {
 * @return	True iff the two vectors form an acute angle.
 */
 
-bool formAcuteAngle(const dvec3& a, const dvec3& b) {
+bool formAcuteAngle(const rvec3& a, const rvec3& b) {
 	return cosBetween(a, b) > 0;
 }
 
 /**
- * @fn	double cosBetween(const dvec2 &v1, const dvec2 &v2)
+ * @fn	real cosBetween(const rvec2 &v1, const rvec2 &v2)
  * @brief	Cosine between v1 and v2. 
  * @param	v1	The first vector.
  * @param	v2	The second vector.
  * @return	The cosine between v1 and v2.
  */
 
-double cosBetween(const dvec2 &v1, const dvec2 &v2) {
+real cosBetween(const rvec2 &v1, const rvec2 &v2) {
 	return (glm::dot(v1, v2) / (glm::length(v1) * glm::length(v2)));
 }
 
 /**
- * @fn	double cosBetween(const dvec3 &v1, const dvec3 &v2)
+ * @fn	real cosBetween(const rvec3 &v1, const rvec3 &v2)
  * @brief	Computes the cosine between v1 and v2.
  * @param	v1	The first vector.
  * @param	v2	The second vector.
- * @return	A double.
+ * @return	A real.
  */
 
-double cosBetween(const dvec3 &v1, const dvec3 &v2) {
+real cosBetween(const rvec3 &v1, const rvec3 &v2) {
 	return (glm::dot(v1, v2) / (glm::length(v1) * glm::length(v2)));
 }
 
 /**
- * @fn	double cosBetween(const dvec4 &v1, const dvec4 &v2)
+ * @fn	real cosBetween(const rvec4 &v1, const rvec4 &v2)
  * @brief	Computes the cosine between v1 and v2.
  * @param	v1	The first vector.
  * @param	v2	The second vector.
- * @return	A double.
+ * @return	A real.
  */
 
-double cosBetween(const dvec4& v1, const dvec4& v2) {
+real cosBetween(const rvec4& v1, const rvec4& v2) {
 	return (glm::dot(v1, v2) / (glm::length(v1) * glm::length(v2)));
 }
 
 /**
- * @fn	double areaOfParallelogram(const dvec3 &v1, const dvec3 &v2)
+ * @fn	real areaOfParallelogram(const rvec3 &v1, const rvec3 &v2)
  * @brief	Computes the area of parallelogram, given two vectors eminating
  * 			from the same corner of the parallelogram.
  * @param	v1	The first vector.
@@ -432,12 +434,12 @@ double cosBetween(const dvec4& v1, const dvec4& v2) {
  * @return	Area of parallelogram.
  */
 
-double areaOfParallelogram(const dvec3& v1, const dvec3& v2) {
+real areaOfParallelogram(const rvec3& v1, const rvec3& v2) {
 	return glm::length(glm::cross(v1, v2));
 }
 
 /**
- * @fn	double areaOfTriangle(const dvec3 &pt1, const dvec3 &pt2, const dvec3 &pt3)
+ * @fn	real areaOfTriangle(const rvec3 &pt1, const rvec3 &pt2, const rvec3 &pt3)
  * @brief	Computes the area of triangle.
  * Programming constraint: use areaOfParalellogram to solve this one.
  * @param	pt1	The first point.
@@ -446,24 +448,24 @@ double areaOfParallelogram(const dvec3& v1, const dvec3& v2) {
  * @return	Area of triangle.
  */
 
-double areaOfTriangle(const dvec3& pt1, const dvec3& pt2, const dvec3& pt3) {
+real areaOfTriangle(const rvec3& pt1, const rvec3& pt2, const rvec3& pt3) {
 	return 0.5 * areaOfParallelogram(pt3-pt1, pt2-pt1);
 }
 
 /**
-* @fn	dvec3 pointingVector(const dvec3 &pt1, const dvec3 &pt2)
+* @fn	rvec3 pointingVector(const rvec3 &pt1, const rvec3 &pt2)
 * @brief	Computes unit-length pointing vector.
 * @param	pt1	The first point.
 * @param	pt2	The second point.
 * @return	Unit length vector that points from pt1 to pt2.
 */
 
-dvec3 pointingVector(const dvec3& pt1, const dvec3& pt2) {
+rvec3 pointingVector(const rvec3& pt1, const rvec3& pt2) {
 	return myNormalize(pt2 - pt1);
 }
 
 /**
- * @fn	double map(double x, double xLow, double xHigh, double yLow, double yHigh)
+ * @fn	real map(real x, real xLow, real xHigh, real yLow, real yHigh)
  * @brief	Linearlly map a value from one interval to another.
  * @param 		  	x	 	x value.
  * @param 		  	xLow 	The low value of the x range.
@@ -473,13 +475,13 @@ dvec3 pointingVector(const dvec3& pt1, const dvec3& pt2) {
  * @test	map(2, 0, 5, 10, 11) --> 10.4
  */
 
-double map(double x, double xLow, double xHigh, double yLow, double yHigh) {
+real map(real x, real xLow, real xHigh, real yLow, real yHigh) {
 
 	return ((x-xLow)/(xHigh-xLow))*(yHigh-yLow)+yLow;
 }
 
 /**
- * @fn	vector<double> quadratic(double A, double B, double C)
+ * @fn	vector<real> quadratic(real A, real B, real C)
  * @brief	Solves the quadratic equation, given A, B, and C.
  * 			0, 1, or 2 roots are inserted into the vector and returned.
  * 			The roots are placed into the vector sorted in ascending order.
@@ -494,46 +496,20 @@ double map(double x, double xLow, double xHigh, double yLow, double yHigh) {
  * @test	quadratic(-4, -2, -1) --> []
  */
 
-vector<double> quadratic(double A, double B, double C) {
-	
-
-	vector<double> result;
-
-	double determinant = std::pow(B, 2) - 4 * A * C;
-
-	if (approximatelyZero(determinant))
-	{
-		result.push_back(-B/(2*A));
-	}
-	else if (determinant > 0)
-	{
-		double root1 = (-B - std::sqrt(determinant)) / (2 * A);
-		double root2 = (-B + std::sqrt(determinant)) / (2 * A);
-
-		if (root1 < root2)
-		{
-			result.push_back(root1);
-			result.push_back(root2);
-		}
-		else
-		{
-			result.push_back(root2);
-			result.push_back(root1);
-		}
-		
-	}
-
-	return result;
+vector<real> quadratic(real A, real B, real C) {
+	real roots[2];
+	int rootCnt = quadratic(A, B, C, roots);
+	return vector<real>(roots, roots + rootCnt);
 }
 
 /**
- * @fn	int quadratic(double A, double B, double C, double roots[2])
+ * @fn	int quadratic(real A, real B, real C, real roots[2])
  * @brief	Solves the quadratic equation, given A, B, and C.
  * 			0, 1, or 2 roots are inserted into the array 'roots'.
  * 			The roots are sorted in ascending order.
  * Here is an example of how this is to be used:
  * 
- * 	double roots[2];
+ * 	real roots[2];
  *	int numRoots = quadratic(1, 2, -3, roots);
  *	if (numRoots == 0) {
  *		cout << "There are no real roots" << endl;
@@ -558,28 +534,37 @@ vector<double> quadratic(double A, double B, double C) {
  * @return	The number of real roots put into the array 'roots'
 */
 
-int quadratic(double A, double B, double C, double roots[2]) {
-	vector<double> result = quadratic(A, B, C);
+int quadratic(real A, real B, real C, real roots[2]) {
+	real determinant = std::pow(B, 2) - 4 * A * C;
 
-	int rootCnt = result.size();
-	for(int i = 0; i < rootCnt; i++)
+	if (approximatelyZero(determinant))
 	{
-		roots[i] = result[i];
+		roots[0] = -B / (2 * A);
+		return 1;
 	}
+	else if (determinant > 0)
+	{
+		real root1 = (-B - std::sqrt(determinant)) / (2 * A);
+		real root2 = (-B + std::sqrt(determinant)) / (2 * A);
 
-	return rootCnt;
+		roots[0] = glm::min(root1, root2);
+		roots[1] = glm::max(root1, root2);
+		return 2;
+	}
+
+	return 0;
 }
 
 /**
-* @fn	dvec3 getRow(const dmat3 &mat, int row)
+* @fn	rvec3 getRow(const rmat3 &mat, int row)
 * @brief	Retrieves a particular row out of a matrix.
 * @param	mat	The matrix.
 * @param	row	The row.
 * @return	The extracted row.
 */
 
-dvec3 getRow(const dmat3 &mat, int row) {
-	dvec3 rowVec;
+rvec3 getRow(const rmat3 &mat, int row) {
+	rvec3 rowVec;
 
 	for (int i = 0; i < mat.length(); i ++)
 	{
@@ -590,31 +575,31 @@ dvec3 getRow(const dmat3 &mat, int row) {
 }
 
 /**
- * @fn	dvec3 getCol(const dmat3 &mat, int col)
+ * @fn	rvec3 getCol(const rmat3 &mat, int col)
  * @brief	Retrieves a particular column out of a matrix.
  * @param	mat	The matrix.
  * @param	col	The column.
  * @return	The extracted column.
  */
 
-dvec3 getCol(const dmat3 &mat, int col) {
+rvec3 getCol(const rmat3 &mat, int col) {
 	return mat[col];
 }
 
 /**
- * @fn	bool isInvertible(const dmat3 &mat)
+ * @fn	bool isInvertible(const rmat3 &mat)
  * @brief	Determines if mat is invertible. A matrix is invertible if
  *			its determinant is not 0.
  * @param	mat	The matrix.
  * @return	true if invertible, false if not.
  */
 
-bool isInvertible(const dmat3 &mat) {
+bool isInvertible(const rmat3 &mat) {
 	return glm::determinant(mat) != 0;
 }
 
 /**
- * @fn	dvec3 solveLinearSystem(const dmat3 &M, const dvec3 &y)
+ * @fn	rvec3 solveLinearSystem(const rmat3 &M, const rvec3 &y)
  * @brief	Solves a linear system using x = inv(M)*y, when M is invertible. When M is singular
  *			return <0,0,0>
  * @param	M	The matrix.
@@ -622,20 +607,20 @@ bool isInvertible(const dmat3 &mat) {
  * @return	x, such that M*x = y. Returns <0,0,0> if no solution exists (i.e., M is not invertible).
  */
 
-dvec3 solveLinearSystem(const dmat3 &M, const dvec3 &y) {
+rvec3 solveLinearSystem(const rmat3 &M, const rvec3 &y) {
 	/* CSE 386 - todo  */
-	return dvec3(0, 0, 0);
+	return rvec3(0, 0, 0);
 }
 
 /**
- * @fn	dmat3 addMatrices(const vector<dmat3> &M)
+ * @fn	rmat3 addMatrices(const vector<rmat3> &M)
  * @brief	Adds the several matrices together. Assume the vector has length > 0.
  * @param	M	Vector of matrices.
  * @return	M[0]+M[1]+...+M[m-1]
  */
 
-dmat3 addMatrices(const vector<dmat3> &M) {
-	dmat3 zeroMat(0, 0, 0, 0, 0, 0, 0, 0, 0);
+rmat3 addMatrices(const vector<rmat3> &M) {
+	rmat3 zeroMat(0, 0, 0, 0, 0, 0, 0, 0, 0);
 	for (int i = 0; i < M.size(); i++) 
 	{
 		zeroMat += M[i];
@@ -645,14 +630,14 @@ dmat3 addMatrices(const vector<dmat3> &M) {
 }
 
 /**
- * @fn	dmat3 multiplyMatrices(const vector<dmat3> &M)
+ * @fn	rmat3 multiplyMatrices(const vector<rmat3> &M)
  * @brief	Multiply many matrices together. Assume the vector has length > 0.
  * @param	M	The vector of matrices.
  * @return	Returns M[0]*M[1]*...M[m-1].
  */
 
-dmat3 multiplyMatrices(const vector<dmat3> &M) {
-	dmat3 product;
+rmat3 multiplyMatrices(const vector<rmat3> &M) {
+	rmat3 product;
 	for (int i = 0; i < M.size(); i++) 
 	{
 		product *= M[i];
@@ -662,39 +647,39 @@ dmat3 multiplyMatrices(const vector<dmat3> &M) {
 }
 
 /**
- * @fn	dvec3 multiplyMatrixAndVertex(const dmat3 &M, const dvec3 &x)
+ * @fn	rvec3 multiplyMatrixAndVertex(const rmat3 &M, const rvec3 &x)
  * @brief	Multiply matrix and vertex
  * @param	M	A matrix.
  * @param	x	A vector.
  * @return	Returns M*x.
  */
 
-dvec3 multiplyMatrixAndVertex(const dmat3 &M, const dvec3 &x) {
+rvec3 multiplyMatrixAndVertex(const rmat3 &M, const rvec3 &x) {
 	return M*x;
 }
 
 /**
- * @fn	dvec3 multiplyMatricesAndVertex(const vector<dmat3> &M, const dvec3 &x)
+ * @fn	rvec3 multiplyMatricesAndVertex(const vector<rmat3> &M, const rvec3 &x)
  * @brief	Multiply matrices and vertex.
  * @param	M	A vector of matrices to process. Assume the vector has length > 0.
  * @param	x	The vertex to process.
  * @return	Returns the result of M[0]*M[1]*...M[n-1]*x
  */
 
-dvec3 multiplyMatricesAndVertex(const vector<dmat3> &M, const dvec3 &x) {
+rvec3 multiplyMatricesAndVertex(const vector<rmat3> &M, const rvec3 &x) {
 	return multiplyMatrices(M)*x;
 }
 
 /**
- * @fn	vector<dvec3> multiplyMatrixAndVertices(const dmat3 &M, const vector<dvec3> &verts)
+ * @fn	vector<rvec3> multiplyMatrixAndVertices(const rmat3 &M, const vector<rvec3> &verts)
  * @brief	Returns the vector containing: <M*verts[0], M*verts[1], ... M*verts[n-1]>
- * @param	M	 	A dmat3 to process.
+ * @param	M	 	A rmat3 to process.
  * @param	verts	The vertices.
  * @return	Returns the vector: <M*verts[0], M*verts[1], ... M*verts[n-1]>
  */
 
-vector<dvec3> multiplyMatrixAndVertices(const dmat3 &M, const vector<dvec3> &verts) {
-	vector<dvec3> result(verts.size());
+vector<rvec3> multiplyMatrixAndVertices(const rmat3 &M, const vector<rvec3> &verts) {
+	vector<rvec3> result(verts.size());
 	for (int i = 0; i < verts.size(); i++) 
 	{
 		result[i] = M * verts[i];
@@ -704,7 +689,7 @@ vector<dvec3> multiplyMatrixAndVertices(const dmat3 &M, const vector<dvec3> &ver
 }
 
 /**
- * @fn	vector<dvec3> multiplyMatricesAndVertices(const vector<dmat3> &M, const vector<dvec3> &verts)
+ * @fn	vector<rvec3> multiplyMatricesAndVertices(const vector<rmat3> &M, const vector<rvec3> &verts)
  * @brief	Multiply matrices and vertices
  * @param	M	 	Vector of matrices. Assume the vector has length > 0.
  * @param	verts	Vector of vertices.
@@ -712,8 +697,8 @@ vector<dvec3> multiplyMatrixAndVertices(const dmat3 &M, const vector<dvec3> &ver
  *		<M[0]*M[1]*...M[m-1]*verts[0], M[0]*M[1]*...M[m-1]*verts[1], ... M[0]*M[1]*...M[m-1]*verts[n-1]>
  */
 
-vector<dvec3> multiplyMatricesAndVertices(const vector<dmat3> &M, const vector<dvec3> &verts) {
-	vector<dvec3> result(verts.size());
+vector<rvec3> multiplyMatricesAndVertices(const vector<rmat3> &M, const vector<rvec3> &verts) {
+	vector<rvec3> result(verts.size());
 	for (int i = 0; i < verts.size(); i++)
 	{
 		result[i] = multiplyMatrices(M) * verts[i];
@@ -723,65 +708,65 @@ vector<dvec3> multiplyMatricesAndVertices(const vector<dmat3> &M, const vector<d
 }
 
 /**
-* @fn	dmat3 T(double dx, double dy)
+* @fn	rmat3 T(real dx, real dy)
 * @brief	Creates the 3x3 translation matrix for 2D systems.
 * @param	dx	x translation factor.
 * @param	dy	y translation factor.
 * @return	The scaling matrix.
 */
 
-dmat3 T(double dx, double dy) {
-	return dmat3(1, 0, 0, 0, 1, 0, dx, dy, 1);
+rmat3 T(real dx, real dy) {
+	return rmat3(1, 0, 0, 0, 1, 0, dx, dy, 1);
 }
 
 /**
- * @fn	dmat3 S(double sx, double sy)
+ * @fn	rmat3 S(real sx, real sy)
  * @brief	Creates the 3x3 scaling matrix for 2D systems.
  * @param	sx	x scale factor.
  * @param	sy	y scale factor.
  * @return	The scaling matrix.
  */
 
-dmat3 S(double sx, double sy) {
-	return dmat3(sx, 0, 0, 0, sy, 0, 0, 0, 1);
+rmat3 S(real sx, real sy) {
+	return rmat3(sx, 0, 0, 0, sy, 0, 0, 0, 1);
 }
 
 /**
- * @fn	dmat3 R(double deg)
+ * @fn	rmat3 R(real deg)
  * @brief	Returns 3x3 rotation matrix for 2D rotations.
  * @param	deg	Degrees to rotate.
  * @return	The rotation matrix.
  */
 
-dmat3 R(double deg) {
-	double rads = glm::radians(deg);
-	return dmat3(cos(rads), sin(rads), 0, -sin(rads), cos(rads), 0, 0, 0, 1);
+rmat3 R(real deg) {
+	real rads = glm::radians(deg);
+	return rmat3(cos(rads), sin(rads), 0, -sin(rads), cos(rads), 0, 0, 0, 1);
 }
 
 /**
- * @fn	dmat3 horzShear(double a)
+ * @fn	rmat3 horzShear(real a)
  * @brief	Horizontal shear.
  * @param	a	Shearing parameter.
  * @return	The 3x3 shearing matrix.
  */
 
-dmat3 horzShear(double a) {
-	return dmat3(1, 0, 0, a, 1, 0, 0, 0, 1);
+rmat3 horzShear(real a) {
+	return rmat3(1, 0, 0, a, 1, 0, 0, 0, 1);
 }
 
 /**
- * @fn	dmat3 vertShear(double a)
+ * @fn	rmat3 vertShear(real a)
  * @brief	Vertical shear.
  * @param	a	Shearing parameter.
  * @return	The 3x3 shearing matrix.
  */
 
-dmat3 vertShear(double a) {
-	return dmat3(1, a, 0, 0, 1, 0, 0, 0, 1);
+rmat3 vertShear(real a) {
+	return rmat3(1, a, 0, 0, 1, 0, 0, 0, 1);
 }
 
 /**
-* @fn	dmat4 T(double dx, double dy, double dz)
+* @fn	rmat4 T(real dx, real dy, real dz)
 * @brief	Creates the 4x4 translation matrix for 3D systems.
 * @param	dx	The x translation factor.
 * @param	dy	The y translation factor.
@@ -789,12 +774,12 @@ dmat3 vertShear(double a) {
 * @return	The 4x4 translation matrix for 3D systems.
 */
 
-dmat4 T(double dx, double dy, double dz) {
-	return glm::translate(dvec3(dx, dy, dz));
+rmat4 T(real dx, real dy, real dz) {
+	return glm::translate(rvec3(dx, dy, dz));
 }
 
 /**
-* @fn	dmat4 S(double sx, double sy, double sz)
+* @fn	rmat4 S(real sx, real sy, real sz)
 * @brief	Creates the 4x4 scaling matrix for 3D systems.
 * @param	sx	The x scaling factor.
 * @param	sy	The y scaling factor.
@@ -802,76 +787,76 @@ dmat4 T(double dx, double dy, double dz) {
 * @return	The 4x4 scaling matrix for 3D systems.
 */
 
-dmat4 S(double sx, double sy, double sz) {
-	return glm::scale(dvec3(sx, sy, sz));
+rmat4 S(real sx, real sy, real sz) {
+	return glm::scale(rvec3(sx, sy, sz));
 }
 
 /**
-* @fn	dmat4 S(double scale)
+* @fn	rmat4 S(real scale)
 * @brief	Creates the 4x4 scaling matrix for 3D systems.
 * @param	scale	The scale.
 * @return	The 4x4 [uniform] scaling matrix for 3D systems.
 */
 
-dmat4 S(double scale) {
+rmat4 S(real scale) {
 	return S(scale, scale, scale);
 }
 
 /**
-* @fn	dmat3 Rx(double rads)
+* @fn	rmat3 Rx(real rads)
 * @brief	Creates the 4x4 rotation matrix for 3D systems.
 * @param	rads	Rotation amount, in radians.
 * @return	The 4x4 matrix for rotation about the +x axis.
 */
 
-dmat4 Rx(double rads) {
-	return glm::rotate(rads, dvec3(1.0, 0.0, 0.0));
+rmat4 Rx(real rads) {
+	return glm::rotate(rads, rvec3(1.0, 0.0, 0.0));
 }
 
 /**
-* @fn	dmat3 Ry(double rads)
+* @fn	rmat3 Ry(real rads)
 * @brief	Creates the 4x4 rotation matrix for 3D systems.
 * @param	rads	Rotation amount, in radians.
 * @return	The 4x4 matrix for rotation about the +y axis.
 */
 
-dmat4 Ry(double rads) {
-	return glm::rotate(rads, dvec3(0.0, 1.0, 0.0));
+rmat4 Ry(real rads) {
+	return glm::rotate(rads, rvec3(0.0, 1.0, 0.0));
 }
 
 /**
-* @fn	dmat3 Rz(double rads)
+* @fn	rmat3 Rz(real rads)
 * @brief	Creates the 4x4 rotation matrix for 3D systems.
 * @param	rads	Rotation amount, in radians.
 * @return	The 4x4 matrix for rotation about the +z axis.
 */
 
-dmat4 Rz(double rads) {
-	return glm::rotate(rads, dvec3(0.0, 0.0, 1.0));
+rmat4 Rz(real rads) {
+	return glm::rotate(rads, rvec3(0.0, 0.0, 1.0));
 }
 /**
-* @fn	void computeXYZFromAzimuthAndElevation(double R, double az, double el, 
-*												double &x, double &y, double &z)
+* @fn	void computeXYZFromAzimuthAndElevation(real R, real az, real el, 
+*												real &x, real &y, real &z)
 * @brief	Computes (x,y,z), given a specific azimuth/elevation angles.
 * @param 		  	R 	The radius of the sphere.
 * @param 		  	az	Azimuth
 * @param 		  	el	Elevation.
-* @param [in,out]	x 	A double to process.
-* @param [in,out]	y 	A double to process.
-* @param [in,out]	z 	A double to process.
+* @param [in,out]	x 	A real to process.
+* @param [in,out]	y 	A real to process.
+* @param [in,out]	z 	A real to process.
 */
 
-void computeXYZFromAzimuthAndElevation(double R,
-										double az, double el,
-										double &x, double &y, double &z) {
+void computeXYZFromAzimuthAndElevation(real R,
+										real az, real el,
+										real &x, real &y, real &z) {
 	z = R*std::cos(el)*std::cos(az);
 	x = R*std::cos(el)*std::sin(az);
 	y = R*std::sin(el);
 }
 
 /**
-* @fn	void computeAzimuthAndElevationFromXYZ(double x, double y, double z, 
-*												double &R, double &az, double &el)
+* @fn	void computeAzimuthAndElevationFromXYZ(real x, real y, real z, 
+*												real &R, real &az, real &el)
 * @brief	Calculates the azimuth and elevation from xyz
 * @param 		  	x 	The x coordinate.
 * @param 		  	y 	The y coordinate.
@@ -881,15 +866,15 @@ void computeXYZFromAzimuthAndElevation(double R,
 * @param [in,out]	el	Elevation.
 */
 
-void computeAzimuthAndElevationFromXYZ(double x, double y, double z,
-										double &R, double &az, double &el) {
-	R = glm::length(dvec3(x, y, z));
+void computeAzimuthAndElevationFromXYZ(real x, real y, real z,
+										real &R, real &az, real &el) {
+	R = glm::length(rvec3(x, y, z));
 	az = std::atan2(x, z);
-	el = std::atan2(y, glm::length(dvec2(x, z)));
+	el = std::atan2(y, glm::length(rvec2(x, z)));
 }
 
 /**
-* @fn	void computeAzimuthAndElevationFromXYZ(const dvec3 &pt, double &R, double &az, double &el)
+* @fn	void computeAzimuthAndElevationFromXYZ(const rvec3 &pt, real &R, real &az, real &el)
 * @brief	Compute the azimuth/elevation (relative to the origin) of the point (x,y,z)
 * @param 		  	pt	The point - (x,y,z).
 * @param [in,out]	R 	The radius of the sphere.
@@ -897,19 +882,19 @@ void computeAzimuthAndElevationFromXYZ(double x, double y, double z,
 * @param [in,out]	el	Elevation.
 */
 
-void computeAzimuthAndElevationFromXYZ(const dvec3 &pt,
-										double &R, double &az, double &el) {
+void computeAzimuthAndElevationFromXYZ(const rvec3 &pt,
+										real &R, real &az, real &el) {
 	computeAzimuthAndElevationFromXYZ(pt.x, pt.y, pt.z, R, az, el);
 }
-bool inRangeInclusive(double val, double lo, double hi) {
+bool inRangeInclusive(real val, real lo, real hi) {
 	return val >= lo && val <= hi;
 }
-bool inRangeExclusive(double val, double lo, double hi) {
+bool inRangeExclusive(real val, real lo, real hi) {
 	return val > lo && val < hi;
 }
 
 /**
-* @fn	bool inRectangle(double x, double y, double left, double bottom, double right, double top)
+* @fn	bool inRectangle(real x, real y, real left, real bottom, real right, real top)
 * @brief	Determines if (x,y) is inside (or on) a rectangle.
 * @param	x	  	The x coordinate.
 * @param	y	  	The y coordinate.
@@ -920,13 +905,13 @@ bool inRangeExclusive(double val, double lo, double hi) {
 * @return	true iff (x,y) is in/on the rectangle.
 */
 
-bool inRectangle(double x, double y, double left, double bottom, double right, double top) {
+bool inRectangle(real x, real y, real left, real bottom, real right, real top) {
 	return inRangeInclusive(x, left, right) &&
 		inRangeInclusive(y, bottom, top);
 }
 
 /**
-* @fn	bool inRectangle(const dvec2 &pt, const dvec2 &lowerLeft, const dvec2 &upperRight)
+* @fn	bool inRectangle(const rvec2 &pt, const rvec2 &lowerLeft, const rvec2 &upperRight)
 * @brief	Determines if (x,y) is inside (or on) a rectangle.
 * @param	pt		  	The point - (x,y)
 * @param	lowerLeft 	The lower left corner of the rectangle - (left, bottom).
@@ -934,7 +919,7 @@ bool inRectangle(double x, double y, double left, double bottom, double right, d
 * @return	true iff (x,y) is in/on the rectangle.
 */
 
-bool inRectangle(const dvec2 &pt, const dvec2 &lowerLeft, const dvec2 &upperRight) {
+bool inRectangle(const rvec2 &pt, const rvec2 &lowerLeft, const rvec2 &upperRight) {
 	return inRangeInclusive(pt.x, lowerLeft.x, upperRight.x) &&
 		inRangeInclusive(pt.y, lowerLeft.y, upperRight.y);
 }
@@ -956,17 +941,48 @@ string extractBaseFilename(const string &str) {
 	return str.substr(pos + 1);
 }
 
-bool DEBUG_PIXEL = false;
+/**
+ * @fn	void parallelFor(int numItems, int numThreads, const std::function<void(int)> &body)
+ * @brief	Calls body(0) ... body(numItems - 1), handing the items out to numThreads
+ * 			threads as they become free. The calling thread is one of them. Returns
+ * 			once every item is done.
+ * @param	numItems  	The number of items.
+ * @param	numThreads	Threads to use. 0 ==> one per core.
+ * @param	body	  	Processes one item. Must be safe to call concurrently.
+ */
+
+void parallelFor(int numItems, int numThreads, const std::function<void(int)> &body) {
+	int threads = numThreads > 0 ? numThreads : (int)std::thread::hardware_concurrency();
+	threads = glm::clamp(threads, 1, glm::max(numItems, 1));
+
+	std::atomic<int> nextItem(0);
+	auto worker = [&]() {
+		for (int i = nextItem++; i < numItems; i = nextItem++) {
+			body(i);
+		}
+	};
+
+	vector<std::thread> pool;
+	for (int i = 1; i < threads; i++) {
+		pool.push_back(std::thread(worker));
+	}
+	worker();
+	for (std::thread &t : pool) {
+		t.join();
+	}
+}
+
+thread_local bool DEBUG_PIXEL = false;
 int xDebug = -1, yDebug = -1;
 
 void mouseUtility(int b, int s, int x, int y) {
+#ifndef CONSOLE_ONLY
 	if (b == GLUT_RIGHT_BUTTON && s == GLUT_DOWN) {
 		xDebug = x;
-#ifndef CONSOLE_ONLY
 		yDebug = glutGet(GLUT_WINDOW_HEIGHT) - y - 1;
-#endif
 		cout << "(" << xDebug << "," << yDebug << ") = " << endl;
 	}
+#endif
 }
 
 void keyboardUtility(unsigned char key, int x, int y) {
@@ -13,91 +13,94 @@
 #include <vector>
 #include <cmath>
 #include <string>
+#include <functional>
 #include "defs.h"
 
-extern bool DEBUG_PIXEL;
+extern thread_local bool DEBUG_PIXEL;
 extern int xDebug, yDebug;
 void mouseUtility(int, int, int, int);
 void keyboardUtility(unsigned char key, int x, int y);
 
-void swap(double &a, double &b);
-bool approximatelyEqual(double a, double b);
-bool approximatelyZero(double a);
-double normalizeDegrees(double degrees);
-double normalizeRadians(double rads);
-double rad2deg(double rads);
-double deg2rad(double degs);
-double min(double a, double b, double c);
-double max(double a, double b, double c);
-double distanceFromOrigin(double x, double y);
-double distanceBetween(double x1, double y1, double x2, double y2);
-
-void pointOnUnitCircle(double angleRads, double &x, double &y);
-dvec2 pointOnCircle(const dvec2 &center, double R, double angleRads);
-
-double directionInRadians(double x1, double y1, double x2, double y2);
-double directionInRadians(const dvec2 &targetPt);
-double directionInRadians(const dvec2 &referencePt, const dvec2 &targetPt);
-
-dvec2 doubleIt(const dvec2 &V);
-dvec3 myNormalize(const dvec3 &V);
-bool isOrthogonal(const dvec3 &a, const dvec3 &b);
-bool formAcuteAngle(const dvec3& a, const dvec3& b);
-double cosBetween(const dvec2 &v1, const dvec2 &v2);
-double cosBetween(const dvec3 &v1, const dvec3 &v2);
-double cosBetween(const dvec4& v1, const dvec4& v2);
-
-double map(double x, double xLow, double xHigh, double yLow, double yHigh);
-
-vector<double> quadratic(double A, double B, double C);
-int quadratic(double A, double B, double C, double roots[2]);
-
-double areaOfParallelogram(const dvec3 &v1, const dvec3 &v2);
-double areaOfTriangle(const dvec3 &pt1, const dvec3 &pt2, const dvec3 &pt3);
-double areaOfTriangle(double a, double b, double c);
-double areaOfTriangle(double x1, double y1, double x2, double y2, double x3, double y3);
-
-dvec3 pointingVector(const dvec3 &pt1, const dvec3 &pt2);
-dvec3 getRow(const dmat3 &mat, int row);
-dvec3 getCol(const dmat3 &mat, int col);
-bool isInvertible(const dmat3 &mat);
-dvec3 solveLinearSystem(const dmat3 &M, const dvec3 &y);
-dmat3 addMatrices(const vector<dmat3> &M);
-dmat3 multiplyMatrices(const vector<dmat3> &M);
-dvec3 multiplyMatrixAndVertex(const dmat3 &M, const dvec3 &x);
-dvec3 multiplyMatricesAndVertex(const vector<dmat3> &M, const dvec3 &x);
-vector<dvec3> multiplyMatrixAndVertices(const dmat3 &M, const vector<dvec3> &verts);
-vector<dvec3> multiplyMatricesAndVertices(const vector<dmat3> &M, const vector<dvec3> &verts);
-
-void computeXYZFromAzimuthAndElevation(double R,
-										double az, double el,
-										double &x, double &y, double &z);
-void computeAzimuthAndElevationFromXYZ(double x, double y, double z,
-										double &R, double &az, double &el);
-void computeAzimuthAndElevationFromXYZ(const dvec3 &pt,
-										double &R, double &az, double &el);
+void swap(real &a, real &b);
+bool approximatelyEqual(real a, real b);
+bool approximatelyZero(real a);
+real normalizeDegrees(real degrees);
+real normalizeRadians(real rads);
+real rad2deg(real rads);
+real deg2rad(real degs);
+real min(real a, real b, real c);
+real max(real a, real b, real c);
+real distanceFromOrigin(real x, real y);
+real distanceBetween(real x1, real y1, real x2, real y2);
+
+void pointOnUnitCircle(real angleRads, real &x, real &y);
+rvec2 pointOnCircle(const rvec2 &center, real R, real angleRads);
+
+real directionInRadians(real x1, real y1, real x2, real y2);
+real directionInRadians(const rvec2 &targetPt);
+real directionInRadians(const rvec2 &referencePt, const rvec2 &targetPt);
+
+rvec2 doubleIt(const rvec2 &V);
+rvec3 myNormalize(const rvec3 &V);
+bool isOrthogonal(const rvec3 &a, const rvec3 &b);
+bool formAcuteAngle(const rvec3& a, const rvec3& b);
+real cosBetween(const rvec2 &v1, const rvec2 &v2);
+real cosBetween(const rvec3 &v1, const rvec3 &v2);
+real cosBetween(const rvec4& v1, const rvec4& v2);
+
+real map(real x, real xLow, real xHigh, real yLow, real yHigh);
+
+vector<real> quadratic(real A, real B, real C);
+int quadratic(real A, real B, real C, real roots[2]);
+
+real areaOfParallelogram(const rvec3 &v1, const rvec3 &v2);
+real areaOfTriangle(const rvec3 &pt1, const rvec3 &pt2, const rvec3 &pt3);
+real areaOfTriangle(real a, real b, real c);
+real areaOfTriangle(real x1, real y1, real x2, real y2, real x3, real y3);
+
+rvec3 pointingVector(const rvec3 &pt1, const rvec3 &pt2);
+rvec3 getRow(const rmat3 &mat, int row);
+rvec3 getCol(const rmat3 &mat, int col);
+bool isInvertible(const rmat3 &mat);
+rvec3 solveLinearSystem(const rmat3 &M, const rvec3 &y);
+rmat3 addMatrices(const vector<rmat3> &M);
+rmat3 multiplyMatrices(const vector<rmat3> &M);
+rvec3 multiplyMatrixAndVertex(const rmat3 &M, const rvec3 &x);
+rvec3 multiplyMatricesAndVertex(const vector<rmat3> &M, const rvec3 &x);
+vector<rvec3> multiplyMatrixAndVertices(const rmat3 &M, const vector<rvec3> &verts);
+vector<rvec3> multiplyMatricesAndVertices(const vector<rmat3> &M, const vector<rvec3> &verts);
+
+void computeXYZFromAzimuthAndElevation(real R,
+										real az, real el,
+										real &x, real &y, real &z);
+void computeAzimuthAndElevationFromXYZ(real x, real y, real z,
+										real &R, real &az, real &el);
+void computeAzimuthAndElevationFromXYZ(const rvec3 &pt,
+										real &R, real &az, real &el);
 
 string extractBaseFilename(const string &str);
 
+void parallelFor(int numItems, int numThreads, const std::function<void(int)> &body);
+
 // 2D versions
-dmat3 T(double dx, double dy);
-dmat3 S(double sx, double sy);
-dmat3 R(double deg);
-dmat3 vertShear(double a);
-dmat3 horzShear(double a);
+rmat3 T(real dx, real dy);
+rmat3 S(real sx, real sy);
+rmat3 R(real deg);
+rmat3 vertShear(real a);
+rmat3 horzShear(real a);
 
 // 3D versions
-dmat4 T(double dx, double dy, double dz);
-dmat4 S(double sx, double sy, double sz);
-dmat4 S(double scale);
-dmat4 Rx(double rads);
-dmat4 Ry(double rads);
-dmat4 Rz(double rads);
-
-bool inRangeInclusive(double val, double lo, double hi);
-bool inRangeExclusive(double val, double lo, double hi);
-bool inRectangle(double x, double y, double left, double bottom, double right, double top);
-bool inRectangle(const dvec2 &pt, const dvec2 &lowerLeft, const dvec2 &upperRight);
+rmat4 T(real dx, real dy, real dz);
+rmat4 S(real sx, real sy, real sz);
+rmat4 S(real scale);
+rmat4 Rx(real rads);
+rmat4 Ry(real rads);
+rmat4 Rz(real rads);
+
+bool inRangeInclusive(real val, real lo, real hi);
+bool inRangeExclusive(real val, real lo, real hi);
+bool inRectangle(real x, real y, real left, real bottom, real right, real top);
+bool inRectangle(const rvec2 &pt, const rvec2 &lowerLeft, const rvec2 &upperRight);
 
 /**
  * @fn	template <class T> vector< vector<T> > allocate2D(int rows, int cols)
@@ -118,7 +121,7 @@ vector<vector<T>> allocate2D(int rows, int cols) {
 }
 
 /**
- * @fn	template <class T> T weightedAverage(double W1, const T &item1, double W2, const T &item2)
+ * @fn	template <class T> T weightedAverage(real W1, const T &item1, real W2, const T &item2)
  * @brief	Computes the weighted average of two items.
  * @tparam	T	Generic type parameter.
  * @param	W1   	The first weight.
@@ -129,7 +132,7 @@ vector<vector<T>> allocate2D(int rows, int cols) {
  */
 
 template <class T>
-T weightedAverage(double W1, const T &item1, double W2, const T &item2) {
+T weightedAverage(real W1, const T &item1, real W2, const T &item2) {
 	return item1 * W1 + item2 * W2;
 }
 
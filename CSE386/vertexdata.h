@@ -17,23 +17,23 @@
  */
 
 struct VertexData {
-	dvec4 pos;			//!< Processed coordinate.
-	dvec3 normal;		//!< transformed normal vector.
-	dvec3 worldPos;		//!< Saved world position, for lighting calculations.
+	rvec4 pos;			//!< Processed coordinate.
+	rvec3 normal;		//!< transformed normal vector.
+	rvec3 worldPos;		//!< Saved world position, for lighting calculations.
 	Material material;	//!< This vertex's material.
 
-	VertexData(const dvec4 &pos, const dvec3 &norm,
-				const Material &mat, const dvec3 &worldPos);
-	VertexData(const dvec4 &pos) : VertexData(pos, Z_AXIS, bronze, ORIGIN3D) {
+	VertexData(const rvec4 &pos, const rvec3 &norm,
+				const Material &mat, const rvec3 &worldPos);
+	VertexData(const rvec4 &pos) : VertexData(pos, Z_AXIS, bronze, ORIGIN3D) {
 	}
-	VertexData(const dvec4 &pos, const dvec3 &norm, const Material &mat) :
+	VertexData(const rvec4 &pos, const rvec3 &norm, const Material &mat) :
 						VertexData(pos, norm, mat, ORIGIN3D) {
 	}
-	VertexData(double w1, const VertexData &vd1, double w2, const VertexData &vd2);
+	VertexData(real w1, const VertexData &vd1, real w2, const VertexData &vd2);
 	static void addTriVertsAndComputeNormal(vector<VertexData> &verts,
-											const dvec4 &V1, const dvec4 &V2, const dvec4 &V3,
+											const rvec4 &V1, const rvec4 &V2, const rvec4 &V3,
 											const Material &mat);
 	VertexData operator + (const VertexData &other) const;
 };
 
-VertexData operator * (double w, const VertexData &V1);
+VertexData operator * (real w, const VertexData &V1);
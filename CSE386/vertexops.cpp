@@ -7,70 +7,73 @@
  * permission is granted.
  ****************************************************/
 
+#include <thread>
 #include "defs.h"
 #include "vertexops.h"
 
 // Planes describing the normalized device coordinates view volume - 2x2x2 cube
 
-vector<IPlane> VertexOps::allButNearNDCPlanes{ IPlane(dvec3(1, 0, 0), dvec3(-1, 0, 0)),
-												IPlane(dvec3(0, 1, 0), dvec3(0, -1, 0)),
-												IPlane(dvec3(0, 0, 1), dvec3(0, 0, -1)),
-												IPlane(dvec3(-1, 0, 0), dvec3(1, 0, 0)),
-												IPlane(dvec3(0, -1, 0), dvec3(0, 1, 0)),
-//												IPlane(dvec3(0, 0, -1), dvec3(0, 0, 1))
+vector<IPlane> VertexOps::allButNearNDCPlanes{ IPlane(rvec3(1, 0, 0), rvec3(-1, 0, 0)),
+												IPlane(rvec3(0, 1, 0), rvec3(0, -1, 0)),
+												IPlane(rvec3(0, 0, 1), rvec3(0, 0, -1)),
+												IPlane(rvec3(-1, 0, 0), rvec3(1, 0, 0)),
+												IPlane(rvec3(0, -1, 0), rvec3(0, 1, 0)),
+//												IPlane(rvec3(0, 0, -1), rvec3(0, 0, 1))
 										};
 
+int VertexOps::numThreads = 1;
+int VertexOps::tileSize = 64;
+
+const int TRIANGLES_PER_CHUNK = 256;	//!< Triangles each thread transforms and clips at a time.
+
 /**
- * @fn	vector<VertexData> triangulate(const vector<VertexData> &poly)
+ * @fn	void triangulate(const vector<VertexData> &poly, vector<VertexData> &triangles)
  * @brief	Triangulates the given polygon
- * @param	poly	The polygon to be decomposed into individual triangles.
- * @return	A vector of triangles, which comprise the original polygon.
+ * @param 		  	poly	 	The polygon to be decomposed into individual triangles.
+ * @param [in,out]	triangles	The triangles that comprise the polygon are added to the end.
  */
 
-vector<VertexData> triangulate(const vector<VertexData> &poly) {
-	vector<VertexData> triangles;
-
-	for (unsigned int i = 1; i < poly.size() - 1; i++) {
+void triangulate(const vector<VertexData> &poly, vector<VertexData> &triangles) {
+	for (unsigned int i = 1; i + 1 < poly.size(); i++) {
 		triangles.push_back(poly[0]);
 		triangles.push_back(poly[i]);
 		triangles.push_back(poly[i + 1]);
 	}
-
-	return triangles;
 }
 
 /**
- * @fn	vector<VertexData> VertexOps::clipAgainstPlane(vector<VertexData> &verts, const IPlane &plane)
+ * @fn	void VertexOps::clipAgainstPlane(const vector<VertexData> &verts, const IPlane &plane,
+ *											vector<VertexData> &output)
  * @brief	Clips a polygon against a single plane
- * @param [in,out]	verts	The array of vertices.
- * @param 		  	plane	The plane that will do the clipping.
- * @return	The polygon that exludes the portions outside the given plane.
+ * @param 	   	verts 	The array of vertices.
+ * @param 	   	plane 	The plane that will do the clipping.
+ * @param [out]	output	The polygon that exludes the portions outside the given plane.
  */
 
-vector<VertexData> VertexOps::clipAgainstPlane(vector<VertexData> &verts, const IPlane &plane) {
-	vector<VertexData> output;
+void VertexOps::clipAgainstPlane(const vector<VertexData> &verts, const IPlane &plane,
+									vector<VertexData> &output) {
+	output.clear();
 
 	if (verts.size() > 2) {
-		verts.push_back(verts[0]);
-
-		for (unsigned int i = 1; i < verts.size(); i++) {
-			bool v0In = plane.onFrontSide(verts[i - 1].pos.xyz());
-			bool v1In = plane.onFrontSide(verts[i].pos.xyz());
+		const unsigned int N = (unsigned int)verts.size();
+		for (unsigned int i = 1; i <= N; i++) {
+			const VertexData &prev = verts[i - 1];
+			const VertexData &curr = verts[i % N];
+			bool v0In = plane.onFrontSide(prev.pos.xyz());
+			bool v1In = plane.onFrontSide(curr.pos.xyz());
 
 			if (v0In && v1In) {
-				output.push_back(verts[i]);
+				output.push_back(curr);
 			} else if (v0In || v1In) {
-				double t;
-				plane.findIntersection(verts[i - 1].pos.xyz(), verts[i].pos.xyz(), t);
-				VertexData I(1.0 - t, verts[i - 1], t, verts[i]);
-				output.push_back(I);
+				real t;
+				plane.findIntersection(prev.pos.xyz(), curr.pos.xyz(), t);
+				output.push_back(VertexData(1.0 - t, prev, t, curr));
 				if (!v0In && v1In) {
-					output.push_back(verts[i]);
+					output.push_back(curr);
 				}
 			}
 		}
 	}
-	return output;
 }
 
 /**
@@ -84,26 +87,38 @@ vector<VertexData> VertexOps::clipAgainstPlane(vector<VertexData> &verts, const
 vector<VertexData> VertexOps::clipPolygon(const vector<VertexData> &clipCoords,
 											const vector<IPlane> &planes) {
 	vector<VertexData> ndcCoords;
+	clipPolygon(clipCoords, planes, ndcCoords);
+	return ndcCoords;
+}
 
-	if (clipCoords.size() > 2) {
-		for (unsigned int i = 0; i < clipCoords.size() - 2; i += 3) {
-			vector<VertexData> polygon;
-			polygon.push_back(clipCoords[i]);
-			polygon.push_back(clipCoords[i + 1]);
-			polygon.push_back(clipCoords[i + 2]);
+/**
+ * @fn	void VertexOps::clipPolygon(const vector<VertexData> &clipCoords, const vector<IPlane> &planes,
+ *										vector<VertexData> &ndcCoords)
+ * @brief	Clip polygon against the normalized view volumn - 2x2x2 cube. Reuses per-thread
+ * 			scratch polygons, so once ndcCoords has grown to size nothing is allocated.
+ * @param 	   	clipCoords	The array of triangles.
+ * @param 	   	planes		Planes to clip against
+ * @param [out]	ndcCoords 	The array of triangles, after performing clipping.
+ */
 
-			for (const IPlane &plane : planes) {
-				polygon = clipAgainstPlane(polygon, plane);
-			}
-			if (polygon.size() > 3) {
-				polygon = triangulate(polygon);
-			}
-			for (const VertexData &v : polygon) {
-				ndcCoords.push_back(v);
-			}
+void VertexOps::clipPolygon(const vector<VertexData> &clipCoords, const vector<IPlane> &planes,
+							vector<VertexData> &ndcCoords) {
+	static thread_local vector<VertexData> polygon, clipped;
+	ndcCoords.clear();
+
+	for (int i = 0; i < (int)clipCoords.size() - 2; i += 3) {
+		polygon.assign(clipCoords.begin() + i, clipCoords.begin() + i + 3);
+
+		for (const IPlane &plane : planes) {
+			clipAgainstPlane(polygon, plane, clipped);
+			polygon.swap(clipped);
+		}
+		if (polygon.size() > 3) {
+			triangulate(polygon, ndcCoords);
+		} else {
+			ndcCoords.insert(ndcCoords.end(), polygon.begin(), polygon.end());
 		}
 	}
-	return ndcCoords;
 }
 
 /**
@@ -133,11 +148,11 @@ vector<VertexData> VertexOps::clipLineSegments(const vector<VertexData> &clipCoo
 					outsideViewVolume = true;
 					break; 
 				} else if (v0In && !v1In) {
-					double t;
+					real t;
 					plane.findIntersection(v0.pos.xyz(), v1.pos.xyz(), t);
 					v1 = VertexData(1.0-t, v0, t, v1);
 				} else if (!v0In && v1In) {
-					double t;
+					real t;
 					plane.findIntersection(v0.pos.xyz(), v1.pos.xyz(), t);
 					v0 = VertexData(1.0-t, v0, t, v1);
 				} else {  // both inside
@@ -154,98 +169,371 @@ vector<VertexData> VertexOps::clipLineSegments(const vector<VertexData> &clipCoo
 }
 
  /**
- * @fn	vector<VertexData> VertexOps::processBackwardFacingTriangles(const vector<VertexData> &triangleVerts,
- *																	 bool renderBackfaces)
- * @brief	Removes the backward facing triangles
- * @param	triangleVerts	The vector of triangle vertices.
- * @return	Vector of triangle vertices, without those facing backward.
+ * @fn	void VertexOps::processBackwardFacingTriangles(vector<VertexData> &triangleVerts,
+ *														bool renderBackfaces)
+ * @brief	Removes the backward facing triangles, in place. If they are to be rendered,
+ * 			their normals are flipped instead.
+ * @param [in,out]	triangleVerts  	The vector of triangle vertices.
+ * @param 		  	renderBackfaces	True if backfaces are to be rendered
  */
 
-vector<VertexData> VertexOps::processBackwardFacingTriangles(const vector<VertexData> &triangleVerts, bool renderBackfaces) {
-	vector<VertexData> triangles;
+void VertexOps::processBackwardFacingTriangles(vector<VertexData> &triangleVerts, bool renderBackfaces) {
+	int numKept = 0;
 
 	for (int i = 0; i < (int)triangleVerts.size() - 2; i += 3) {
-		dvec3 n = normalFrom3Points(triangleVerts[i].pos.xyz(), 
+		rvec3 n = normalFrom3Points(triangleVerts[i].pos.xyz(), 
 									triangleVerts[i + 1].pos.xyz(), 
 									triangleVerts[i + 2].pos.xyz());
-		if (n.z >= 0.0) {
-			triangles.push_back(triangleVerts[i]);
-			triangles.push_back(triangleVerts[i + 1]);
-			triangles.push_back(triangleVerts[i + 2]);
-		} else if (renderBackfaces) {
-			triangles.push_back(triangleVerts[i]);
-			triangles.back().normal *= -1;
-
-			triangles.push_back(triangleVerts[i + 1]);
-			triangles.back().normal *= -1;
-
-			triangles.push_back(triangleVerts[i + 2]);
-			triangles.back().normal *= -1;
+		if (n.z >= 0.0 || renderBackfaces) {
+			for (int j = 0; j < 3; j++) {
+				triangleVerts[numKept + j] = triangleVerts[i + j];
+				if (n.z < 0.0) {
+					triangleVerts[numKept + j].normal *= -1;
+				}
+			}
+			numKept += 3;
 		}
 	}
-	return triangles;
+	triangleVerts.erase(triangleVerts.begin() + numKept, triangleVerts.end());
 }
 
 /**
- * @fn	vector<VertexData> VertexOps::transformVerticesToWorldCoordinates(const dmat4 &modelMatrix, 
- *																			const vector<VertexData> &vertices)
- * @brief	Apply modeling transformation to vector of vertices. This method is called only
- *          for the first stage of the pipeline.
- * @param	modelMatrix	Modeling matrix.
- * @param	vertices   	The vector of vertices.
- * @return	The transformed vertices.
+ * @fn	const DrawMatrices &VertexOps::getDrawMatrices(const rmat4 &modelingMatrix,
+ *														const PipelineMatrices &pipeMats)
+ * @brief	Gets the matrices for a draw. They are cached, per thread: the parts that depend
+ * 			on the camera are only recomputed when the viewing or projection matrix changes,
+ * 			and the rest only when the modeling matrix changes as well.
+ * @param	modelingMatrix	The transformation applied to the object
+ * @param	pipeMats	  	The pipeline matrices
+ * @return	The draw matrices. Valid until the next call on this thread.
  */
 
-vector<VertexData> VertexOps::transformVerticesToWorldCoordinates(const dmat4 &modelMatrix, 
-																	const vector<VertexData> &vertices) {
-	// Create 3 x 3 matrix for transforming normal vectors to world coordinates
-	dmat3 TM3x3(modelMatrix);
-	dmat3 modelingTransfomationForNormals = glm::transpose(glm::inverse(TM3x3));
+const DrawMatrices &VertexOps::getDrawMatrices(const rmat4 &modelingMatrix,
+												const PipelineMatrices &pipeMats) {
+	static thread_local DrawMatrices cached;
+	static thread_local PipelineMatrices cachedPipeMats;
+	static thread_local bool haveCamera = false;
+	static thread_local bool haveModel = false;
+
+	if (!haveCamera || pipeMats.viewingMatrix != cachedPipeMats.viewingMatrix ||
+						pipeMats.projectionMatrix != cachedPipeMats.projectionMatrix) {
+		cachedPipeMats = pipeMats;
+		cached.viewProjection = pipeMats.projectionMatrix * pipeMats.viewingMatrix;
+		cached.eyePos = glm::inverse(pipeMats.viewingMatrix)[3].xyz();
+		cached.eyeFrame = Frame::createOrthoNormalBasis(pipeMats.viewingMatrix);
+		haveCamera = true;
+		haveModel = false;
+	}
+	if (!haveModel || modelingMatrix != cached.modelingMatrix) {
+		cached.modelingMatrix = modelingMatrix;
+		cached.modelViewProjection = cached.viewProjection * modelingMatrix;
+		cached.normalMatrix = glm::transpose(glm::inverse(rmat3(modelingMatrix)));
+		haveModel = true;
+	}
+	cached.viewportMatrix = pipeMats.viewportMatrix;
+	return cached;
+}
 
-	vector<VertexData> transformedVertices;
-	for (unsigned int i=0; i<vertices.size(); i++) {
+/**
+ * @fn	void VertexOps::transformVertices(const rmat4 &TM, vector<VertexData> &vertices)
+ * @brief	Applies a transformation matrix to a vector of vertices, in place. Does not
+ * 			change the worldPosition.
+ * @param 		  	TM			The transformation matrix.
+ * @param [in,out]	vertices   	The vertices.
+ */
+
+void VertexOps::transformVertices(const rmat4 &TM, vector<VertexData> &vertices) {
+	for (VertexData &v : vertices) {
+		v.pos = TM * v.pos;
+	}
+}
+
+/**
+ * @brief	Outcode bits, one for each plane of the view volume in clip coordinates, plus
+ * 			one for leaving the guard band.
+ */
+
+enum Outcode {
+	OUT_LEFT = 1, OUT_RIGHT = 2, OUT_BOTTOM = 4, OUT_TOP = 8, OUT_NEAR = 16, OUT_FAR = 32,
+	OUT_GUARD_BAND = 64
+};
+
+/**
+ * @brief	Half width of the guard band, in NDC units. Triangles that cross only the left,
+ * 			right, bottom or top planes, and stay within the guard band, are not clipped;
+ * 			the rasterizer confines them to the window. 64 keeps window coordinates well
+ * 			within the rasterizer's +/- 2^20 pixel range for windows up to 16384 pixels.
+ */
+
+static const real GUARD_BAND = 64.0;
+
+/**
+ * @fn	unsigned int outcode(const rvec4 &p)
+ * @brief	Computes the clip coordinate outcode of a point: one bit for each plane of
+ * 			the view volume the point is outside of, and OUT_GUARD_BAND if it is outside
+ * 			the guard band.
+ * @param	p	The point, in clip coordinates.
+ * @return	The outcode. Zero means inside.
+ */
+
+inline unsigned int outcode(const rvec4 &p) {
+	real limit = GUARD_BAND * p.w;
+	return (p.x < -p.w ? OUT_LEFT : 0) | (p.x > p.w ? OUT_RIGHT : 0) |
+			(p.y < -p.w ? OUT_BOTTOM : 0) | (p.y > p.w ? OUT_TOP : 0) |
+			(p.z < -p.w ? OUT_NEAR : 0) | (p.z > p.w ? OUT_FAR : 0) |
+			(std::abs(p.x) <= limit && std::abs(p.y) <= limit ? 0 : OUT_GUARD_BAND);
+}
+
+/**
+ * @fn	inline void perspectiveDivide(rvec4 &pos)
+ * @brief	Takes a position from clip coordinates to normalized device coordinates.
+ * @param [in,out]	pos	The position.
+ */
+
+inline void perspectiveDivide(rvec4 &pos) {
+	if (pos.w >= 0) {
+		pos /= pos.w;
+	} else {							// should not happen
+		pos.x /= -pos.w;
+		pos.y /= -pos.w;
+		pos.z = -std::abs(pos.z/-pos.w);
+		pos.w = 1.0;
+	}
+}
+
+/**
+ * @fn	void VertexOps::transformMeshVertices(const DrawMatrices &drawMats,
+ *												const VertexData vertices[], int first, int last,
+ *												TransformedVertices &transformed)
+ * @brief	Takes a run of vertices from object coordinates straight to clip coordinates, in
+ * 			a single pass. The world position and world normal, needed for lighting, are
+ * 			saved along the way, as are each vertex's outcode and its normalized device and
+ * 			window coordinates. transformed must already hold a copy of the vertices.
+ * @param 		  	drawMats   	The draw matrices.
+ * @param 		  	vertices   	The vertices, in object coordinates.
+ * @param 		  	first	   	Index of the first vertex to transform.
+ * @param 		  	last	   	One past the index of the last vertex to transform.
+ * @param [in,out]	transformed	The post-transform vertices.
+ */
+
+void VertexOps::transformMeshVertices(const DrawMatrices &drawMats,
+										const VertexData vertices[], int first, int last,
+										TransformedVertices &transformed) {
+	const rmat4 &M = drawMats.modelingMatrix;
+	const rmat4 &MVP = drawMats.modelViewProjection;
+	const rmat3 &N = drawMats.normalMatrix;
+	const rmat4 &viewportMatrix = drawMats.viewportMatrix;
+
+	for (int i = first; i < last; i++) {
 		const VertexData &v = vertices[i];
-		dvec3 n = modelingTransfomationForNormals * v.normal;
-		dvec4 worldPos = modelMatrix * v.pos;
-		VertexData vt(worldPos, n, v.material, worldPos.xyz());
-		transformedVertices.push_back(vt);
+		VertexData &clip = transformed.clipCoords[i];
+		clip.pos = MVP * v.pos;
+		clip.normal = glm::normalize(N * v.normal);
+		clip.worldPos = (M * v.pos).xyz();
+
+		transformed.outcodes[i] = outcode(clip.pos);
+		rvec4 ndc = clip.pos;
+		perspectiveDivide(ndc);
+		transformed.ndcCoords[i] = ndc;
+		transformed.windowCoords[i] = viewportMatrix * ndc;
+	}
+}
+
+/**
+ * @fn	void VertexOps::prepareTransformedVertices(const VertexData vertices[], int count,
+ *													TransformedVertices &transformed)
+ * @brief	Sizes the post-transform vertices for a mesh, and copies its vertices in.
+ * @param 	   	vertices   	The vertices, in object coordinates.
+ * @param 	   	count	   	The number of vertices.
+ * @param [out]	transformed	The post-transform vertices.
+ */
+
+void VertexOps::prepareTransformedVertices(const VertexData vertices[], int count,
+											TransformedVertices &transformed) {
+	transformed.clipCoords.assign(vertices, vertices + count);
+	transformed.outcodes.resize(count);
+	transformed.ndcCoords.resize(count);
+	transformed.windowCoords.resize(count);
+}
+
+/**
+ * @fn	void VertexOps::clipAgainstNearPlane(const vector<VertexData> &verts,
+ *												vector<VertexData> &output)
+ * @brief	Clips a polygon in clip coordinates against the near plane, z = -w.
+ * @param 	   	verts 	The array of vertices.
+ * @param [out]	output	The polygon that exludes the portion in front of the near plane.
+ */
+
+void VertexOps::clipAgainstNearPlane(const vector<VertexData> &verts, vector<VertexData> &output) {
+	output.clear();
+
+	if (verts.size() > 2) {
+		const unsigned int N = (unsigned int)verts.size();
+		for (unsigned int i = 1; i <= N; i++) {
+			const VertexData &prev = verts[i - 1];
+			const VertexData &curr = verts[i % N];
+			real d0 = prev.pos.z + prev.pos.w;
+			real d1 = curr.pos.z + curr.pos.w;
+			bool v0In = d0 >= 0.0;
+			bool v1In = d1 >= 0.0;
+
+			if (v0In && v1In) {
+				output.push_back(curr);
+			} else if (v0In || v1In) {
+				real t = d0 / (d0 - d1);
+				output.push_back(VertexData(1.0 - t, prev, t, curr));
+				if (!v0In && v1In) {
+					output.push_back(curr);
+				}
+			}
+		}
 	}
-	return transformedVertices;
 }
 
 /**
- * @fn	vector<VertexData> VertexOps::transformVertices(const dmat4 &TM, 
- *														const vector<VertexData> & vertices)
- * @brief	Applies a transformation matrix to a vector of vertices. Does not change the worldPosition; copies it over.
- * @param	TM			The transformation matrix.
- * @param	vertices   	The vertices.
- * @return	The transformed vector of vertices.
+ * @fn	void VertexOps::assembleTriangles(const DrawMatrices &drawMats,
+ *											const TransformedVertices &transformed,
+ *											const unsigned int indices[], int first, int last,
+ *											bool renderBackfaces,
+ *											vector<VertexData> &windowCoords)
+ * @brief	Assembles triangles from transformed vertices, clipping and culling as it goes.
+ * 			Outcodes trivially reject triangles outside one plane of the view volume. A
+ * 			triangle that crosses no plane but the left, right, bottom or top, and stays
+ * 			within the guard band, goes to the rasterizer unclipped. Only triangles crossing
+ * 			the near or far plane, or leaving the guard band, are clipped. Triangles come
+ * 			out in their original order. Each triangle is handled on its own, so any run of
+ * 			triangles can be done independently of the rest. Intermediate results live in
+ * 			per-thread buffers that keep their capacity, so a steady stream of draws does
+ * 			not allocate.
+ * @param 	   	drawMats			The draw matrices.
+ * @param 	   	transformed			The transformed vertices.
+ * @param 	   	indices				Vertex index triplets. nullptr ==> successive vertex triplets.
+ * @param 	   	first				Position in indices of the first triangle's first vertex.
+ * @param 	   	last				One past the position in indices of the last triangle's last vertex.
+ * @param 	   	renderBackfaces 	True if backfaces are to be rendered
+ * @param [out]	windowCoords		The window coordinates of the surviving triangles.
  */
 
-vector<VertexData> VertexOps::transformVertices(const dmat4 &TM, const vector<VertexData> & vertices) {
-	vector<VertexData> transformedVertices;
+void VertexOps::assembleTriangles(const DrawMatrices &drawMats,
+									const TransformedVertices &transformed,
+									const unsigned int indices[], int first, int last,
+									bool renderBackfaces,
+									vector<VertexData> &windowCoords) {
+	static thread_local vector<VertexData> polygon, clipped, ndcCoords;
+	const rmat4 &viewportMatrix = drawMats.viewportMatrix;
+	const vector<unsigned int> &codes = transformed.outcodes;
+
+	windowCoords.clear();
+	for (int i = first; i + 2 < last; i += 3) {
+		unsigned int tri[3];
+		for (int j = 0; j < 3; j++) {
+			tri[j] = indices != nullptr ? indices[i + j] : i + j;
+		}
+		unsigned int c0 = codes[tri[0]];
+		unsigned int c1 = codes[tri[1]];
+		unsigned int c2 = codes[tri[2]];
 
-	for (const VertexData &v : vertices) {
-		VertexData vt(TM * v.pos, v.normal, v.material);
-		// Save the world position separately for use in per pixel lighting calculations
-		vt.worldPos = v.worldPos;
+		if ((c0 & c1 & c2 & ~OUT_GUARD_BAND) != 0) {	// all outside one plane
+			continue;
+		}
+		if (((c0 | c1 | c2) & (OUT_NEAR | OUT_FAR | OUT_GUARD_BAND)) == 0) {
+			const rvec4 &p0 = transformed.ndcCoords[tri[0]];
+			const rvec4 &p1 = transformed.ndcCoords[tri[1]];
+			const rvec4 &p2 = transformed.ndcCoords[tri[2]];
+			rvec3 n = normalFrom3Points(p0.xyz(), p1.xyz(), p2.xyz());
+			if (n.z < 0.0 && !renderBackfaces) {
+				continue;
+			}
+			for (int j = 0; j < 3; j++) {
+				windowCoords.push_back(transformed.clipCoords[tri[j]]);
+				windowCoords.back().pos = transformed.windowCoords[tri[j]];
+				if (n.z < 0.0) {
+					windowCoords.back().normal *= -1;
+				}
+			}
+			continue;
+		}
 
-		transformedVertices.push_back(vt);
+		polygon.clear();					// needs clipping
+		for (int j = 0; j < 3; j++) {
+			polygon.push_back(transformed.clipCoords[tri[j]]);
+		}
+		clipAgainstNearPlane(polygon, clipped);
+		polygon.clear();
+		triangulate(clipped, polygon);
+		for (VertexData &v : polygon) {
+			perspectiveDivide(v.pos);
+		}
+		processBackwardFacingTriangles(polygon, renderBackfaces);
+		clipPolygon(polygon, allButNearNDCPlanes, ndcCoords);
+		for (VertexData &v : ndcCoords) {
+			windowCoords.push_back(v);
+			windowCoords.back().pos = viewportMatrix * v.pos;
+		}
 	}
-	return transformedVertices;
 }
 
-double computeNearPlane(const dmat4 &PM) {
-	double alpha = PM[2][2];
-	double beta = PM[3][2];
-	double gamma = PM[2][3];
-	double omega = PM[3][3];
-	double nearf = -(omega + beta) / (alpha + gamma);
-	return nearf;
+/**
+ * @fn	void VertexOps::binAndDrawTriangles(FrameBuffer &frameBuffer, const rvec3 &eyePos,
+ *											const vector<LightSourcePtr> &lights,
+ *											const vector<VertexData> &windowCoords,
+ *											const Frame &eyeFrame, int threads)
+ * @brief	Sorts window coordinate triangles into the tileSize x tileSize screen tiles their
+ * 			bounding boxes touch, then draws the tiles on several threads. Each tile draws
+ * 			its triangles in their original order and touches only its own pixels, so the
+ * 			result is identical to drawManyFilledTriangles. tileSize is rounded up to a
+ * 			multiple of FRAMEBUFFER_TILE_SIZE, so that no tile of the framebuffer's coarse
+ * 			depth buffer is shared by two threads.
+ * @param [in,out]	frameBuffer 	Buffer for frame data.
+ * @param 		  	eyePos			The eye position.
+ * @param 		  	lights			The lights.
+ * @param 		  	windowCoords	The vertex-triplets, in window coordinates.
+ * @param 		  	eyeFrame    	The camera's frame.
+ * @param 		  	threads			Number of threads to draw with.
+ */
+
+void VertexOps::binAndDrawTriangles(FrameBuffer &frameBuffer, const rvec3 &eyePos,
+									const vector<LightSourcePtr> &lights,
+									const vector<VertexData> &windowCoords,
+									const Frame &eyeFrame, int threads) {
+	const int W = frameBuffer.getWindowWidth();
+	const int H = frameBuffer.getWindowHeight();
+	const int depthTile = FRAMEBUFFER_TILE_SIZE;
+	const int tile = tileSize > 0 ? (tileSize + depthTile - 1) / depthTile * depthTile : 64;
+	const int tilesAcross = (W + tile - 1) / tile;
+	const int tilesUp = (H + tile - 1) / tile;
+
+	static thread_local vector<vector<int>> tileBins;
+	vector<vector<int>> &bins = tileBins;	// the workers need this thread's bins, not their own
+	bins.resize(tilesAcross * tilesUp);
+	for (vector<int> &bin : bins) {
+		bin.clear();
+	}
+	for (int i = 0; i < (int)windowCoords.size() - 2; i += 3) {
+		const rvec4 &p0 = windowCoords[i].pos, &p1 = windowCoords[i + 1].pos, &p2 = windowCoords[i + 2].pos;
+		int xMin = glm::max(0, (int)glm::floor(min(p0.x, p1.x, p2.x)));
+		int xMax = glm::min(W - 1, (int)glm::ceil(max(p0.x, p1.x, p2.x)));
+		int yMin = glm::max(0, (int)glm::floor(min(p0.y, p1.y, p2.y)));
+		int yMax = glm::min(H - 1, (int)glm::ceil(max(p0.y, p1.y, p2.y)));
+		for (int ty = yMin / tile; yMin <= yMax && ty <= yMax / tile; ty++) {
+			for (int tx = xMin / tile; xMin <= xMax && tx <= xMax / tile; tx++) {
+				bins[ty * tilesAcross + tx].push_back(i);
+			}
+		}
+	}
+
+	parallelFor((int)bins.size(), threads, [&](int b) {
+		BoundingBoxi scissor((b % tilesAcross) * tile, tile, (b / tilesAcross) * tile, tile);
+		for (int i : bins[b]) {
+			drawFilledTriangle(frameBuffer, eyePos, lights,
+								windowCoords[i], windowCoords[i + 1], windowCoords[i + 2],
+								eyeFrame, scissor);
+		}
+	});
 }
 
 /**
- * @fn	void VertexOps::processTriangleVertices(FrameBuffer &frameBuffer, const dvec3 &eyePos, 
+ * @fn	void VertexOps::processTriangleVertices(FrameBuffer &frameBuffer, const rvec3 &eyePos, 
  *												const vector<LightSourcePtr> &lights, 
  *												const vector<VertexData> &objectCoords)
  * @brief	Transforms the triangle vertices through pipeline: 
@@ -253,52 +541,121 @@ double computeNearPlane(const dmat4 &PM) {
  * @param [in,out]	frameBuffer 	Buffer for frame data.
  * @param 		  	eyePos			The eye position.
  * @param 		  	lights			The lights.
- * @param 		  	objectCoords	The object coordinates.
+ * @param 		  	objectCoords	The object coordinates, as successive vertex triplets.
  */
 
-void VertexOps::processTriangleVertices(FrameBuffer &frameBuffer, const dvec3 &eyePos,
+void VertexOps::processTriangleVertices(FrameBuffer &frameBuffer, const rvec3 &eyePos,
 										const vector<LightSourcePtr> &lights,
 										const vector<VertexData> &objectCoords,
-										const dmat4& modelingMatrix,
+										const rmat4& modelingMatrix,
 										const PipelineMatrices& pipeMats,
 										bool renderBackfaces) {
-	const dmat4& viewingMatrix = pipeMats.viewingMatrix;
-	const dmat4& projectionMatrix = pipeMats.projectionMatrix;
-	const dmat4& viewportMatrix = pipeMats.viewportMatrix;
+	processTriangles(frameBuffer, eyePos, lights, objectCoords.data(), (int)objectCoords.size(),
+						nullptr, (int)objectCoords.size(), modelingMatrix, pipeMats, renderBackfaces);
+}
 
-	vector<VertexData> worldCoords = transformVerticesToWorldCoordinates(modelingMatrix, objectCoords);
-	vector<VertexData> eyeCoords = transformVertices(viewingMatrix, worldCoords);
+/**
+ * @fn	void VertexOps::processTriangleVertices(FrameBuffer &frameBuffer, const rvec3 &eyePos, 
+ *												const vector<LightSourcePtr> &lights, 
+ *												const EShapeData &shape)
+ * @brief	Transforms the triangles of an indexed mesh through pipeline: 
+ *					object -> world -> eye -> clip/ndc -> window.
+ * @param [in,out]	frameBuffer 	Buffer for frame data.
+ * @param 		  	eyePos			The eye position.
+ * @param 		  	lights			The lights.
+ * @param 		  	shape			The mesh, in object coordinates.
+ */
 
-	double nearZ = computeNearPlane(projectionMatrix);
-	vector <IPlane> nearPlane = { IPlane(dvec4(0.0, 0.0, nearZ, 1.0), -Z_AXIS) };
-	vector<VertexData> eyeCoordsClippedOnNearPlane = clipPolygon(eyeCoords, nearPlane);
+void VertexOps::processTriangleVertices(FrameBuffer &frameBuffer, const rvec3 &eyePos,
+										const vector<LightSourcePtr> &lights,
+										const EShapeData &shape,
+										const rmat4& modelingMatrix,
+										const PipelineMatrices& pipeMats,
+										bool renderBackfaces) {
+	processTriangles(frameBuffer, eyePos, lights, shape.vertices.data(), (int)shape.vertices.size(),
+						shape.indices.data(), (int)shape.indices.size(), 
+						modelingMatrix, pipeMats, renderBackfaces);
+}
 
-	vector<VertexData> projCoords = transformVertices(projectionMatrix, eyeCoordsClippedOnNearPlane);
-	vector<VertexData> clipCoords;
+/**
+ * @fn	void VertexOps::processTriangles(FrameBuffer &frameBuffer, const rvec3 &eyePos,
+ *										const vector<LightSourcePtr> &lights,
+ *										const VertexData vertices[], int numVertices,
+ *										const unsigned int indices[], int numIndices,
+ *										const rmat4& modelingMatrix,
+ *										const PipelineMatrices& pipeMats,
+ *										bool renderBackfaces)
+ * @brief	Draws triangles. Every vertex is transformed exactly once, into a post-transform
+ * 			buffer that all the triangles sharing it read from; then the triangles are
+ * 			assembled, clipped and rasterized.
+ * 			With more than one thread, this is a sort-middle pipeline: runs of vertices are
+ * 			transformed and runs of triangles assembled in parallel, and the results are
+ * 			binned into screen tiles that are rasterized in parallel. The image is identical
+ * 			to the serial one.
+ * @param [in,out]	frameBuffer 	Buffer for frame data.
+ * @param 		  	eyePos			The eye position.
+ * @param 		  	lights			The lights.
+ * @param 		  	vertices		The vertices, in object coordinates.
+ * @param 		  	numVertices		The number of vertices.
+ * @param 		  	indices			Vertex index triplets. nullptr ==> successive vertex triplets.
+ * @param 		  	numIndices		The number of indices, or of vertices if indices is nullptr.
+ * @param 		  	modelingMatrix  The transformation applied to the object
+ * @param 		  	pipeMats		The pipeline matrices
+ * @param 		  	renderBackfaces True if backfaces are to be rendered
+ */
 
-	for (VertexData v : projCoords) {		// Perspective division
-		if (v.pos.w >= 0) {
-			v.pos /= v.pos.w;
-		} else {							// should not happen
-			v.pos.x /= -v.pos.w;
-			v.pos.y /= -v.pos.w;
-			v.pos.z = -std::abs(v.pos.z/-v.pos.w);
-			v.pos.w = 1.0;
-		}
-		clipCoords.push_back(v);
+void VertexOps::processTriangles(FrameBuffer &frameBuffer, const rvec3 &eyePos,
+									const vector<LightSourcePtr> &lights,
+									const VertexData vertices[], int numVertices,
+									const unsigned int indices[], int numIndices,
+									const rmat4& modelingMatrix,
+									const PipelineMatrices& pipeMats,
+									bool renderBackfaces) {
+	const DrawMatrices &drawMats = getDrawMatrices(modelingMatrix, pipeMats);
+	const Frame &eyeFrame = drawMats.eyeFrame;
+	int threads = numThreads > 0 ? numThreads : (int)std::thread::hardware_concurrency();
+	static thread_local TransformedVertices transformedVertices;
+	static thread_local vector<VertexData> windowCoords;
+	TransformedVertices &transformed = transformedVertices;	// the workers need this thread's buffers, not their own
+
+	prepareTransformedVertices(vertices, numVertices, transformed);
+	if (threads <= 1) {
+		transformMeshVertices(drawMats, vertices, 0, numVertices, transformed);
+		assembleTriangles(drawMats, transformed, indices, 0, numIndices, renderBackfaces, windowCoords);
+		drawManyFilledTriangles(frameBuffer, eyePos, lights, windowCoords, eyeFrame);
+		return;
 	}
 
-	clipCoords = processBackwardFacingTriangles(clipCoords, renderBackfaces);	
-
-	vector<VertexData> ndcCoords = clipPolygon(clipCoords, allButNearNDCPlanes);
-	vector<VertexData> windowCoords = transformVertices(viewportMatrix, ndcCoords);
-
-	Frame eyeFrame = Frame::createOrthoNormalBasis(viewingMatrix);
-	drawManyFilledTriangles(frameBuffer, eyePos, lights, windowCoords, eyeFrame);
+	const int VERTICES_PER_CHUNK = 3 * TRIANGLES_PER_CHUNK;
+	const int numVertexChunks = (numVertices + VERTICES_PER_CHUNK - 1) / VERTICES_PER_CHUNK;
+	parallelFor(numVertexChunks, threads, [&](int c) {
+		int first = c * VERTICES_PER_CHUNK;
+		int last = glm::min(first + VERTICES_PER_CHUNK, numVertices);
+		transformMeshVertices(drawMats, vertices, first, last, transformed);
+	});
+
+	const int numTriangles = numIndices / 3;
+	const int numChunks = (numTriangles + TRIANGLES_PER_CHUNK - 1) / TRIANGLES_PER_CHUNK;
+	static thread_local vector<vector<VertexData>> chunkBuffers;
+	vector<vector<VertexData>> &chunks = chunkBuffers;
+	if ((int)chunks.size() < numChunks) {
+		chunks.resize(numChunks);
+	}
+	parallelFor(numChunks, threads, [&](int c) {
+		int first = 3 * c * TRIANGLES_PER_CHUNK;
+		int last = 3 * glm::min((c + 1) * TRIANGLES_PER_CHUNK, numTriangles);
+		assembleTriangles(drawMats, transformed, indices, first, last, renderBackfaces, chunks[c]);
+	});
+
+	windowCoords.clear();
+	for (int c = 0; c < numChunks; c++) {
+		windowCoords.insert(windowCoords.end(), chunks[c].begin(), chunks[c].end());
+	}
+	binAndDrawTriangles(frameBuffer, eyePos, lights, windowCoords, eyeFrame, threads);
 }
 
 /**
- * @fn	void VertexOps::processLineSegments(FrameBuffer &frameBuffer, const dvec3 &eyePos,
+ * @fn	void VertexOps::processLineSegments(FrameBuffer &frameBuffer, const rvec3 &eyePos,
  *											const vector<LightSourcePtr> &lights,
  *											const vector<VertexData> &objectCoords)
  * @brief	Process the line segments through the pipeline.
@@ -308,40 +665,36 @@ void VertexOps::processTriangleVertices(FrameBuffer &frameBuffer, const dvec3 &e
  * @param 		  	objectCoords	The vector of object coordinates.
  */
 
-void VertexOps::processLineSegments(FrameBuffer &frameBuffer, const dvec3 &eyePos,
+void VertexOps::processLineSegments(FrameBuffer &frameBuffer, const rvec3 &eyePos,
 									const vector<LightSourcePtr> &lights,
 									const vector<VertexData> &objectCoords,
-									const dmat4& modelingMatrix,
+									const rmat4& modelingMatrix,
 									const PipelineMatrices &pipeMats) {
-	const dmat4& viewingMatrix = pipeMats.viewingMatrix;
-	const dmat4& projectionMatrix = pipeMats.projectionMatrix;
-	const dmat4& viewportMatrix = pipeMats.viewportMatrix;
+	const DrawMatrices &drawMats = getDrawMatrices(modelingMatrix, pipeMats);
+	static thread_local TransformedVertices transformed;
+	vector<VertexData> &clipCoords = transformed.clipCoords;
 
-	vector<VertexData> worldCoords = transformVerticesToWorldCoordinates(modelingMatrix, objectCoords);
+	prepareTransformedVertices(objectCoords.data(), (int)objectCoords.size(), transformed);
+	transformMeshVertices(drawMats, objectCoords.data(), 0, (int)objectCoords.size(), transformed);
 
-	vector<VertexData> eyeCoords = transformVertices(viewingMatrix, worldCoords);
-	vector<VertexData> projCoords = transformVertices(projectionMatrix, eyeCoords);
-	vector<VertexData> clipCoords;
-
-	for (VertexData v : projCoords) {	// Perspective division
+	for (VertexData &v : clipCoords) {	// Perspective division
 		if (v.pos.w >= 0)
 			v.pos /= v.pos.w;
 		else {							// this should not happen
 			v.pos /= -v.pos.w;
 			v.pos.z = -std::abs(v.pos.z);
 		}
-		clipCoords.push_back(v);
 	}
 
-	vector<VertexData> ndcCoords = clipLineSegments(clipCoords, allButNearNDCPlanes);
-	vector<VertexData> windowCoords = transformVertices(viewportMatrix, ndcCoords);
-	Frame eyeFrame = Frame::createOrthoNormalBasis(viewingMatrix);
+	vector<VertexData> windowCoords = clipLineSegments(clipCoords, allButNearNDCPlanes);
+	transformVertices(drawMats.viewportMatrix, windowCoords);
+	const Frame &eyeFrame = drawMats.eyeFrame;
 	drawManyLines(frameBuffer, eyePos, lights, windowCoords, eyeFrame);
 }
 
 /**
  * @fn	void VertexOps::render(FrameBuffer &frameBuffer, const vector<VertexData> &verts,
- *								const vector<LightSourcePtr> &lights, const dmat4 &TM)
+ *								const vector<LightSourcePtr> &lights, const rmat4 &TM)
  * @brief	Renders this object
  * @param [in,out]	frameBuffer	Buffer for frame data.
  * @param 		  	verts	   	The vertices.
@@ -353,21 +706,41 @@ void VertexOps::processLineSegments(FrameBuffer &frameBuffer, const dvec3 &eyePo
 
 void VertexOps::render(FrameBuffer &frameBuffer, const vector<VertexData> &verts,
 							const vector<LightSourcePtr> &lights,
-							const dmat4& modelingMatrix,
+							const rmat4& modelingMatrix,
 							const PipelineMatrices &pipeMats,
 							bool renderBackfaces) {
-	const dmat4& viewingMatrix = pipeMats.viewingMatrix;
-
-	dvec3 eyePos = glm::inverse(viewingMatrix)[3].xyz();
+	rvec3 eyePos = getDrawMatrices(modelingMatrix, pipeMats).eyePos;
 	VertexOps::processTriangleVertices(frameBuffer, eyePos, lights, verts,
 		modelingMatrix, pipeMats, renderBackfaces);
 }
 
+/**
+ * @fn	void VertexOps::render(FrameBuffer &frameBuffer, const EShapeData &shape,
+ *								const vector<LightSourcePtr> &lights, const rmat4 &TM)
+ * @brief	Renders an indexed mesh
+ * @param [in,out]	frameBuffer	Buffer for frame data.
+ * @param 		  	shape	   	The mesh.
+ * @param 		  	lights	   	The lights.
+ * @param           modelingMatrix  The transformation applied to the object
+ * @param 		  	pipeMats    The pipeline matrices
+ * @param           renderBackfaces True if backfaces are to be rendered
+ */
+
+void VertexOps::render(FrameBuffer &frameBuffer, const EShapeData &shape,
+							const vector<LightSourcePtr> &lights,
+							const rmat4& modelingMatrix,
+							const PipelineMatrices &pipeMats,
+							bool renderBackfaces) {
+	rvec3 eyePos = getDrawMatrices(modelingMatrix, pipeMats).eyePos;
+	VertexOps::processTriangleVertices(frameBuffer, eyePos, lights, shape,
+		modelingMatrix, pipeMats, renderBackfaces);
+}
+
 /**
  * @fn	void VertexOps::getViewportTransformation()
  * @brief	Sets viewport transformation based on the current viewport settings.
  */
 
-dmat4 VertexOps::getViewportTransformation(int left, int width, int bottom, int height) {
-	return T((double)left, (double)bottom, 0.0) * S(width / 2.0, height / 2.0, 1.0) * T(1.0, 1.0, 0.0);
+rmat4 VertexOps::getViewportTransformation(int left, int width, int bottom, int height) {
+	return T((real)left, (real)bottom, 0.0) * S(width / 2.0, height / 2.0, 1.0) * T(1.0, 1.0, 0.0);
 }
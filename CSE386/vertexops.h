@@ -13,6 +13,7 @@
 #include "framebuffer.h"
 #include "light.h"
 #include "vertexdata.h"
+#include "eshape.h"
 #include "iscene.h"
 #include "rasterization.h"
 
@@ -22,9 +23,38 @@
   */
 
 struct PipelineMatrices {
-	dmat4 viewingMatrix;
-	dmat4 projectionMatrix;
-	dmat4 viewportMatrix;
+	rmat4 viewingMatrix;
+	rmat4 projectionMatrix;
+	rmat4 viewportMatrix;
+};
+
+/**
+ * @struct	DrawMatrices
+ * @brief	The matrices needed to draw one object, derived from its modeling matrix and
+ * 			the pipeline matrices. See VertexOps::getDrawMatrices.
+ */
+
+struct DrawMatrices {
+	rmat4 modelingMatrix;		//!< Object to world coordinates.
+	rmat4 viewProjection;		//!< World to clip coordinates.
+	rmat4 modelViewProjection;	//!< Object to clip coordinates.
+	rmat3 normalMatrix;			//!< Object to world coordinates, for normal vectors.
+	rmat4 viewportMatrix;		//!< NDC to window coordinates.
+	rvec3 eyePos;				//!< Eye position, in world coordinates.
+	Frame eyeFrame;				//!< The camera's frame.
+};
+
+/**
+ * @struct	TransformedVertices
+ * @brief	Post-transform vertex cache. Holds a mesh's vertices after the vertex stage, so
+ * 			every triangle sharing a vertex reuses the one transformation of it.
+ */
+
+struct TransformedVertices {
+	vector<VertexData> clipCoords;	//!< Clip coordinates, with world position and world normal.
+	vector<unsigned int> outcodes;	//!< Planes of the view volume, and guard band, each vertex is outside of.
+	vector<rvec4> ndcCoords;		//!< Normalized device coordinates.
+	vector<rvec4> windowCoords;		//!< Window coordinates.
 };
 
 /**
@@ -35,34 +65,73 @@ struct PipelineMatrices {
 class VertexOps {
 public:
 	static vector<IPlane> allButNearNDCPlanes;		//!< 5 of the 6 planes of the 2x2x2 cube.
+	static int numThreads;		//!< Threads used to process triangles. 1 ==> serial (default), 0 ==> one per core.
+	static int tileSize;		//!< Width and height, in pixels, of the screen tiles triangles are binned into.
 
-	static void processTriangleVertices(FrameBuffer &frameBuffer, const dvec3 &eyePos,
+	static void processTriangleVertices(FrameBuffer &frameBuffer, const rvec3 &eyePos,
 										const vector<LightSourcePtr> &lights,
 										const vector<VertexData> &objectCoords,
-										const dmat4& modelingMatrix,
+										const rmat4& modelingMatrix,
 										const PipelineMatrices& pipeMats,
 										bool renderBackfaces);
-	static void processLineSegments(FrameBuffer &frameBuffer, const dvec3 &eyePos,
+	static void processTriangleVertices(FrameBuffer &frameBuffer, const rvec3 &eyePos,
+										const vector<LightSourcePtr> &lights,
+										const EShapeData &shape,
+										const rmat4& modelingMatrix,
+										const PipelineMatrices& pipeMats,
+										bool renderBackfaces);
+	static void processLineSegments(FrameBuffer &frameBuffer, const rvec3 &eyePos,
 									const vector<LightSourcePtr> &lights,
 									const vector<VertexData> &objectCoords,
-									const dmat4& modelingMatrix,
+									const rmat4& modelingMatrix,
 									const PipelineMatrices&pipeMats);
 	static void render(FrameBuffer &frameBuffer, const vector<VertexData> &verts,
 								const vector<LightSourcePtr> &lights,
-								const dmat4& modelingMatrix,
+								const rmat4& modelingMatrix,
 								const PipelineMatrices&pipeMats,
 								bool renderBackfaces
 		);
-	static dmat4 getViewportTransformation(int left, int width, int bottom, int height);
-protected:
-	static vector<VertexData> clipAgainstPlane(vector<VertexData> &verts, const IPlane &plane);
+	static void render(FrameBuffer &frameBuffer, const EShapeData &shape,
+								const vector<LightSourcePtr> &lights,
+								const rmat4& modelingMatrix,
+								const PipelineMatrices&pipeMats,
+								bool renderBackfaces);
+	static rmat4 getViewportTransformation(int left, int width, int bottom, int height);
 	static vector<VertexData> clipPolygon(const vector<VertexData> &clipCoords,
 											const vector<IPlane> &planes);
+	static void clipPolygon(const vector<VertexData> &clipCoords,
+							const vector<IPlane> &planes,
+							vector<VertexData> &ndcCoords);
+protected:
+	static const DrawMatrices &getDrawMatrices(const rmat4 &modelingMatrix,
+												const PipelineMatrices &pipeMats);
+	static void processTriangles(FrameBuffer &frameBuffer, const rvec3 &eyePos,
+									const vector<LightSourcePtr> &lights,
+									const VertexData vertices[], int numVertices,
+									const unsigned int indices[], int numIndices,
+									const rmat4& modelingMatrix,
+									const PipelineMatrices& pipeMats,
+									bool renderBackfaces);
+	static void prepareTransformedVertices(const VertexData vertices[], int count,
+											TransformedVertices &transformed);
+	static void transformMeshVertices(const DrawMatrices &drawMats,
+										const VertexData vertices[], int first, int last,
+										TransformedVertices &transformed);
+	static void assembleTriangles(const DrawMatrices &drawMats,
+									const TransformedVertices &transformed,
+									const unsigned int indices[], int first, int last,
+									bool renderBackfaces,
+									vector<VertexData> &windowCoords);
+	static void binAndDrawTriangles(FrameBuffer &frameBuffer, const rvec3 &eyePos,
+									const vector<LightSourcePtr> &lights,
+									const vector<VertexData> &windowCoords,
+									const Frame &eyeFrame, int threads);
+	static void clipAgainstPlane(const vector<VertexData> &verts, const IPlane &plane,
+									vector<VertexData> &output);
+	static void clipAgainstNearPlane(const vector<VertexData> &verts, vector<VertexData> &output);
 	static vector<VertexData> clipLineSegments(const vector<VertexData> &clipCoords,
 												const vector<IPlane> &planes);
-	static vector<VertexData> processBackwardFacingTriangles(const vector<VertexData> &triangleVerts,
-																bool renderBackfaces);
-	static vector<VertexData> transformVerticesToWorldCoordinates(const dmat4 &modelMatrix,
-																	const vector<VertexData> &vertices);
-	static vector<VertexData> transformVertices(const dmat4 &TM, const vector<VertexData> &vertices);
+	static void processBackwardFacingTriangles(vector<VertexData> &triangleVerts,
+												bool renderBackfaces);
+	static void transformVertices(const rmat4 &TM, vector<VertexData> &vertices);
 };
@@ -12,8 +12,8 @@
 #include "ishape.h"
 
 /**
- * @fn	VertexData::VertexData(const dvec4 &P, const dvec3 &norm, 
-								const Material &mat, const dvec3 &WP)
+ * @fn	VertexData::VertexData(const rvec4 &P, const rvec3 &norm, 
+								const Material &mat, const rvec3 &WP)
  * @brief	Constructor
  * @param	P			Current coordinate.
  * @param	norm		Normal vector
@@ -21,15 +21,15 @@
  * @param	WP			World position.
  */
 
-VertexData::VertexData(const dvec4 &P,
-				const dvec3 &norm,
+VertexData::VertexData(const rvec4 &P,
+				const rvec3 &norm,
 				const Material &mat,
-				const dvec3 &WP) :
+				const rvec3 &WP) :
 	pos(P), normal(glm::normalize(norm)), material(mat), worldPos(WP) {
 }
 
 /**
- * @fn	VertexData::VertexData(double w1, const VertexData &vd1, double w2, const VertexData &vd2)
+ * @fn	VertexData::VertexData(real w1, const VertexData &vd1, real w2, const VertexData &vd2)
  * @brief	Constructs object using weighted average of two VertexData objects.
  * @param	w1 	Weight #1.
  * @param	vd1	VertexData #1.
@@ -37,8 +37,8 @@ VertexData::VertexData(const dvec4 &P,
  * @param	vd2	VertexData #2.
  */
 
-VertexData::VertexData(double w1, const VertexData &vd1,
-					double w2, const VertexData &vd2)
+VertexData::VertexData(real w1, const VertexData &vd1,
+					real w2, const VertexData &vd2)
 					: pos(weightedAverage(w1, vd1.pos, w2, vd2.pos)),
 						normal(weightedAverage(w1, vd1.normal, w2, vd2.normal)),
 						material(weightedAverage(w1, vd1.material, w2, vd2.material)),
@@ -47,7 +47,7 @@ VertexData::VertexData(double w1, const VertexData &vd1,
 
 /**
  * @fn	void VertexData::addTriVertsAndComputeNormal(vector<VertexData> &verts, 
- *													const dvec4 &V1, const dvec4 &V2, const dvec4 &V3, 
+ *													const rvec4 &V1, const rvec4 &V2, const rvec4 &V3, 
  *													const Material &mat)
  * @brief	Adds a triangle vertices and computes normal, adding vertices to end of verts. 
  *          Vertices are specified in counterclockwise order.
@@ -59,25 +59,25 @@ VertexData::VertexData(double w1, const VertexData &vd1,
  */
 
 void VertexData::addTriVertsAndComputeNormal(vector<VertexData> &verts,
-											const dvec4 &V1,
-											const dvec4 &V2,
-											const dvec4 &V3,
+											const rvec4 &V1,
+											const rvec4 &V2,
+											const rvec4 &V3,
 											const Material &mat) {
-	dvec3 n = normalFrom3Points(V1.xyz(), V2.xyz(), V3.xyz());
+	rvec3 n = normalFrom3Points(V1.xyz(), V2.xyz(), V3.xyz());
 	verts.push_back(VertexData(V1, n, mat));
 	verts.push_back(VertexData(V2, n, mat));
 	verts.push_back(VertexData(V3, n, mat));
 }
 
 /**
- * @fn	VertexData operator* (double w, const VertexData &data)
+ * @fn	VertexData operator* (real w, const VertexData &data)
  * @brief	Multiplication operator for VertexData objects
  * @param	w   	The scalar multiplier.
  * @param	data	Vertex data to scale.
  * @return	The scaled Vertex data.
  */
 
-VertexData operator * (double w, const VertexData &data) {
+VertexData operator * (real w, const VertexData &data) {
 	VertexData result(w*data.pos, w*data.normal, w*data.material, w*data.worldPos);
 	return result;
 }